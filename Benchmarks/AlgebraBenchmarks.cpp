@@ -0,0 +1,101 @@
+#include <cmath>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "Benchmark.h"
+#include "SlimeMath.h"
+
+namespace Bench {
+    namespace {
+        template<typename T>
+        void algebra_benchmarks(Runner &runner) {
+            const std::string type = type_name<T>();
+
+            std::vector<T> a(singleItems), b(singleItems), t(singleItems), out(singleItems);
+            for (std::size_t i = 0; i < singleItems; ++i) {
+                a[i] = random_value<T>(rng());
+                b[i] = random_value<T>(rng());
+                t[i] = random_value<T>(rng());
+            }
+
+            auto scalar_op = [&](const std::string &name, auto op) {
+                runner.run("Sm::" + name, type, "single", singleItems, [&] {
+                    for (std::size_t i = 0; i < singleItems; ++i)
+                        out[i] = op(a[i], b[i], t[i]);
+                    do_not_optimize(out.data());
+                });
+            };
+
+            scalar_op("lerp", [](T x, T y, T s) { return Sm::lerp(x, y, s); });
+            scalar_op("mix", [](T x, T y, T s) { return Sm::mix(x, y, s, T(1) - s); });
+            scalar_op("saturate", [](T x, T, T) { return Sm::saturate(x); });
+            scalar_op("clamp", [](T x, T y, T s) { return Sm::clamp(x, (std::min)(y, s), (std::max)(y, s)); });
+            scalar_op("smooth_step", [](T x, T, T) { return Sm::smooth_step(x); });
+            scalar_op("smoother_step", [](T x, T, T) { return Sm::smoother_step(x); });
+            scalar_op("reciprocal", [](T x, T, T) { return Sm::reciprocal(x); });
+            scalar_op("rescale", [](T x, T, T) { return Sm::rescale(x, T(-4), T(4), T(0), T(1)); });
+
+            // Approximations next to the standard library calls they replace
+            if constexpr (std::is_floating_point<T>::value) {
+                auto std_op = [&](const std::string &name, auto op) {
+                    runner.run("std::" + name, type, "single", singleItems, [&] {
+                        for (std::size_t i = 0; i < singleItems; ++i)
+                            out[i] = op(a[i]);
+                        do_not_optimize(out.data());
+                    });
+                };
+
+                std_op("rsqrt", [](T x) { return T(1) / std::sqrt(std::abs(x)); });
+                scalar_op("fast::rsqrt", [](T x, T, T) { return Sm::fast::rsqrt(std::abs(x)); });
+                std_op("sin", [](T x) { return std::sin(x); });
+                scalar_op("fast::sin", [](T x, T, T) { return Sm::fast::sin(x); });
+                std_op("cos", [](T x) { return std::cos(x); });
+                scalar_op("fast::cos", [](T x, T, T) { return Sm::fast::cos(x); });
+                std_op("acos", [](T x) { return std::acos(x * T(0.25)); });
+                scalar_op("fast::acos", [](T x, T, T) { return Sm::fast::acos(x * T(0.25)); });
+
+                // Whole arrays, the fast kernels run a pack of lanes per instruction
+                std::vector<T> angles(batchItems), cosines(batchItems), results(batchItems);
+                for (std::size_t i = 0; i < batchItems; ++i) {
+                    angles[i] = random_value<T>(rng());
+                    cosines[i] = angles[i] * T(0.25);
+                }
+
+                auto batch_op = [&](const std::string &name, const std::vector<T> &input, auto op) {
+                    runner.run(name, type, "batch", batchItems, [&] {
+                        op(input.data(), results.data(), batchItems);
+                        do_not_optimize(results.data());
+                    });
+                };
+
+                batch_op("std::sin", angles, [](const T *in, T *res, std::size_t count) {
+                    for (std::size_t i = 0; i < count; ++i)
+                        res[i] = std::sin(in[i]);
+                });
+                batch_op("Sm::fast::sin", angles, [](const T *in, T *res, std::size_t count) {
+                    Sm::fast::sin(in, res, count);
+                });
+                batch_op("std::cos", angles, [](const T *in, T *res, std::size_t count) {
+                    for (std::size_t i = 0; i < count; ++i)
+                        res[i] = std::cos(in[i]);
+                });
+                batch_op("Sm::fast::cos", angles, [](const T *in, T *res, std::size_t count) {
+                    Sm::fast::cos(in, res, count);
+                });
+                batch_op("std::acos", cosines, [](const T *in, T *res, std::size_t count) {
+                    for (std::size_t i = 0; i < count; ++i)
+                        res[i] = std::acos(in[i]);
+                });
+                batch_op("Sm::fast::acos", cosines, [](const T *in, T *res, std::size_t count) {
+                    Sm::fast::acos(in, res, count);
+                });
+            }
+        }
+    }
+
+    void register_algebra_benchmarks(Runner &runner) {
+        algebra_benchmarks<float>(runner);
+        algebra_benchmarks<double>(runner);
+        algebra_benchmarks<int>(runner);
+    }
+}
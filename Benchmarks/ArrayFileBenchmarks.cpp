@@ -0,0 +1,83 @@
+#include <cstdio>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "SlimeMath.h"
+#include "ArrayFile.h"
+
+// Streaming a point cloud into an array file and running a kernel straight on the mapped data,
+// next to the text round trip through operator<< the library had before.
+namespace Bench {
+    namespace {
+        void array_file_benchmarks(Runner &runner) {
+            const std::size_t count = 1 << 20, chunk = 1 << 16;
+            const std::string workload = std::to_string(count) + " Vec3";
+            const std::string path = (std::filesystem::temp_directory_path() / "slimemaths_benchmark.smaf").string();
+
+            std::vector<Vec3> points(count), out(count);
+            for (auto &point: points)
+                point = Vec3{random_value<float>(rng()), random_value<float>(rng()), random_value<float>(rng())};
+            Mat4 model;
+            for (std::size_t i = 0; i < model.elements; ++i)
+                model[i] = random_value<float>(rng());
+
+            Result *result = runner.run("ArrayFileWriter::append", "float", workload, count, [&] {
+                ArrayFileWriter writer{path};
+                writer.begin<Vec3>("points");
+                for (std::size_t i = 0; i < count; i += chunk)
+                    writer.append(points.data() + i, chunk);
+                writer.end();
+                writer.finish();
+            });
+            Runner::add_counter(result, "MB", double(count * sizeof(Vec3)) / 1e6);
+
+            runner.run("ArrayFileWriter::append(SoA)", "float", workload, count, [&] {
+                ArrayFileWriter writer{path + ".soa"};
+                writer.begin_soa<float, 3>("points", count);
+                for (std::size_t i = 0; i < count; i += chunk)
+                    writer.append(points.data() + i, chunk);
+                writer.end();
+                writer.finish();
+            });
+
+            /* Make sure both files exist even when the filter skipped the writers */
+            {
+                ArrayFileWriter writer{path};
+                writer.write("points", points.data(), count);
+                writer.write_soa("soa", points.data(), count);
+                writer.finish();
+            }
+
+            runner.run("ArrayFileReader+Sm::transform_points", "float", workload, count, [&] {
+                ArrayFileReader reader{path};
+                const ArraySpan<Vec3> mapped = reader.array<Vec3>("points");
+                Sm::transform_points(model, mapped.data(), out.data(), mapped.size());
+                do_not_optimize(out.data());
+            });
+            runner.run("ArrayFileReader::soa", "float", workload, count, [&] {
+                ArrayFileReader reader{path};
+                const SoASpan<float, 3> mapped = reader.soa<float, 3>("soa");
+                float sum = 0.0f;
+                for (std::size_t i = 0; i < mapped.size(); ++i)
+                    sum += mapped.component(1)[i];
+                do_not_optimize(sum);
+            });
+
+            runner.run("operator<<(stringstream)", "float", workload, count, [&] {
+                std::stringstream stream;
+                for (const auto &point: points)
+                    stream << point << '\n';
+                do_not_optimize(stream);
+            });
+
+            std::remove(path.c_str());
+            std::remove((path + ".soa").c_str());
+        }
+    }
+
+    void register_array_file_benchmarks(Runner &runner) {
+        array_file_benchmarks(runner);
+    }
+}
@@ -0,0 +1,271 @@
+#include <cmath>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "Benchmark.h"
+#include "SlimeMath.h"
+
+// Batch entry points next to the equivalent loop over the single element functions.
+namespace Bench {
+    namespace {
+        template<typename T, std::size_t N>
+        void vector_array_benchmarks(Runner &runner) {
+            using V = Vector<T, N>;
+            const std::string type = type_name<T>();
+            const std::string prefix = "VectorArray<" + std::to_string(N) + ">::";
+
+            std::vector<V> aos(batchItems);
+            for (auto &vec: aos)
+                for (std::size_t c = 0; c < N; ++c)
+                    vec[c] = random_value<T>(rng());
+            VectorArray<T, N> soa{aos.data(), aos.size()};
+            std::vector<T> out(batchItems);
+
+            runner.run(prefix + "Sm::length", type, "batch", batchItems, [&] {
+                Sm::length(soa, out.data());
+            });
+            runner.run(prefix + "Sm::length(loop)", type, "batch", batchItems, [&] {
+                for (std::size_t i = 0; i < batchItems; ++i)
+                    out[i] = Sm::length(aos[i]);
+            });
+            runner.run(prefix + "Sm::dot", type, "batch", batchItems, [&] {
+                Sm::dot(soa, soa, out.data());
+            });
+            runner.run(prefix + "Sm::dot(loop)", type, "batch", batchItems, [&] {
+                for (std::size_t i = 0; i < batchItems; ++i)
+                    out[i] = Sm::dot(aos[i], aos[i]);
+            });
+            runner.run(prefix + "Sm::normalize", type, "batch", batchItems, [&] {
+                Sm::normalize(soa);
+            });
+            runner.run(prefix + "Sm::normalize(loop)", type, "batch", batchItems, [&] {
+                for (std::size_t i = 0; i < batchItems; ++i)
+                    Sm::normalize(aos[i]);
+            });
+            runner.run(prefix + "Sm::fast::normalize", type, "batch", batchItems, [&] {
+                Sm::fast::normalize(soa);
+            });
+            runner.run(prefix + "Sm::resize", type, "batch", batchItems, [&] {
+                Sm::resize(soa, T(2));
+            });
+        }
+
+        template<typename T>
+        void transform_benchmarks(Runner &runner) {
+            using V3 = Vector<T, 3>;
+            using V4 = Vector<T, 4>;
+            const std::string type = type_name<T>();
+
+            Matrix<T, 4, 4> mat;
+            Matrix<T, 3, 3> mat3;
+            for (std::size_t i = 0; i < mat.elements; ++i)
+                mat[i] = random_value<T>(rng());
+            for (std::size_t i = 0; i < mat3.elements; ++i)
+                mat3[i] = random_value<T>(rng());
+
+            std::vector<V3> in3(batchItems), out3(batchItems);
+            std::vector<V4> in4(batchItems), out4(batchItems);
+            for (std::size_t i = 0; i < batchItems; ++i) {
+                in3[i] = V3{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng())};
+                in4[i] = V4{in3[i], random_value<T>(rng())};
+            }
+
+            runner.run("Sm::transform_points", type, "batch", batchItems, [&] {
+                Sm::transform_points(mat, in3.data(), out3.data(), batchItems);
+            });
+            runner.run("Sm::transform_points(loop)", type, "batch", batchItems, [&] {
+                for (std::size_t i = 0; i < batchItems; ++i)
+                    out3[i] = V3{Sm::operator*(mat, V4{in3[i], T(1)})};
+            });
+            runner.run("Sm::transform_directions", type, "batch", batchItems, [&] {
+                Sm::transform_directions(mat, in3.data(), out3.data(), batchItems);
+            });
+            /* Integer w can be zero after the transform */
+            if (std::is_floating_point<T>::value)
+                runner.run("Sm::transform_points_projected", type, "batch", batchItems, [&] {
+                    Sm::transform_points_projected(mat, in3.data(), out3.data(), batchItems);
+                });
+            runner.run("Sm::transform(Mat4,Vec4)", type, "batch", batchItems, [&] {
+                Sm::transform(mat, in4.data(), out4.data(), batchItems);
+            });
+            runner.run("Sm::transform(Mat4,Vec4)(loop)", type, "batch", batchItems, [&] {
+                for (std::size_t i = 0; i < batchItems; ++i)
+                    out4[i] = Sm::operator*(mat, in4[i]);
+            });
+            runner.run("Sm::transform(Mat3,Vec3)", type, "batch", batchItems, [&] {
+                Sm::transform(mat3, in3.data(), out3.data(), batchItems);
+            });
+        }
+
+        template<typename T>
+        void slerp_benchmarks(Runner &runner) {
+            using Q = Quaternion<T>;
+            const std::string type = type_name<T>();
+
+            std::vector<Q> from(batchItems), to(batchItems), out(batchItems);
+            std::vector<T> t(batchItems);
+            for (std::size_t i = 0; i < batchItems; ++i) {
+                from[i] = Q{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng()),
+                            random_value<T>(rng())}.Normalized();
+                to[i] = Q{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng()),
+                          random_value<T>(rng())}.Normalized();
+                t[i] = T(i % 97) / T(97);
+            }
+
+            runner.run("Sm::slerp(Accurate)", type, "batch", batchItems, [&] {
+                Sm::slerp(from.data(), to.data(), t.data(), out.data(), batchItems, Sm::SlerpMode::Accurate);
+            });
+            runner.run("Sm::slerp(Fast)", type, "batch", batchItems, [&] {
+                Sm::slerp(from.data(), to.data(), t.data(), out.data(), batchItems, Sm::SlerpMode::Fast);
+            });
+            runner.run("Sm::slerp(loop)", type, "batch", batchItems, [&] {
+                for (std::size_t i = 0; i < batchItems; ++i)
+                    out[i] = Sm::slerp(from[i], to[i], t[i]);
+            });
+        }
+
+        template<typename T>
+        void palette_benchmarks(Runner &runner) {
+            using Q = Quaternion<T>;
+            using V3 = Vector<T, 3>;
+            const std::string type = type_name<T>();
+
+            std::vector<Q> rotations(batchItems);
+            std::vector<V3> translations(batchItems), scales(batchItems);
+            for (std::size_t i = 0; i < batchItems; ++i) {
+                rotations[i] = Q{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng()),
+                                 random_value<T>(rng())}.Normalized();
+                translations[i] = V3{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng())};
+                scales[i] = V3{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng())};
+            }
+
+            std::vector<Matrix<T, 3, 3>> mat3(batchItems);
+            std::vector<Matrix<T, 3, 4>> palette3x4(batchItems);
+            std::vector<Matrix<T, 4, 4>> palette4x4(batchItems);
+
+            runner.run("Sm::quaternion_to_matrix(Mat3)", type, "batch", batchItems, [&] {
+                Sm::quaternion_to_matrix(rotations.data(), mat3.data(), batchItems);
+            });
+            runner.run("Sm::quaternion_to_matrix(Mat3)(loop)", type, "batch", batchItems, [&] {
+                for (std::size_t i = 0; i < batchItems; ++i)
+                    Sm::quaternion_to_matrix(mat3[i], rotations[i]);
+            });
+            runner.run("Sm::compose_palette(3x4)", type, "batch", batchItems, [&] {
+                Sm::compose_palette(rotations.data(), translations.data(), scales.data(), palette3x4.data(),
+                                    batchItems);
+            });
+            runner.run("Sm::compose_palette(4x4)", type, "batch", batchItems, [&] {
+                Sm::compose_palette(rotations.data(), translations.data(), scales.data(), palette4x4.data(),
+                                    batchItems);
+            });
+            /* The usual per bone code: build T, R and S as matrices and multiply them */
+            runner.run("Sm::compose_palette(4x4)(loop)", type, "batch", batchItems, [&] {
+                for (std::size_t i = 0; i < batchItems; ++i) {
+                    Matrix<T, 3, 3> r{};
+                    Sm::quaternion_to_matrix(r, rotations[i]);
+                    Matrix<T, 4, 4> rotation, translation, scale;
+                    for (std::size_t row = 0; row < 3; ++row)
+                        for (std::size_t col = 0; col < 3; ++col)
+                            rotation(row, col) = r(row, col);
+                    for (std::size_t c = 0; c < 3; ++c) {
+                        translation(c, 3) = translations[i][c];
+                        scale(c, c) = scales[i][c];
+                    }
+                    palette4x4[i] = translation * rotation * scale;
+                }
+            });
+        }
+
+        template<typename T>
+        void skinning_benchmarks(Runner &runner) {
+            using Q = Quaternion<T>;
+            using V3 = Vector<T, 3>;
+            const std::string type = type_name<T>();
+            const std::size_t boneCount = 256;
+
+            std::vector<Q> rotations(boneCount);
+            std::vector<V3> translations(boneCount);
+            std::vector<DualQuaternion<T>> bones(boneCount);
+            std::vector<Matrix<T, 3, 4>> palette(boneCount);
+            for (std::size_t b = 0; b < boneCount; ++b) {
+                rotations[b] = Q{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng()),
+                                 random_value<T>(rng())}.Normalized();
+                translations[b] = V3{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng())};
+                bones[b] = DualQuaternion<T>{rotations[b], translations[b]};
+            }
+            Sm::compose_palette(rotations.data(), translations.data(), palette.data(), boneCount);
+
+            std::vector<unsigned> indices(batchItems * Sm::skinInfluences);
+            std::vector<T> weights(batchItems * Sm::skinInfluences);
+            std::vector<V3> positions(batchItems), normals(batchItems), outPositions(batchItems), outNormals(batchItems);
+            for (std::size_t i = 0; i < batchItems; ++i) {
+                T sum = T(0);
+                for (std::size_t k = 0; k < Sm::skinInfluences; ++k) {
+                    indices[i * Sm::skinInfluences + k] = static_cast<unsigned>(rng()() % boneCount);
+                    weights[i * Sm::skinInfluences + k] = std::abs(random_value<T>(rng())) + T(0.01);
+                    sum += weights[i * Sm::skinInfluences + k];
+                }
+                for (std::size_t k = 0; k < Sm::skinInfluences; ++k)
+                    weights[i * Sm::skinInfluences + k] /= sum;
+                positions[i] = V3{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng())};
+                normals[i] = V3{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng())};
+            }
+
+            runner.run("Sm::skin(DualQuaternion)", type, "batch", batchItems, [&] {
+                Sm::skin(bones.data(), indices.data(), weights.data(), positions.data(), normals.data(),
+                         outPositions.data(), outNormals.data(), batchItems);
+            });
+            /* Per vertex blend with the DualQuaternion operators */
+            runner.run("Sm::skin(DualQuaternion)(loop)", type, "batch", batchItems, [&] {
+                for (std::size_t i = 0; i < batchItems; ++i) {
+                    const unsigned *index = indices.data() + i * Sm::skinInfluences;
+                    const T *weight = weights.data() + i * Sm::skinInfluences;
+                    const Q &pivot = bones[index[0]].real;
+                    DualQuaternion<T> blend = bones[index[0]] * weight[0];
+                    for (std::size_t k = 1; k < Sm::skinInfluences; ++k) {
+                        const DualQuaternion<T> &bone = bones[index[k]];
+                        blend += bone * (Sm::dot(bone.real, pivot) < T(0) ? -weight[k] : weight[k]);
+                    }
+                    blend.Normalize();
+                    outPositions[i] = blend.transform_point(positions[i]);
+                    outNormals[i] = blend.transform_direction(normals[i]);
+                }
+            });
+            runner.run("Sm::skin(Matrix<3, 4>)", type, "batch", batchItems, [&] {
+                Sm::skin(palette.data(), indices.data(), weights.data(), positions.data(), normals.data(),
+                         outPositions.data(), outNormals.data(), batchItems);
+            });
+            runner.run("Sm::skin(Matrix<3, 4>)(loop)", type, "batch", batchItems, [&] {
+                for (std::size_t i = 0; i < batchItems; ++i) {
+                    const unsigned *index = indices.data() + i * Sm::skinInfluences;
+                    const T *weight = weights.data() + i * Sm::skinInfluences;
+                    Matrix<T, 3, 4> blend = palette[index[0]] * weight[0];
+                    for (std::size_t k = 1; k < Sm::skinInfluences; ++k)
+                        blend += palette[index[k]] * weight[k];
+                    const V3 &p = positions[i], &n = normals[i];
+                    for (std::size_t r = 0; r < 3; ++r) {
+                        outPositions[i][r] = blend(r, 0) * p.x + blend(r, 1) * p.y + blend(r, 2) * p.z + blend(r, 3);
+                        outNormals[i][r] = blend(r, 0) * n.x + blend(r, 1) * n.y + blend(r, 2) * n.z;
+                    }
+                }
+            });
+        }
+
+        template<typename T>
+        void batch_benchmarks_for_type(Runner &runner) {
+            vector_array_benchmarks<T, 3>(runner);
+            vector_array_benchmarks<T, 4>(runner);
+            transform_benchmarks<T>(runner);
+            palette_benchmarks<T>(runner);
+            skinning_benchmarks<T>(runner);
+        }
+    }
+
+    void register_batch_benchmarks(Runner &runner) {
+        batch_benchmarks_for_type<float>(runner);
+        batch_benchmarks_for_type<double>(runner);
+        transform_benchmarks<int>(runner);
+        slerp_benchmarks<float>(runner);
+        slerp_benchmarks<double>(runner);
+    }
+}
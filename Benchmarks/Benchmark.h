@@ -0,0 +1,405 @@
+#ifndef SLIMEMATHS_BENCHMARK_H
+#define SLIMEMATHS_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Minimal self contained micro benchmark harness.
+// Every benchmark is a callable that processes `items` elements per invocation. The runner grows the
+// invocation count until one sample lasts at least min_time, takes the median of several samples
+// and reports nanoseconds per item and items per second.
+
+namespace Bench {
+
+    // Keeps the compiler from discarding a value or the memory behind it.
+    template<typename T>
+    inline void do_not_optimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const void *sink;
+        sink = &value;
+#endif
+    }
+
+    inline void clobber_memory() {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : : "memory");
+#endif
+    }
+
+    struct Result {
+        std::string name;
+        std::string type;
+        std::string workload;
+        std::size_t items = 0;
+        std::uint64_t iterations = 0;
+        double nsPerItem = 0.0;
+        double itemsPerSecond = 0.0;
+        std::vector<std::pair<std::string, double>> counters;
+    };
+
+    enum class Format {
+        Text,
+        Csv,
+        Json
+    };
+
+    struct Options {
+        double minTimeMs = 10.0;
+        std::size_t repetitions = 3;
+        std::string filter;
+        Format format = Format::Text;
+        std::string outputPath;
+        bool list = false;
+        bool hardwareCounters = false;
+    };
+
+    // Retired instructions and stores of the calling thread, read from the Linux perf events.
+    // Stores are the generic L1D write accesses, which the kernel maps to the retired store event of the CPU.
+    // Without a PMU (most VMs and containers, other systems, perf_event_paranoid above 2) or when not enabled,
+    // available() is false.
+    class HardwareCounters {
+    public:
+        explicit HardwareCounters(bool enabled) {
+#if defined(__linux__)
+            if (!enabled)
+                return;
+            _instructions = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+            _stores = open_event(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_WRITE << 8) |
+                                                     (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16));
+#else
+            (void) enabled;
+#endif
+        }
+
+        ~HardwareCounters() {
+#if defined(__linux__)
+            if (_instructions >= 0)
+                close(_instructions);
+            if (_stores >= 0)
+                close(_stores);
+#endif
+        }
+
+        HardwareCounters(const HardwareCounters &) = delete;
+
+        HardwareCounters &operator=(const HardwareCounters &) = delete;
+
+        bool available() const {
+            return _instructions >= 0 && _stores >= 0;
+        }
+
+        // Counts func() called `iterations` times, the loop around it included
+        template<typename Func>
+        void measure(Func &func, std::uint64_t iterations, std::uint64_t &instructions, std::uint64_t &stores) {
+            instructions = stores = 0;
+#if defined(__linux__)
+            if (!available())
+                return;
+            for (int fd: {_instructions, _stores}) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+            for (std::uint64_t i = 0; i < iterations; ++i) {
+                func();
+                clobber_memory();
+            }
+            for (int fd: {_instructions, _stores})
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(_instructions, &instructions, sizeof(instructions)) != ssize_t(sizeof(instructions)) ||
+                read(_stores, &stores, sizeof(stores)) != ssize_t(sizeof(stores)))
+                instructions = stores = 0;
+#else
+            (void) func;
+            (void) iterations;
+#endif
+        }
+
+    private:
+#if defined(__linux__)
+        static int open_event(std::uint32_t type, std::uint64_t config) {
+            perf_event_attr attributes{};
+            attributes.size = sizeof(attributes);
+            attributes.type = type;
+            attributes.config = config;
+            attributes.disabled = 1;
+            attributes.exclude_kernel = 1;
+            attributes.exclude_hv = 1;
+            return int(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+        }
+#endif
+
+        int _instructions = -1;
+        int _stores = -1;
+    };
+
+    class Runner {
+    public:
+        explicit Runner(Options options) : _options{std::move(options)}, _counters{_options.hardwareCounters} {}
+
+        const Options &options() const {
+            return _options;
+        }
+
+        bool selected(const std::string &name, const std::string &type) const {
+            if (_options.filter.empty())
+                return true;
+            return (name + "/" + type).find(_options.filter) != std::string::npos;
+        }
+
+        // Times func(), which must process `items` elements per call.
+        // The returned result stays valid and can be given extra counters (flops, bytes, ...) through add_counter.
+        template<typename Func>
+        Result *run(const std::string &name, const std::string &type, const std::string &workload,
+                    std::size_t items, Func &&func) {
+            if (!selected(name, type))
+                return nullptr;
+
+            Result result;
+            result.name = name;
+            result.type = type;
+            result.workload = workload;
+            result.items = items;
+
+            if (_options.list) {
+                _results.push_back(result);
+                return &_results.back();
+            }
+
+            /* Calibrate: double the invocation count until one sample lasts long enough */
+            std::uint64_t iterations = 1;
+            for (;;) {
+                const double ns = time(func, iterations);
+                if (ns >= _options.minTimeMs * 1e6 || iterations >= (std::uint64_t(1) << 40))
+                    break;
+                iterations *= (ns <= 0.0) ? 16 : (std::max)(std::uint64_t(2), std::uint64_t(
+                        _options.minTimeMs * 1e6 * 1.2 / ns));
+            }
+
+            std::vector<double> samples;
+            for (std::size_t r = 0; r < (std::max)(_options.repetitions, std::size_t(1)); ++r)
+                samples.push_back(time(func, iterations));
+            std::sort(samples.begin(), samples.end());
+            const double median = samples[samples.size() / 2];
+
+            result.iterations = iterations;
+            result.nsPerItem = median / double(iterations * items);
+            result.itemsPerSecond = 1e9 / result.nsPerItem;
+
+            /* One more pass under the hardware counters, reported per item */
+            if (_options.hardwareCounters && _counters.available()) {
+                std::uint64_t instructions, stores;
+                _counters.measure(func, iterations, instructions, stores);
+                result.counters.emplace_back("instructions", double(instructions) / double(iterations * items));
+                result.counters.emplace_back("stores", double(stores) / double(iterations * items));
+            }
+
+            _results.push_back(result);
+            return &_results.back();
+        }
+
+        static void add_counter(Result *result, const std::string &name, double value) {
+            if (result)
+                result->counters.emplace_back(name, value);
+        }
+
+        // Adds a GFLOP/s counter from the floating point operations done per item
+        static void add_flops(Result *result, double flopsPerItem) {
+            if (result && result->nsPerItem > 0.0)
+                result->counters.emplace_back("gflops", flopsPerItem / result->nsPerItem);
+        }
+
+        // Whether the instruction and store counters of Options::hardwareCounters could be opened
+        bool hardware_counters_available() const {
+            return _counters.available();
+        }
+
+        const std::deque<Result> &results() const {
+            return _results;
+        }
+
+        void report() const {
+            std::ofstream file;
+            if (!_options.outputPath.empty())
+                file.open(_options.outputPath);
+            std::ostream &os = file.is_open() ? static_cast<std::ostream &>(file) : std::cout;
+
+            if (_options.list) {
+                for (const auto &result: _results)
+                    os << result.name << "/" << result.type << "/" << result.workload << '\n';
+                return;
+            }
+
+            switch (_options.format) {
+                case Format::Csv:
+                    write_csv(os);
+                    break;
+                case Format::Json:
+                    write_json(os);
+                    break;
+                case Format::Text:
+                    for (const auto &result: _results)
+                        print_text_row(os, result);
+                    break;
+            }
+        }
+
+    private:
+        template<typename Func>
+        static double time(Func &func, std::uint64_t iterations) {
+            const auto start = std::chrono::steady_clock::now();
+            for (std::uint64_t i = 0; i < iterations; ++i) {
+                func();
+                clobber_memory();
+            }
+            const auto end = std::chrono::steady_clock::now();
+            return std::chrono::duration<double, std::nano>(end - start).count();
+        }
+
+        static void print_text_row(std::ostream &os, const Result &result) {
+            std::ostringstream label;
+            label << result.name << "/" << result.type << "/" << result.workload;
+            os << std::left << std::setw(64) << label.str() << std::right
+               << std::setw(12) << std::fixed << std::setprecision(3) << result.nsPerItem << " ns/op"
+               << std::setw(14) << std::setprecision(2) << result.itemsPerSecond / 1e6 << " M/s";
+            for (const auto &counter: result.counters)
+                os << "  " << counter.first << "=" << std::setprecision(3) << counter.second;
+            os << '\n';
+        }
+
+        static std::string escape(const std::string &text) {
+            std::string out;
+            for (char c: text) {
+                if (c == '"' || c == '\\')
+                    out += '\\';
+                out += c;
+            }
+            return out;
+        }
+
+        void write_csv(std::ostream &os) const {
+            os << std::defaultfloat;
+            os << "name,type,workload,items,iterations,ns_per_op,ops_per_second,counters\n";
+            for (const auto &result: _results) {
+                os << '"' << result.name << "\"," << result.type << ',' << result.workload << ','
+                   << result.items << ',' << result.iterations << ','
+                   << std::setprecision(6) << result.nsPerItem << ',' << result.itemsPerSecond << ',';
+                for (std::size_t i = 0; i < result.counters.size(); ++i)
+                    os << (i ? ";" : "") << result.counters[i].first << '=' << result.counters[i].second;
+                os << '\n';
+            }
+        }
+
+        void write_json(std::ostream &os) const {
+            os << std::defaultfloat;
+            os << "{\n  \"benchmarks\": [\n";
+            for (std::size_t r = 0; r < _results.size(); ++r) {
+                const auto &result = _results[r];
+                os << "    {\"name\": \"" << escape(result.name) << "\", \"type\": \"" << result.type
+                   << "\", \"workload\": \"" << result.workload << "\", \"items\": " << result.items
+                   << ", \"iterations\": " << result.iterations
+                   << ", \"ns_per_op\": " << std::setprecision(6) << result.nsPerItem
+                   << ", \"ops_per_second\": " << result.itemsPerSecond;
+                for (const auto &counter: result.counters)
+                    os << ", \"" << escape(counter.first) << "\": " << counter.second;
+                os << "}" << (r + 1 < _results.size() ? "," : "") << '\n';
+            }
+            os << "  ]\n}\n";
+        }
+
+        Options _options;
+        std::deque<Result> _results;
+        HardwareCounters _counters;
+    };
+
+    // Deterministic random inputs so runs are comparable between releases
+    template<typename T>
+    T random_value(std::mt19937 &rng) {
+        std::uniform_real_distribution<double> dist(-4.0, 4.0);
+        T value = T(dist(rng));
+        return value == T(0) ? T(1) : value;
+    }
+
+    inline std::mt19937 &rng() {
+        static std::mt19937 generator{1234};
+        return generator;
+    }
+
+    template<typename T>
+    const char *type_name();
+
+    template<>
+    inline const char *type_name<float>() { return "float"; }
+
+    template<>
+    inline const char *type_name<double>() { return "double"; }
+
+    template<>
+    inline const char *type_name<int>() { return "int"; }
+
+    // Element count used by every "single" workload, small enough to stay in L1
+    static const std::size_t singleItems = 256;
+
+    // Element count used by every "batch" workload
+    static const std::size_t batchItems = 1 << 16;
+
+    // Benchmark groups, one per source file
+    void register_vector_benchmarks(Runner &runner);
+
+    void register_matrix_benchmarks(Runner &runner);
+
+    void register_quaternion_benchmarks(Runner &runner);
+
+    void register_algebra_benchmarks(Runner &runner);
+
+    void register_batch_benchmarks(Runner &runner);
+
+    void register_expression_benchmarks(Runner &runner);
+
+    void register_dynamic_matrix_benchmarks(Runner &runner);
+
+    void register_transform_hierarchy_benchmarks(Runner &runner);
+
+    void register_culling_benchmarks(Runner &runner);
+
+    void register_ray_benchmarks(Runner &runner);
+
+    void register_bvh_benchmarks(Runner &runner);
+
+    void register_encoding_benchmarks(Runner &runner);
+
+    void register_dispatch_benchmarks(Runner &runner);
+
+    void register_array_file_benchmarks(Runner &runner);
+
+    void register_executor_benchmarks(Runner &runner);
+
+    void register_instrument_benchmarks(Runner &runner);
+
+    void register_eigen_benchmarks(Runner &runner);
+
+    void register_svd_benchmarks(Runner &runner);
+
+    void register_trs_benchmarks(Runner &runner);
+}
+
+#endif //SLIMEMATHS_BENCHMARK_H
@@ -0,0 +1,97 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "Benchmark.h"
+#include "Dispatch.h"
+#include "Instrument.h"
+
+namespace {
+    void print_usage(const char *program) {
+        std::cout << "Usage: " << program << " [options]\n"
+                  << "  --filter <text>       only run benchmarks whose name/type contains text\n"
+                  << "  --min-time <ms>       minimum duration of one sample (default 10)\n"
+                  << "  --repetitions <n>     samples per benchmark, the median is reported (default 3)\n"
+                  << "  --format <text|csv|json>\n"
+                  << "  --out <file>          write the report to a file instead of stdout\n"
+                  << "  --isa <name>          run the dispatched kernels for scalar, sse2, avx2 or avx512\n"
+                  << "  --instrument          print the call counts of the run (builds with SLIMEMATHS_INSTRUMENT)\n"
+                  << "  --counters            add retired instructions and stores per item (Linux perf events)\n"
+                  << "  --list                list benchmark names without running them\n";
+    }
+}
+
+int main(int argc, char **argv) {
+    Bench::Options options;
+    bool instrumentReport = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (!std::strcmp(arg, "--filter") && hasValue)
+            options.filter = argv[++i];
+        else if (!std::strcmp(arg, "--min-time") && hasValue)
+            options.minTimeMs = std::atof(argv[++i]);
+        else if (!std::strcmp(arg, "--repetitions") && hasValue)
+            options.repetitions = std::size_t(std::atoi(argv[++i]));
+        else if (!std::strcmp(arg, "--format") && hasValue) {
+            const char *format = argv[++i];
+            if (!std::strcmp(format, "csv"))
+                options.format = Bench::Format::Csv;
+            else if (!std::strcmp(format, "json"))
+                options.format = Bench::Format::Json;
+            else
+                options.format = Bench::Format::Text;
+        } else if (!std::strcmp(arg, "--out") && hasValue)
+            options.outputPath = argv[++i];
+        else if (!std::strcmp(arg, "--isa") && hasValue) {
+            Sm::Isa isa;
+            if (!Sm::parse_isa(argv[++i], isa)) {
+                print_usage(argv[0]);
+                return 1;
+            }
+            if (Sm::force_isa(isa) != isa)
+                std::cerr << "This CPU has no " << Sm::isa_name(isa) << ", using " << Sm::isa_name(Sm::active_isa())
+                          << '\n';
+        } else if (!std::strcmp(arg, "--instrument")) {
+            instrumentReport = true;
+            Sm::instrument_sample_cycles(64);
+        } else if (!std::strcmp(arg, "--counters"))
+            options.hardwareCounters = true;
+        else if (!std::strcmp(arg, "--list"))
+            options.list = true;
+        else {
+            print_usage(argv[0]);
+            return std::strcmp(arg, "--help") ? 1 : 0;
+        }
+    }
+
+    Bench::Runner runner{options};
+    if (options.hardwareCounters && !runner.hardware_counters_available())
+        std::cerr << "No hardware counters on this system, --counters is ignored\n";
+
+    Bench::register_vector_benchmarks(runner);
+    Bench::register_matrix_benchmarks(runner);
+    Bench::register_quaternion_benchmarks(runner);
+    Bench::register_algebra_benchmarks(runner);
+    Bench::register_batch_benchmarks(runner);
+    Bench::register_expression_benchmarks(runner);
+    Bench::register_dynamic_matrix_benchmarks(runner);
+    Bench::register_transform_hierarchy_benchmarks(runner);
+    Bench::register_culling_benchmarks(runner);
+    Bench::register_ray_benchmarks(runner);
+    Bench::register_bvh_benchmarks(runner);
+    Bench::register_encoding_benchmarks(runner);
+    Bench::register_dispatch_benchmarks(runner);
+    Bench::register_array_file_benchmarks(runner);
+    Bench::register_executor_benchmarks(runner);
+    Bench::register_instrument_benchmarks(runner);
+    Bench::register_eigen_benchmarks(runner);
+    Bench::register_svd_benchmarks(runner);
+    Bench::register_trs_benchmarks(runner);
+
+    runner.report();
+    if (instrumentReport)
+        Sm::instrument_report(std::cerr);
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "SlimeMath.h"
+
+// Bvh build, refit and queries over a million triangle height field.
+namespace Bench {
+    namespace {
+        template<typename T>
+        void bvh_benchmarks(Runner &runner) {
+            using V3 = Vector<T, 3>;
+            const std::string type = type_name<T>();
+
+            /* 708 x 708 quads of a bumpy terrain, two triangles each */
+            const std::size_t side = 709;
+            std::vector<V3> vertices(side * side);
+            for (std::size_t z = 0; z < side; ++z)
+                for (std::size_t x = 0; x < side; ++x)
+                    vertices[z * side + x] = V3{T(x), T(4) * std::sin(T(x) * T(0.05)) * std::cos(T(z) * T(0.07)) +
+                                                      random_value<T>(rng()) * T(0.1), T(z)};
+            std::vector<std::uint32_t> indices;
+            for (std::size_t z = 0; z + 1 < side; ++z)
+                for (std::size_t x = 0; x + 1 < side; ++x) {
+                    const auto v = static_cast<std::uint32_t>(z * side + x), s = static_cast<std::uint32_t>(side);
+                    indices.insert(indices.end(), {v, v + 1, v + s, v + 1, v + s + 1, v + s});
+                }
+            const std::size_t triangles = indices.size() / 3;
+            const std::string workload = std::to_string(triangles) + " triangles";
+
+            Bvh<T> bvh;
+            runner.run("Bvh::build", type, workload, triangles, [&] {
+                bvh.build(vertices.data(), indices.data(), triangles);
+            });
+            Sm::BvhOptions parallel;
+            parallel.threads = 0;
+            runner.run("Bvh::build(all threads)", type, workload, triangles, [&] {
+                bvh.build(vertices.data(), indices.data(), triangles, parallel);
+            });
+            Result *result = runner.run("Bvh::refit", type, workload, triangles, [&] {
+                bvh.refit(vertices.data(), indices.data());
+            });
+            Runner::add_counter(result, "nodes", double(bvh.node_count()));
+
+            /* Rays from above the terrain towards random points on it nearby */
+            const std::size_t rays = 4096;
+            const T extent = T(side - 1);
+            std::vector<V3> origins(rays), directions(rays);
+            for (std::size_t r = 0; r < rays; ++r) {
+                origins[r] = V3{(random_value<T>(rng()) + T(4)) * extent / T(8), T(30),
+                                (random_value<T>(rng()) + T(4)) * extent / T(8)};
+                const V3 target{origins[r].x + random_value<T>(rng()) * T(8), T(0),
+                                origins[r].z + random_value<T>(rng()) * T(8)};
+                directions[r] = target - origins[r];
+                Sm::normalize(directions[r]);
+            }
+
+            T checksum = T(0);
+            result = runner.run("Bvh::raycast", type, workload, rays, [&] {
+                for (std::size_t r = 0; r < rays; ++r) {
+                    const Ray<T> ray{origins[r], directions[r]};
+                    checksum += bvh.raycast(ray.origin, ray.direction, std::numeric_limits<T>::max(),
+                                            [&](std::uint32_t t, T tMax) {
+                                                T distance, u, v;
+                                                const bool hit = Sm::intersect_triangle(
+                                                        ray, vertices[indices[3 * t]], vertices[indices[3 * t + 1]],
+                                                        vertices[indices[3 * t + 2]], distance, u, v);
+                                                return hit && distance < tMax ? distance : tMax;
+                                            });
+                }
+                do_not_optimize(checksum);
+            });
+
+            /* Boxes a few quads wide, like a character's collision query */
+            std::size_t found = 0;
+            result = runner.run("Bvh::query", type, workload, rays, [&] {
+                found = 0;
+                for (std::size_t r = 0; r < rays; ++r) {
+                    const V3 corner{origins[r].x, T(-5), origins[r].z};
+                    bvh.query(AABB<T>{corner, corner + V3{T(3), T(10), T(3)}}, [&](std::uint32_t) { ++found; });
+                }
+                do_not_optimize(found);
+            });
+            Runner::add_counter(result, "hits/query", double(found) / double(rays));
+        }
+    }
+
+    void register_bvh_benchmarks(Runner &runner) {
+        bvh_benchmarks<float>(runner);
+        bvh_benchmarks<double>(runner);
+    }
+}
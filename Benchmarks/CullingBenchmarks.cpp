@@ -0,0 +1,103 @@
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "SlimeMath.h"
+
+// Batch frustum culling against the per object Frustum tests, over a scene of bounding volumes.
+namespace Bench {
+    namespace {
+        // OpenGL style perspective looking down -z from (0, 0, 10)
+        template<typename T>
+        Matrix<T, 4, 4> view_projection() {
+            const T nearPlane = T(0.1), farPlane = T(200), focal = T(1) / std::tan(T(0.6));
+            Matrix<T, 4, 4> projection;
+            projection(0, 0) = focal / T(16.0 / 9.0);
+            projection(1, 1) = focal;
+            projection(2, 2) = (farPlane + nearPlane) / (nearPlane - farPlane);
+            projection(2, 3) = T(2) * farPlane * nearPlane / (nearPlane - farPlane);
+            projection(3, 2) = T(-1);
+            projection(3, 3) = T(0);
+
+            Matrix<T, 4, 4> view;
+            view(2, 3) = T(-10);
+            return projection * view;
+        }
+
+        template<typename T>
+        void culling_benchmarks(Runner &runner) {
+            using V3 = Vector<T, 3>;
+            const std::string type = type_name<T>();
+            const std::size_t objects = 100000;
+            const std::string workload = std::to_string(objects) + " objects";
+
+            /* Objects spread around the camera, about 15% of them end up visible */
+            const T spread = T(50);
+            std::vector<V3> centers(objects), mins(objects), maxs(objects);
+            std::vector<T> radii(objects);
+            for (std::size_t i = 0; i < objects; ++i) {
+                centers[i] = V3{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng())} * spread;
+                const V3 extent{std::abs(random_value<T>(rng())), std::abs(random_value<T>(rng())),
+                                std::abs(random_value<T>(rng()))};
+                radii[i] = Sm::length(extent);
+                mins[i] = centers[i] - extent;
+                maxs[i] = centers[i] + extent;
+            }
+            const VectorArray<T, 3> centerArray{centers.data(), objects};
+            const VectorArray<T, 3> minArray{mins.data(), objects}, maxArray{maxs.data(), objects};
+
+            const Frustum<T> frustum{view_projection<T>()};
+            std::vector<std::uint32_t> visible(objects);
+            std::size_t count = 0;
+
+            Result *result = runner.run("Sm::cull_spheres", type, workload, objects, [&] {
+                count = Sm::cull_spheres(frustum, centers.data(), radii.data(), objects, visible.data());
+                do_not_optimize(count);
+            });
+            Runner::add_counter(result, "visible", double(count));
+            runner.run("Sm::cull_spheres(VectorArray)", type, workload, objects, [&] {
+                count = Sm::cull_spheres(frustum, centerArray, radii.data(), visible.data());
+                do_not_optimize(count);
+            });
+            runner.run("Sm::cull_spheres(loop)", type, workload, objects, [&] {
+                count = 0;
+                for (std::size_t i = 0; i < objects; ++i)
+                    if (frustum.intersects_sphere(centers[i], radii[i]))
+                        visible[count++] = static_cast<std::uint32_t>(i);
+                do_not_optimize(count);
+            });
+
+            result = runner.run("Sm::cull_aabbs", type, workload, objects, [&] {
+                count = Sm::cull_aabbs(frustum, mins.data(), maxs.data(), objects, visible.data());
+                do_not_optimize(count);
+            });
+            Runner::add_counter(result, "visible", double(count));
+            runner.run("Sm::cull_aabbs(VectorArray)", type, workload, objects, [&] {
+                count = Sm::cull_aabbs(frustum, minArray, maxArray, visible.data());
+                do_not_optimize(count);
+            });
+            runner.run("Sm::cull_aabbs(loop)", type, workload, objects, [&] {
+                count = 0;
+                for (std::size_t i = 0; i < objects; ++i)
+                    if (frustum.intersects_aabb(mins[i], maxs[i]))
+                        visible[count++] = static_cast<std::uint32_t>(i);
+                do_not_optimize(count);
+            });
+
+            runner.run("Frustum(Mat4)", type, "single", singleItems, [&] {
+                Matrix<T, 4, 4> matrix = view_projection<T>();
+                for (std::size_t i = 0; i < singleItems; ++i) {
+                    matrix(0, 3) = T(i);
+                    Frustum<T> extracted{matrix};
+                    do_not_optimize(extracted);
+                }
+            });
+        }
+    }
+
+    void register_culling_benchmarks(Runner &runner) {
+        culling_benchmarks<float>(runner);
+        culling_benchmarks<double>(runner);
+    }
+}
@@ -0,0 +1,70 @@
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "SlimeMath.h"
+
+// The dispatched batch transforms under every instruction set the CPU supports, and the per call cost of the
+// dispatch itself on a short span next to calling the same kernel through a pointer resolved beforehand.
+namespace Bench {
+    namespace {
+        template<typename T>
+        void dispatch_benchmarks(Runner &runner) {
+            using V3 = Vector<T, 3>;
+            using V4 = Vector<T, 4>;
+            const std::string type = type_name<T>();
+
+            Matrix<T, 4, 4> mat;
+            Matrix<T, 3, 3> mat3;
+            for (std::size_t i = 0; i < mat.elements; ++i)
+                mat[i] = random_value<T>(rng());
+            for (std::size_t i = 0; i < mat3.elements; ++i)
+                mat3[i] = random_value<T>(rng());
+
+            std::vector<V3> in3(batchItems), out3(batchItems);
+            std::vector<V4> in4(batchItems), out4(batchItems);
+            for (std::size_t i = 0; i < batchItems; ++i) {
+                in3[i] = V3{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng())};
+                in4[i] = V4{in3[i], random_value<T>(rng())};
+            }
+
+            const Sm::Isa previous = Sm::active_isa();
+            for (Sm::Isa isa: {Sm::Isa::Scalar, Sm::Isa::Sse2, Sm::Isa::Avx2, Sm::Isa::Avx512}) {
+                if (isa > Sm::detected_isa())
+                    break;
+                Sm::force_isa(isa);
+                const std::string suffix = std::string("[") + Sm::isa_name(isa) + "]";
+
+                runner.run("Sm::transform_points" + suffix, type, "batch", batchItems, [&] {
+                    Sm::transform_points(mat, in3.data(), out3.data(), batchItems);
+                });
+                runner.run("Sm::transform_points_projected" + suffix, type, "batch", batchItems, [&] {
+                    Sm::transform_points_projected(mat, in3.data(), out3.data(), batchItems);
+                });
+                runner.run("Sm::transform(Mat4,Vec4)" + suffix, type, "batch", batchItems, [&] {
+                    Sm::transform(mat, in4.data(), out4.data(), batchItems);
+                });
+                runner.run("Sm::transform(Mat3,Vec3)" + suffix, type, "batch", batchItems, [&] {
+                    Sm::transform(mat3, in3.data(), out3.data(), batchItems);
+                });
+            }
+            Sm::force_isa(previous);
+
+            /* Short spans, where the table lookup and indirect call are the largest share */
+            const std::size_t span = 8;
+            runner.run("Sm::transform_points(dispatched)", type, std::to_string(span) + " points", span, [&] {
+                Sm::transform_points(mat, in3.data(), out3.data(), span);
+                do_not_optimize(out3.data());
+            });
+            const auto kernel = Sm::detail::BatchTransformDispatch<T>::kernels().points;
+            runner.run("Sm::transform_points(resolved)", type, std::to_string(span) + " points", span, [&] {
+                kernel(mat.ptr(), in3.data(), out3.data(), span);
+                do_not_optimize(out3.data());
+            });
+        }
+    }
+
+    void register_dispatch_benchmarks(Runner &runner) {
+        dispatch_benchmarks<float>(runner);
+        dispatch_benchmarks<double>(runner);
+    }
+}
@@ -0,0 +1,66 @@
+#include <string>
+#include <thread>
+#include "Benchmark.h"
+#include "SlimeMath.h"
+
+// DynamicMatrix products against the textbook i-j-k loop, reported in GFLOP/s.
+namespace Bench {
+    namespace {
+        template<typename T>
+        void naive_multiply(const DynamicMatrix<T> &lhs, const DynamicMatrix<T> &rhs, DynamicMatrix<T> &out) {
+            for (std::size_t r = 0; r < lhs.rows(); ++r)
+                for (std::size_t c = 0; c < rhs.columns(); ++c) {
+                    T sum = T(0);
+                    for (std::size_t i = 0; i < lhs.columns(); ++i)
+                        sum += lhs(r, i) * rhs(i, c);
+                    out(r, c) = sum;
+                }
+        }
+
+        template<typename T>
+        void gemm_benchmarks(Runner &runner, std::size_t size) {
+            const std::string type = type_name<T>();
+            const std::string workload = std::to_string(size) + "x" + std::to_string(size);
+            const double flops = 2.0 * double(size) * double(size) * double(size);
+
+            DynamicMatrix<T> a{size, size}, b{size, size}, out{size, size};
+            for (std::size_t i = 0; i < a.elements(); ++i) {
+                a[i] = random_value<T>(rng());
+                b[i] = random_value<T>(rng());
+            }
+
+            /* The naive loop takes seconds past 512 and tells nothing new */
+            if (size <= 512)
+                Runner::add_flops(runner.run("DynamicMatrix::multiply(naive)", type, workload, 1, [&] {
+                    naive_multiply(a, b, out);
+                    do_not_optimize(out.ptr());
+                }), flops);
+
+            Sm::GemmOptions single;
+            single.threads = 1;
+            Runner::add_flops(runner.run("DynamicMatrix::multiply(1 thread)", type, workload, 1, [&] {
+                Sm::multiply(a, b, out, single);
+                do_not_optimize(out.ptr());
+            }), flops);
+
+            Sm::GemmOptions all;
+            Result *result = runner.run("DynamicMatrix::multiply(all threads)", type, workload, 1, [&] {
+                Sm::multiply(a, b, out, all);
+                do_not_optimize(out.ptr());
+            });
+            Runner::add_flops(result, flops);
+            Runner::add_counter(result, "threads", double(std::thread::hardware_concurrency()));
+        }
+
+        template<typename T>
+        void gemm_benchmarks(Runner &runner) {
+            for (std::size_t size: {64, 256, 512, 1024})
+                gemm_benchmarks<T>(runner, size);
+        }
+    }
+
+    void register_dynamic_matrix_benchmarks(Runner &runner) {
+        gemm_benchmarks<float>(runner);
+        gemm_benchmarks<double>(runner);
+    }
+}
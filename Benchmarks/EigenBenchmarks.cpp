@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "SlimeMath.h"
+
+// Symmetric 3x3 eigen decompositions one at a time and in batches, and covariance accumulation over point spans.
+// residual_eps is the largest |m * v - value * v| of the run relative to the largest element of m, in units of epsilon.
+namespace Bench {
+    namespace {
+        template<typename T>
+        double max_residual(const std::vector<Matrix<T, 3, 3>> &matrices, const std::vector<SymmetricEigen<T>> &eigen) {
+            double worst = 0.0;
+            for (std::size_t i = 0; i < matrices.size(); ++i) {
+                const Matrix<T, 3, 3> &m = matrices[i];
+                double scale = 0.0;
+                for (std::size_t e = 0; e < m.elements; ++e)
+                    scale = std::max(scale, double(std::abs(m[e])));
+
+                for (std::size_t k = 0; k < 3; ++k) {
+                    const Vector<T, 3> axis = eigen[i].axis(k);
+                    const Vector<T, 3> mapped = Sm::operator*(m, axis);
+                    for (std::size_t c = 0; c < 3; ++c)
+                        worst = std::max(worst, std::abs(double(mapped[c]) - double(eigen[i].values[k] * axis[c])) /
+                                                scale);
+                }
+            }
+            return worst / double(std::numeric_limits<T>::epsilon());
+        }
+
+        template<typename T>
+        void eigen_benchmarks(Runner &runner) {
+            using M = Matrix<T, 3, 3>;
+            using V3 = Vector<T, 3>;
+            const std::string type = type_name<T>();
+            const std::string workload = std::to_string(batchItems) + " matrices";
+
+            std::vector<M> matrices(batchItems);
+            VectorArray<T, 3> diagonal(batchItems), offDiagonal(batchItems);
+            for (std::size_t i = 0; i < batchItems; ++i) {
+                M &m = matrices[i];
+                for (std::size_t r = 0; r < 3; ++r)
+                    for (std::size_t c = r; c < 3; ++c)
+                        m(r, c) = m(c, r) = random_value<T>(rng());
+                diagonal.set(i, V3{m(0, 0), m(1, 1), m(2, 2)});
+                offDiagonal.set(i, V3{m(0, 1), m(0, 2), m(1, 2)});
+            }
+            std::vector<SymmetricEigen<T>> eigen(batchItems);
+
+            Result *result = runner.run("Sm::eigen_symmetric", type, "single", singleItems, [&] {
+                for (std::size_t i = 0; i < singleItems; ++i)
+                    eigen[i] = Sm::eigen_symmetric(matrices[i]);
+                do_not_optimize(eigen.data());
+            });
+            if (result && !runner.options().list) {
+                const std::vector<M> first(matrices.begin(), matrices.begin() + singleItems);
+                Runner::add_counter(result, "residual_eps",
+                                    max_residual(first, std::vector<SymmetricEigen<T>>(eigen.begin(),
+                                                                                      eigen.begin() + singleItems)));
+            }
+
+            result = runner.run("Sm::eigen_symmetric(batch)", type, workload, batchItems, [&] {
+                Sm::eigen_symmetric(matrices.data(), eigen.data(), batchItems);
+                do_not_optimize(eigen.data());
+            });
+            if (result && !runner.options().list)
+                Runner::add_counter(result, "residual_eps", max_residual(matrices, eigen));
+
+            VectorArray<T, 3> values, axes[3];
+            runner.run("Sm::eigen_symmetric(VectorArray)", type, workload, batchItems, [&] {
+                Sm::eigen_symmetric(diagonal, offDiagonal, values, axes);
+                do_not_optimize(values.component(0));
+            });
+
+            /* Points spread far more along one axis, offset from the origin like model space vertices */
+            std::vector<V3> points(batchItems);
+            for (std::size_t i = 0; i < batchItems; ++i)
+                points[i] = V3{random_value<T>(rng()) * T(8) + T(100), random_value<T>(rng()) + T(50),
+                               random_value<T>(rng()) * T(0.25)};
+            const VectorArray<T, 3> pointArray{points.data(), batchItems};
+            const std::string pointWorkload = std::to_string(batchItems) + " points";
+
+            runner.run("Covariance::add(loop)", type, pointWorkload, batchItems, [&] {
+                Covariance<T> covariance;
+                for (const V3 &point: points)
+                    covariance.add(point);
+                do_not_optimize(covariance);
+            });
+            runner.run("Covariance::add(batch)", type, pointWorkload, batchItems, [&] {
+                Covariance<T> covariance;
+                covariance.add(points.data(), batchItems);
+                do_not_optimize(covariance);
+            });
+            runner.run("Covariance::add(VectorArray)", type, pointWorkload, batchItems, [&] {
+                Covariance<T> covariance;
+                covariance.add(pointArray);
+                do_not_optimize(covariance);
+            });
+            runner.run("Sm::covariance(Executor)", type, pointWorkload, batchItems, [&] {
+                const Covariance<T> covariance = Sm::covariance(Sm::default_executor(), points.data(), batchItems);
+                do_not_optimize(covariance);
+            });
+        }
+    }
+
+    void register_eigen_benchmarks(Runner &runner) {
+        eigen_benchmarks<float>(runner);
+        eigen_benchmarks<double>(runner);
+    }
+}
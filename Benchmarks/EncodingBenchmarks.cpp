@@ -0,0 +1,189 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "SlimeMath.h"
+
+// Half floats and quantized encodings: the array conversions next to the same single value conversions in a
+// loop, with the error each encoding leaves over the data set as a counter.
+namespace Bench {
+    namespace {
+        constexpr double degrees = 57.29577951308232;
+
+        void half_benchmarks(Runner &runner) {
+            const std::size_t count = batchItems * 4;
+            const std::string workload = std::to_string(count) + " values";
+
+            std::vector<float> floats(count), restored(count);
+            for (auto &value: floats)
+                value = random_value<float>(rng()) * 1000.0f;
+            std::vector<half> halves(count);
+
+            runner.run("Sm::to_half(loop)", "float", workload, count, [&] {
+                for (std::size_t i = 0; i < count; ++i)
+                    halves[i] = half{floats[i]};
+                do_not_optimize(halves.data());
+            });
+            runner.run("Sm::to_half", "float", workload, count, [&] {
+                Sm::to_half(floats.data(), halves.data(), count);
+                do_not_optimize(halves.data());
+            });
+            runner.run("Sm::to_float(loop)", "float", workload, count, [&] {
+                for (std::size_t i = 0; i < count; ++i)
+                    restored[i] = float(halves[i]);
+                do_not_optimize(restored.data());
+            });
+            Result *result = runner.run("Sm::to_float", "float", workload, count, [&] {
+                Sm::to_float(halves.data(), restored.data(), count);
+                do_not_optimize(restored.data());
+            });
+            Runner::add_counter(result, "maxError", Sm::absolute_error(floats.data(), restored.data(), count).max);
+        }
+
+        template<typename T, typename Q>
+        void norm_benchmarks(Runner &runner, const std::string &name, bool isSigned) {
+            const std::size_t count = batchItems * 4;
+            const std::string type = type_name<T>();
+            const std::string workload = std::to_string(count) + " values to " + name;
+
+            std::vector<T> values(count), restored(count);
+            for (auto &value: values)
+                value = isSigned ? random_value<T>(rng()) / T(4) : random_value<T>(rng()) / T(8) + T(0.5);
+            std::vector<Q> encoded(count);
+
+            if constexpr (std::is_signed<Q>::value) {
+                runner.run("Sm::encode_snorm(loop)", type, workload, count, [&] {
+                    for (std::size_t i = 0; i < count; ++i)
+                        encoded[i] = Sm::encode_snorm<Q>(values[i]);
+                    do_not_optimize(encoded.data());
+                });
+                runner.run("Sm::encode_snorm", type, workload, count, [&] {
+                    Sm::encode_snorm(values.data(), encoded.data(), count);
+                    do_not_optimize(encoded.data());
+                });
+                runner.run("Sm::decode_snorm(loop)", type, workload, count, [&] {
+                    for (std::size_t i = 0; i < count; ++i)
+                        restored[i] = Sm::decode_snorm<T>(encoded[i]);
+                    do_not_optimize(restored.data());
+                });
+                Result *result = runner.run("Sm::decode_snorm", type, workload, count, [&] {
+                    Sm::decode_snorm(encoded.data(), restored.data(), count);
+                    do_not_optimize(restored.data());
+                });
+                Runner::add_counter(result, "maxError", Sm::absolute_error(values.data(), restored.data(), count).max);
+            } else {
+                runner.run("Sm::encode_unorm(loop)", type, workload, count, [&] {
+                    for (std::size_t i = 0; i < count; ++i)
+                        encoded[i] = Sm::encode_unorm<Q>(values[i]);
+                    do_not_optimize(encoded.data());
+                });
+                runner.run("Sm::encode_unorm", type, workload, count, [&] {
+                    Sm::encode_unorm(values.data(), encoded.data(), count);
+                    do_not_optimize(encoded.data());
+                });
+                runner.run("Sm::decode_unorm(loop)", type, workload, count, [&] {
+                    for (std::size_t i = 0; i < count; ++i)
+                        restored[i] = Sm::decode_unorm<T>(encoded[i]);
+                    do_not_optimize(restored.data());
+                });
+                Result *result = runner.run("Sm::decode_unorm", type, workload, count, [&] {
+                    Sm::decode_unorm(encoded.data(), restored.data(), count);
+                    do_not_optimize(restored.data());
+                });
+                Runner::add_counter(result, "maxError", Sm::absolute_error(values.data(), restored.data(), count).max);
+            }
+        }
+
+        template<typename T, typename Q>
+        void octahedral_benchmarks(Runner &runner, const std::vector<Vector<T, 3>> &normals) {
+            const std::size_t count = normals.size();
+            const std::string type = type_name<T>();
+            const std::string workload = std::to_string(count) + " normals to " + std::to_string(16 * sizeof(Q)) +
+                                         " bits";
+
+            std::vector<Vector<Q, 2>> encoded(count);
+            std::vector<Vector<T, 3>> restored(count);
+            runner.run("Sm::encode_octahedral(loop)", type, workload, count, [&] {
+                for (std::size_t i = 0; i < count; ++i)
+                    encoded[i] = Sm::encode_octahedral<Q>(normals[i]);
+                do_not_optimize(encoded.data());
+            });
+            runner.run("Sm::encode_octahedral", type, workload, count, [&] {
+                Sm::encode_octahedral(normals.data(), encoded.data(), count);
+                do_not_optimize(encoded.data());
+            });
+            runner.run("Sm::decode_octahedral(loop)", type, workload, count, [&] {
+                for (std::size_t i = 0; i < count; ++i)
+                    restored[i] = Sm::decode_octahedral<T>(encoded[i]);
+                do_not_optimize(restored.data());
+            });
+            Result *result = runner.run("Sm::decode_octahedral", type, workload, count, [&] {
+                Sm::decode_octahedral(encoded.data(), restored.data(), count);
+                do_not_optimize(restored.data());
+            });
+            const Sm::EncodingError error = Sm::angular_error(normals.data(), restored.data(), count);
+            Runner::add_counter(result, "maxDegrees", error.max * degrees);
+            Runner::add_counter(result, "meanDegrees", error.mean * degrees);
+        }
+
+        template<typename T>
+        void smallest_three_benchmarks(Runner &runner) {
+            const std::size_t count = batchItems;
+            const std::string type = type_name<T>();
+            const std::string workload = std::to_string(count) + " quaternions to 32 bits";
+
+            std::vector<Quaternion<T>> rotations(count), restored(count);
+            for (auto &q: rotations) {
+                q = Quaternion<T>(random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng()),
+                                  random_value<T>(rng()));
+                const T norm = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+                q = Quaternion<T>(q.x / norm, q.y / norm, q.z / norm, q.w / norm);
+            }
+            std::vector<Sm::SmallestThree<10>> encoded(count);
+
+            runner.run("Sm::encode_smallest_three(loop)", type, workload, count, [&] {
+                for (std::size_t i = 0; i < count; ++i)
+                    encoded[i] = Sm::encode_smallest_three(rotations[i]);
+                do_not_optimize(encoded.data());
+            });
+            runner.run("Sm::encode_smallest_three", type, workload, count, [&] {
+                Sm::encode_smallest_three(rotations.data(), encoded.data(), count);
+                do_not_optimize(encoded.data());
+            });
+            runner.run("Sm::decode_smallest_three(loop)", type, workload, count, [&] {
+                for (std::size_t i = 0; i < count; ++i)
+                    restored[i] = Sm::decode_smallest_three<10, T>(encoded[i]);
+                do_not_optimize(restored.data());
+            });
+            Result *result = runner.run("Sm::decode_smallest_three", type, workload, count, [&] {
+                Sm::decode_smallest_three(encoded.data(), restored.data(), count);
+                do_not_optimize(restored.data());
+            });
+            const Sm::EncodingError error = Sm::angular_error(rotations.data(), restored.data(), count);
+            Runner::add_counter(result, "maxDegrees", error.max * degrees);
+            Runner::add_counter(result, "meanDegrees", error.mean * degrees);
+        }
+
+        template<typename T>
+        void encoding_benchmarks(Runner &runner) {
+            norm_benchmarks<T, std::uint8_t>(runner, "unorm8", false);
+            norm_benchmarks<T, std::int16_t>(runner, "snorm16", true);
+
+            std::vector<Vector<T, 3>> normals(batchItems);
+            for (auto &n: normals) {
+                n = Vector<T, 3>{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng())};
+                Sm::normalize(n);
+            }
+            octahedral_benchmarks<T, std::int8_t>(runner, normals);
+            octahedral_benchmarks<T, std::int16_t>(runner, normals);
+
+            smallest_three_benchmarks<T>(runner);
+        }
+    }
+
+    void register_encoding_benchmarks(Runner &runner) {
+        half_benchmarks(runner);
+        encoding_benchmarks<float>(runner);
+        encoding_benchmarks<double>(runner);
+    }
+}
@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Benchmark.h"
+#include "SlimeMath.h"
+
+// Scaling curves of the Executor overloads: every batch kernel over a span far larger than the caches, on pools of
+// 1, 2, 4 ... threads up to the core count. speedup is against the one thread pool, so a flat curve means the
+// kernel is bound by memory bandwidth (or the machine has one core) rather than by the pool.
+namespace Bench {
+    namespace {
+        const std::size_t scalingItems = 1 << 20;
+
+        std::vector<std::size_t> thread_counts() {
+            const std::size_t cores = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+            std::vector<std::size_t> counts;
+            for (std::size_t threads = 1; threads < cores; threads *= 2)
+                counts.push_back(threads);
+            counts.push_back(cores);
+            return counts;
+        }
+
+        // Runs func(executor) once per pool size and adds threads, speedup and steals counters
+        template<typename Func>
+        void run_scaling(Runner &runner, const std::string &name, const std::string &type, Func &&func) {
+            double serialNs = 0.0;
+            for (const std::size_t threads: thread_counts()) {
+                Executor executor{threads};
+                Result *result = runner.run(name + "[" + std::to_string(threads) + " threads]", type,
+                                            std::to_string(scalingItems) + " items", scalingItems, [&] {
+                            func(executor);
+                        });
+                if (!result || result->nsPerItem <= 0.0)
+                    continue;
+                if (threads == 1)
+                    serialNs = result->nsPerItem;
+                Runner::add_counter(result, "threads", double(threads));
+                if (serialNs > 0.0)
+                    Runner::add_counter(result, "speedup", serialNs / result->nsPerItem);
+                Runner::add_counter(result, "steals", double(executor.steals()));
+            }
+        }
+
+        template<typename T>
+        void executor_benchmarks(Runner &runner) {
+            using V3 = Vector<T, 3>;
+            const std::string type = type_name<T>();
+
+            Matrix<T, 4, 4> mat;
+            for (std::size_t i = 0; i < mat.elements; ++i)
+                mat[i] = random_value<T>(rng());
+
+            std::vector<V3> in(scalingItems), out(scalingItems);
+            VectorArray<T, 3> soa(scalingItems);
+            std::vector<Quaternion<T>> from(scalingItems), to(scalingItems), blended(scalingItems);
+            for (std::size_t i = 0; i < scalingItems; ++i) {
+                in[i] = V3{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng())};
+                soa.set(i, in[i]);
+                from[i] = Quaternion<T>{random_value<T>(rng()), random_value<T>(rng()),
+                                        random_value<T>(rng()), random_value<T>(rng())};
+                to[i] = Quaternion<T>{random_value<T>(rng()), random_value<T>(rng()),
+                                      random_value<T>(rng()), random_value<T>(rng())};
+                from[i].Normalize();
+                to[i].Normalize();
+            }
+
+            run_scaling(runner, "Sm::transform_points(Executor)", type, [&](Executor &executor) {
+                Sm::transform_points(executor, mat, in.data(), out.data(), scalingItems);
+                do_not_optimize(out.data());
+            });
+            run_scaling(runner, "Sm::normalize(Executor,VectorArray)", type, [&](Executor &executor) {
+                Sm::normalize(executor, soa);
+                do_not_optimize(soa.component(0));
+            });
+            run_scaling(runner, "Sm::slerp(Executor)", type, [&](Executor &executor) {
+                Sm::slerp(executor, from.data(), to.data(), T(0.3), blended.data(), scalingItems);
+                do_not_optimize(blended.data());
+            });
+            run_scaling(runner, "Sm::parallel_reduce(length)", type, [&](Executor &executor) {
+                const auto map = [&](std::size_t begin, std::size_t end) {
+                    T sum = T(0);
+                    for (std::size_t i = begin; i < end; ++i)
+                        sum += in[i].length();
+                    return sum;
+                };
+                const T total = Sm::parallel_reduce(executor, scalingItems, 4096, T(0), map, [](T a, T b) {
+                    return a + b;
+                });
+                do_not_optimize(total);
+            });
+        }
+    }
+
+    void register_executor_benchmarks(Runner &runner) {
+        executor_benchmarks<float>(runner);
+        executor_benchmarks<double>(runner);
+    }
+}
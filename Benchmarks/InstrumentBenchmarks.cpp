@@ -0,0 +1,82 @@
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "SlimeMath.h"
+
+// Instrumented entry points next to the uninstrumented code they wrap, so one run shows what the counting costs.
+// Without SLIMEMATHS_INSTRUMENT each pair must time the same, with it the overhead counter is the price per call.
+namespace Bench {
+    namespace {
+        // Times both, tags them and adds the difference to the instrumented one
+        template<typename Instrumented, typename Raw>
+        void run_pair(Runner &runner, const std::string &name, const std::string &type, const std::string &workload,
+                      std::size_t items, Instrumented &&instrumented, Raw &&raw) {
+            Result *site = runner.run(name + "(instrumented)", type, workload, items, instrumented);
+            Result *plain = runner.run(name + "(raw)", type, workload, items, raw);
+            Runner::add_counter(site, "instrumented", Sm::instrument_enabled ? 1.0 : 0.0);
+            if (site && plain)
+                Runner::add_counter(site, "overhead_ns", site->nsPerItem - plain->nsPerItem);
+        }
+
+        template<typename T>
+        void instrument_benchmarks(Runner &runner) {
+            using M = Matrix<T, 4, 4>;
+            using V3 = Vector<T, 3>;
+            const std::string type = type_name<T>();
+
+            std::vector<M> a(singleItems), b(singleItems), out(singleItems);
+            std::vector<V3> u(singleItems), v(singleItems);
+            std::vector<T> dots(singleItems);
+            for (std::size_t i = 0; i < singleItems; ++i) {
+                for (std::size_t e = 0; e < M::elements; ++e) {
+                    a[i][e] = random_value<T>(rng());
+                    b[i][e] = random_value<T>(rng());
+                }
+                u[i] = V3{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng())};
+                v[i] = V3{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng())};
+            }
+
+            run_pair(runner, "Matrix4x4::operator*", type, "single", singleItems, [&] {
+                for (std::size_t i = 0; i < singleItems; ++i)
+                    out[i] = a[i] * b[i];
+                do_not_optimize(out.data());
+            }, [&] {
+                for (std::size_t i = 0; i < singleItems; ++i) {
+                    M product;
+                    Sm::detail::MatrixMultiplyKernel<T, 4, 4, 4>::apply(product.ptr(), a[i].ptr(), b[i].ptr());
+                    out[i] = product;
+                }
+                do_not_optimize(out.data());
+            });
+
+            run_pair(runner, "Sm::dot", type, "single", singleItems, [&] {
+                for (std::size_t i = 0; i < singleItems; ++i)
+                    dots[i] = Sm::dot(u[i], v[i]);
+                do_not_optimize(dots.data());
+            }, [&] {
+                for (std::size_t i = 0; i < singleItems; ++i) {
+                    T dot = T(0);
+                    for (std::size_t c = 0; c < 3; ++c)
+                        dot += u[i][c] * v[i][c];
+                    dots[i] = dot;
+                }
+                do_not_optimize(dots.data());
+            });
+
+            /* A short span, where a per call cost is the largest share */
+            const std::size_t span = 8;
+            run_pair(runner, "Sm::transform_points", type, std::to_string(span) + " points", span, [&] {
+                Sm::transform_points(a[0], u.data(), v.data(), span);
+                do_not_optimize(v.data());
+            }, [&] {
+                Sm::detail::BatchTransformDispatch<T>::kernels().points(a[0].ptr(), u.data(), v.data(), span);
+                do_not_optimize(v.data());
+            });
+        }
+    }
+
+    void register_instrument_benchmarks(Runner &runner) {
+        instrument_benchmarks<float>(runner);
+        instrument_benchmarks<double>(runner);
+    }
+}
@@ -0,0 +1,143 @@
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "Benchmark.h"
+#include "SlimeMath.h"
+
+namespace Bench {
+    namespace {
+        template<typename M>
+        std::vector<M> random_matrices(std::size_t count) {
+            std::vector<M> result(count);
+            for (auto &mat: result)
+                for (std::size_t i = 0; i < M::elements; ++i)
+                    mat[i] = random_value<typename M::ScalerType>(rng());
+            return result;
+        }
+
+        template<typename T, std::size_t N>
+        void matrix_benchmarks(Runner &runner) {
+            using M = Matrix<T, N, N>;
+            using V = Vector<T, N>;
+            const std::string type = type_name<T>();
+            const std::string prefix = "Matrix" + std::to_string(N) + "x" + std::to_string(N) + "::";
+
+            const auto a = random_matrices<M>(singleItems);
+            const auto b = random_matrices<M>(singleItems);
+            std::vector<V> vecs(singleItems);
+            for (auto &vec: vecs)
+                for (std::size_t c = 0; c < N; ++c)
+                    vec[c] = random_value<T>(rng());
+            std::vector<T> scalars(singleItems);
+            for (auto &s: scalars)
+                s = random_value<T>(rng());
+
+            std::vector<M> out(singleItems);
+            std::vector<V> outVecs(singleItems);
+            std::vector<T> outScalars(singleItems);
+
+            auto matrix_op = [&](const std::string &name, auto op) {
+                runner.run(prefix + name, type, "single", singleItems, [&] {
+                    for (std::size_t i = 0; i < singleItems; ++i)
+                        out[i] = op(a[i], b[i], scalars[i]);
+                    do_not_optimize(out.data());
+                });
+            };
+
+            // Operators
+            matrix_op("operator+", [](const M &l, const M &r, T) { return l + r; });
+            matrix_op("operator-", [](const M &l, const M &r, T) { return l - r; });
+            matrix_op("operator*", [](const M &l, const M &r, T) { return l * r; });
+            matrix_op("operator*(scalar)", [](const M &l, const M &, T s) { return l * s; });
+            matrix_op("operator*(scalar,mat)", [](const M &l, const M &, T s) { return s * l; });
+            matrix_op("operator*=", [](M l, const M &r, T) { return l *= r; });
+            matrix_op("operator+=", [](M l, const M &r, T) { return l += r; });
+
+            // Member functions
+            matrix_op("transposed", [](const M &l, const M &, T) { return l.transposed(); });
+            matrix_op("transpose", [](M l, const M &, T) {
+                l.transpose();
+                return l;
+            });
+            matrix_op("identity", [](const M &, const M &, T) { return M::identity(); });
+            matrix_op("reset", [](M l, const M &, T) {
+                l.reset();
+                return l;
+            });
+            matrix_op("Cast", [](const M &l, const M &, T) { return l.template Cast<double>().template Cast<T>(); });
+            matrix_op("Sm::reciprocal", [](const M &l, const M &, T) { return Sm::reciprocal(l); });
+
+            if constexpr (std::is_floating_point<T>::value) {
+                matrix_op("inverse", [](const M &l, const M &, T) { return l.inverse(); });
+                matrix_op("try_inverse", [](const M &l, const M &, T) {
+                    M result;
+                    l.try_inverse(result);
+                    return result;
+                });
+
+                if constexpr (N > 2) {
+                    /* Make the inputs affine so both fast paths do meaningful work */
+                    auto affine = a;
+                    for (auto &mat: affine) {
+                        for (std::size_t c = 0; c + 1 < N; ++c)
+                            mat(N - 1, c) = T(0);
+                        mat(N - 1, N - 1) = T(1);
+                    }
+
+                    runner.run(prefix + "inverse(affine input)", type, "single", singleItems, [&] {
+                        for (std::size_t i = 0; i < singleItems; ++i)
+                            out[i] = affine[i].inverse();
+                        do_not_optimize(out.data());
+                    });
+                    runner.run(prefix + "inverse_affine", type, "single", singleItems, [&] {
+                        for (std::size_t i = 0; i < singleItems; ++i)
+                            out[i] = affine[i].inverse_affine();
+                        do_not_optimize(out.data());
+                    });
+                    runner.run(prefix + "inverse_rigid", type, "single", singleItems, [&] {
+                        for (std::size_t i = 0; i < singleItems; ++i)
+                            out[i] = affine[i].inverse_rigid();
+                        do_not_optimize(out.data());
+                    });
+                }
+            }
+
+            runner.run(prefix + "determinant", type, "single", singleItems, [&] {
+                for (std::size_t i = 0; i < singleItems; ++i)
+                    outScalars[i] = a[i].determinant();
+                do_not_optimize(outScalars.data());
+            });
+
+            runner.run(prefix + "trace", type, "single", singleItems, [&] {
+                for (std::size_t i = 0; i < singleItems; ++i)
+                    outScalars[i] = a[i].trace();
+                do_not_optimize(outScalars.data());
+            });
+
+            runner.run(prefix + "Sm::operator*(mat,vec)", type, "single", singleItems, [&] {
+                for (std::size_t i = 0; i < singleItems; ++i)
+                    outVecs[i] = Sm::operator*(a[i], vecs[i]);
+                do_not_optimize(outVecs.data());
+            });
+
+            runner.run(prefix + "Sm::operator*(vec,mat)", type, "single", singleItems, [&] {
+                for (std::size_t i = 0; i < singleItems; ++i)
+                    outVecs[i] = Sm::operator*(vecs[i], a[i]);
+                do_not_optimize(outVecs.data());
+            });
+        }
+
+        template<typename T>
+        void matrix_benchmarks_for_type(Runner &runner) {
+            matrix_benchmarks<T, 2>(runner);
+            matrix_benchmarks<T, 3>(runner);
+            matrix_benchmarks<T, 4>(runner);
+        }
+    }
+
+    void register_matrix_benchmarks(Runner &runner) {
+        matrix_benchmarks_for_type<float>(runner);
+        matrix_benchmarks_for_type<double>(runner);
+        matrix_benchmarks_for_type<int>(runner);
+    }
+}
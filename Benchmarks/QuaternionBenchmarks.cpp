@@ -0,0 +1,126 @@
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "SlimeMath.h"
+
+namespace Bench {
+    namespace {
+        template<typename T>
+        std::vector<Quaternion<T>> random_rotations(std::size_t count) {
+            std::vector<Quaternion<T>> result(count);
+            for (auto &q: result) {
+                q = Quaternion<T>{random_value<T>(rng()), random_value<T>(rng()),
+                                  random_value<T>(rng()), random_value<T>(rng())};
+                q.Normalize();
+            }
+            return result;
+        }
+
+        template<typename T>
+        void quaternion_benchmarks(Runner &runner) {
+            using Q = Quaternion<T>;
+            using V = Vector<T, 3>;
+            const std::string type = type_name<T>();
+            const std::string prefix = "Quaternion::";
+
+            const auto a = random_rotations<T>(singleItems);
+            const auto b = random_rotations<T>(singleItems);
+            std::vector<V> vecs(singleItems);
+            std::vector<T> scalars(singleItems);
+            for (std::size_t i = 0; i < singleItems; ++i) {
+                vecs[i] = V{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng())};
+                scalars[i] = T(i) / T(singleItems);
+            }
+
+            std::vector<Q> out(singleItems);
+            std::vector<V> outVecs(singleItems);
+            std::vector<T> outScalars(singleItems);
+
+            auto quaternion_op = [&](const std::string &name, auto op) {
+                runner.run(prefix + name, type, "single", singleItems, [&] {
+                    for (std::size_t i = 0; i < singleItems; ++i)
+                        out[i] = op(a[i], b[i], scalars[i], vecs[i]);
+                    do_not_optimize(out.data());
+                });
+            };
+
+            auto vector_op = [&](const std::string &name, auto op) {
+                runner.run(prefix + name, type, "single", singleItems, [&] {
+                    for (std::size_t i = 0; i < singleItems; ++i)
+                        outVecs[i] = op(a[i], vecs[i]);
+                    do_not_optimize(outVecs.data());
+                });
+            };
+
+            // Operators
+            quaternion_op("operator*", [](const Q &l, const Q &r, T, const V &) { return l * r; });
+            quaternion_op("operator+", [](const Q &l, const Q &r, T, const V &) { return l + r; });
+            quaternion_op("operator-", [](const Q &l, const Q &r, T, const V &) { return l - r; });
+            quaternion_op("operator*(scalar)", [](const Q &l, const Q &, T s, const V &) { return l * s; });
+            quaternion_op("operator*=", [](Q l, const Q &r, T, const V &) { return l *= r; });
+            vector_op("operator*(vec3)", [](const Q &l, const V &v) { return l * v; });
+
+            // Member functions
+            quaternion_op("Normalized", [](const Q &l, const Q &, T, const V &) { return l.Normalized(); });
+            quaternion_op("Inverse", [](const Q &l, const Q &, T, const V &) { return l.Inverse(); });
+            quaternion_op("slerp", [](const Q &l, const Q &r, T s, const V &) {
+                Q result;
+                result.slerp(l, r, s);
+                return result;
+            });
+            quaternion_op("set_euler_angles", [](const Q &, const Q &, T, const V &v) {
+                Q result;
+                result.set_euler_angles(v);
+                return result;
+            });
+            quaternion_op("set_angle_axis", [](const Q &, const Q &, T s, const V &v) {
+                Q result;
+                result.set_angle_axis(v.normalized(), s);
+                return result;
+            });
+            vector_op("get_euler_angles", [](const Q &l, const V &) {
+                V angles;
+                l.get_euler_angles(angles);
+                return angles;
+            });
+            vector_op("get_angle_axis", [](const Q &l, const V &) {
+                V axis;
+                T angle;
+                l.get_angle_axis(axis, angle);
+                return axis * angle;
+            });
+
+            // Sm:: functions
+            runner.run(prefix + "Sm::dot", type, "single", singleItems, [&] {
+                for (std::size_t i = 0; i < singleItems; ++i)
+                    outScalars[i] = Sm::dot(a[i], b[i]);
+                do_not_optimize(outScalars.data());
+            });
+            quaternion_op("Sm::slerp", [](const Q &l, const Q &r, T s, const V &) { return Sm::slerp(l, r, s); });
+            quaternion_op("Sm::normalize", [](Q l, const Q &, T, const V &) {
+                Sm::normalize(l);
+                return l;
+            });
+
+            // Sm::fast:: functions
+            quaternion_op("Sm::fast::slerp", [](const Q &l, const Q &r, T s, const V &) {
+                return Sm::fast::slerp(l, r, s);
+            });
+            quaternion_op("Sm::fast::normalize", [](Q l, const Q &, T, const V &) {
+                Sm::fast::normalize(l);
+                return l;
+            });
+            vector_op("Sm::fast::get_angle_axis", [](const Q &l, const V &) {
+                V axis;
+                T angle;
+                Sm::fast::get_angle_axis(l, axis, angle);
+                return axis * angle;
+            });
+        }
+    }
+
+    void register_quaternion_benchmarks(Runner &runner) {
+        quaternion_benchmarks<float>(runner);
+        quaternion_benchmarks<double>(runner);
+    }
+}
@@ -0,0 +1,138 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "SlimeMath.h"
+
+// Ray-triangle and ray-box kernels: packets against one primitive and one ray against many primitives,
+// each next to the same tests done one ray and one primitive at a time.
+namespace Bench {
+    namespace {
+        template<typename T, std::size_t N>
+        void packet_benchmarks(Runner &runner, const std::vector<Ray<T>> &rays, const std::vector<Vector<T, 3>> &a,
+                               const std::vector<Vector<T, 3>> &b, const std::vector<Vector<T, 3>> &c,
+                               const std::vector<AABB<T>> &boxes) {
+            const std::string type = type_name<T>();
+            const std::size_t tests = rays.size() * a.size();
+            const std::string workload = std::to_string(rays.size()) + " rays x " + std::to_string(a.size()) +
+                                         " primitives, " + std::to_string(N) + " wide";
+
+            std::vector<RayPacket<T, N>> packets;
+            for (std::size_t r = 0; r < rays.size(); r += N)
+                packets.emplace_back(rays.data() + r);
+
+            std::size_t hits = 0;
+            Result *result = runner.run("Sm::intersect_triangle(packet)", type, workload, tests, [&] {
+                hits = 0;
+                for (auto packet: packets) {
+                    RayPacketHit<T, N> hit;
+                    for (std::size_t i = 0; i < a.size(); ++i)
+                        hits += Sm::intersect_triangle(packet, a[i], b[i], c[i], static_cast<std::uint32_t>(i), hit) != 0;
+                    do_not_optimize(hit);
+                }
+                do_not_optimize(hits);
+            });
+            Runner::add_counter(result, "hits", double(hits));
+
+            runner.run("Sm::intersect_aabb(packet)", type, workload, tests, [&] {
+                hits = 0;
+                for (const auto &packet: packets)
+                    for (const auto &box: boxes)
+                        hits += Sm::intersect_aabb(packet, box) != 0;
+                do_not_optimize(hits);
+            });
+        }
+
+        template<typename T>
+        void ray_benchmarks(Runner &runner) {
+            using V3 = Vector<T, 3>;
+            const std::string type = type_name<T>();
+
+            /* Camera rays through a 64 x 64 grid towards small triangles scattered in front of them */
+            const std::size_t side = 64, primitiveCount = 256;
+            std::vector<Ray<T>> rays;
+            for (std::size_t y = 0; y < side; ++y)
+                for (std::size_t x = 0; x < side; ++x)
+                    rays.emplace_back(V3{}, V3{T(x) / T(side / 8) - T(4), T(y) / T(side / 8) - T(4), T(-8)});
+
+            std::vector<V3> a(primitiveCount), b(primitiveCount), c(primitiveCount);
+            std::vector<AABB<T>> boxes(primitiveCount);
+            std::vector<V3> mins(primitiveCount), maxs(primitiveCount);
+            for (std::size_t i = 0; i < primitiveCount; ++i) {
+                const V3 center{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng()) - T(8)};
+                a[i] = center + V3{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng())} * T(0.25);
+                b[i] = center + V3{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng())} * T(0.25);
+                c[i] = center + V3{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng())} * T(0.25);
+                boxes[i] = AABB<T>{a[i]};
+                boxes[i].expand(b[i]);
+                boxes[i].expand(c[i]);
+                mins[i] = boxes[i].min;
+                maxs[i] = boxes[i].max;
+            }
+
+            const std::size_t tests = rays.size() * primitiveCount;
+            const std::string workload = std::to_string(rays.size()) + " rays x " + std::to_string(primitiveCount) +
+                                         " primitives";
+
+            std::size_t hits = 0;
+            runner.run("Sm::intersect_triangle(loop)", type, workload, tests, [&] {
+                hits = 0;
+                for (auto ray: rays) {
+                    RayHit<T> hit;
+                    for (std::size_t i = 0; i < primitiveCount; ++i) {
+                        T t, u, v;
+                        if (Sm::intersect_triangle(ray, a[i], b[i], c[i], t, u, v)) {
+                            ray.tMax = t;
+                            hit = RayHit<T>{u, v, static_cast<std::uint32_t>(i)};
+                            ++hits;
+                        }
+                    }
+                    do_not_optimize(hit);
+                }
+                do_not_optimize(hits);
+            });
+            runner.run("Sm::intersect_triangles", type, workload, tests, [&] {
+                hits = 0;
+                for (auto ray: rays) {
+                    RayHit<T> hit;
+                    hits += Sm::intersect_triangles(ray, a.data(), b.data(), c.data(), primitiveCount, hit);
+                    do_not_optimize(hit);
+                }
+                do_not_optimize(hits);
+            });
+            runner.run("Sm::occluded_triangles", type, workload, tests, [&] {
+                hits = 0;
+                for (const auto &ray: rays)
+                    hits += Sm::occluded_triangles(ray, a.data(), b.data(), c.data(), primitiveCount);
+                do_not_optimize(hits);
+            });
+
+            runner.run("Sm::intersect_aabb(loop)", type, workload, tests, [&] {
+                hits = 0;
+                for (const auto &ray: rays)
+                    for (const auto &box: boxes) {
+                        T near;
+                        hits += Sm::intersect_aabb(ray, box, near);
+                    }
+                do_not_optimize(hits);
+            });
+            std::vector<std::uint32_t> indices(primitiveCount);
+            std::vector<T> distances(primitiveCount);
+            runner.run("Sm::intersect_aabbs", type, workload, tests, [&] {
+                hits = 0;
+                for (const auto &ray: rays)
+                    hits += Sm::intersect_aabbs(ray, mins.data(), maxs.data(), primitiveCount, indices.data(),
+                                                distances.data());
+                do_not_optimize(hits);
+            });
+
+            packet_benchmarks<T, 4>(runner, rays, a, b, c, boxes);
+            packet_benchmarks<T, 8>(runner, rays, a, b, c, boxes);
+        }
+    }
+
+    void register_ray_benchmarks(Runner &runner) {
+        ray_benchmarks<float>(runner);
+        ray_benchmarks<double>(runner);
+    }
+}
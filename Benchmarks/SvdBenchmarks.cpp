@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Benchmark.h"
+#include "SlimeMath.h"
+
+// 3x3 singular value and polar decompositions one at a time and in batches, measured against a one sided Jacobi
+// solver in double precision that iterates until the columns are orthogonal.
+// reconstruction_eps is the largest |m - u * diag(sigma) * transposed(v)| relative to the largest element of m,
+// sigma_eps the largest singular value error relative to the largest singular value, rotation_error the largest
+// element difference between the polar rotation and the reference one. Errors in units of epsilon of the type.
+// The closest rotation to a reflecting matrix is ill conditioned when its two smallest singular values nearly cancel,
+// those few matrices set rotation_error of the whole batch.
+namespace Bench {
+    namespace {
+        struct Reference {
+            double sigma[3];
+            double rotation[9];
+        };
+
+        // Hestenes' one sided Jacobi: rotates pairs of columns of m until they are orthogonal
+        template<typename T>
+        Reference reference_svd(const Matrix<T, 3, 3> &m) {
+            double w[9], v[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+            for (std::size_t k = 0; k < 9; ++k)
+                w[k] = double(m[k]);
+
+            for (std::size_t sweep = 0; sweep < 32; ++sweep) {
+                bool rotated = false;
+                for (std::size_t p = 0; p < 2; ++p) {
+                    for (std::size_t q = p + 1; q < 3; ++q) {
+                        double alpha = 0.0, beta = 0.0, gamma = 0.0;
+                        for (std::size_t r = 0; r < 3; ++r) {
+                            alpha += w[r * 3 + p] * w[r * 3 + p];
+                            beta += w[r * 3 + q] * w[r * 3 + q];
+                            gamma += w[r * 3 + p] * w[r * 3 + q];
+                        }
+                        if (std::abs(gamma) <= 1e-17 * std::sqrt(alpha * beta))
+                            continue;
+                        rotated = true;
+
+                        const double zeta = (beta - alpha) / (2.0 * gamma);
+                        const double t = (zeta >= 0.0 ? 1.0 : -1.0) / (std::abs(zeta) + std::sqrt(1.0 + zeta * zeta));
+                        const double c = 1.0 / std::sqrt(1.0 + t * t);
+                        const double s = c * t;
+                        for (double *a: {w, v}) {
+                            for (std::size_t r = 0; r < 3; ++r) {
+                                const double ap = a[r * 3 + p], aq = a[r * 3 + q];
+                                a[r * 3 + p] = c * ap - s * aq;
+                                a[r * 3 + q] = s * ap + c * aq;
+                            }
+                        }
+                    }
+                }
+                if (!rotated)
+                    break;
+            }
+
+            std::size_t order[3] = {0, 1, 2};
+            double lengths[3];
+            for (std::size_t c = 0; c < 3; ++c)
+                lengths[c] = std::sqrt(w[c] * w[c] + w[3 + c] * w[3 + c] + w[6 + c] * w[6 + c]);
+            std::sort(order, order + 3, [&](std::size_t a, std::size_t b) { return lengths[a] > lengths[b]; });
+
+            Reference result{};
+            double u[9];
+            for (std::size_t c = 0; c < 3; ++c) {
+                result.sigma[c] = lengths[order[c]];
+                for (std::size_t r = 0; r < 3; ++r)
+                    u[r * 3 + c] = lengths[order[c]] > 0.0 ? w[r * 3 + order[c]] / lengths[order[c]] : 0.0;
+            }
+
+            /* The closest rotation, a reflection moves to the smallest singular value */
+            for (std::size_t r = 0; r < 3; ++r)
+                for (std::size_t c = 0; c < 3; ++c)
+                    result.rotation[r * 3 + c] = u[r * 3] * v[c * 3 + order[0]] + u[r * 3 + 1] * v[c * 3 + order[1]] +
+                                                 u[r * 3 + 2] * v[c * 3 + order[2]];
+            const double *r = result.rotation;
+            const double det = r[0] * (r[4] * r[8] - r[5] * r[7]) - r[1] * (r[3] * r[8] - r[5] * r[6]) +
+                               r[2] * (r[3] * r[7] - r[4] * r[6]);
+            if (det < 0.0) {
+                for (std::size_t row = 0; row < 3; ++row)
+                    for (std::size_t c = 0; c < 3; ++c)
+                        result.rotation[row * 3 + c] -= 2.0 * u[row * 3 + 2] * v[c * 3 + order[2]];
+            }
+            return result;
+        }
+
+        template<typename T>
+        std::pair<double, double> svd_errors(const std::vector<Matrix<T, 3, 3>> &matrices,
+                                             const std::vector<Reference> &references, const std::vector<Svd<T>> &svd,
+                                             std::size_t count) {
+            double reconstruction = 0.0, sigma = 0.0;
+            for (std::size_t i = 0; i < count; ++i) {
+                const Matrix<T, 3, 3> &m = matrices[i];
+                const Matrix<T, 3, 3> product = svd[i].matrix();
+                double scale = 0.0;
+                for (std::size_t e = 0; e < m.elements; ++e)
+                    scale = std::max(scale, double(std::abs(m[e])));
+                for (std::size_t e = 0; e < m.elements; ++e)
+                    reconstruction = std::max(reconstruction, std::abs(double(product[e]) - double(m[e])) / scale);
+
+                for (std::size_t k = 0; k < 3; ++k)
+                    sigma = std::max(sigma, std::abs(std::abs(double(svd[i].sigma[k])) - references[i].sigma[k]) /
+                                            references[i].sigma[0]);
+            }
+            const double eps = double(std::numeric_limits<T>::epsilon());
+            return {reconstruction / eps, sigma / eps};
+        }
+
+        template<typename T>
+        double rotation_error(const std::vector<Reference> &references, const std::vector<Quaternion<T>> &rotations,
+                              std::size_t count) {
+            double worst = 0.0;
+            for (std::size_t i = 0; i < count; ++i) {
+                Matrix<T, 3, 3> rotation;
+                Sm::quaternion_to_matrix(rotation, rotations[i]);
+                for (std::size_t e = 0; e < 9; ++e)
+                    worst = std::max(worst, std::abs(double(rotation[e]) - references[i].rotation[e]));
+            }
+            return worst / double(std::numeric_limits<T>::epsilon());
+        }
+
+        template<typename T>
+        void svd_benchmarks(Runner &runner) {
+            using M = Matrix<T, 3, 3>;
+            const std::string type = type_name<T>();
+            const std::string workload = std::to_string(batchItems) + " matrices";
+
+            /* Rotations with some stretch and shear, like shape matching deformations, every eighth one reflected */
+            std::vector<M> matrices(batchItems);
+            for (std::size_t i = 0; i < batchItems; ++i) {
+                Quaternion<T> q{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng()),
+                                random_value<T>(rng())};
+                q.Normalize();
+                Sm::quaternion_to_matrix(matrices[i], q);
+                for (std::size_t e = 0; e < 9; ++e)
+                    matrices[i][e] += random_value<T>(rng()) * T(0.125);
+                if (i % 8 == 0)
+                    for (std::size_t c = 0; c < 3; ++c)
+                        matrices[i](2, c) = -matrices[i](2, c);
+            }
+
+            std::vector<Reference> references(batchItems);
+            if (!runner.options().list)
+                for (std::size_t i = 0; i < batchItems; ++i)
+                    references[i] = reference_svd(matrices[i]);
+
+            runner.run("reference one sided Jacobi(double)", type, "single", singleItems, [&] {
+                for (std::size_t i = 0; i < singleItems; ++i)
+                    references[i] = reference_svd(matrices[i]);
+                do_not_optimize(references.data());
+            });
+
+            std::vector<Svd<T>> svd(batchItems);
+            Result *result = runner.run("Sm::svd", type, "single", singleItems, [&] {
+                for (std::size_t i = 0; i < singleItems; ++i)
+                    svd[i] = Sm::svd(matrices[i]);
+                do_not_optimize(svd.data());
+            });
+            if (result && !runner.options().list) {
+                const auto errors = svd_errors(matrices, references, svd, singleItems);
+                Runner::add_counter(result, "reconstruction_eps", errors.first);
+                Runner::add_counter(result, "sigma_eps", errors.second);
+            }
+
+            result = runner.run("Sm::svd(batch)", type, workload, batchItems, [&] {
+                Sm::svd(matrices.data(), svd.data(), batchItems);
+                do_not_optimize(svd.data());
+            });
+            if (result && !runner.options().list) {
+                const auto errors = svd_errors(matrices, references, svd, batchItems);
+                Runner::add_counter(result, "reconstruction_eps", errors.first);
+                Runner::add_counter(result, "sigma_eps", errors.second);
+            }
+
+            std::vector<Quaternion<T>> rotations(batchItems);
+            result = runner.run("Sm::polar_rotation", type, "single", singleItems, [&] {
+                for (std::size_t i = 0; i < singleItems; ++i)
+                    rotations[i] = Sm::polar_rotation(matrices[i]);
+                do_not_optimize(rotations.data());
+            });
+            if (result && !runner.options().list)
+                Runner::add_counter(result, "rotation_error", rotation_error(references, rotations, singleItems));
+
+            result = runner.run("Sm::polar_rotation(batch)", type, workload, batchItems, [&] {
+                Sm::polar_rotation(matrices.data(), rotations.data(), batchItems);
+                do_not_optimize(rotations.data());
+            });
+            if (result && !runner.options().list)
+                Runner::add_counter(result, "rotation_error", rotation_error(references, rotations, batchItems));
+
+            runner.run("Sm::polar_rotation(Executor)", type, workload, batchItems, [&] {
+                Sm::polar_rotation(Sm::default_executor(), matrices.data(), rotations.data(), batchItems);
+                do_not_optimize(rotations.data());
+            });
+        }
+    }
+
+    void register_svd_benchmarks(Runner &runner) {
+        svd_benchmarks<float>(runner);
+        svd_benchmarks<double>(runner);
+    }
+}
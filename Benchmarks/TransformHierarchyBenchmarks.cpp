@@ -0,0 +1,90 @@
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "SlimeMath.h"
+#include "TransformHierarchy.h"
+
+// TransformHierarchy::update() against recomputing every world matrix, per node in the hierarchy.
+namespace Bench {
+    namespace {
+        template<typename T>
+        void transform_hierarchy_benchmarks(Runner &runner) {
+            using H = TransformHierarchy<T>;
+            using V3 = Vector<T, 3>;
+            using Q = Quaternion<T>;
+            const std::string type = type_name<T>();
+            const std::string workload = std::to_string(batchItems) + " nodes";
+
+            auto random_rotation = [] {
+                return Q{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng()),
+                         random_value<T>(rng())}.Normalized();
+            };
+
+            /* Roughly a scene graph: one root, every node has up to eight children */
+            H hierarchy;
+            std::vector<typename H::Node> nodes;
+            nodes.push_back(hierarchy.add());
+            for (std::size_t i = 1; i < batchItems; ++i)
+                nodes.push_back(hierarchy.add(nodes[rng()() % ((i + 7) / 8)],
+                                              V3{random_value<T>(rng()), random_value<T>(rng()),
+                                                 random_value<T>(rng())},
+                                              random_rotation()));
+            hierarchy.update();
+
+            std::vector<Q> rotations(batchItems);
+            for (auto &rotation: rotations)
+                rotation = random_rotation();
+
+            Result *result = runner.run("TransformHierarchy::update(all dirty)", type, workload, batchItems, [&] {
+                for (std::size_t i = 0; i < batchItems; ++i)
+                    hierarchy.set_rotation(nodes[i], rotations[i]);
+                hierarchy.update();
+            });
+            Runner::add_counter(result, "updated", double(hierarchy.stats().worldUpdated));
+
+            /* Leaves mostly, like animated props in a static level */
+            result = runner.run("TransformHierarchy::update(1% dirty)", type, workload, batchItems, [&] {
+                for (std::size_t i = batchItems - 1; i >= batchItems / 2; i -= 50)
+                    hierarchy.set_rotation(nodes[i], rotations[i]);
+                hierarchy.update();
+            });
+            Runner::add_counter(result, "updated", double(hierarchy.stats().worldUpdated));
+
+            Sm::TransformHierarchyOptions parallel;
+            parallel.threads = 0;
+            result = runner.run("TransformHierarchy::update(all dirty, all threads)", type, workload, batchItems, [&] {
+                for (std::size_t i = 0; i < batchItems; ++i)
+                    hierarchy.set_rotation(nodes[i], rotations[i]);
+                hierarchy.update(parallel);
+            });
+            Runner::add_counter(result, "threads", double(hierarchy.stats().threads));
+
+            /* What every scene update did before: rebuild each world matrix from its parent */
+            std::vector<typename H::Node> parents(batchItems);
+            for (std::size_t i = 0; i < batchItems; ++i)
+                parents[i] = hierarchy.parent(nodes[i]);
+            std::vector<Matrix<T, 4, 4>> world(batchItems);
+            runner.run("TransformHierarchy(recompute loop)", type, workload, batchItems, [&] {
+                for (std::size_t i = 0; i < batchItems; ++i) {
+                    Matrix<T, 3, 3> r{};
+                    Sm::quaternion_to_matrix(r, rotations[i]);
+                    Matrix<T, 4, 4> local;
+                    const V3 &t = hierarchy.translation(nodes[i]);
+                    const V3 &s = hierarchy.scale(nodes[i]);
+                    for (std::size_t row = 0; row < 3; ++row) {
+                        for (std::size_t col = 0; col < 3; ++col)
+                            local(row, col) = r(row, col) * s[col];
+                        local(row, 3) = t[row];
+                    }
+                    world[i] = parents[i] == H::none ? local : world[parents[i]] * local;
+                }
+                do_not_optimize(world.data());
+            });
+        }
+    }
+
+    void register_transform_hierarchy_benchmarks(Runner &runner) {
+        transform_hierarchy_benchmarks<float>(runner);
+        transform_hierarchy_benchmarks<double>(runner);
+    }
+}
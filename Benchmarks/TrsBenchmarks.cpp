@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "SlimeMath.h"
+
+// Model matrices from translation, rotation and scale, the closed form against building the three factors and
+// multiplying them, and the decomposition back. roundtrip_eps is the largest element difference between a matrix
+// and compose_trs of its decomposition, relative to the largest element of the matrix and in units of epsilon.
+namespace Bench {
+    namespace {
+        template<typename T>
+        void trs_benchmarks(Runner &runner) {
+            using V3 = Vector<T, 3>;
+            using M4 = Matrix<T, 4, 4>;
+            const std::string type = type_name<T>();
+            const std::string workload = std::to_string(batchItems) + " transforms";
+
+            std::vector<V3> translations(batchItems), scales(batchItems);
+            std::vector<Quaternion<T>> rotations(batchItems);
+            for (std::size_t i = 0; i < batchItems; ++i) {
+                translations[i] = V3{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng())};
+                scales[i] = V3{std::abs(random_value<T>(rng())), std::abs(random_value<T>(rng())),
+                               std::abs(random_value<T>(rng()))};
+                rotations[i] = Quaternion<T>{random_value<T>(rng()), random_value<T>(rng()), random_value<T>(rng()),
+                                             random_value<T>(rng())}.Normalized();
+            }
+            const VectorArray<T, 3> translationArray{translations.data(), batchItems};
+            const VectorArray<T, 3> scaleArray{scales.data(), batchItems};
+            VectorArray<T, 4> rotationArray(batchItems);
+            for (std::size_t i = 0; i < batchItems; ++i)
+                rotationArray.set(i, Vector<T, 4>{rotations[i].x, rotations[i].y, rotations[i].z, rotations[i].w});
+
+            std::vector<M4> matrices(batchItems);
+            runner.run("Translate * Rotate * Scale(generic)", type, "single", singleItems, [&] {
+                for (std::size_t i = 0; i < singleItems; ++i) {
+                    M4 translate, rotate, scale;
+                    const Matrix<T, 3, 3> rotation = rotations[i].ToMatrix3();
+                    for (std::size_t r = 0; r < 3; ++r) {
+                        translate(r, 3) = translations[i][r];
+                        scale(r, r) = scales[i][r];
+                        for (std::size_t c = 0; c < 3; ++c)
+                            rotate(r, c) = rotation(r, c);
+                    }
+                    matrices[i] = translate * rotate * scale;
+                }
+                do_not_optimize(matrices.data());
+            });
+            runner.run("Sm::compose_trs", type, "single", singleItems, [&] {
+                for (std::size_t i = 0; i < singleItems; ++i)
+                    matrices[i] = Sm::compose_trs(translations[i], rotations[i], scales[i]);
+                do_not_optimize(matrices.data());
+            });
+            runner.run("Sm::compose_trs(VectorArray)", type, workload, batchItems, [&] {
+                Sm::compose_trs(translationArray, rotationArray, scaleArray, matrices.data());
+                do_not_optimize(matrices.data());
+            });
+
+            const auto roundtrip_error = [&](const Trs<T> &trs, const M4 &m) {
+                const M4 back = Sm::compose_trs(trs);
+                double worst = 0.0, scale = 0.0;
+                for (std::size_t e = 0; e < m.elements; ++e) {
+                    worst = std::max(worst, std::abs(double(back[e]) - double(m[e])));
+                    scale = std::max(scale, double(std::abs(m[e])));
+                }
+                return worst / scale / double(std::numeric_limits<T>::epsilon());
+            };
+
+            std::vector<Trs<T>> parts(batchItems);
+            Result *result = runner.run("Sm::decompose_trs", type, "single", singleItems, [&] {
+                for (std::size_t i = 0; i < singleItems; ++i)
+                    parts[i] = Sm::decompose_trs(matrices[i]);
+                do_not_optimize(parts.data());
+            });
+            if (result && !runner.options().list) {
+                double worst = 0.0;
+                for (std::size_t i = 0; i < singleItems; ++i)
+                    worst = std::max(worst, roundtrip_error(parts[i], matrices[i]));
+                Runner::add_counter(result, "roundtrip_eps", worst);
+            }
+
+            VectorArray<T, 3> translationParts, scaleParts;
+            VectorArray<T, 4> rotationParts;
+            result = runner.run("Sm::decompose_trs(VectorArray)", type, workload, batchItems, [&] {
+                Sm::decompose_trs(matrices.data(), batchItems, translationParts, rotationParts, scaleParts);
+                do_not_optimize(rotationParts.component(0));
+            });
+            if (result && !runner.options().list) {
+                double worst = 0.0;
+                for (std::size_t i = 0; i < batchItems; ++i) {
+                    const Vector<T, 4> q = rotationParts.get(i);
+                    const Trs<T> trs{translationParts.get(i), Quaternion<T>{q.x, q.y, q.z, q.w}, scaleParts.get(i)};
+                    worst = std::max(worst, roundtrip_error(trs, matrices[i]));
+                }
+                Runner::add_counter(result, "roundtrip_eps", worst);
+            }
+        }
+    }
+
+    void register_trs_benchmarks(Runner &runner) {
+        trs_benchmarks<float>(runner);
+        trs_benchmarks<double>(runner);
+    }
+}
@@ -0,0 +1,129 @@
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "Benchmark.h"
+#include "SlimeMath.h"
+
+namespace Bench {
+    namespace {
+        template<typename V>
+        std::vector<V> random_vectors(std::size_t count) {
+            std::vector<V> result(count);
+            for (auto &vec: result)
+                for (std::size_t c = 0; c < V::components; ++c)
+                    vec[c] = random_value<typename V::ScalarType>(rng());
+            return result;
+        }
+
+        template<typename T, std::size_t N>
+        void vector_benchmarks(Runner &runner) {
+            using V = Vector<T, N>;
+            const std::string type = type_name<T>();
+            const std::string prefix = "Vector" + std::to_string(N) + "::";
+
+            const auto a = random_vectors<V>(singleItems);
+            const auto b = random_vectors<V>(singleItems);
+            std::vector<T> scalars(singleItems);
+            for (auto &s: scalars)
+                s = random_value<T>(rng());
+
+            std::vector<V> out(singleItems);
+            std::vector<T> outScalars(singleItems);
+
+            auto vector_op = [&](const std::string &name, auto op) {
+                runner.run(prefix + name, type, "single", singleItems, [&] {
+                    for (std::size_t i = 0; i < singleItems; ++i)
+                        out[i] = op(a[i], b[i], scalars[i]);
+                    do_not_optimize(out.data());
+                });
+            };
+
+            auto scalar_op = [&](const std::string &name, auto op) {
+                runner.run(prefix + name, type, "single", singleItems, [&] {
+                    for (std::size_t i = 0; i < singleItems; ++i)
+                        outScalars[i] = op(a[i], b[i]);
+                    do_not_optimize(outScalars.data());
+                });
+            };
+
+            // Operators
+            vector_op("operator+", [](const V &l, const V &r, T) { return l + r; });
+            vector_op("operator-", [](const V &l, const V &r, T) { return l - r; });
+            vector_op("operator*", [](const V &l, const V &r, T) { return l * r; });
+            vector_op("operator/", [](const V &l, const V &r, T) { return l / r; });
+            vector_op("operator*(scalar)", [](const V &l, const V &, T s) { return l * s; });
+            vector_op("operator*(scalar,vec)", [](const V &l, const V &, T s) { return s * l; });
+            vector_op("operator/(scalar)", [](const V &l, const V &, T s) { return l / s; });
+            vector_op("operator-(unary)", [](const V &l, const V &, T) { return -l; });
+            vector_op("operator+=", [](V l, const V &r, T) { return l += r; });
+            vector_op("operator*=(scalar)", [](V l, const V &, T s) { return l *= s; });
+            scalar_op("operator[]", [](const V &l, const V &r) { return l[N - 1] + r[0]; });
+
+            // Member functions
+            scalar_op("length_sq", [](const V &l, const V &) { return l.length_sq(); });
+            scalar_op("length", [](const V &l, const V &) { return l.length(); });
+            vector_op("normalized", [](const V &l, const V &, T) { return l.normalized(); });
+            vector_op("resize", [](V l, const V &, T s) {
+                l.resize(s);
+                return l;
+            });
+            vector_op("cast", [](const V &l, const V &, T) { return l.template cast<double>().template cast<T>(); });
+
+            // Sm:: functions
+            scalar_op("Sm::dot", [](const V &l, const V &r) { return Sm::dot(l, r); });
+            scalar_op("Sm::distance", [](const V &l, const V &r) { return Sm::distance(l, r); });
+            scalar_op("Sm::distance_sq", [](const V &l, const V &r) { return Sm::distance_sq(l, r); });
+            scalar_op("Sm::angle", [](const V &l, const V &r) { return Sm::angle(l, r); });
+            vector_op("Sm::reflect", [](const V &l, const V &r, T) { return Sm::reflect(l, r); });
+            vector_op("Sm::lerp", [](const V &l, const V &r, T s) { return Sm::lerp(l, r, s); });
+            vector_op("Sm::mix", [](const V &l, const V &r, T s) { return Sm::mix(l, r, s, T(1) - s); });
+            vector_op("Sm::reciprocal", [](const V &l, const V &, T) { return Sm::reciprocal(l); });
+            vector_op("Sm::normalize", [](V l, const V &, T) {
+                Sm::normalize(l);
+                return l;
+            });
+
+            // Sm::fast:: functions
+            if constexpr (std::is_floating_point<T>::value) {
+                scalar_op("Sm::fast::length", [](const V &l, const V &) { return Sm::fast::length(l); });
+                scalar_op("Sm::fast::angle", [](const V &l, const V &r) { return Sm::fast::angle(l, r); });
+                vector_op("Sm::fast::normalize", [](V l, const V &, T) {
+                    Sm::fast::normalize(l);
+                    return l;
+                });
+                vector_op("Sm::fast::resize", [](V l, const V &, T s) {
+                    Sm::fast::resize(l, s);
+                    return l;
+                });
+            }
+        }
+
+        template<typename T>
+        void cross_benchmark(Runner &runner) {
+            using V = Vector<T, 3>;
+            const auto a = random_vectors<V>(singleItems);
+            const auto b = random_vectors<V>(singleItems);
+            std::vector<V> out(singleItems);
+
+            runner.run("Vector3::Sm::cross", type_name<T>(), "single", singleItems, [&] {
+                for (std::size_t i = 0; i < singleItems; ++i)
+                    out[i] = Sm::cross(a[i], b[i]);
+                do_not_optimize(out.data());
+            });
+        }
+
+        template<typename T>
+        void vector_benchmarks_for_type(Runner &runner) {
+            vector_benchmarks<T, 2>(runner);
+            vector_benchmarks<T, 3>(runner);
+            vector_benchmarks<T, 4>(runner);
+            cross_benchmark<T>(runner);
+        }
+    }
+
+    void register_vector_benchmarks(Runner &runner) {
+        vector_benchmarks_for_type<float>(runner);
+        vector_benchmarks_for_type<double>(runner);
+        vector_benchmarks_for_type<int>(runner);
+    }
+}
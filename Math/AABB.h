@@ -0,0 +1,155 @@
+#ifndef SLIMEMATHS_AABB_H
+#define SLIMEMATHS_AABB_H
+
+#include <cstddef>
+#include <limits>
+#include <algorithm>
+#include <ostream>
+#include "Vector3.h"
+
+// Axis aligned bounding box [min, max].
+// A default constructed box is empty (min above max), so it can be grown with expand() from nothing.
+
+template<typename T>
+struct AABB {
+    using ScalarType = T;
+    using Vec = Vector<T, 3>;
+
+    // Constructors
+    constexpr AABB() :
+            min{std::numeric_limits<T>::max(), std::numeric_limits<T>::max(), std::numeric_limits<T>::max()},
+            max{std::numeric_limits<T>::lowest(), std::numeric_limits<T>::lowest(), std::numeric_limits<T>::lowest()} {}
+
+    constexpr AABB(const AABB<T> &rhs) = default;
+
+    constexpr AABB(const Vec &min, const Vec &max) : min{min}, max{max} {}
+
+    explicit constexpr AABB(const Vec &point) : min{point}, max{point} {}
+
+    constexpr AABB<T> &operator=(const AABB<T> &rhs) = default;
+
+    // Functions
+    constexpr bool is_empty() const {
+        return min.x > max.x || min.y > max.y || min.z > max.z;
+    }
+
+    constexpr void expand(const Vec &point) {
+        expand(point, point);
+    }
+
+    constexpr void expand(const AABB<T> &box) {
+        expand(box.min, box.max);
+    }
+
+    constexpr Vec center() const {
+        return (min + max) * T(0.5);
+    }
+
+    // Half the size on every axis
+    constexpr Vec extent() const {
+        return (max - min) * T(0.5);
+    }
+
+    constexpr Vec size() const {
+        return max - min;
+    }
+
+    // 0 for empty boxes
+    constexpr T surface_area() const {
+        if (is_empty())
+            return T(0);
+        const Vec s = size();
+        return T(2) * (s.x * s.y + s.y * s.z + s.z * s.x);
+    }
+
+    constexpr T volume() const {
+        if (is_empty())
+            return T(0);
+        const Vec s = size();
+        return s.x * s.y * s.z;
+    }
+
+    // 0, 1 or 2 for x, y or z
+    constexpr std::size_t longest_axis() const {
+        const Vec s = size();
+        return s.x >= s.y && s.x >= s.z ? 0 : (s.y >= s.z ? 1 : 2);
+    }
+
+    constexpr bool contains(const Vec &point) const {
+        return point.x >= min.x && point.x <= max.x &&
+               point.y >= min.y && point.y <= max.y &&
+               point.z >= min.z && point.z <= max.z;
+    }
+
+    constexpr bool contains(const AABB<T> &box) const {
+        return box.min.x >= min.x && box.max.x <= max.x &&
+               box.min.y >= min.y && box.max.y <= max.y &&
+               box.min.z >= min.z && box.max.z <= max.z;
+    }
+
+    // Touching boxes overlap
+    constexpr bool overlaps(const AABB<T> &box) const {
+        return box.min.x <= max.x && box.max.x >= min.x &&
+               box.min.y <= max.y && box.max.y >= min.y &&
+               box.min.z <= max.z && box.max.z >= min.z;
+    }
+
+    template<typename C>
+    constexpr AABB<C> Cast() const {
+        return AABB<C>{Vector<C, 3>{C(min.x), C(min.y), C(min.z)}, Vector<C, 3>{C(max.x), C(max.y), C(max.z)}};
+    }
+
+    // OStream Overrider
+    friend std::ostream &operator<<(std::ostream &os, const AABB<T> &box) {
+        os << "[" << box.min.x << ", " << box.min.y << ", " << box.min.z << "] - ["
+           << box.max.x << ", " << box.max.y << ", " << box.max.z << "]";
+        return os;
+    }
+
+    Vec min;
+    Vec max;
+
+private:
+    /* Comparisons in this order become minss / maxss, std::max would be a branch per component */
+    constexpr void expand(const Vec &lower, const Vec &upper) {
+        min.x = lower.x < min.x ? lower.x : min.x;
+        min.y = lower.y < min.y ? lower.y : min.y;
+        min.z = lower.z < min.z ? lower.z : min.z;
+        max.x = upper.x > max.x ? upper.x : max.x;
+        max.y = upper.y > max.y ? upper.y : max.y;
+        max.z = upper.z > max.z ? upper.z : max.z;
+    }
+};
+
+using AABBf = AABB<float>;
+using AABBd = AABB<double>;
+
+namespace Sm {
+    // Smallest box holding both
+    template<typename T>
+    constexpr AABB<T> merge(const AABB<T> &lhs, const AABB<T> &rhs) {
+        auto result = lhs;
+        result.expand(rhs);
+        return result;
+    }
+
+    // Overlap of both, empty when they are disjoint
+    template<typename T>
+    constexpr AABB<T> intersection(const AABB<T> &lhs, const AABB<T> &rhs) {
+        return AABB<T>{Vector<T, 3>{std::max(lhs.min.x, rhs.min.x), std::max(lhs.min.y, rhs.min.y),
+                                    std::max(lhs.min.z, rhs.min.z)},
+                       Vector<T, 3>{std::min(lhs.max.x, rhs.max.x), std::min(lhs.max.y, rhs.max.y),
+                                    std::min(lhs.max.z, rhs.max.z)}};
+    }
+
+    // Bounds of count points, empty for none
+    template<typename T>
+    AABB<T> bounds(const Vector<T, 3> *points, std::size_t count) {
+        AABB<T> result;
+        for (std::size_t i = 0; i < count; ++i)
+            result.expand(points[i]);
+        return result;
+    }
+}
+
+#endif //SLIMEMATHS_AABB_H
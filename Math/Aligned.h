@@ -0,0 +1,135 @@
+#ifndef SLIMEMATHS_ALIGNED_H
+#define SLIMEMATHS_ALIGNED_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include "Vector2.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix.h"
+#include "Quaternion.h"
+
+// Opt-in over-aligned math types and an aligned allocator.
+// The plain types keep natural scalar alignment so they pack tightly. Aligned<Type, Alignment> is the
+// same type with a raised alignment, padded up to a multiple of it, so a std::vector of them never straddles
+// a cache line and SIMD code can use aligned loads. It converts to and from Type and works with every
+// Sm:: function and operator that takes Type.
+
+template<typename Base, std::size_t Alignment>
+struct alignas(Alignment) Aligned : Base {
+    static_assert(Alignment != 0 && (Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+    static_assert(Alignment >= alignof(Base), "Alignment can not be lower than the natural alignment");
+
+    using BaseType = Base;
+    static const std::size_t alignment = Alignment;
+
+    using Base::Base;
+
+    constexpr Aligned() = default;
+
+    constexpr Aligned(const Base &rhs) : Base(rhs) {}
+
+    constexpr Aligned &operator=(const Base &rhs) {
+        Base::operator=(rhs);
+        return *this;
+    }
+};
+
+namespace Sm {
+
+    // Standard allocator returning Alignment aligned memory, e.g. std::vector<Mat4, Sm::AlignedAllocator<Mat4, 64>>
+    template<typename T, std::size_t Alignment = (alignof(T) > 16 ? alignof(T) : 16)>
+    struct AlignedAllocator {
+        static_assert(Alignment != 0 && (Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+        static_assert(Alignment >= alignof(T), "Alignment can not be lower than the natural alignment");
+
+        using value_type = T;
+        static const std::size_t alignment = Alignment;
+
+        template<typename U>
+        struct rebind {
+            using other = AlignedAllocator<U, Alignment>;
+        };
+
+        constexpr AlignedAllocator() noexcept = default;
+
+        template<typename U>
+        constexpr AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+        T *allocate(std::size_t count) {
+            if (count > std::numeric_limits<std::size_t>::max() / sizeof(T))
+                throw std::bad_array_new_length();
+            return static_cast<T *>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+        }
+
+        void deallocate(T *data, std::size_t) noexcept {
+            ::operator delete(data, std::align_val_t(Alignment));
+        }
+
+        template<typename U>
+        constexpr bool operator==(const AlignedAllocator<U, Alignment> &) const noexcept {
+            return true;
+        }
+
+        template<typename U>
+        constexpr bool operator!=(const AlignedAllocator<U, Alignment> &) const noexcept {
+            return false;
+        }
+    };
+
+    namespace detail {
+        // True when Type is exactly Count tightly packed Scalars that can be memcpy'd as is
+        template<typename Type, typename Scalar, std::size_t Count>
+        constexpr bool is_packed_layout() {
+            return sizeof(Type) == sizeof(Scalar) * Count &&
+                   alignof(Type) == alignof(Scalar) &&
+                   std::is_standard_layout<Type>::value &&
+                   std::is_trivially_copyable<Type>::value;
+        }
+
+        // True when Type is the packed layout of Base, padded to its alignment
+        template<typename Type, typename Base>
+        constexpr bool is_aligned_layout() {
+            return alignof(Type) == Type::alignment &&
+                   sizeof(Type) == (sizeof(Base) + Type::alignment - 1) / Type::alignment * Type::alignment &&
+                   std::is_standard_layout<Type>::value &&
+                   std::is_trivially_copyable<Type>::value;
+        }
+    }
+}
+
+// --Default types--
+
+using AlignedVec3 = Aligned<Vec3, 16>;
+using AlignedVec4 = Aligned<Vec4, 16>;
+using AlignedVec4d = Aligned<Vector4d, 32>;
+
+using AlignedMat4 = Aligned<Mat4, 64>;
+using AlignedMat4d = Aligned<Mat4d, 64>;
+
+using AlignedQuat = Aligned<Quaternionf, 16>;
+using AlignedQuatd = Aligned<Quaternion<double>, 32>;
+
+// Layout guarantees relied on for GPU uploads and SIMD loads
+static_assert(Sm::detail::is_packed_layout<Vec2, float, 2>(), "Vec2 must be 2 packed floats");
+static_assert(Sm::detail::is_packed_layout<Vec3, float, 3>(), "Vec3 must be 3 packed floats");
+static_assert(Sm::detail::is_packed_layout<Vec4, float, 4>(), "Vec4 must be 4 packed floats");
+static_assert(Sm::detail::is_packed_layout<Vector4d, double, 4>(), "Vector4d must be 4 packed doubles");
+static_assert(Sm::detail::is_packed_layout<Mat3, float, 9>(), "Mat3 must be 9 packed floats");
+static_assert(Sm::detail::is_packed_layout<Mat4, float, 16>(), "Mat4 must be 16 packed floats");
+static_assert(Sm::detail::is_packed_layout<Mat4d, double, 16>(), "Mat4d must be 16 packed doubles");
+static_assert(Sm::detail::is_packed_layout<Quaternionf, float, 4>(), "Quaternionf must be 4 packed floats");
+static_assert(Sm::detail::is_packed_layout<Quaternion<double>, double, 4>(), "Quaternion<double> must be 4 packed doubles");
+
+static_assert(Sm::detail::is_aligned_layout<AlignedVec3, Vec3>() && sizeof(AlignedVec3) == 16, "AlignedVec3 layout");
+static_assert(Sm::detail::is_aligned_layout<AlignedVec4, Vec4>() && sizeof(AlignedVec4) == 16, "AlignedVec4 layout");
+static_assert(Sm::detail::is_aligned_layout<AlignedVec4d, Vector4d>() && sizeof(AlignedVec4d) == 32, "AlignedVec4d layout");
+static_assert(Sm::detail::is_aligned_layout<AlignedMat4, Mat4>() && sizeof(AlignedMat4) == 64, "AlignedMat4 layout");
+static_assert(Sm::detail::is_aligned_layout<AlignedMat4d, Mat4d>() && sizeof(AlignedMat4d) == 128, "AlignedMat4d layout");
+static_assert(Sm::detail::is_aligned_layout<AlignedQuat, Quaternionf>() && sizeof(AlignedQuat) == 16, "AlignedQuat layout");
+static_assert(Sm::detail::is_aligned_layout<AlignedQuatd, Quaternion<double>>() && sizeof(AlignedQuatd) == 32, "AlignedQuatd layout");
+
+#endif //SLIMEMATHS_ALIGNED_H
@@ -0,0 +1,789 @@
+#ifndef SLIMEMATHS_ARRAYFILE_H
+#define SLIMEMATHS_ARRAYFILE_H
+
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Vector.h"
+#include "Matrix.h"
+#include "Quaternion.h"
+#include "DualQuaternion.h"
+#include "Half.h"
+#include "VectorArray.h"
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Versioned binary container for arrays of scalars, vectors, matrices and quaternions.
+// ArrayFileWriter streams arrays out in chunks of any size and only keeps one directory entry per array in memory,
+// ArrayFileReader maps the file read only and hands out spans straight into the mapping, ready for the batch kernels.
+//
+// Layout, in the byte order of the writer (readers reject the other one), offsets from the start of the file:
+//   header     64 bytes: "SMARRAYS", format version, byte order mark, array count, directory offset
+//   arrays     each starts on a 64 byte boundary. AoS arrays are the elements back to back as they are in memory,
+//              SoA arrays of Vector<T, N> are N streams of count scalars, each on a 64 byte boundary.
+//   directory  one 96 byte entry per array: name, element type, layout, count, offset and stride between streams
+// The directory offset stays 0 until finish(), so a file whose writer died is rejected instead of read half way.
+// Not part of SlimeMath.h since it pulls in the OS file mapping headers, include it where files are read or written.
+//
+//     ArrayFileWriter writer{"cloud.smaf"};
+//     writer.begin<Vec3>("positions");
+//     for (const auto &chunk: chunks)
+//         writer.append(chunk.data(), chunk.size());
+//     writer.end();
+//     writer.finish();
+//
+//     ArrayFileReader reader{"cloud.smaf"};
+//     ArraySpan<Vec3> positions = reader.array<Vec3>("positions");
+//     Sm::transform_points(model, positions.data(), out, positions.size());
+
+namespace Sm {
+
+    enum class ScalarKind : std::uint8_t {
+        Float16 = 1,
+        Float32,
+        Float64,
+        Int8,
+        UInt8,
+        Int16,
+        UInt16,
+        Int32,
+        UInt32,
+        Int64,
+        UInt64
+    };
+
+    enum class ElementShape : std::uint8_t {
+        Scalar = 1,
+        Vector,         // rows components
+        Matrix,         // rows x cols, row major
+        Quaternion,     // x, y, z, w
+        DualQuaternion  // real then dual quaternion
+    };
+
+    enum class ArrayLayout : std::uint8_t {
+        AoS = 1,
+        SoA
+    };
+
+    struct ElementType {
+        ScalarKind scalar;
+        ElementShape shape;
+        std::uint8_t rows;
+        std::uint8_t cols;
+
+        friend bool operator==(const ElementType &lhs, const ElementType &rhs) {
+            return lhs.scalar == rhs.scalar && lhs.shape == rhs.shape && lhs.rows == rhs.rows && lhs.cols == rhs.cols;
+        }
+
+        friend bool operator!=(const ElementType &lhs, const ElementType &rhs) {
+            return !(lhs == rhs);
+        }
+
+        std::size_t scalar_size() const {
+            switch (scalar) {
+                case ScalarKind::Int8:
+                case ScalarKind::UInt8:
+                    return 1;
+                case ScalarKind::Float16:
+                case ScalarKind::Int16:
+                case ScalarKind::UInt16:
+                    return 2;
+                case ScalarKind::Float32:
+                case ScalarKind::Int32:
+                case ScalarKind::UInt32:
+                    return 4;
+                case ScalarKind::Float64:
+                case ScalarKind::Int64:
+                case ScalarKind::UInt64:
+                    return 8;
+            }
+            return 0;
+        }
+
+        std::size_t size() const {
+            return scalar_size() * rows * cols;
+        }
+    };
+
+    // One array as the directory describes it
+    struct ArrayInfo {
+        std::string name;
+        ElementType type;
+        ArrayLayout layout;
+        std::uint64_t count;
+        std::uint64_t offset;           // first element, or first component stream for SoA
+        std::uint64_t componentStride;  // bytes between SoA component streams, 0 for AoS
+    };
+
+    namespace detail {
+
+        template<typename T>
+        struct ScalarKindOf;
+
+        template<>
+        struct ScalarKindOf<half> { static constexpr ScalarKind value = ScalarKind::Float16; };
+
+        template<>
+        struct ScalarKindOf<float> { static constexpr ScalarKind value = ScalarKind::Float32; };
+
+        template<>
+        struct ScalarKindOf<double> { static constexpr ScalarKind value = ScalarKind::Float64; };
+
+        template<>
+        struct ScalarKindOf<std::int8_t> { static constexpr ScalarKind value = ScalarKind::Int8; };
+
+        template<>
+        struct ScalarKindOf<std::uint8_t> { static constexpr ScalarKind value = ScalarKind::UInt8; };
+
+        template<>
+        struct ScalarKindOf<std::int16_t> { static constexpr ScalarKind value = ScalarKind::Int16; };
+
+        template<>
+        struct ScalarKindOf<std::uint16_t> { static constexpr ScalarKind value = ScalarKind::UInt16; };
+
+        template<>
+        struct ScalarKindOf<std::int32_t> { static constexpr ScalarKind value = ScalarKind::Int32; };
+
+        template<>
+        struct ScalarKindOf<std::uint32_t> { static constexpr ScalarKind value = ScalarKind::UInt32; };
+
+        template<>
+        struct ScalarKindOf<std::int64_t> { static constexpr ScalarKind value = ScalarKind::Int64; };
+
+        template<>
+        struct ScalarKindOf<std::uint64_t> { static constexpr ScalarKind value = ScalarKind::UInt64; };
+
+        template<typename E>
+        struct ElementTypeOf {
+            static ElementType get() { return ElementType{ScalarKindOf<E>::value, ElementShape::Scalar, 1, 1}; }
+        };
+
+        template<typename T, std::size_t N>
+        struct ElementTypeOf<Vector<T, N>> {
+            static ElementType get() {
+                return ElementType{ScalarKindOf<T>::value, ElementShape::Vector, std::uint8_t(N), 1};
+            }
+        };
+
+        template<typename T, std::size_t Rows, std::size_t Cols>
+        struct ElementTypeOf<Matrix<T, Rows, Cols>> {
+            static ElementType get() {
+                return ElementType{ScalarKindOf<T>::value, ElementShape::Matrix, std::uint8_t(Rows),
+                                   std::uint8_t(Cols)};
+            }
+        };
+
+        template<typename T>
+        struct ElementTypeOf<Quaternion<T>> {
+            static ElementType get() { return ElementType{ScalarKindOf<T>::value, ElementShape::Quaternion, 4, 1}; }
+        };
+
+        template<typename T>
+        struct ElementTypeOf<DualQuaternion<T>> {
+            static ElementType get() { return ElementType{ScalarKindOf<T>::value, ElementShape::DualQuaternion, 8, 1}; }
+        };
+
+        template<typename E>
+        ElementType element_type() {
+            static_assert(std::is_trivially_copyable<E>::value, "array elements are stored as raw bytes");
+            const ElementType type = ElementTypeOf<E>::get();
+            assert(type.size() == sizeof(E));
+            return type;
+        }
+
+        constexpr char arrayFileMagic[8] = {'S', 'M', 'A', 'R', 'R', 'A', 'Y', 'S'};
+        constexpr std::uint32_t arrayFileVersion = 1;
+        constexpr std::uint32_t arrayFileByteOrder = 0x01020304u;
+        constexpr std::uint64_t arrayFileAlignment = 64;
+
+        struct ArrayFileHeader {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t byteOrder;
+            std::uint64_t arrayCount;
+            std::uint64_t directoryOffset;
+            std::uint8_t reserved[32];
+        };
+
+        struct ArrayFileEntry {
+            char name[56];
+            std::uint64_t offset;
+            std::uint64_t count;
+            std::uint64_t componentStride;
+            std::uint8_t scalar;
+            std::uint8_t shape;
+            std::uint8_t rows;
+            std::uint8_t cols;
+            std::uint8_t layout;
+            std::uint8_t reserved[11];
+        };
+
+        static_assert(sizeof(ArrayFileHeader) == 64, "the file header is 64 bytes");
+        static_assert(sizeof(ArrayFileEntry) == 96, "directory entries are 96 bytes");
+
+        inline std::uint64_t align_up(std::uint64_t value, std::uint64_t alignment) {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+    }
+}
+
+// Elements of an AoS array, pointing into the reader's mapping
+template<typename E>
+struct ArraySpan {
+    ArraySpan() = default;
+
+    ArraySpan(const E *data, std::size_t size) : _data{data}, _size{size} {}
+
+    const E *data() const { return _data; }
+
+    std::size_t size() const { return _size; }
+
+    bool empty() const { return _size == 0; }
+
+    const E *begin() const { return _data; }
+
+    const E *end() const { return _data + _size; }
+
+    const E &operator[](std::size_t i) const { return _data[i]; }
+
+private:
+    const E *_data = nullptr;
+    std::size_t _size = 0;
+};
+
+// Component streams of an SoA array, each one 64 byte aligned like a VectorArray component
+template<typename T, std::size_t N>
+struct SoASpan {
+    using VectorType = Vector<T, N>;
+
+    SoASpan() = default;
+
+    SoASpan(const T *first, std::size_t stride, std::size_t size) : _first{first}, _stride{stride}, _size{size} {}
+
+    const T *component(std::size_t c) const { return _first + c * _stride; }
+
+    std::size_t size() const { return _size; }
+
+    bool empty() const { return _size == 0; }
+
+    VectorType get(std::size_t index) const {
+        VectorType result;
+        for (std::size_t c = 0; c < N; ++c)
+            result[c] = component(c)[index];
+        return result;
+    }
+
+    // Copies into a VectorArray for the Sm:: SoA overloads
+    void store(VectorArray<T, N> &out) const {
+        out.resize(_size);
+        for (std::size_t c = 0; c < N; ++c)
+            std::memcpy(out.component(c), component(c), _size * sizeof(T));
+    }
+
+private:
+    const T *_first = nullptr;
+    std::size_t _stride = 0;    // in scalars
+    std::size_t _size = 0;
+};
+
+// Writes one array at a time: begin, any number of appends, end. finish() writes the directory, a file that was
+// never finished stays unreadable.
+// Errors throw std::runtime_error (I/O) or std::invalid_argument / std::logic_error (misuse).
+struct ArrayFileWriter {
+    explicit ArrayFileWriter(const std::string &path)
+            : _file{path, std::ios::binary | std::ios::out | std::ios::trunc} {
+        if (!_file)
+            throw std::runtime_error("ArrayFileWriter: cannot create " + path);
+
+        /* Placeholder header, finish() rewrites it with the directory */
+        Sm::detail::ArrayFileHeader header{};
+        std::memcpy(header.magic, Sm::detail::arrayFileMagic, sizeof(header.magic));
+        header.version = Sm::detail::arrayFileVersion;
+        header.byteOrder = Sm::detail::arrayFileByteOrder;
+        write_at(0, &header, sizeof(header));
+    }
+
+    ArrayFileWriter(const ArrayFileWriter &rhs) = delete;
+
+    ArrayFileWriter &operator=(const ArrayFileWriter &rhs) = delete;
+
+    // Closes the file without writing the directory if finish() was not called. The writer may be going away because
+    // an append threw, so the file stays unfinished and readers reject it instead of trusting truncated arrays.
+    ~ArrayFileWriter() = default;
+
+    // Starts an AoS array of E, the element count grows with every append
+    template<typename E>
+    void begin(const std::string &name) {
+        start(name, Sm::detail::element_type<E>(), Sm::ArrayLayout::AoS, 0);
+    }
+
+    // Starts an SoA array of count Vector<T, N>, exactly count elements must be appended before end()
+    template<typename T, std::size_t N>
+    void begin_soa(const std::string &name, std::size_t count) {
+        start(name, Sm::detail::element_type<Vector<T, N>>(), Sm::ArrayLayout::SoA, count);
+        _current.componentStride = Sm::detail::align_up(count * sizeof(T), Sm::detail::arrayFileAlignment);
+    }
+
+    // Appends count elements to the open array
+    template<typename E>
+    void append(const E *data, std::size_t count) {
+        check_append(Sm::detail::element_type<E>(), count);
+
+        if (_current.layout == Sm::ArrayLayout::AoS) {
+            write_at(_current.offset + _appended * sizeof(E), data, count * sizeof(E));
+        } else {
+            append_components(data, count);
+        }
+        _appended += count;
+    }
+
+    template<typename T, std::size_t N>
+    void append(const VectorArray<T, N> &chunk) {
+        check_append(Sm::detail::element_type<Vector<T, N>>(), chunk.size());
+        if (_current.layout != Sm::ArrayLayout::SoA)
+            throw std::logic_error("ArrayFileWriter: VectorArray chunks go to SoA arrays");
+
+        for (std::size_t c = 0; c < N; ++c)
+            write_at(_current.offset + c * _current.componentStride + _appended * sizeof(T), chunk.component(c),
+                     chunk.size() * sizeof(T));
+        _appended += chunk.size();
+    }
+
+    void end() {
+        if (!_open)
+            throw std::logic_error("ArrayFileWriter: no array to end");
+
+        const std::uint64_t scalarSize = _current.type.scalar_size();
+        if (_current.layout == Sm::ArrayLayout::SoA) {
+            if (_appended != _current.count)
+                throw std::logic_error("ArrayFileWriter: SoA array " + _current.name +
+                                       " got fewer elements than declared");
+
+            /* Zero the padding between component streams so the file does not depend on how holes read back */
+            const std::uint64_t components = _current.type.rows;
+            for (std::uint64_t c = 0; c + 1 < components; ++c)
+                pad(_current.offset + c * _current.componentStride + _current.count * scalarSize,
+                    _current.offset + (c + 1) * _current.componentStride);
+            _end = _current.offset + (components - 1) * _current.componentStride + _current.count * scalarSize;
+        } else {
+            _current.count = _appended;
+            _end = _current.offset + _appended * _current.type.size();
+        }
+
+        _arrays.push_back(_current);
+        _open = false;
+    }
+
+    // Writes a whole AoS array
+    template<typename E>
+    void write(const std::string &name, const E *data, std::size_t count) {
+        begin<E>(name);
+        append(data, count);
+        end();
+    }
+
+    // Writes a whole SoA array
+    template<typename T, std::size_t N>
+    void write_soa(const std::string &name, const Vector<T, N> *data, std::size_t count) {
+        begin_soa<T, N>(name, count);
+        append(data, count);
+        end();
+    }
+
+    template<typename T, std::size_t N>
+    void write_soa(const std::string &name, const VectorArray<T, N> &data) {
+        begin_soa<T, N>(name, data.size());
+        append(data);
+        end();
+    }
+
+    // Writes the directory and header and closes the file, nothing can be written afterwards
+    void finish() {
+        if (!_file.is_open())
+            throw std::logic_error("ArrayFileWriter: already finished");
+        if (_open)
+            end();
+
+        const std::uint64_t directory = Sm::detail::align_up(_end, Sm::detail::arrayFileAlignment);
+        pad(_end, directory);
+
+        std::vector<Sm::detail::ArrayFileEntry> entries(_arrays.size());
+        for (std::size_t i = 0; i < _arrays.size(); ++i) {
+            const Sm::ArrayInfo &info = _arrays[i];
+            Sm::detail::ArrayFileEntry &entry = entries[i];
+            entry = Sm::detail::ArrayFileEntry{};
+            std::memcpy(entry.name, info.name.c_str(), info.name.size());
+            entry.offset = info.offset;
+            entry.count = info.count;
+            entry.componentStride = info.componentStride;
+            entry.scalar = static_cast<std::uint8_t>(info.type.scalar);
+            entry.shape = static_cast<std::uint8_t>(info.type.shape);
+            entry.rows = info.type.rows;
+            entry.cols = info.type.cols;
+            entry.layout = static_cast<std::uint8_t>(info.layout);
+        }
+        if (!entries.empty())
+            write_at(directory, entries.data(), entries.size() * sizeof(Sm::detail::ArrayFileEntry));
+
+        Sm::detail::ArrayFileHeader header{};
+        std::memcpy(header.magic, Sm::detail::arrayFileMagic, sizeof(header.magic));
+        header.version = Sm::detail::arrayFileVersion;
+        header.byteOrder = Sm::detail::arrayFileByteOrder;
+        header.arrayCount = _arrays.size();
+        header.directoryOffset = directory;
+        write_at(0, &header, sizeof(header));
+
+        _file.close();
+        if (!_file)
+            throw std::runtime_error("ArrayFileWriter: closing the file failed");
+    }
+
+private:
+    void start(const std::string &name, const Sm::ElementType &type, Sm::ArrayLayout layout, std::size_t count) {
+        if (!_file.is_open())
+            throw std::logic_error("ArrayFileWriter: already finished");
+        if (_open)
+            throw std::logic_error("ArrayFileWriter: end() the open array first");
+        if (name.empty() || name.size() >= sizeof(Sm::detail::ArrayFileEntry::name))
+            throw std::invalid_argument("ArrayFileWriter: array names are 1 to 55 characters");
+        for (const auto &array: _arrays)
+            if (array.name == name)
+                throw std::invalid_argument("ArrayFileWriter: duplicate array " + name);
+
+        const std::uint64_t offset = Sm::detail::align_up(_end, Sm::detail::arrayFileAlignment);
+        pad(_end, offset);
+        _current = Sm::ArrayInfo{name, type, layout, count, offset, 0};
+        _appended = 0;
+        _open = true;
+    }
+
+    void check_append(const Sm::ElementType &type, std::size_t count) {
+        if (!_open)
+            throw std::logic_error("ArrayFileWriter: begin() an array first");
+        if (type != _current.type)
+            throw std::invalid_argument("ArrayFileWriter: element type differs from array " + _current.name);
+        if (_current.layout == Sm::ArrayLayout::SoA && count > _current.count - _appended)
+            throw std::logic_error("ArrayFileWriter: more elements than declared for SoA array " + _current.name);
+    }
+
+    template<typename T, std::size_t N>
+    void append_components(const Vector<T, N> *data, std::size_t count) {
+        /* Gather one component of a block at a time, the scratch buffer bounds memory for any chunk size */
+        const std::size_t block = 4096;
+        _scratch.resize(block * sizeof(T));
+        T *scratch = reinterpret_cast<T *>(_scratch.data());
+        for (std::size_t first = 0; first < count; first += block) {
+            const std::size_t n = count - first < block ? count - first : block;
+            for (std::size_t c = 0; c < N; ++c) {
+                for (std::size_t i = 0; i < n; ++i)
+                    scratch[i] = data[first + i][c];
+                write_at(_current.offset + c * _current.componentStride + (_appended + first) * sizeof(T), scratch,
+                         n * sizeof(T));
+            }
+        }
+    }
+
+    /* Only vectors make SoA arrays, check_append already rejected anything else */
+    template<typename E>
+    void append_components(const E *, std::size_t) {
+        throw std::logic_error("ArrayFileWriter: SoA arrays hold vectors");
+    }
+
+    void pad(std::uint64_t from, std::uint64_t to) {
+        static const char zeros[Sm::detail::arrayFileAlignment] = {};
+        while (from < to) {
+            const std::uint64_t n = to - from < sizeof(zeros) ? to - from : sizeof(zeros);
+            write_at(from, zeros, n);
+            from += n;
+        }
+    }
+
+    void write_at(std::uint64_t offset, const void *data, std::uint64_t bytes) {
+        if (_position != offset)
+            _file.seekp(static_cast<std::streamoff>(offset));
+        _file.write(static_cast<const char *>(data), static_cast<std::streamsize>(bytes));
+        if (!_file)
+            throw std::runtime_error("ArrayFileWriter: write failed");
+        _position = offset + bytes;
+    }
+
+    std::ofstream _file;
+    std::uint64_t _position = 0;    // where the stream currently is
+    std::uint64_t _end = sizeof(Sm::detail::ArrayFileHeader);  // end of the last finished array
+    std::vector<Sm::ArrayInfo> _arrays;
+    Sm::ArrayInfo _current{};
+    std::uint64_t _appended = 0;
+    bool _open = false;
+    std::vector<unsigned char> _scratch;
+};
+
+// Maps a finished file read only, spans stay valid as long as the reader lives.
+// OS errors throw std::system_error, malformed files std::runtime_error and wrong element types std::invalid_argument.
+struct ArrayFileReader {
+    explicit ArrayFileReader(const std::string &path) {
+        map(path);
+        try {
+            parse();
+        } catch (...) {
+            unmap();
+            throw;
+        }
+    }
+
+    ArrayFileReader(const ArrayFileReader &rhs) = delete;
+
+    ArrayFileReader &operator=(const ArrayFileReader &rhs) = delete;
+
+    ArrayFileReader(ArrayFileReader &&rhs) noexcept {
+        swap(rhs);
+    }
+
+    ArrayFileReader &operator=(ArrayFileReader &&rhs) noexcept {
+        if (this != &rhs) {
+            unmap();
+            _arrays.clear();
+            swap(rhs);
+        }
+        return *this;
+    }
+
+    ~ArrayFileReader() {
+        unmap();
+    }
+
+    void swap(ArrayFileReader &rhs) noexcept {
+        std::swap(_data, rhs._data);
+        std::swap(_bytes, rhs._bytes);
+        std::swap(_arrays, rhs._arrays);
+#if defined(_WIN32)
+        std::swap(_mapping, rhs._mapping);
+#endif
+    }
+
+    std::size_t size() const {
+        return _arrays.size();
+    }
+
+    const Sm::ArrayInfo &info(std::size_t index) const {
+        return _arrays[index];
+    }
+
+    // nullptr when there is no array with that name
+    const Sm::ArrayInfo *find(const std::string &name) const {
+        for (const auto &array: _arrays)
+            if (array.name == name)
+                return &array;
+        return nullptr;
+    }
+
+    template<typename E>
+    ArraySpan<E> array(const std::string &name) const {
+        const Sm::ArrayInfo &info = lookup(name, Sm::detail::element_type<E>(), Sm::ArrayLayout::AoS);
+        return ArraySpan<E>{reinterpret_cast<const E *>(_data + info.offset), static_cast<std::size_t>(info.count)};
+    }
+
+    template<typename T, std::size_t N>
+    SoASpan<T, N> soa(const std::string &name) const {
+        const Sm::ArrayInfo &info = lookup(name, Sm::detail::element_type<Vector<T, N>>(), Sm::ArrayLayout::SoA);
+        return SoASpan<T, N>{reinterpret_cast<const T *>(_data + info.offset),
+                             static_cast<std::size_t>(info.componentStride / sizeof(T)),
+                             static_cast<std::size_t>(info.count)};
+    }
+
+    // The whole mapping
+    const unsigned char *data() const {
+        return _data;
+    }
+
+    std::size_t bytes() const {
+        return _bytes;
+    }
+
+private:
+    const Sm::ArrayInfo &lookup(const std::string &name, const Sm::ElementType &type, Sm::ArrayLayout layout) const {
+        const Sm::ArrayInfo *info = find(name);
+        if (!info)
+            throw std::invalid_argument("ArrayFileReader: no array " + name);
+        if (info->type != type || info->layout != layout)
+            throw std::invalid_argument("ArrayFileReader: array " + name + " has a different element type or layout");
+        return *info;
+    }
+
+    void parse() {
+        using Sm::detail::ArrayFileEntry;
+        using Sm::detail::ArrayFileHeader;
+
+        Sm::detail::ArrayFileHeader header;
+        if (_bytes < sizeof(header))
+            throw std::runtime_error("ArrayFileReader: file too small");
+        std::memcpy(&header, _data, sizeof(header));
+
+        if (std::memcmp(header.magic, Sm::detail::arrayFileMagic, sizeof(header.magic)) != 0)
+            throw std::runtime_error("ArrayFileReader: not an array file");
+        if (header.byteOrder != Sm::detail::arrayFileByteOrder)
+            throw std::runtime_error("ArrayFileReader: written with the other byte order");
+        if (header.version == 0 || header.version > Sm::detail::arrayFileVersion)
+            throw std::runtime_error("ArrayFileReader: unsupported format version " + std::to_string(header.version));
+        if (header.directoryOffset == 0)
+            throw std::runtime_error("ArrayFileReader: the writer never finished this file");
+        if (header.directoryOffset > _bytes ||
+            header.arrayCount > (_bytes - header.directoryOffset) / sizeof(ArrayFileEntry))
+            throw std::runtime_error("ArrayFileReader: directory outside the file");
+
+        _arrays.resize(static_cast<std::size_t>(header.arrayCount));
+        for (std::size_t i = 0; i < _arrays.size(); ++i) {
+            ArrayFileEntry entry;
+            std::memcpy(&entry, _data + header.directoryOffset + i * sizeof(entry), sizeof(entry));
+
+            Sm::ArrayInfo &info = _arrays[i];
+            info.name.assign(entry.name, name_length(entry.name, sizeof(entry.name)));
+            info.type = Sm::ElementType{static_cast<Sm::ScalarKind>(entry.scalar),
+                                        static_cast<Sm::ElementShape>(entry.shape), entry.rows, entry.cols};
+            info.layout = static_cast<Sm::ArrayLayout>(entry.layout);
+            info.count = entry.count;
+            info.offset = entry.offset;
+            info.componentStride = entry.componentStride;
+            validate(info);
+        }
+    }
+
+    void validate(const Sm::ArrayInfo &info) const {
+        const std::uint64_t scalarSize = info.type.scalar_size();
+        const std::uint64_t components = std::uint64_t(info.type.rows) * info.type.cols;
+        if (scalarSize == 0 || components == 0 || info.offset % Sm::detail::arrayFileAlignment != 0)
+            throw std::runtime_error("ArrayFileReader: bad directory entry for " + info.name);
+
+        /* Overflow safe: every product is checked against the file size before it is formed */
+        std::uint64_t extent;
+        if (info.layout == Sm::ArrayLayout::AoS) {
+            if (info.count > _bytes / (scalarSize * components))
+                throw std::runtime_error("ArrayFileReader: array " + info.name + " runs past the end of the file");
+            extent = info.count * scalarSize * components;
+        } else if (info.layout == Sm::ArrayLayout::SoA && info.type.shape == Sm::ElementShape::Vector &&
+                   info.componentStride % Sm::detail::arrayFileAlignment == 0) {
+            if (info.count > _bytes / scalarSize || info.componentStride < info.count * scalarSize ||
+                info.componentStride > _bytes / components)
+                throw std::runtime_error("ArrayFileReader: array " + info.name + " runs past the end of the file");
+            extent = (components - 1) * info.componentStride + info.count * scalarSize;
+        } else {
+            throw std::runtime_error("ArrayFileReader: bad directory entry for " + info.name);
+        }
+
+        if (info.offset > _bytes || extent > _bytes - info.offset)
+            throw std::runtime_error("ArrayFileReader: array " + info.name + " runs past the end of the file");
+    }
+
+    static std::size_t name_length(const char *text, std::size_t size) {
+        std::size_t length = 0;
+        while (length < size && text[length] != '\0')
+            ++length;
+        return length;
+    }
+
+#if defined(_WIN32)
+    void map(const std::string &path) {
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw std::system_error(int(GetLastError()), std::system_category(), "ArrayFileReader: open " + path);
+
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(file, &size)) {
+            const DWORD error = GetLastError();
+            CloseHandle(file);
+            throw std::system_error(int(error), std::system_category(), "ArrayFileReader: size of " + path);
+        }
+        if (size.QuadPart == 0) {
+            CloseHandle(file);
+            throw std::runtime_error("ArrayFileReader: file too small");
+        }
+
+        _mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!_mapping)
+            throw std::system_error(int(GetLastError()), std::system_category(), "ArrayFileReader: map " + path);
+
+        _data = static_cast<const unsigned char *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!_data) {
+            const DWORD error = GetLastError();
+            CloseHandle(_mapping);
+            _mapping = nullptr;
+            throw std::system_error(int(error), std::system_category(), "ArrayFileReader: map " + path);
+        }
+        _bytes = static_cast<std::size_t>(size.QuadPart);
+    }
+
+    void unmap() {
+        if (_data)
+            UnmapViewOfFile(_data);
+        if (_mapping)
+            CloseHandle(_mapping);
+        _data = nullptr;
+        _mapping = nullptr;
+        _bytes = 0;
+    }
+
+    HANDLE _mapping = nullptr;
+#else
+    void map(const std::string &path) {
+        const int file = ::open(path.c_str(), O_RDONLY);
+        if (file < 0)
+            throw std::system_error(errno, std::generic_category(), "ArrayFileReader: open " + path);
+
+        struct stat status{};
+        if (::fstat(file, &status) != 0) {
+            const int error = errno;
+            ::close(file);
+            throw std::system_error(error, std::generic_category(), "ArrayFileReader: stat " + path);
+        }
+        if (status.st_size <= 0) {
+            ::close(file);
+            throw std::runtime_error("ArrayFileReader: file too small");
+        }
+
+        void *data = ::mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_SHARED, file, 0);
+        const int error = errno;
+        ::close(file);
+        if (data == MAP_FAILED)
+            throw std::system_error(error, std::generic_category(), "ArrayFileReader: map " + path);
+
+        _data = static_cast<const unsigned char *>(data);
+        _bytes = static_cast<std::size_t>(status.st_size);
+    }
+
+    void unmap() {
+        if (_data)
+            ::munmap(const_cast<unsigned char *>(_data), _bytes);
+        _data = nullptr;
+        _bytes = 0;
+    }
+#endif
+
+    const unsigned char *_data = nullptr;
+    std::size_t _bytes = 0;
+    std::vector<Sm::ArrayInfo> _arrays;
+};
+
+#endif //SLIMEMATHS_ARRAYFILE_H
@@ -0,0 +1,562 @@
+#ifndef SLIMEMATHS_BATCHTRANSFORM_H
+#define SLIMEMATHS_BATCHTRANSFORM_H
+
+#include <cstddef>
+#include "Matrix.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "MatrixKernels.h"
+#include "Dispatch.h"
+#include "Executor.h"
+#include "Instrument.h"
+
+// Batch transforms of vector spans by a single matrix.
+// The matrix columns are loaded once per call, each vector then costs a handful of
+// broadcast/multiply/add steps and writes straight into the output span.
+// Results match Sm::operator*(matrix, vector) with the implied w. in and out may be the same span.
+// The float and double kernels are picked at run time for the active instruction set (Dispatch.h).
+// The overloads taking an Executor split the span across its threads at cache line boundaries of out.
+
+namespace Sm {
+
+    enum class TransformMode {
+        Direction,      // w = 0
+        Point,          // w = 1
+        ProjectedPoint  // w = 1, then divided by the resulting w
+    };
+
+    namespace detail {
+
+        template<typename T>
+        struct BatchTransformScalar {
+            template<TransformMode Mode>
+            static void mat4_vec3(const T *m, const Vector<T, 3> *in, Vector<T, 3> *out, std::size_t count) {
+                const T m00 = m[0], m01 = m[1], m02 = m[2], m03 = m[3];
+                const T m10 = m[4], m11 = m[5], m12 = m[6], m13 = m[7];
+                const T m20 = m[8], m21 = m[9], m22 = m[10], m23 = m[11];
+                const T m30 = m[12], m31 = m[13], m32 = m[14], m33 = m[15];
+
+                for (std::size_t i = 0; i < count; ++i) {
+                    const T x = in[i].x, y = in[i].y, z = in[i].z;
+                    T rx = m00 * x + m01 * y + m02 * z;
+                    T ry = m10 * x + m11 * y + m12 * z;
+                    T rz = m20 * x + m21 * y + m22 * z;
+
+                    if (Mode != TransformMode::Direction) {
+                        rx += m03;
+                        ry += m13;
+                        rz += m23;
+                    }
+
+                    if (Mode == TransformMode::ProjectedPoint) {
+                        const T rw = m30 * x + m31 * y + m32 * z + m33;
+                        rx /= rw;
+                        ry /= rw;
+                        rz /= rw;
+                    }
+
+                    out[i].x = rx;
+                    out[i].y = ry;
+                    out[i].z = rz;
+                }
+            }
+
+            static void mat4_vec4(const T *m, const Vector<T, 4> *in, Vector<T, 4> *out, std::size_t count) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    const T x = in[i].x, y = in[i].y, z = in[i].z, w = in[i].w;
+                    out[i].x = m[0] * x + m[1] * y + m[2] * z + m[3] * w;
+                    out[i].y = m[4] * x + m[5] * y + m[6] * z + m[7] * w;
+                    out[i].z = m[8] * x + m[9] * y + m[10] * z + m[11] * w;
+                    out[i].w = m[12] * x + m[13] * y + m[14] * z + m[15] * w;
+                }
+            }
+
+            static void mat3_vec3(const T *m, const Vector<T, 3> *in, Vector<T, 3> *out, std::size_t count) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    const T x = in[i].x, y = in[i].y, z = in[i].z;
+                    out[i].x = m[0] * x + m[1] * y + m[2] * z;
+                    out[i].y = m[3] * x + m[4] * y + m[5] * z;
+                    out[i].z = m[6] * x + m[7] * y + m[8] * z;
+                }
+            }
+        };
+
+        template<typename T>
+        struct BatchTransformKernel : BatchTransformScalar<T> {
+        };
+
+#if defined(SLIMEMATHS_SSE2)
+
+        template<>
+        struct BatchTransformKernel<float> {
+            template<TransformMode Mode>
+            static void mat4_vec3(const float *m, const Vector<float, 3> *in, Vector<float, 3> *out,
+                                  std::size_t count) {
+                const __m128 c0 = _mm_setr_ps(m[0], m[4], m[8], m[12]);
+                const __m128 c1 = _mm_setr_ps(m[1], m[5], m[9], m[13]);
+                const __m128 c2 = _mm_setr_ps(m[2], m[6], m[10], m[14]);
+                const __m128 c3 = _mm_setr_ps(m[3], m[7], m[11], m[15]);
+
+                for (std::size_t i = 0; i < count; ++i) {
+                    const float *p = in[i].ptr();
+                    __m128 r = _mm_mul_ps(c0, _mm_set1_ps(p[0]));
+                    r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(p[1])));
+                    r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(p[2])));
+
+                    if (Mode != TransformMode::Direction)
+                        r = _mm_add_ps(r, c3);
+
+                    if (Mode == TransformMode::ProjectedPoint)
+                        r = _mm_div_ps(r, _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 3, 3)));
+
+                    store_float3(out[i].ptr(), r);
+                }
+            }
+
+            static void mat4_vec4(const float *m, const Vector<float, 4> *in, Vector<float, 4> *out,
+                                  std::size_t count) {
+                const __m128 c0 = _mm_setr_ps(m[0], m[4], m[8], m[12]);
+                const __m128 c1 = _mm_setr_ps(m[1], m[5], m[9], m[13]);
+                const __m128 c2 = _mm_setr_ps(m[2], m[6], m[10], m[14]);
+                const __m128 c3 = _mm_setr_ps(m[3], m[7], m[11], m[15]);
+
+                for (std::size_t i = 0; i < count; ++i) {
+                    const __m128 p = _mm_loadu_ps(in[i].ptr());
+                    __m128 r = _mm_mul_ps(c0, _mm_shuffle_ps(p, p, _MM_SHUFFLE(0, 0, 0, 0)));
+                    r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1))));
+                    r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2))));
+                    r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 3, 3))));
+                    _mm_storeu_ps(out[i].ptr(), r);
+                }
+            }
+
+            static void mat3_vec3(const float *m, const Vector<float, 3> *in, Vector<float, 3> *out,
+                                  std::size_t count) {
+                const __m128 c0 = _mm_setr_ps(m[0], m[3], m[6], 0.0f);
+                const __m128 c1 = _mm_setr_ps(m[1], m[4], m[7], 0.0f);
+                const __m128 c2 = _mm_setr_ps(m[2], m[5], m[8], 0.0f);
+
+                for (std::size_t i = 0; i < count; ++i) {
+                    const float *p = in[i].ptr();
+                    __m128 r = _mm_mul_ps(c0, _mm_set1_ps(p[0]));
+                    r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(p[1])));
+                    r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(p[2])));
+                    store_float3(out[i].ptr(), r);
+                }
+            }
+        };
+
+#endif
+
+#if defined(SLIMEMATHS_DISPATCH)
+
+        // Run time dispatched kernels, compiled for their instruction set whatever the build flags are.
+        // They fuse the multiply-adds, so results can differ from the SSE2 and scalar kernels in the last bit.
+        template<typename T>
+        struct BatchTransformAvx2;
+
+        // Two vectors per register, one in each 128 bit half
+        template<>
+        struct BatchTransformAvx2<float> {
+            template<TransformMode Mode>
+            SLIMEMATHS_TARGET_AVX2 static void mat4_vec3(const float *m, const Vector<float, 3> *in,
+                                                         Vector<float, 3> *out, std::size_t count) {
+                const __m256 c0 = _mm256_setr_ps(m[0], m[4], m[8], m[12], m[0], m[4], m[8], m[12]);
+                const __m256 c1 = _mm256_setr_ps(m[1], m[5], m[9], m[13], m[1], m[5], m[9], m[13]);
+                const __m256 c2 = _mm256_setr_ps(m[2], m[6], m[10], m[14], m[2], m[6], m[10], m[14]);
+                const __m256 c3 = _mm256_setr_ps(m[3], m[7], m[11], m[15], m[3], m[7], m[11], m[15]);
+
+                vec3<Mode>(c0, c1, c2, c3, in, out, count);
+            }
+
+            SLIMEMATHS_TARGET_AVX2 static void mat4_vec4(const float *m, const Vector<float, 4> *in,
+                                                         Vector<float, 4> *out, std::size_t count) {
+                const __m256 c0 = _mm256_setr_ps(m[0], m[4], m[8], m[12], m[0], m[4], m[8], m[12]);
+                const __m256 c1 = _mm256_setr_ps(m[1], m[5], m[9], m[13], m[1], m[5], m[9], m[13]);
+                const __m256 c2 = _mm256_setr_ps(m[2], m[6], m[10], m[14], m[2], m[6], m[10], m[14]);
+                const __m256 c3 = _mm256_setr_ps(m[3], m[7], m[11], m[15], m[3], m[7], m[11], m[15]);
+
+                std::size_t i = 0;
+                for (; i + 2 <= count; i += 2) {
+                    const __m256 p = _mm256_loadu_ps(in[i].ptr());
+                    __m256 r = _mm256_mul_ps(c0, _mm256_permute_ps(p, _MM_SHUFFLE(0, 0, 0, 0)));
+                    r = _mm256_fmadd_ps(c1, _mm256_permute_ps(p, _MM_SHUFFLE(1, 1, 1, 1)), r);
+                    r = _mm256_fmadd_ps(c2, _mm256_permute_ps(p, _MM_SHUFFLE(2, 2, 2, 2)), r);
+                    r = _mm256_fmadd_ps(c3, _mm256_permute_ps(p, _MM_SHUFFLE(3, 3, 3, 3)), r);
+                    _mm256_storeu_ps(out[i].ptr(), r);
+                }
+
+                /* An odd last vector takes the same fused steps in one half */
+                if (i < count) {
+                    const __m128 p = _mm_loadu_ps(in[i].ptr());
+                    __m128 r = _mm_mul_ps(_mm256_castps256_ps128(c0), _mm_shuffle_ps(p, p, _MM_SHUFFLE(0, 0, 0, 0)));
+                    r = _mm_fmadd_ps(_mm256_castps256_ps128(c1), _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1)), r);
+                    r = _mm_fmadd_ps(_mm256_castps256_ps128(c2), _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2)), r);
+                    r = _mm_fmadd_ps(_mm256_castps256_ps128(c3), _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 3, 3)), r);
+                    _mm_storeu_ps(out[i].ptr(), r);
+                }
+            }
+
+            SLIMEMATHS_TARGET_AVX2 static void mat3_vec3(const float *m, const Vector<float, 3> *in,
+                                                         Vector<float, 3> *out, std::size_t count) {
+                vec3<TransformMode::Direction>(_mm256_setr_ps(m[0], m[3], m[6], 0.0f, m[0], m[3], m[6], 0.0f),
+                                               _mm256_setr_ps(m[1], m[4], m[7], 0.0f, m[1], m[4], m[7], 0.0f),
+                                               _mm256_setr_ps(m[2], m[5], m[8], 0.0f, m[2], m[5], m[8], 0.0f),
+                                               _mm256_setzero_ps(), in, out, count);
+            }
+
+        private:
+            // Pairs while a third vector follows to cover the 8 float load, then the last one or two vectors alone
+            // with the same fused steps, so a vector's result does not depend on where the span starts or ends
+            template<TransformMode Mode>
+            SLIMEMATHS_TARGET_AVX2 static void vec3(__m256 c0, __m256 c1, __m256 c2, __m256 c3,
+                                                    const Vector<float, 3> *in, Vector<float, 3> *out,
+                                                    std::size_t count) {
+                const __m256i xs = _mm256_setr_epi32(0, 0, 0, 0, 3, 3, 3, 3);
+                const __m256i ys = _mm256_setr_epi32(1, 1, 1, 1, 4, 4, 4, 4);
+                const __m256i zs = _mm256_setr_epi32(2, 2, 2, 2, 5, 5, 5, 5);
+                const __m256i packed = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+
+                /* The 8 float load covers two vectors and the start of a third, stop while that one exists */
+                std::size_t i = 0;
+                for (; i + 3 <= count; i += 2) {
+                    const __m256 p = _mm256_loadu_ps(in[i].ptr());
+                    __m256 r = _mm256_mul_ps(c0, _mm256_permutevar8x32_ps(p, xs));
+                    r = _mm256_fmadd_ps(c1, _mm256_permutevar8x32_ps(p, ys), r);
+                    r = _mm256_fmadd_ps(c2, _mm256_permutevar8x32_ps(p, zs), r);
+
+                    if (Mode != TransformMode::Direction)
+                        r = _mm256_add_ps(r, c3);
+
+                    if (Mode == TransformMode::ProjectedPoint)
+                        r = _mm256_div_ps(r, _mm256_permute_ps(r, _MM_SHUFFLE(3, 3, 3, 3)));
+
+                    r = _mm256_permutevar8x32_ps(r, packed);
+                    _mm_storeu_ps(out[i].ptr(), _mm256_castps256_ps128(r));
+                    _mm_storel_pi(reinterpret_cast<__m64 *>(out[i].ptr() + 4), _mm256_extractf128_ps(r, 1));
+                }
+
+                for (; i < count; ++i) {
+                    const float *p = in[i].ptr();
+                    __m128 r = _mm_mul_ps(_mm256_castps256_ps128(c0), _mm_set1_ps(p[0]));
+                    r = _mm_fmadd_ps(_mm256_castps256_ps128(c1), _mm_set1_ps(p[1]), r);
+                    r = _mm_fmadd_ps(_mm256_castps256_ps128(c2), _mm_set1_ps(p[2]), r);
+
+                    if (Mode != TransformMode::Direction)
+                        r = _mm_add_ps(r, _mm256_castps256_ps128(c3));
+
+                    if (Mode == TransformMode::ProjectedPoint)
+                        r = _mm_div_ps(r, _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 3, 3)));
+
+                    store_float3(out[i].ptr(), r);
+                }
+            }
+        };
+
+        // One vector per register
+        template<>
+        struct BatchTransformAvx2<double> {
+            template<TransformMode Mode>
+            SLIMEMATHS_TARGET_AVX2 static void mat4_vec3(const double *m, const Vector<double, 3> *in,
+                                                         Vector<double, 3> *out, std::size_t count) {
+                vec3<Mode>(_mm256_setr_pd(m[0], m[4], m[8], m[12]), _mm256_setr_pd(m[1], m[5], m[9], m[13]),
+                           _mm256_setr_pd(m[2], m[6], m[10], m[14]), _mm256_setr_pd(m[3], m[7], m[11], m[15]),
+                           in, out, count);
+            }
+
+            SLIMEMATHS_TARGET_AVX2 static void mat4_vec4(const double *m, const Vector<double, 4> *in,
+                                                         Vector<double, 4> *out, std::size_t count) {
+                const __m256d c0 = _mm256_setr_pd(m[0], m[4], m[8], m[12]);
+                const __m256d c1 = _mm256_setr_pd(m[1], m[5], m[9], m[13]);
+                const __m256d c2 = _mm256_setr_pd(m[2], m[6], m[10], m[14]);
+                const __m256d c3 = _mm256_setr_pd(m[3], m[7], m[11], m[15]);
+
+                for (std::size_t i = 0; i < count; ++i) {
+                    const double *p = in[i].ptr();
+                    __m256d r = _mm256_mul_pd(c0, _mm256_broadcast_sd(p));
+                    r = _mm256_fmadd_pd(c1, _mm256_broadcast_sd(p + 1), r);
+                    r = _mm256_fmadd_pd(c2, _mm256_broadcast_sd(p + 2), r);
+                    r = _mm256_fmadd_pd(c3, _mm256_broadcast_sd(p + 3), r);
+                    _mm256_storeu_pd(out[i].ptr(), r);
+                }
+            }
+
+            SLIMEMATHS_TARGET_AVX2 static void mat3_vec3(const double *m, const Vector<double, 3> *in,
+                                                         Vector<double, 3> *out, std::size_t count) {
+                vec3<TransformMode::Direction>(_mm256_setr_pd(m[0], m[3], m[6], 0.0),
+                                               _mm256_setr_pd(m[1], m[4], m[7], 0.0),
+                                               _mm256_setr_pd(m[2], m[5], m[8], 0.0), _mm256_setzero_pd(),
+                                               in, out, count);
+            }
+
+        private:
+            template<TransformMode Mode>
+            SLIMEMATHS_TARGET_AVX2 static void vec3(__m256d c0, __m256d c1, __m256d c2, __m256d c3,
+                                                    const Vector<double, 3> *in, Vector<double, 3> *out,
+                                                    std::size_t count) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    const double *p = in[i].ptr();
+                    __m256d r = _mm256_mul_pd(c0, _mm256_broadcast_sd(p));
+                    r = _mm256_fmadd_pd(c1, _mm256_broadcast_sd(p + 1), r);
+                    r = _mm256_fmadd_pd(c2, _mm256_broadcast_sd(p + 2), r);
+
+                    if (Mode != TransformMode::Direction)
+                        r = _mm256_add_pd(r, c3);
+
+                    if (Mode == TransformMode::ProjectedPoint)
+                        r = _mm256_div_pd(r, _mm256_permute4x64_pd(r, _MM_SHUFFLE(3, 3, 3, 3)));
+
+                    double *o = out[i].ptr();
+                    _mm_storeu_pd(o, _mm256_castpd256_pd128(r));
+                    _mm_store_sd(o + 2, _mm256_extractf128_pd(r, 1));
+                }
+            }
+        };
+
+        // Four vectors per register, the tail goes through masked loads and stores.
+        // Double has no AVX-512 kernels yet and keeps the AVX2 ones.
+        // The shuffles use the zero masking forms, GCC 12 warns about the undefined source of the plain ones.
+        struct BatchTransformAvx512 {
+            template<TransformMode Mode>
+            SLIMEMATHS_TARGET_AVX512 static void mat4_vec3(const float *m, const Vector<float, 3> *in,
+                                                           Vector<float, 3> *out, std::size_t count) {
+                vec3<Mode>(columns(m[0], m[4], m[8], m[12]),
+                           columns(m[1], m[5], m[9], m[13]),
+                           columns(m[2], m[6], m[10], m[14]),
+                           columns(m[3], m[7], m[11], m[15]), in, out, count);
+            }
+
+            SLIMEMATHS_TARGET_AVX512 static void mat4_vec4(const float *m, const Vector<float, 4> *in,
+                                                           Vector<float, 4> *out, std::size_t count) {
+                const __m512 c0 = columns(m[0], m[4], m[8], m[12]);
+                const __m512 c1 = columns(m[1], m[5], m[9], m[13]);
+                const __m512 c2 = columns(m[2], m[6], m[10], m[14]);
+                const __m512 c3 = columns(m[3], m[7], m[11], m[15]);
+                const __mmask16 all = 0xffff;
+
+                for (std::size_t i = 0; i < count; i += 4) {
+                    const std::size_t n = count - i < 4 ? count - i : 4;
+                    const __mmask16 lanes = static_cast<__mmask16>((1u << (4 * n)) - 1u);
+
+                    const __m512 p = _mm512_maskz_loadu_ps(lanes, in[i].ptr());
+                    __m512 r = _mm512_mul_ps(c0, _mm512_maskz_permute_ps(all, p, _MM_SHUFFLE(0, 0, 0, 0)));
+                    r = _mm512_fmadd_ps(c1, _mm512_maskz_permute_ps(all, p, _MM_SHUFFLE(1, 1, 1, 1)), r);
+                    r = _mm512_fmadd_ps(c2, _mm512_maskz_permute_ps(all, p, _MM_SHUFFLE(2, 2, 2, 2)), r);
+                    r = _mm512_fmadd_ps(c3, _mm512_maskz_permute_ps(all, p, _MM_SHUFFLE(3, 3, 3, 3)), r);
+                    _mm512_mask_storeu_ps(out[i].ptr(), lanes, r);
+                }
+            }
+
+            SLIMEMATHS_TARGET_AVX512 static void mat3_vec3(const float *m, const Vector<float, 3> *in,
+                                                           Vector<float, 3> *out, std::size_t count) {
+                vec3<TransformMode::Direction>(columns(m[0], m[3], m[6], 0.0f),
+                                               columns(m[1], m[4], m[7], 0.0f),
+                                               columns(m[2], m[5], m[8], 0.0f),
+                                               _mm512_setzero_ps(), in, out, count);
+            }
+
+        private:
+            // The same column in every 128 bit lane
+            SLIMEMATHS_TARGET_AVX512 static __m512 columns(float x, float y, float z, float w) {
+                return _mm512_setr_ps(x, y, z, w, x, y, z, w, x, y, z, w, x, y, z, w);
+            }
+
+            template<TransformMode Mode>
+            SLIMEMATHS_TARGET_AVX512 static void vec3(__m512 c0, __m512 c1, __m512 c2, __m512 c3,
+                                                      const Vector<float, 3> *in, Vector<float, 3> *out,
+                                                      std::size_t count) {
+                const __m512i xs = _mm512_setr_epi32(0, 0, 0, 0, 3, 3, 3, 3, 6, 6, 6, 6, 9, 9, 9, 9);
+                const __m512i ys = _mm512_add_epi32(xs, _mm512_set1_epi32(1));
+                const __m512i zs = _mm512_add_epi32(xs, _mm512_set1_epi32(2));
+                const __m512i packed = _mm512_setr_epi32(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, 15, 15, 15, 15);
+                const __mmask16 all = 0xffff;
+
+                for (std::size_t i = 0; i < count; i += 4) {
+                    const std::size_t n = count - i < 4 ? count - i : 4;
+                    const __mmask16 lanes = static_cast<__mmask16>((1u << (3 * n)) - 1u);
+
+                    const __m512 p = _mm512_maskz_loadu_ps(lanes, in[i].ptr());
+                    __m512 r = _mm512_mul_ps(c0, _mm512_maskz_permutexvar_ps(all, xs, p));
+                    r = _mm512_fmadd_ps(c1, _mm512_maskz_permutexvar_ps(all, ys, p), r);
+                    r = _mm512_fmadd_ps(c2, _mm512_maskz_permutexvar_ps(all, zs, p), r);
+
+                    if (Mode != TransformMode::Direction)
+                        r = _mm512_add_ps(r, c3);
+
+                    if (Mode == TransformMode::ProjectedPoint)
+                        r = _mm512_div_ps(r, _mm512_maskz_permute_ps(all, r, _MM_SHUFFLE(3, 3, 3, 3)));
+
+                    _mm512_mask_storeu_ps(out[i].ptr(), lanes, _mm512_maskz_permutexvar_ps(all, packed, r));
+                }
+            }
+        };
+
+#endif
+
+        // One entry per Sm:: batch transform, bound to the kernels of one instruction set
+        template<typename T>
+        struct BatchTransformTable {
+            using Vec3Kernel = void (*)(const T *, const Vector<T, 3> *, Vector<T, 3> *, std::size_t);
+            using Vec4Kernel = void (*)(const T *, const Vector<T, 4> *, Vector<T, 4> *, std::size_t);
+
+            Vec3Kernel points;
+            Vec3Kernel directions;
+            Vec3Kernel projectedPoints;
+            Vec4Kernel mat4Vec4;
+            Vec3Kernel mat3Vec3;
+
+            template<typename Kernel>
+            static BatchTransformTable of() {
+                return BatchTransformTable{&Kernel::template mat4_vec3<TransformMode::Point>,
+                                           &Kernel::template mat4_vec3<TransformMode::Direction>,
+                                           &Kernel::template mat4_vec3<TransformMode::ProjectedPoint>,
+                                           &Kernel::mat4_vec4, &Kernel::mat3_vec3};
+            }
+        };
+
+        template<typename T>
+        struct BatchTransformDispatch {
+            static const BatchTransformTable<T> &kernels() {
+                using Table = BatchTransformTable<T>;
+                static const Table scalar = Table::template of<BatchTransformScalar<T>>();
+                static const Table native = Table::template of<BatchTransformKernel<T>>();
+                return active_isa() == Isa::Scalar ? scalar : native;
+            }
+        };
+
+#if defined(SLIMEMATHS_DISPATCH)
+        template<>
+        struct BatchTransformDispatch<float> {
+            static const BatchTransformTable<float> &kernels() {
+                using Table = BatchTransformTable<float>;
+                static const Table tables[] = {Table::of<BatchTransformScalar<float>>(),
+                                               Table::of<BatchTransformKernel<float>>(),
+                                               Table::of<BatchTransformAvx2<float>>(),
+                                               Table::of<BatchTransformAvx512>()};
+                switch (active_isa()) {
+                    case Isa::Scalar:
+                        return tables[0];
+                    case Isa::Avx2:
+                        return tables[2];
+                    case Isa::Avx512:
+                        return tables[3];
+                    default:
+                        return tables[1];
+                }
+            }
+        };
+
+        template<>
+        struct BatchTransformDispatch<double> {
+            static const BatchTransformTable<double> &kernels() {
+                using Table = BatchTransformTable<double>;
+                static const Table tables[] = {Table::of<BatchTransformScalar<double>>(),
+                                               Table::of<BatchTransformKernel<double>>(),
+                                               Table::of<BatchTransformAvx2<double>>()};
+                switch (active_isa()) {
+                    case Isa::Scalar:
+                        return tables[0];
+                    case Isa::Avx2:
+                    case Isa::Avx512:
+                        return tables[2];
+                    default:
+                        return tables[1];
+                }
+            }
+        };
+#endif
+    }
+
+    // out[i] = (mat * (in[i], 1)).xyz
+    template<typename T>
+    void transform_points(const Matrix<T, 4, 4> &mat, const Vector<T, 3> *in, Vector<T, 3> *out,
+                          std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::transform_points");
+        detail::BatchTransformDispatch<T>::kernels().points(mat.ptr(), in, out, count);
+    }
+
+    // out[i] = (mat * (in[i], 0)).xyz
+    template<typename T>
+    void transform_directions(const Matrix<T, 4, 4> &mat, const Vector<T, 3> *in, Vector<T, 3> *out,
+                              std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::transform_directions");
+        detail::BatchTransformDispatch<T>::kernels().directions(mat.ptr(), in, out, count);
+    }
+
+    // out[i] = (mat * (in[i], 1)).xyz / (mat * (in[i], 1)).w
+    template<typename T>
+    void transform_points_projected(const Matrix<T, 4, 4> &mat, const Vector<T, 3> *in, Vector<T, 3> *out,
+                                    std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::transform_points_projected");
+        detail::BatchTransformDispatch<T>::kernels().projectedPoints(mat.ptr(), in, out, count);
+    }
+
+    // out[i] = mat * in[i]
+    template<typename T>
+    void transform(const Matrix<T, 4, 4> &mat, const Vector<T, 4> *in, Vector<T, 4> *out, std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::transform");
+        detail::BatchTransformDispatch<T>::kernels().mat4Vec4(mat.ptr(), in, out, count);
+    }
+
+    // out[i] = mat * in[i]
+    template<typename T>
+    void transform(const Matrix<T, 3, 3> &mat, const Vector<T, 3> *in, Vector<T, 3> *out, std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::transform");
+        detail::BatchTransformDispatch<T>::kernels().mat3Vec3(mat.ptr(), in, out, count);
+    }
+
+    namespace detail {
+
+        // Runs kernel over pieces of the span, the dispatched kernel is looked up once by the caller
+        template<typename MatrixType, typename VectorType, typename Kernel>
+        void parallel_transform(Executor &executor, const MatrixType &mat, const VectorType *in, VectorType *out,
+                                std::size_t count, Kernel kernel) {
+            parallel_for(executor, count, [&](std::size_t begin, std::size_t end) {
+                kernel(mat.ptr(), in + begin, out + begin, end - begin);
+            }, cache_partition(out));
+        }
+    }
+
+    // Sm::transform_points spread over executor
+    template<typename T>
+    void transform_points(Executor &executor, const Matrix<T, 4, 4> &mat, const Vector<T, 3> *in, Vector<T, 3> *out,
+                          std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::transform_points(Executor)");
+        detail::parallel_transform(executor, mat, in, out, count, detail::BatchTransformDispatch<T>::kernels().points);
+    }
+
+    // Sm::transform_directions spread over executor
+    template<typename T>
+    void transform_directions(Executor &executor, const Matrix<T, 4, 4> &mat, const Vector<T, 3> *in,
+                              Vector<T, 3> *out, std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::transform_directions(Executor)");
+        detail::parallel_transform(executor, mat, in, out, count,
+                                   detail::BatchTransformDispatch<T>::kernels().directions);
+    }
+
+    // Sm::transform_points_projected spread over executor
+    template<typename T>
+    void transform_points_projected(Executor &executor, const Matrix<T, 4, 4> &mat, const Vector<T, 3> *in,
+                                    Vector<T, 3> *out, std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::transform_points_projected(Executor)");
+        detail::parallel_transform(executor, mat, in, out, count,
+                                   detail::BatchTransformDispatch<T>::kernels().projectedPoints);
+    }
+
+    // Sm::transform spread over executor
+    template<typename T>
+    void transform(Executor &executor, const Matrix<T, 4, 4> &mat, const Vector<T, 4> *in, Vector<T, 4> *out,
+                   std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::transform(Executor)");
+        detail::parallel_transform(executor, mat, in, out, count, detail::BatchTransformDispatch<T>::kernels().mat4Vec4);
+    }
+
+    template<typename T>
+    void transform(Executor &executor, const Matrix<T, 3, 3> &mat, const Vector<T, 3> *in, Vector<T, 3> *out,
+                   std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::transform(Executor)");
+        detail::parallel_transform(executor, mat, in, out, count, detail::BatchTransformDispatch<T>::kernels().mat3Vec3);
+    }
+}
+
+#endif //SLIMEMATHS_BATCHTRANSFORM_H
@@ -0,0 +1,498 @@
+#ifndef SLIMEMATHS_BVH_H
+#define SLIMEMATHS_BVH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <array>
+#include <initializer_list>
+#include <limits>
+#include <vector>
+#include "Vector3.h"
+#include "AABB.h"
+#include "Ray.h"
+#include "Executor.h"
+
+// Bounding volume hierarchy over primitives given by their bounds (or triangles given by vertices and indices).
+// Built top-down with the binned surface area heuristic: every range is binned by centroid along all three axes
+// and split where SAH cost is lowest, or made a leaf when splitting does not pay off.
+// Nodes are flattened depth-first, the first child of an inner node is always the next node, so a traversal
+// mostly walks forward in memory and a node is 32 bytes for float.
+// Large subtrees are built on separate threads, refit() recomputes every box bottom-up without rebuilding for
+// primitives that moved.
+//
+//     Bvhf bvh;
+//     bvh.build(vertices, indices, triangleCount);
+//     bvh.query(box, [&](std::uint32_t triangle) { ... });
+//     float t = bvh.raycast(origin, direction, tMax, [&](std::uint32_t triangle, float tMax) { return hit or tMax; });
+
+namespace Sm {
+
+    struct BvhOptions {
+        // Threads the build is spread over, 0 uses every thread of the executor, 1 stays on the calling thread
+        std::size_t threads = 1;
+
+        // Pool the build runs on, nullptr uses Sm::default_executor()
+        Executor *executor = nullptr;
+
+        // Ranges with fewer primitives than this are built on one thread
+        std::size_t parallelThreshold = 16384;
+
+        // Centroid bins per axis, between 2 and 64
+        std::size_t bins = 16;
+
+        // Ranges up to this size become leaves when no split is cheaper, larger ranges are always split
+        std::size_t maxLeafSize = 8;
+
+        // SAH cost of visiting an inner node relative to testing one primitive
+        float traversalCost = 1.0f;
+    };
+}
+
+template<typename T>
+struct Bvh {
+    using ScalarType = T;
+    using Vec = Vector<T, 3>;
+    using Box = AABB<T>;
+
+    struct Node {
+        Box bounds;
+        std::uint32_t first;    // leaf: first entry in primitives(), inner: index of the second child
+        std::uint32_t count;    // primitives in a leaf, 0 for inner nodes
+
+        bool is_leaf() const {
+            return count != 0;
+        }
+    };
+
+    // Deepest traversal stack a query can need, deeper trees are split at the object median instead
+    static constexpr std::size_t maxDepth = 96;
+
+    // Builds over count primitives with the given bounds, primitive i is reported to queries as i
+    void build(const Box *primitiveBounds, std::size_t count, const Sm::BvhOptions &options = {}) {
+        assert(count < std::numeric_limits<std::uint32_t>::max());
+
+        _nodes.clear();
+        _primitives.resize(count);
+        for (std::size_t i = 0; i < count; ++i)
+            _primitives[i] = static_cast<std::uint32_t>(i);
+        if (count == 0)
+            return;
+
+        Builder builder{primitiveBounds, options, {}};
+        builder.centroids.resize(count);
+        Range root{0, count, Box{}, Box{}};
+        for (std::size_t i = 0; i < count; ++i) {
+            builder.centroids[i] = primitiveBounds[i].center();
+            root.bounds.expand(primitiveBounds[i]);
+            root.centroidBounds.expand(builder.centroids[i]);
+        }
+
+        /* The shared pool is only started when something may run on it */
+        if (!builder.options.executor && options.threads != 1)
+            builder.options.executor = &Sm::default_executor();
+        std::size_t threads = options.threads ? options.threads : builder.options.executor->threads();
+        threads = std::max<std::size_t>(1, threads);
+
+        _nodes.reserve(2 * count);
+        Scratch scratch;
+        build_node(builder, scratch, _nodes, root, 0, threads);
+    }
+
+    // Builds over triangleCount triangles, triangle i uses vertices indices[3 * i], indices[3 * i + 1] and indices[3 * i + 2]
+    void build(const Vec *vertices, const std::uint32_t *indices, std::size_t triangleCount,
+               const Sm::BvhOptions &options = {}) {
+        triangle_bounds(vertices, indices, triangleCount);
+        build(_triangleBounds.data(), triangleCount, options);
+    }
+
+    // Recomputes every node box after primitives moved, the tree shape stays the same.
+    // Quality degrades as primitives drift away from where they were at build time, rebuild once it matters.
+    void refit(const Box *primitiveBounds) {
+        /* Children always come after their parent, so one backward sweep sees children first */
+        for (std::size_t i = _nodes.size(); i-- > 0;) {
+            Node &node = _nodes[i];
+            if (node.is_leaf()) {
+                Box bounds;
+                for (std::size_t p = node.first; p < node.first + node.count; ++p)
+                    bounds.expand(primitiveBounds[_primitives[p]]);
+                node.bounds = bounds;
+            } else {
+                node.bounds = Sm::merge(_nodes[i + 1].bounds, _nodes[node.first].bounds);
+            }
+        }
+    }
+
+    void refit(const Vec *vertices, const std::uint32_t *indices) {
+        triangle_bounds(vertices, indices, _primitives.size());
+        refit(_triangleBounds.data());
+    }
+
+    // Calls visit(primitive) for every primitive in a leaf whose box overlaps box,
+    // primitives themselves are not tested against box
+    template<typename Visitor>
+    void query(const Box &box, Visitor &&visit) const {
+        if (_nodes.empty())
+            return;
+
+        std::uint32_t stack[maxDepth];
+        std::size_t top = 0;
+        std::uint32_t index = 0;
+        while (true) {
+            const Node &node = _nodes[index];
+            if (node.bounds.overlaps(box)) {
+                if (node.is_leaf()) {
+                    for (std::size_t p = node.first; p < node.first + node.count; ++p)
+                        visit(_primitives[p]);
+                } else {
+                    stack[top++] = node.first;
+                    ++index;
+                    continue;
+                }
+            }
+            if (top == 0)
+                break;
+            index = stack[--top];
+        }
+    }
+
+    // Closest hit along origin + t * direction for t in [0, tMax].
+    // hit(primitive, tMax) tests one primitive and returns its distance when it is closer than tMax, or tMax;
+    // the returned value then culls the rest of the traversal. Returns the closest distance found, or tMax.
+    template<typename Hit>
+    T raycast(const Vec &origin, const Vec &direction, T tMax, Hit &&hit) const {
+        if (_nodes.empty())
+            return tMax;
+
+        const Vec inverse{T(1) / direction.x, T(1) / direction.y, T(1) / direction.z};
+        struct Entry {
+            std::uint32_t index;
+            T distance;
+        };
+        Entry stack[maxDepth];
+        std::size_t top = 0;
+
+        Entry current{0, T(0)};
+        if (!slab(_nodes[0].bounds, origin, inverse, tMax, current.distance))
+            return tMax;
+        while (true) {
+            /* Only boxes the ray hits get here, a stacked one may since have fallen behind a closer hit */
+            if (current.distance <= tMax) {
+                const Node &node = _nodes[current.index];
+                if (node.is_leaf()) {
+                    for (std::size_t p = node.first; p < node.first + node.count; ++p)
+                        tMax = hit(_primitives[p], tMax);
+                } else {
+                    /* Nearer child first, the farther one waits on the stack with its entry distance */
+                    Entry a{current.index + 1, T(0)}, b{node.first, T(0)};
+                    const bool hitA = slab(_nodes[a.index].bounds, origin, inverse, tMax, a.distance);
+                    const bool hitB = slab(_nodes[b.index].bounds, origin, inverse, tMax, b.distance);
+                    if (hitA && hitB) {
+                        if (b.distance < a.distance)
+                            std::swap(a, b);
+                        stack[top++] = b;
+                        current = a;
+                        continue;
+                    }
+                    if (hitA || hitB) {
+                        current = hitA ? a : b;
+                        continue;
+                    }
+                }
+            }
+            if (top == 0)
+                break;
+            current = stack[--top];
+        }
+        return tMax;
+    }
+
+    // Root box, empty without primitives
+    Box bounds() const {
+        return _nodes.empty() ? Box{} : _nodes[0].bounds;
+    }
+
+    const Node *nodes() const {
+        return _nodes.data();
+    }
+
+    std::size_t node_count() const {
+        return _nodes.size();
+    }
+
+    // Primitive indices in leaf order, leaves reference ranges of this array
+    const std::uint32_t *primitives() const {
+        return _primitives.data();
+    }
+
+    std::size_t primitive_count() const {
+        return _primitives.size();
+    }
+
+private:
+    static constexpr std::size_t maxBins = 64;
+    static constexpr std::size_t medianDepth = 64;
+
+    struct Range {
+        std::size_t begin;
+        std::size_t end;
+        Box bounds;
+        Box centroidBounds;
+    };
+
+    struct Bin {
+        Box bounds;
+        std::size_t count;
+    };
+
+    using Bins = std::array<Bin, maxBins>;
+
+    struct Builder {
+        const Box *bounds;
+        Sm::BvhOptions options;
+        std::vector<Vec> centroids;
+    };
+
+    // Bins reused by every split() of one thread, only the first options.bins are ever touched
+    struct Scratch {
+        Bins bins[3];
+        std::vector<Bins> partial;
+    };
+
+    // True when the ray enters box within [0, tMax], distance is then the entry distance.
+    // A miss is reported as such and not as an infinite distance, which would pass every test against tMax = inf.
+    static bool slab(const Box &box, const Vec &origin, const Vec &inverse, T tMax, T &distance) {
+        using P = Sm::simd::ScalarPack<T>;
+        P o[3], inv[3], min[3], max[3];
+        Sm::detail::broadcast_vector(origin, o);
+        Sm::detail::broadcast_vector(inverse, inv);
+        Sm::detail::broadcast_vector(box.min, min);
+        Sm::detail::broadcast_vector(box.max, max);
+
+        P near;
+        const bool hit = bits(Sm::detail::slab(o, inv, min, max, P::broadcast(T(0)), P::broadcast(tMax), near)) != 0;
+        distance = near.v;
+        return hit;
+    }
+
+    void triangle_bounds(const Vec *vertices, const std::uint32_t *indices, std::size_t triangleCount) {
+        _triangleBounds.resize(triangleCount);
+        for (std::size_t i = 0; i < triangleCount; ++i) {
+            Box box{vertices[indices[3 * i]]};
+            box.expand(vertices[indices[3 * i + 1]]);
+            box.expand(vertices[indices[3 * i + 2]]);
+            _triangleBounds[i] = box;
+        }
+    }
+
+    static std::size_t bin_of(const Vec &centroid, std::size_t axis, const Box &centroidBounds, T scale,
+                              std::size_t bins) {
+        /* Through a signed integer, converting straight to std::size_t costs a branch */
+        const auto bin = static_cast<std::int64_t>((centroid[axis] - centroidBounds.min[axis]) * scale);
+        return static_cast<std::size_t>(std::min<std::int64_t>(std::max<std::int64_t>(bin, 0),
+                                                               static_cast<std::int64_t>(bins) - 1));
+    }
+
+    // Bins primitives [begin, end) by centroid along every axis
+    void bin_range(const Builder &builder, std::size_t begin, std::size_t end, const Box &centroidBounds,
+                   const T *scale, std::size_t bins, Bins *binned) const {
+        for (std::size_t axis = 0; axis < 3; ++axis)
+            std::fill(binned[axis].begin(), binned[axis].begin() + bins, Bin{Box{}, 0});
+
+        for (std::size_t i = begin; i < end; ++i) {
+            const std::uint32_t primitive = _primitives[i];
+            const Vec &centroid = builder.centroids[primitive];
+            const Box &bounds = builder.bounds[primitive];
+            for (std::size_t axis = 0; axis < 3; ++axis) {
+                Bin &bin = binned[axis][bin_of(centroid, axis, centroidBounds, scale[axis], bins)];
+                bin.bounds.expand(bounds);
+                ++bin.count;
+            }
+        }
+    }
+
+    void build_node(const Builder &builder, Scratch &scratch, std::vector<Node> &out, const Range &range,
+                    std::size_t depth, std::size_t threads) {
+        const std::size_t index = out.size();
+        const std::size_t count = range.end - range.begin;
+        out.push_back(Node{range.bounds, static_cast<std::uint32_t>(range.begin), static_cast<std::uint32_t>(count)});
+
+        const Sm::BvhOptions &options = builder.options;
+        if (count <= 1)
+            return;
+
+        Range left{}, right{};
+        if (!split(builder, scratch, range, depth, threads, left, right))
+            return;
+
+        out[index].count = 0;
+        if (threads > 1 && count >= options.parallelThreshold) {
+            /* Each half builds into its own array, appended after with the second child indices moved */
+            std::vector<Node> leftNodes, rightNodes;
+            const std::size_t leftThreads = threads / 2;
+            Sm::parallel_invoke(*options.executor, [&] {
+                Scratch leftScratch;
+                build_node(builder, leftScratch, leftNodes, left, depth + 1, leftThreads);
+            }, [&] {
+                build_node(builder, scratch, rightNodes, right, depth + 1, threads - leftThreads);
+            });
+
+            append(out, leftNodes);
+            out[index].first = static_cast<std::uint32_t>(out.size());
+            append(out, rightNodes);
+        } else {
+            build_node(builder, scratch, out, left, depth + 1, 1);
+            out[index].first = static_cast<std::uint32_t>(out.size());
+            build_node(builder, scratch, out, right, depth + 1, 1);
+        }
+    }
+
+    static void append(std::vector<Node> &out, const std::vector<Node> &nodes) {
+        const auto offset = static_cast<std::uint32_t>(out.size());
+        for (Node node: nodes) {
+            if (!node.is_leaf())
+                node.first += offset;
+            out.push_back(node);
+        }
+    }
+
+    // Partitions range into left and right, false when it should stay a leaf
+    bool split(const Builder &builder, Scratch &scratch, const Range &range, std::size_t depth, std::size_t threads,
+               Range &left, Range &right) {
+        const Sm::BvhOptions &options = builder.options;
+        const std::size_t count = range.end - range.begin;
+        /* Small ranges do not need more bins than primitives */
+        const std::size_t bins = std::min({std::max<std::size_t>(options.bins, 2), maxBins,
+                                           std::max<std::size_t>(count, 4)});
+        const Vec extent = range.centroidBounds.size();
+
+        T scale[3];
+        for (std::size_t axis = 0; axis < 3; ++axis)
+            scale[axis] = extent[axis] > T(0) ? T(bins) * (T(1) - T(1e-6)) / extent[axis] : T(0);
+
+        /* All centroids on one point: nothing to bin, only an arbitrary split keeps leaves small */
+        if (extent.x <= T(0) && extent.y <= T(0) && extent.z <= T(0)) {
+            if (count <= options.maxLeafSize)
+                return false;
+            split_median(builder, range, 0, left, right);
+            return true;
+        }
+
+        if (depth >= medianDepth) {
+            split_median(builder, range, range.centroidBounds.longest_axis(), left, right);
+            return true;
+        }
+
+        Bins *binned = scratch.bins;
+        if (threads > 1 && count >= options.parallelThreshold) {
+            /* Every thread bins a slice into its own bins, then the bins are merged */
+            scratch.partial.resize(threads * 3);
+            Sm::parallel_for(*options.executor, threads, [&](std::size_t first, std::size_t last) {
+                for (std::size_t t = first; t < last; ++t)
+                    bin_range(builder, range.begin + t * count / threads, range.begin + (t + 1) * count / threads,
+                              range.centroidBounds, scale, bins, scratch.partial.data() + t * 3);
+            });
+
+            for (std::size_t axis = 0; axis < 3; ++axis)
+                for (std::size_t b = 0; b < bins; ++b) {
+                    binned[axis][b] = Bin{Box{}, 0};
+                    for (std::size_t t = 0; t < threads; ++t) {
+                        const Bin &bin = scratch.partial[t * 3 + axis][b];
+                        binned[axis][b].bounds.expand(bin.bounds);
+                        binned[axis][b].count += bin.count;
+                    }
+                }
+        } else {
+            bin_range(builder, range.begin, range.end, range.centroidBounds, scale, bins, binned);
+        }
+
+        /* SAH: traversal + (area(left) * count(left) + area(right) * count(right)) / area(parent),
+         * swept once from each side per axis */
+        T bestCost = std::numeric_limits<T>::max();
+        std::size_t bestAxis = 0, bestSplit = 0;
+        for (std::size_t axis = 0; axis < 3; ++axis) {
+            if (scale[axis] == T(0))
+                continue;
+
+            T rightCost[maxBins];
+            Box accumulated;
+            std::size_t accumulatedCount = 0;
+            for (std::size_t b = bins - 1; b > 0; --b) {
+                accumulated.expand(binned[axis][b].bounds);
+                accumulatedCount += binned[axis][b].count;
+                rightCost[b] = accumulated.surface_area() * T(accumulatedCount);
+            }
+
+            accumulated = Box{};
+            accumulatedCount = 0;
+            for (std::size_t b = 1; b < bins; ++b) {
+                accumulated.expand(binned[axis][b - 1].bounds);
+                accumulatedCount += binned[axis][b - 1].count;
+                const T cost = accumulated.surface_area() * T(accumulatedCount) + rightCost[b];
+                if (accumulatedCount != 0 && accumulatedCount != count && cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = b;
+                }
+            }
+        }
+
+        const T area = range.bounds.surface_area();
+        const T splitCost = T(options.traversalCost) + (area > T(0) ? bestCost / area : T(0));
+        if (bestSplit == 0 || (splitCost >= T(count) && count <= options.maxLeafSize)) {
+            if (count <= options.maxLeafSize)
+                return false;
+            split_median(builder, range, range.centroidBounds.longest_axis(), left, right);
+            return true;
+        }
+
+        /* Box bounds of both sides come from the bins, centroid bounds are gathered while partitioning */
+        left = Range{range.begin, range.begin, Box{}, Box{}};
+        right = Range{range.end, range.end, Box{}, Box{}};
+        for (std::size_t b = 0; b < bins; ++b)
+            (b < bestSplit ? left : right).bounds.expand(binned[bestAxis][b].bounds);
+
+        const T axisScale = scale[bestAxis];
+        std::size_t first = range.begin, last = range.end;
+        while (first < last) {
+            const Vec &centroid = builder.centroids[_primitives[first]];
+            if (bin_of(centroid, bestAxis, range.centroidBounds, axisScale, bins) < bestSplit) {
+                left.centroidBounds.expand(centroid);
+                ++first;
+            } else {
+                right.centroidBounds.expand(centroid);
+                std::swap(_primitives[first], _primitives[--last]);
+            }
+        }
+        left.end = first;
+        right.begin = first;
+        return true;
+    }
+
+    // Splits range in two halves of equal count along axis
+    void split_median(const Builder &builder, const Range &range, std::size_t axis, Range &left, Range &right) {
+        const std::size_t middle = range.begin + (range.end - range.begin) / 2;
+        std::nth_element(_primitives.begin() + range.begin, _primitives.begin() + middle,
+                         _primitives.begin() + range.end, [&](std::uint32_t a, std::uint32_t b) {
+                    return builder.centroids[a][axis] < builder.centroids[b][axis];
+                });
+
+        left = Range{range.begin, middle, Box{}, Box{}};
+        right = Range{middle, range.end, Box{}, Box{}};
+        for (Range *side: {&left, &right})
+            for (std::size_t i = side->begin; i < side->end; ++i) {
+                side->bounds.expand(builder.bounds[_primitives[i]]);
+                side->centroidBounds.expand(builder.centroids[_primitives[i]]);
+            }
+    }
+
+    std::vector<Node> _nodes;
+    std::vector<std::uint32_t> _primitives;
+    std::vector<Box> _triangleBounds;
+};
+
+using Bvhf = Bvh<float>;
+using Bvhd = Bvh<double>;
+
+#endif //SLIMEMATHS_BVH_H
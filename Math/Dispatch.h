@@ -0,0 +1,145 @@
+#ifndef SLIMEMATHS_DISPATCH_H
+#define SLIMEMATHS_DISPATCH_H
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include "Simd.h"
+
+#if defined(SLIMEMATHS_DISPATCH) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// Run time selection of the batch kernels.
+// The CPU is inspected once, on first use. The dispatched entry points then look up their kernel table for the active
+// instruction set once per call, never per element, and run the whole span in it. The Sm::transform* batch functions
+// of BatchTransform.h have their own kernels per set, every batch API written with the simd packs (VectorArray,
+// slerp, palettes, skinning, culling, encoding, ray packets, eigen, SVD and TRS) goes through simd::with_pack, which
+// instantiates the same pack kernel for each set (SimdPack.h). The hand written SSE encodings and the covariance sums
+// keep the build's code path.
+// force_isa limits the active set for tests and benchmarks, the SLIMEMATHS_ISA environment variable
+// (scalar, sse2, avx2 or avx512) does the same at start up. Neither can enable what the CPU lacks.
+// Without SLIMEMATHS_DISPATCH only Isa::Scalar and the set the compiler flags target are available.
+
+namespace Sm {
+
+    // Ordered from least to most capable, every level implies the ones before it.
+    // Only sets with their own batch kernels are listed, a CPU with SSE4.2 but no AVX2 runs the SSE2 ones.
+    // The pack kernels run 256 bit packs for both Avx2 and Avx512.
+    enum class Isa {
+        Scalar,
+        Sse2,
+        Avx2,  // AVX2 and FMA
+        Avx512 // AVX-512F
+    };
+
+    inline const char *isa_name(Isa isa) {
+        switch (isa) {
+            case Isa::Scalar:
+                return "scalar";
+            case Isa::Sse2:
+                return "sse2";
+            case Isa::Avx2:
+                return "avx2";
+            case Isa::Avx512:
+                return "avx512";
+        }
+        return "unknown";
+    }
+
+    // Inverse of isa_name, returns false for unknown names
+    inline bool parse_isa(const char *name, Isa &isa) {
+        for (Isa candidate: {Isa::Scalar, Isa::Sse2, Isa::Avx2, Isa::Avx512})
+            if (name && !std::strcmp(name, isa_name(candidate))) {
+                isa = candidate;
+                return true;
+            }
+        return false;
+    }
+
+    namespace detail {
+
+        inline Isa detect_isa() {
+#if defined(SLIMEMATHS_DISPATCH) && defined(_MSC_VER) && !defined(__clang__)
+            int info[4];
+            __cpuid(info, 0);
+            const int leaves = info[0];
+
+            __cpuid(info, 1);
+            const bool fma = (info[2] & (1 << 12)) != 0;
+            const bool avx = (info[2] & (1 << 28)) != 0;
+
+            /* The OS has to save the upper register halves (XCR0) for AVX and AVX-512 to be usable */
+            const unsigned long long xcr0 = (info[2] & (1 << 27)) ? _xgetbv(0) : 0;
+            const bool ymm = (xcr0 & 0x6) == 0x6, zmm = (xcr0 & 0xe6) == 0xe6;
+
+            bool avx2 = false, avx512 = false;
+            if (leaves >= 7) {
+                __cpuidex(info, 7, 0);
+                avx2 = (info[1] & (1 << 5)) != 0;
+                avx512 = (info[1] & (1 << 16)) != 0;
+            }
+
+            if (avx512 && avx2 && fma && avx && zmm)
+                return Isa::Avx512;
+            if (avx2 && fma && avx && ymm)
+                return Isa::Avx2;
+            return Isa::Sse2;
+#elif defined(SLIMEMATHS_DISPATCH)
+            /* libgcc and compiler-rt already check the OS state for the AVX sets */
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+                return Isa::Avx512;
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+                return Isa::Avx2;
+            return Isa::Sse2;
+#elif defined(__AVX512F__)
+            return Isa::Avx512;
+#elif defined(__AVX2__) && defined(__FMA__)
+            return Isa::Avx2;
+#elif defined(SLIMEMATHS_SSE2)
+            return Isa::Sse2;
+#else
+            return Isa::Scalar;
+#endif
+        }
+
+        inline Isa startup_isa(Isa detected) {
+            Isa requested;
+            if (parse_isa(std::getenv("SLIMEMATHS_ISA"), requested) && requested < detected)
+                return requested;
+            return detected;
+        }
+
+        inline std::atomic<Isa> &isa_state() {
+            static std::atomic<Isa> state{startup_isa(detect_isa())};
+            return state;
+        }
+    }
+
+    // Most capable instruction set of the running CPU (and OS) that this build has kernels for
+    inline Isa detected_isa() {
+        static const Isa detected = detail::detect_isa();
+        return detected;
+    }
+
+    // Instruction set the dispatched entry points currently use
+    inline Isa active_isa() {
+        return detail::isa_state().load(std::memory_order_relaxed);
+    }
+
+    // Uses isa, or the detected set if the CPU lacks it, for every following call. Returns the set now active.
+    // Meant for tests and benchmarks, calls already running on other threads finish with the old kernels.
+    inline Isa force_isa(Isa isa) {
+        const Isa active = isa < detected_isa() ? isa : detected_isa();
+        detail::isa_state().store(active, std::memory_order_relaxed);
+        return active;
+    }
+
+    // Back to the start up choice
+    inline Isa reset_isa() {
+        return force_isa(detail::startup_isa(detected_isa()));
+    }
+}
+
+#endif //SLIMEMATHS_DISPATCH_H
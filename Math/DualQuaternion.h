@@ -0,0 +1,228 @@
+#ifndef SLIMEMATHS_DUALQUATERNION_H
+#define SLIMEMATHS_DUALQUATERNION_H
+
+#include <type_traits>
+#include <ostream>
+#include "Vector3.h"
+#include "Matrix.h"
+#include "Quaternion.h"
+#include "SimdPack.h"
+#include "Trs.h"
+
+// Rigid transform (rotation followed by translation) as a unit dual quaternion real + e * dual.
+// Follows the conventions of Quaternion: lhs * rhs applies lhs first and then rhs, the same order as
+// quaternion products, and transform_point agrees with quaternion * vector and with to_matrix() * point.
+// The dual part holds half the translation, dual = real * (t, 0) / 2 in Quaternion's product order.
+
+namespace Sm {
+    namespace detail {
+
+        // Rotation of a rigid matrix by Shepperd's method (Sm::decompose_trs), well conditioned near 180 degrees where
+        // the trace branch of Sm::matrix_to_quaternion loses most of its digits
+        template<typename T>
+        Quaternion<T> rigid_rotation(const Matrix<T, 4, 4> &matrix) {
+            using P = simd::ScalarPack<T>;
+            P elements[12], t[3], q[4], s[3];
+            for (std::size_t k = 0; k < 12; ++k)
+                elements[k] = P::broadcast(matrix[k]);
+            trs_decompose(elements, t, q, s);
+            return Quaternion<T>{q[0].v, q[1].v, q[2].v, q[3].v};
+        }
+    }
+}
+
+template<typename T>
+struct DualQuaternion {
+    static_assert(std::is_floating_point<T>::value, "dual quaternions can only be used with floating point types");
+
+    using ScalarType = T;
+    static const std::size_t components = 8;
+
+    // Constructors
+    constexpr DualQuaternion() : real{}, dual{T(0), T(0), T(0), T(0)} {}
+
+    constexpr DualQuaternion(const DualQuaternion<T> &rhs) = default;
+
+    constexpr DualQuaternion(const Quaternion<T> &real, const Quaternion<T> &dual) : real{real}, dual{dual} {}
+
+    // Rotates by rotation, then translates by translation
+    constexpr DualQuaternion(const Quaternion<T> &rotation, const Vector<T, 3> &translation) :
+            real{rotation},
+            dual{rotation * Quaternion<T>{translation.x, translation.y, translation.z, T(0)}} {
+        dual *= T(0.5);
+    }
+
+    // Rigid matrix, the upper 3x3 must be a rotation
+    explicit DualQuaternion(const Matrix<T, 4, 4> &matrix) :
+            DualQuaternion(Sm::detail::rigid_rotation(matrix),
+                           Vector<T, 3>{matrix(0, 3), matrix(1, 3), matrix(2, 3)}) {}
+
+    constexpr DualQuaternion<T> &operator=(const DualQuaternion<T> &rhs) = default;
+
+    constexpr DualQuaternion<T> &operator+=(const DualQuaternion<T> &rhs) {
+        real += rhs.real;
+        dual += rhs.dual;
+        return *this;
+    }
+
+    constexpr DualQuaternion<T> &operator-=(const DualQuaternion<T> &rhs) {
+        real -= rhs.real;
+        dual -= rhs.dual;
+        return *this;
+    }
+
+    constexpr DualQuaternion<T> &operator*=(const DualQuaternion<T> &rhs) {
+        *this = (*this * rhs);
+        return *this;
+    }
+
+    constexpr DualQuaternion<T> &operator*=(const T &rhs) {
+        real *= rhs;
+        dual *= rhs;
+        return *this;
+    }
+
+    constexpr bool operator==(const DualQuaternion<T> &rhs) const {
+        return real.x == rhs.real.x && real.y == rhs.real.y && real.z == rhs.real.z && real.w == rhs.real.w &&
+               dual.x == rhs.dual.x && dual.y == rhs.dual.y && dual.z == rhs.dual.z && dual.w == rhs.dual.w;
+    }
+
+    constexpr bool operator!=(const DualQuaternion<T> &rhs) const {
+        return !(*this == rhs);
+    }
+
+    // Functions
+
+    // Unit length real part with the dual part made orthogonal to it
+    void Normalize() {
+        const T lengthSq = Sm::dot(real, real);
+        if (lengthSq == T(0))
+            return;
+
+        const T invLength = T(1) / std::sqrt(lengthSq);
+        real *= invLength;
+        dual *= invLength;
+        dual -= real * Sm::dot(real, dual);
+    }
+
+    DualQuaternion<T> Normalized() const {
+        auto result = *this;
+        result.Normalize();
+        return result;
+    }
+
+    constexpr void LoadIdentity() {
+        real.LoadIdentity();
+        dual = Quaternion<T>{T(0), T(0), T(0), T(0)};
+    }
+
+    // Inverse of a unit dual quaternion
+    constexpr DualQuaternion<T> Inverse() const {
+        return DualQuaternion<T>{real.Inverse(), dual.Inverse()};
+    }
+
+    constexpr Quaternion<T> get_rotation() const {
+        return real;
+    }
+
+    constexpr Vector<T, 3> get_translation() const {
+        /* t = 2 * dual * conjugate(real) in Hamilton order */
+        const Vector<T, 3> r{real.x, real.y, real.z};
+        const Vector<T, 3> d{dual.x, dual.y, dual.z};
+        return (d * real.w - r * dual.w + Sm::cross(r, d)) * T(2);
+    }
+
+    constexpr void get_rotation_translation(Quaternion<T> &rotation, Vector<T, 3> &translation) const {
+        rotation = real;
+        translation = get_translation();
+    }
+
+    Matrix<T, 4, 4> to_matrix() const {
+        Matrix<T, 3, 3> rotation{};
+        Sm::quaternion_to_matrix(rotation, real);
+        const Vector<T, 3> translation = get_translation();
+
+        Matrix<T, 4, 4> result;
+        for (std::size_t r = 0; r < 3; ++r) {
+            for (std::size_t c = 0; c < 3; ++c)
+                result(r, c) = rotation(r, c);
+            result(r, 3) = translation[r];
+        }
+        return result;
+    }
+
+    constexpr Vector<T, 3> transform_point(const Vector<T, 3> &point) const {
+        return real * point + get_translation();
+    }
+
+    constexpr Vector<T, 3> transform_direction(const Vector<T, 3> &direction) const {
+        return real * direction;
+    }
+
+    template<typename C>
+    constexpr DualQuaternion<C> Cast() const {
+        return DualQuaternion<C>{real.template Cast<C>(), dual.template Cast<C>()};
+    }
+
+    constexpr T *Ptr() {
+        return real.Ptr();
+    }
+
+    constexpr const T *Ptr() const {
+        return real.Ptr();
+    }
+
+    // OStream Overrider
+    friend std::ostream &operator<<(std::ostream &os, const DualQuaternion<T> &dq) {
+        os << "[" << dq.real.x << ", " << dq.real.y << ", " << dq.real.z << ", " << dq.real.w << "] + e["
+           << dq.dual.x << ", " << dq.dual.y << ", " << dq.dual.z << ", " << dq.dual.w << "]";
+        return os;
+    }
+
+    Quaternion<T> real;
+    Quaternion<T> dual;
+};
+
+template<typename T>
+constexpr DualQuaternion<T> operator+(const DualQuaternion<T> &lhs, const DualQuaternion<T> &rhs) {
+    auto result = lhs;
+    result += rhs;
+    return result;
+}
+
+template<typename T>
+constexpr DualQuaternion<T> operator-(const DualQuaternion<T> &lhs, const DualQuaternion<T> &rhs) {
+    auto result = lhs;
+    result -= rhs;
+    return result;
+}
+
+// Applies lhs first and then rhs, like Quaternion
+template<typename T>
+constexpr DualQuaternion<T> operator*(const DualQuaternion<T> &lhs, const DualQuaternion<T> &rhs) {
+    return DualQuaternion<T>{lhs.real * rhs.real, lhs.real * rhs.dual + lhs.dual * rhs.real};
+}
+
+template<typename T>
+constexpr DualQuaternion<T> operator*(const DualQuaternion<T> &lhs, const T &rhs) {
+    auto result = lhs;
+    result *= rhs;
+    return result;
+}
+
+template<typename T>
+constexpr DualQuaternion<T> operator*(const T &lhs, const DualQuaternion<T> &rhs) {
+    auto result = rhs;
+    result *= lhs;
+    return result;
+}
+
+template<typename T>
+constexpr Vector<T, 3> operator*(const DualQuaternion<T> &lhs, const Vector<T, 3> &rhs) {
+    return lhs.transform_point(rhs);
+}
+
+using DualQuaternionf = DualQuaternion<float>;
+using DualQuaterniond = DualQuaternion<double>;
+
+#endif //SLIMEMATHS_DUALQUATERNION_H
@@ -0,0 +1,241 @@
+#ifndef SLIMEMATHS_DYNAMICMATRIX_H
+#define SLIMEMATHS_DYNAMICMATRIX_H
+
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+#include <initializer_list>
+#include <ostream>
+#include <sstream>
+#include <vector>
+#include "Matrix.h"
+#include "Gemm.h"
+#include "Instrument.h"
+
+// Heap backed row major matrix whose size is chosen at runtime.
+// Meant for the large systems (hundreds to thousands of rows) that do not fit the fixed size Matrix,
+// the product runs through the blocked, multithreaded kernel in Gemm.h.
+template<typename T>
+struct DynamicMatrix {
+    using ScalarType = T;
+    using ThisType = DynamicMatrix<T>;
+
+    // Constructors
+    DynamicMatrix() = default;
+
+    // rows x cols matrix filled with value
+    DynamicMatrix(std::size_t rows, std::size_t cols, const T &value = T(0)) :
+            _rows{rows},
+            _cols{cols},
+            _element(rows * cols, value) {}
+
+    // Row major element list, missing elements are zero
+    DynamicMatrix(std::size_t rows, std::size_t cols, std::initializer_list<T> values) :
+            DynamicMatrix(rows, cols) {
+        assert(values.size() <= _element.size());
+        std::copy(values.begin(), values.end(), _element.begin());
+    }
+
+    template<std::size_t Rows, std::size_t Cols>
+    explicit DynamicMatrix(const Matrix<T, Rows, Cols> &mat) :
+            _rows{Rows},
+            _cols{Cols},
+            _element(mat.ptr(), mat.ptr() + Rows * Cols) {}
+
+    static ThisType identity(std::size_t size) {
+        ThisType result{size, size};
+        for (std::size_t i = 0; i < size; ++i)
+            result(i, i) = T(1);
+        return result;
+    }
+
+    // Element getters/setters
+    T &operator()(std::size_t row, std::size_t col) {
+        assert(row < _rows);
+        assert(col < _cols);
+        return _element[row * _cols + col];
+    }
+
+    const T &operator()(std::size_t row, std::size_t col) const {
+        assert(row < _rows);
+        assert(col < _cols);
+        return _element[row * _cols + col];
+    }
+
+    T &operator[](std::size_t element) {
+        return _element[element];
+    }
+
+    const T &operator[](std::size_t element) const {
+        return _element[element];
+    }
+
+    T *ptr() {
+        return _element.data();
+    }
+
+    const T *ptr() const {
+        return _element.data();
+    }
+
+    std::size_t rows() const {
+        return _rows;
+    }
+
+    std::size_t columns() const {
+        return _cols;
+    }
+
+    std::size_t elements() const {
+        return _element.size();
+    }
+
+    // Resizes to rows x cols, the contents are reset to value
+    void resize(std::size_t rows, std::size_t cols, const T &value = T(0)) {
+        _rows = rows;
+        _cols = cols;
+        _element.assign(rows * cols, value);
+    }
+
+    // Matrix Math
+    ThisType &operator+=(const ThisType &rhs) {
+        assert(_rows == rhs._rows && _cols == rhs._cols);
+        for (std::size_t i = 0; i < _element.size(); ++i)
+            _element[i] += rhs._element[i];
+        return *this;
+    }
+
+    ThisType &operator-=(const ThisType &rhs) {
+        assert(_rows == rhs._rows && _cols == rhs._cols);
+        for (std::size_t i = 0; i < _element.size(); ++i)
+            _element[i] -= rhs._element[i];
+        return *this;
+    }
+
+    ThisType &operator*=(const ThisType &rhs) {
+        *this = (*this * rhs);
+        return *this;
+    }
+
+    ThisType &operator*=(const T &rhs) {
+        for (auto &element: _element)
+            element *= rhs;
+        return *this;
+    }
+
+    bool operator==(const ThisType &rhs) const {
+        return _rows == rhs._rows && _cols == rhs._cols && _element == rhs._element;
+    }
+
+    bool operator!=(const ThisType &rhs) const {
+        return !(*this == rhs);
+    }
+
+    ThisType transposed() const {
+        ThisType result{_cols, _rows};
+        for (std::size_t r = 0; r < _rows; ++r)
+            for (std::size_t c = 0; c < _cols; ++c)
+                result(c, r) = (*this)(r, c);
+        return result;
+    }
+
+    // Copies the matrix into a fixed size Matrix, the sizes must match
+    template<std::size_t Rows, std::size_t Cols>
+    Matrix<T, Rows, Cols> to_matrix() const {
+        assert(_rows == Rows && _cols == Cols);
+        Matrix<T, Rows, Cols> result;
+        std::copy(_element.begin(), _element.end(), result.ptr());
+        return result;
+    }
+
+    // OStream Overrider
+    friend std::ostream &operator<<(std::ostream &os, const ThisType &m) {
+        std::stringstream output;
+        for (std::size_t r = 0; r < m._rows; ++r) {
+            for (std::size_t c = 0; c < m._cols; ++c)
+                output << "[" << m(r, c) << "]\t";
+            output << '\n';
+        }
+
+        os << output.str();
+
+        return os;
+    }
+
+private:
+    std::size_t _rows = 0;
+    std::size_t _cols = 0;
+    std::vector<T> _element;
+};
+
+namespace Sm {
+    // out = lhs * rhs through the blocked kernel, out may not alias lhs or rhs
+    template<typename T>
+    void multiply(const DynamicMatrix<T> &lhs, const DynamicMatrix<T> &rhs, DynamicMatrix<T> &out,
+                  const GemmOptions &options = GemmOptions{}) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::multiply(DynamicMatrix)");
+        assert(lhs.columns() == rhs.rows());
+        assert(&out != &lhs && &out != &rhs);
+        if (out.rows() != lhs.rows() || out.columns() != rhs.columns())
+            out.resize(lhs.rows(), rhs.columns());
+
+        detail::GemmKernel<T>::multiply(out.ptr(), lhs.ptr(), rhs.ptr(), lhs.rows(), rhs.columns(),
+                                        lhs.columns(), options);
+    }
+}
+
+// Global Operators
+
+template<typename T>
+DynamicMatrix<T> operator+(const DynamicMatrix<T> &lhs, const DynamicMatrix<T> &rhs) {
+    auto result = lhs;
+    result += rhs;
+    return result;
+}
+
+template<typename T>
+DynamicMatrix<T> operator-(const DynamicMatrix<T> &lhs, const DynamicMatrix<T> &rhs) {
+    auto result = lhs;
+    result -= rhs;
+    return result;
+}
+
+template<typename T>
+DynamicMatrix<T> operator*(const DynamicMatrix<T> &lhs, const T &rhs) {
+    auto result = lhs;
+    result *= rhs;
+    return result;
+}
+
+template<typename T>
+DynamicMatrix<T> operator*(const T &lhs, const DynamicMatrix<T> &rhs) {
+    auto result = rhs;
+    result *= lhs;
+    return result;
+}
+
+template<typename T>
+DynamicMatrix<T> operator*(const DynamicMatrix<T> &lhs, const DynamicMatrix<T> &rhs) {
+    DynamicMatrix<T> result;
+    Sm::multiply(lhs, rhs, result);
+    return result;
+}
+
+// Mixed products with the fixed size types
+template<typename T, std::size_t Rows, std::size_t Cols>
+DynamicMatrix<T> operator*(const DynamicMatrix<T> &lhs, const Matrix<T, Rows, Cols> &rhs) {
+    return lhs * DynamicMatrix<T>{rhs};
+}
+
+template<typename T, std::size_t Rows, std::size_t Cols>
+DynamicMatrix<T> operator*(const Matrix<T, Rows, Cols> &lhs, const DynamicMatrix<T> &rhs) {
+    return DynamicMatrix<T>{lhs} * rhs;
+}
+
+// --Default types--
+
+using MatX = DynamicMatrix<float>;
+using MatXi = DynamicMatrix<int>;
+using MatXd = DynamicMatrix<double>;
+
+#endif //SLIMEMATHS_DYNAMICMATRIX_H
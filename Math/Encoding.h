@@ -0,0 +1,633 @@
+#ifndef SLIMEMATHS_ENCODING_H
+#define SLIMEMATHS_ENCODING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include "Simd.h"
+#include "Vector2.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Quaternion.h"
+#include "QuaternionBlend.h"
+#include "QuaternionConversion.h"
+#include "SimdPack.h"
+
+// Compact encodings for bandwidth bound vertex and network streams (half floats live in Half.h):
+//  - UNORM / SNORM: [0, 1] or [-1, 1] to 8 or 16 bit integers, clamped and rounded to nearest (NaN encodes to the
+//    lowest value). Decoding follows the D3D / Vulkan rules, the most negative SNORM integer also decodes to -1.
+//  - Octahedral: a unit Vec3 folded onto the octahedron and stored as two SNORM values (Cigolle et al. 2014). The
+//    encoder keeps whichever of the four surrounding grid points decodes closest to the normal, 16 bit normals are
+//    off by at most 0.64 degrees (0.31 on average), 32 bit ones by 0.0025.
+//  - Smallest three: a unit quaternion as the index of its largest component and the other three, which are never
+//    larger than 1 / sqrt(2), in Bits bits each. The largest one is rebuilt from unit length, so the encoder searches
+//    the eight surrounding grid points for the closest rotation. 10 bits (32 bits in total) keep rotations within
+//    0.16 degrees.
+// Every encoding has single value and array functions. The array functions run the same arithmetic a simd pack at a
+// time (SSE2 for the integer conversions) and produce the same bits as the single value ones. The one exception
+// is a build that fuses multiply-adds, where the octahedral and smallest three searches may settle on neighbouring
+// grid points in the two when both are about equally close.
+// The error functions at the end measure what an encoding loses over a data set.
+
+namespace Sm {
+    // [0, 1] to [0, max], Q is std::uint8_t or std::uint16_t
+    template<typename Q, typename T>
+    typename std::enable_if<std::is_floating_point<T>::value, Q>::type encode_unorm(T value) {
+        static_assert(std::is_unsigned<Q>::value && sizeof(Q) <= 2, "UNORM values are 8 or 16 bit unsigned integers");
+        const T clamped = value > T(0) ? (value < T(1) ? value : T(1)) : T(0);
+        return static_cast<Q>(static_cast<std::int32_t>(clamped * T(std::numeric_limits<Q>::max()) + T(0.5)));
+    }
+
+    template<typename T = float, typename Q>
+    typename std::enable_if<std::is_integral<Q>::value, T>::type decode_unorm(Q value) {
+        static_assert(std::is_unsigned<Q>::value && sizeof(Q) <= 2, "UNORM values are 8 or 16 bit unsigned integers");
+        return T(value) / T(std::numeric_limits<Q>::max());
+    }
+
+    // [-1, 1] to [-max, max], Q is std::int8_t or std::int16_t
+    template<typename Q, typename T>
+    typename std::enable_if<std::is_floating_point<T>::value, Q>::type encode_snorm(T value) {
+        static_assert(std::is_signed<Q>::value && sizeof(Q) <= 2, "SNORM values are 8 or 16 bit signed integers");
+        const T clamped = value > T(-1) ? (value < T(1) ? value : T(1)) : T(-1);
+        const T scaled = clamped * T(std::numeric_limits<Q>::max());
+        return static_cast<Q>(static_cast<std::int32_t>(scaled + std::copysign(T(0.5), scaled)));
+    }
+
+    template<typename T = float, typename Q>
+    typename std::enable_if<std::is_integral<Q>::value, T>::type decode_snorm(Q value) {
+        static_assert(std::is_signed<Q>::value && sizeof(Q) <= 2, "SNORM values are 8 or 16 bit signed integers");
+        const T decoded = T(value) / T(std::numeric_limits<Q>::max());
+        return decoded > T(-1) ? decoded : T(-1);
+    }
+
+    template<typename Q, typename T, std::size_t N>
+    Vector<Q, N> encode_unorm(const Vector<T, N> &v) {
+        Vector<Q, N> result;
+        for (std::size_t i = 0; i < N; ++i)
+            result[i] = encode_unorm<Q>(v[i]);
+        return result;
+    }
+
+    template<typename T = float, typename Q, std::size_t N>
+    Vector<T, N> decode_unorm(const Vector<Q, N> &v) {
+        Vector<T, N> result;
+        for (std::size_t i = 0; i < N; ++i)
+            result[i] = decode_unorm<T>(v[i]);
+        return result;
+    }
+
+    template<typename Q, typename T, std::size_t N>
+    Vector<Q, N> encode_snorm(const Vector<T, N> &v) {
+        Vector<Q, N> result;
+        for (std::size_t i = 0; i < N; ++i)
+            result[i] = encode_snorm<Q>(v[i]);
+        return result;
+    }
+
+    template<typename T = float, typename Q, std::size_t N>
+    Vector<T, N> decode_snorm(const Vector<Q, N> &v) {
+        Vector<T, N> result;
+        for (std::size_t i = 0; i < N; ++i)
+            result[i] = decode_snorm<T>(v[i]);
+        return result;
+    }
+
+    namespace detail {
+#if defined(SLIMEMATHS_SSE2)
+        // 8 clamped and scaled values rounded half away from zero, like the scalar encoders, and narrowed to Q
+        template<typename Q>
+        void store_rounded(Q *out, __m128 low, __m128 high) {
+            const __m128 sign = _mm_set1_ps(-0.0f), half = _mm_set1_ps(0.5f);
+            const __m128i a = _mm_cvttps_epi32(_mm_add_ps(low, _mm_or_ps(_mm_and_ps(low, sign), half)));
+            const __m128i b = _mm_cvttps_epi32(_mm_add_ps(high, _mm_or_ps(_mm_and_ps(high, sign), half)));
+
+            if constexpr (std::is_same<Q, std::uint8_t>::value) {
+                const __m128i words = _mm_packs_epi32(a, b);
+                _mm_storel_epi64(reinterpret_cast<__m128i *>(out), _mm_packus_epi16(words, words));
+            } else if constexpr (std::is_same<Q, std::int8_t>::value) {
+                const __m128i words = _mm_packs_epi32(a, b);
+                _mm_storel_epi64(reinterpret_cast<__m128i *>(out), _mm_packs_epi16(words, words));
+            } else if constexpr (std::is_same<Q, std::uint16_t>::value) {
+                /* SSE2 only narrows with signed saturation, so go through the biased signed range */
+                const __m128i bias = _mm_set1_epi32(32768);
+                const __m128i words = _mm_packs_epi32(_mm_sub_epi32(a, bias), _mm_sub_epi32(b, bias));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out),
+                                 _mm_xor_si128(words, _mm_set1_epi16(static_cast<short>(0x8000))));
+            } else {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_packs_epi32(a, b));
+            }
+        }
+
+        // 8 values of Q widened to two vectors of 32 bit integers
+        template<typename Q>
+        void load_widened(const Q *in, __m128i &low, __m128i &high) {
+            const __m128i zero = _mm_setzero_si128();
+            if constexpr (std::is_same<Q, std::uint8_t>::value) {
+                const __m128i words = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(in)), zero);
+                low = _mm_unpacklo_epi16(words, zero);
+                high = _mm_unpackhi_epi16(words, zero);
+            } else if constexpr (std::is_same<Q, std::int8_t>::value) {
+                const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(in));
+                const __m128i words = _mm_srai_epi16(_mm_unpacklo_epi8(bytes, bytes), 8);
+                low = _mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16);
+                high = _mm_srai_epi32(_mm_unpackhi_epi16(words, words), 16);
+            } else if constexpr (std::is_same<Q, std::uint16_t>::value) {
+                const __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+                low = _mm_unpacklo_epi16(words, zero);
+                high = _mm_unpackhi_epi16(words, zero);
+            } else {
+                const __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+                low = _mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16);
+                high = _mm_srai_epi32(_mm_unpackhi_epi16(words, words), 16);
+            }
+        }
+#endif
+    }
+
+    // count values to UNORM, 8 at a time for float
+    template<typename Q, typename T>
+    typename std::enable_if<std::is_floating_point<T>::value>::type
+    encode_unorm(const T *values, Q *out, std::size_t count) {
+        std::size_t i = 0;
+#if defined(SLIMEMATHS_SSE2)
+        if constexpr (std::is_same<T, float>::value) {
+            const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+            const __m128 scale = _mm_set1_ps(float(std::numeric_limits<Q>::max()));
+            for (; i + 8 <= count; i += 8) {
+                const __m128 low = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(values + i), zero), one);
+                const __m128 high = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(values + i + 4), zero), one);
+                detail::store_rounded(out + i, _mm_mul_ps(low, scale), _mm_mul_ps(high, scale));
+            }
+        }
+#endif
+        for (; i < count; ++i)
+            out[i] = encode_unorm<Q>(values[i]);
+    }
+
+    template<typename T, typename Q>
+    typename std::enable_if<std::is_integral<Q>::value>::type
+    decode_unorm(const Q *values, T *out, std::size_t count) {
+        std::size_t i = 0;
+#if defined(SLIMEMATHS_SSE2)
+        if constexpr (std::is_same<T, float>::value) {
+            const __m128 scale = _mm_set1_ps(float(std::numeric_limits<Q>::max()));
+            for (; i + 8 <= count; i += 8) {
+                __m128i low, high;
+                detail::load_widened(values + i, low, high);
+                _mm_storeu_ps(out + i, _mm_div_ps(_mm_cvtepi32_ps(low), scale));
+                _mm_storeu_ps(out + i + 4, _mm_div_ps(_mm_cvtepi32_ps(high), scale));
+            }
+        }
+#endif
+        for (; i < count; ++i)
+            out[i] = decode_unorm<T>(values[i]);
+    }
+
+    // count values to SNORM, 8 at a time for float
+    template<typename Q, typename T>
+    typename std::enable_if<std::is_floating_point<T>::value>::type
+    encode_snorm(const T *values, Q *out, std::size_t count) {
+        std::size_t i = 0;
+#if defined(SLIMEMATHS_SSE2)
+        if constexpr (std::is_same<T, float>::value) {
+            const __m128 lowest = _mm_set1_ps(-1.0f), one = _mm_set1_ps(1.0f);
+            const __m128 scale = _mm_set1_ps(float(std::numeric_limits<Q>::max()));
+            for (; i + 8 <= count; i += 8) {
+                const __m128 low = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(values + i), lowest), one);
+                const __m128 high = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(values + i + 4), lowest), one);
+                detail::store_rounded(out + i, _mm_mul_ps(low, scale), _mm_mul_ps(high, scale));
+            }
+        }
+#endif
+        for (; i < count; ++i)
+            out[i] = encode_snorm<Q>(values[i]);
+    }
+
+    template<typename T, typename Q>
+    typename std::enable_if<std::is_integral<Q>::value>::type
+    decode_snorm(const Q *values, T *out, std::size_t count) {
+        std::size_t i = 0;
+#if defined(SLIMEMATHS_SSE2)
+        if constexpr (std::is_same<T, float>::value) {
+            const __m128 lowest = _mm_set1_ps(-1.0f);
+            const __m128 scale = _mm_set1_ps(float(std::numeric_limits<Q>::max()));
+            for (; i + 8 <= count; i += 8) {
+                __m128i low, high;
+                detail::load_widened(values + i, low, high);
+                _mm_storeu_ps(out + i, _mm_max_ps(_mm_div_ps(_mm_cvtepi32_ps(low), scale), lowest));
+                _mm_storeu_ps(out + i + 4, _mm_max_ps(_mm_div_ps(_mm_cvtepi32_ps(high), scale), lowest));
+            }
+        }
+#endif
+        for (; i < count; ++i)
+            out[i] = decode_snorm<T>(values[i]);
+    }
+
+    // Vector arrays, every component is encoded on its own
+    template<typename Q, typename T, std::size_t N>
+    void encode_unorm(const Vector<T, N> *values, Vector<Q, N> *out, std::size_t count) {
+        if (count != 0)
+            encode_unorm(values[0].ptr(), out[0].ptr(), count * N);
+    }
+
+    template<typename T, typename Q, std::size_t N>
+    void decode_unorm(const Vector<Q, N> *values, Vector<T, N> *out, std::size_t count) {
+        if (count != 0)
+            decode_unorm(values[0].ptr(), out[0].ptr(), count * N);
+    }
+
+    template<typename Q, typename T, std::size_t N>
+    void encode_snorm(const Vector<T, N> *values, Vector<Q, N> *out, std::size_t count) {
+        if (count != 0)
+            encode_snorm(values[0].ptr(), out[0].ptr(), count * N);
+    }
+
+    template<typename T, typename Q, std::size_t N>
+    void decode_snorm(const Vector<Q, N> *values, Vector<T, N> *out, std::size_t count) {
+        if (count != 0)
+            decode_snorm(values[0].ptr(), out[0].ptr(), count * N);
+    }
+
+    namespace detail {
+
+        // Unit (x, y, z) to the octahedron unfolded onto [-1, 1]^2, the lower half is folded over the diagonals
+        template<typename P>
+        void octahedral_encode(const P &x, const P &y, const P &z, P &u, P &v) {
+            using T = typename P::ScalarType;
+            const P zero = P::broadcast(T(0)), one = P::broadcast(T(1));
+
+            const P inverseNorm = one / (abs(x) + abs(y) + abs(z));
+            const P px = x * inverseNorm, py = y * inverseNorm;
+            const P foldedX = (one - abs(py)) * select(px >= zero, one, -one);
+            const P foldedY = (one - abs(px)) * select(py >= zero, one, -one);
+
+            const auto lower = z < zero;
+            u = select(lower, foldedX, px);
+            v = select(lower, foldedY, py);
+        }
+
+        template<typename P>
+        void octahedral_decode(const P &u, const P &v, P &x, P &y, P &z) {
+            using T = typename P::ScalarType;
+            const P zero = P::broadcast(T(0)), one = P::broadcast(T(1));
+
+            z = one - abs(u) - abs(v);
+            const P fold = max(-z, zero);
+            x = u + select(u >= zero, -fold, fold);
+            y = v + select(v >= zero, -fold, fold);
+
+            const P inverseLength = one / sqrt(x * x + y * y + z * z);
+            x = x * inverseLength;
+            y = y * inverseLength;
+            z = z * inverseLength;
+        }
+
+        // Largest whole number not above x, for |x| < 2^22 in float and 2^51 in double. Adding 1.5 * 2^mantissa rounds
+        // x to a whole number (strict IEEE arithmetic, -ffast-math may fold the pair away), one comes off where that
+        // rounded up.
+        template<typename P>
+        P floor_whole(const P &x) {
+            using T = typename P::ScalarType;
+            const P magic = P::broadcast(std::is_same<T, float>::value ? T(12582912.0f) : T(6755399441055744.0));
+            const P rounded = (x + magic) - magic;
+            return rounded - select(rounded > x, P::broadcast(T(1)), P::broadcast(T(0)));
+        }
+
+        // Unit (x, y, z) to two whole SNORM values in [-limit, limit]. Rounding u and v on their own can land further
+        // from the normal than another corner of the grid cell, the folds bend the cells, so all four corners are
+        // decoded and the closest one is kept (the "precise" encoding of Cigolle et al.).
+        template<typename P>
+        void octahedral_encode_snorm(const P &x, const P &y, const P &z, const P &limit, P &u, P &v) {
+            using T = typename P::ScalarType;
+            const P one = P::broadcast(T(1));
+
+            P cu, cv;
+            octahedral_encode(x, y, z, cu, cv);
+            const P lowU = floor_whole(min(max(cu * limit, -limit), limit));
+            const P lowV = floor_whole(min(max(cv * limit, -limit), limit));
+            const P highU = min(lowU + one, limit), highV = min(lowV + one, limit);
+
+            /* Squared distance rather than the cosine, which float can not resolve between neighbours of 16 bit grids */
+            P best = P::broadcast(T(8));
+            u = lowU;
+            v = lowV;
+            for (std::size_t corner = 0; corner < 4; ++corner) {
+                const P qu = corner & 1 ? highU : lowU, qv = corner & 2 ? highV : lowV;
+                P dx, dy, dz;
+                octahedral_decode(qu / limit, qv / limit, dx, dy, dz);
+                const P distance = (dx - x) * (dx - x) + (dy - y) * (dy - y) + (dz - z) * (dz - z);
+
+                const auto closer = distance < best;
+                best = select(closer, distance, best);
+                u = select(closer, qu, u);
+                v = select(closer, qv, v);
+            }
+        }
+    }
+
+    // Unit vector to its octahedral coordinates in [-1, 1]^2, normal must not be zero
+    template<typename T>
+    Vector<T, 2> to_octahedral(const Vector<T, 3> &normal) {
+        using P = simd::ScalarPack<T>;
+        P u, v;
+        detail::octahedral_encode(P::broadcast(normal.x), P::broadcast(normal.y), P::broadcast(normal.z), u, v);
+        return Vector<T, 2>{u.v, v.v};
+    }
+
+    // Octahedral coordinates back to a unit vector
+    template<typename T>
+    Vector<T, 3> from_octahedral(const Vector<T, 2> &coordinates) {
+        using P = simd::ScalarPack<T>;
+        P x, y, z;
+        detail::octahedral_decode(P::broadcast(coordinates.x), P::broadcast(coordinates.y), x, y, z);
+        return Vector<T, 3>{x.v, y.v, z.v};
+    }
+
+    // Unit vector to two SNORM values, std::int8_t for 16 bit or std::int16_t for 32 bit normals, the grid point whose
+    // decoded direction is closest to normal
+    template<typename Q, typename T>
+    Vector<Q, 2> encode_octahedral(const Vector<T, 3> &normal) {
+        using P = simd::ScalarPack<T>;
+        P u, v;
+        detail::octahedral_encode_snorm(P::broadcast(normal.x), P::broadcast(normal.y), P::broadcast(normal.z),
+                                        P::broadcast(T(std::numeric_limits<Q>::max())), u, v);
+        return Vector<Q, 2>{static_cast<Q>(static_cast<std::int32_t>(u.v)),
+                            static_cast<Q>(static_cast<std::int32_t>(v.v))};
+    }
+
+    template<typename T = float, typename Q>
+    Vector<T, 3> decode_octahedral(const Vector<Q, 2> &encoded) {
+        return from_octahedral(decode_snorm<T>(encoded));
+    }
+
+    template<typename Q, typename T>
+    void encode_octahedral(const Vector<T, 3> *normals, Vector<Q, 2> *out, std::size_t count) {
+        simd::for_each_pack<T>(count, [&](auto pack, std::size_t i) {
+            using P = decltype(pack);
+            P x, y, z, u, v;
+            detail::load_vectors(normals + i, x, y, z);
+            detail::octahedral_encode_snorm(x, y, z, P::broadcast(T(std::numeric_limits<Q>::max())), u, v);
+
+            T us[P::width], vs[P::width];
+            u.store(us);
+            v.store(vs);
+            for (std::size_t l = 0; l < P::width; ++l)
+                out[i + l] = Vector<Q, 2>{static_cast<Q>(static_cast<std::int32_t>(us[l])),
+                                          static_cast<Q>(static_cast<std::int32_t>(vs[l]))};
+        });
+    }
+
+    template<typename T, typename Q>
+    void decode_octahedral(const Vector<Q, 2> *encoded, Vector<T, 3> *out, std::size_t count) {
+        simd::for_each_pack<T>(count, [&](auto pack, std::size_t i) {
+            using P = decltype(pack);
+            T coordinates[2 * P::width], us[P::width], vs[P::width];
+            decode_snorm(reinterpret_cast<const Q *>(encoded + i), coordinates, 2 * P::width);
+            for (std::size_t l = 0; l < P::width; ++l) {
+                us[l] = coordinates[2 * l];
+                vs[l] = coordinates[2 * l + 1];
+            }
+
+            P x, y, z;
+            detail::octahedral_decode(P::load(us), P::load(vs), x, y, z);
+            detail::store_vectors(out + i, x, y, z);
+        });
+    }
+
+    // Packed smallest three quaternion: bits 0-1 hold the index of the dropped component, then the other three
+    // components in x, y, z, w order with Bits bits each
+    template<std::size_t Bits>
+    using SmallestThree = typename std::conditional<(2 + 3 * Bits <= 32), std::uint32_t, std::uint64_t>::type;
+
+    namespace detail {
+
+        // Index of the largest magnitude component and the other three with its sign divided out, mapped from
+        // [-1 / sqrt(2), 1 / sqrt(2)] to whole numbers in [0, levels]. Rounding the three on their own is not the
+        // closest rotation once the dropped component is rebuilt from them, so every corner of the grid cell is
+        // decoded and the one nearest q is kept.
+        template<typename P>
+        void smallest_three_encode(const P &x, const P &y, const P &z, const P &w, const P &levels,
+                                   P &index, P (&others)[3]) {
+            using T = typename P::ScalarType;
+            const P zero = P::broadcast(T(0)), one = P::broadcast(T(1));
+            const P two = P::broadcast(T(2)), three = P::broadcast(T(3));
+
+            P largest = x, magnitude = abs(x);
+            index = zero;
+            const P candidates[3] = {y, z, w};
+            const P indices[3] = {one, two, three};
+            for (std::size_t k = 0; k < 3; ++k) {
+                const auto larger = abs(candidates[k]) > magnitude;
+                magnitude = select(larger, abs(candidates[k]), magnitude);
+                largest = select(larger, candidates[k], largest);
+                index = select(larger, indices[k], index);
+            }
+
+            /* q and -q are the same rotation, flip so the dropped component is positive */
+            const P sign = select(largest < zero, -one, one);
+            const P components[3] = {select(index < one, y, x) * sign, select(index < two, z, y) * sign,
+                                     select(index < three, w, z) * sign};
+            const P scale = levels * P::broadcast(std::sqrt(T(2)) * T(0.5));
+            const P offset = levels * P::broadcast(T(0.5));
+            P low[3], high[3];
+            for (std::size_t k = 0; k < 3; ++k) {
+                low[k] = floor_whole(min(max(components[k] * scale + offset, zero), levels));
+                high[k] = min(low[k] + one, levels);
+            }
+
+            /* The same arithmetic as smallest_three_decode */
+            const P step = P::broadcast(std::sqrt(T(2))) / levels;
+            const P center = P::broadcast(std::sqrt(T(0.5)));
+            P best = P::broadcast(T(8));
+            for (std::size_t k = 0; k < 3; ++k)
+                others[k] = low[k];
+            for (std::size_t corner = 0; corner < 8; ++corner) {
+                P grid[3], decoded[3];
+                for (std::size_t k = 0; k < 3; ++k) {
+                    grid[k] = corner >> k & 1 ? high[k] : low[k];
+                    decoded[k] = grid[k] * step - center;
+                }
+                const P dropped = sqrt(max(one - decoded[0] * decoded[0] - decoded[1] * decoded[1] -
+                                           decoded[2] * decoded[2], zero));
+                P distance = (dropped - magnitude) * (dropped - magnitude);
+                for (std::size_t k = 0; k < 3; ++k)
+                    distance = distance + (decoded[k] - components[k]) * (decoded[k] - components[k]);
+
+                const auto closer = distance < best;
+                best = select(closer, distance, best);
+                for (std::size_t k = 0; k < 3; ++k)
+                    others[k] = select(closer, grid[k], others[k]);
+            }
+        }
+
+        template<typename P>
+        void smallest_three_decode(const P &index, const P (&others)[3], const P &levels, P &x, P &y, P &z, P &w) {
+            using T = typename P::ScalarType;
+            const P zero = P::broadcast(T(0)), one = P::broadcast(T(1));
+            const P two = P::broadcast(T(2)), three = P::broadcast(T(3));
+
+            const P scale = P::broadcast(std::sqrt(T(2))) / levels;
+            const P offset = P::broadcast(std::sqrt(T(0.5)));
+            const P a = others[0] * scale - offset;
+            const P b = others[1] * scale - offset;
+            const P c = others[2] * scale - offset;
+            const P dropped = sqrt(max(one - a * a - b * b - c * c, zero));
+
+            x = select(index < one, dropped, a);
+            y = select(index < one, a, select(index < two, dropped, b));
+            z = select(index < two, b, select(index < three, dropped, c));
+            w = select(index < three, c, dropped);
+        }
+
+        template<std::size_t Bits, typename T, std::size_t Lanes>
+        void pack_smallest_three(const T *index, const T (&others)[3][Lanes], SmallestThree<Bits> *out) {
+            using Packed = SmallestThree<Bits>;
+            for (std::size_t l = 0; l < Lanes; ++l)
+                out[l] = static_cast<Packed>(index[l]) | (static_cast<Packed>(others[0][l]) << 2) |
+                         (static_cast<Packed>(others[1][l]) << (2 + Bits)) |
+                         (static_cast<Packed>(others[2][l]) << (2 + 2 * Bits));
+        }
+
+        template<std::size_t Bits, typename T, std::size_t Lanes>
+        void unpack_smallest_three(const SmallestThree<Bits> *in, T *index, T (&others)[3][Lanes]) {
+            using Packed = SmallestThree<Bits>;
+            const Packed mask = (Packed(1) << Bits) - 1;
+            for (std::size_t l = 0; l < Lanes; ++l) {
+                index[l] = T(in[l] & 3);
+                for (std::size_t k = 0; k < 3; ++k)
+                    others[k][l] = T((in[l] >> (2 + k * Bits)) & mask);
+            }
+        }
+
+        template<std::size_t Bits, typename T>
+        constexpr T smallest_three_levels() {
+            static_assert(Bits >= 2 && Bits <= 20, "smallest three components use 2 to 20 bits");
+            return T((std::uint32_t(1) << Bits) - 1);
+        }
+    }
+
+    // Unit quaternion to 2 + 3 * Bits bits, 10 bits fit a std::uint32_t, up to 20 a std::uint64_t
+    template<std::size_t Bits = 10, typename T>
+    SmallestThree<Bits> encode_smallest_three(const Quaternion<T> &q) {
+        using P = simd::ScalarPack<T>;
+        P index, others[3];
+        detail::smallest_three_encode(P::broadcast(q.x), P::broadcast(q.y), P::broadcast(q.z), P::broadcast(q.w),
+                                      P::broadcast(detail::smallest_three_levels<Bits, T>()), index, others);
+
+        T indexLane[1], otherLanes[3][1];
+        index.store(indexLane);
+        for (std::size_t k = 0; k < 3; ++k)
+            others[k].store(otherLanes[k]);
+        SmallestThree<Bits> packed;
+        detail::pack_smallest_three<Bits>(indexLane, otherLanes, &packed);
+        return packed;
+    }
+
+    template<std::size_t Bits = 10, typename T = float>
+    Quaternion<T> decode_smallest_three(SmallestThree<Bits> packed) {
+        using P = simd::ScalarPack<T>;
+        T indexLane[1], otherLanes[3][1];
+        detail::unpack_smallest_three<Bits>(&packed, indexLane, otherLanes);
+
+        const P others[3] = {P::load(otherLanes[0]), P::load(otherLanes[1]), P::load(otherLanes[2])};
+        P x, y, z, w;
+        detail::smallest_three_decode(P::load(indexLane), others,
+                                      P::broadcast(detail::smallest_three_levels<Bits, T>()), x, y, z, w);
+        return Quaternion<T>{x.v, y.v, z.v, w.v};
+    }
+
+    template<std::size_t Bits = 10, typename T>
+    void encode_smallest_three(const Quaternion<T> *in, SmallestThree<Bits> *out, std::size_t count) {
+        simd::for_each_pack<T>(count, [&](auto pack, std::size_t i) {
+            using P = decltype(pack);
+            P x, y, z, w, index, others[3];
+            detail::load_quaternions(in + i, x, y, z, w);
+            detail::smallest_three_encode(x, y, z, w, P::broadcast(detail::smallest_three_levels<Bits, T>()),
+                                          index, others);
+
+            T indexLanes[P::width], otherLanes[3][P::width];
+            index.store(indexLanes);
+            for (std::size_t k = 0; k < 3; ++k)
+                others[k].store(otherLanes[k]);
+            detail::pack_smallest_three<Bits>(indexLanes, otherLanes, out + i);
+        });
+    }
+
+    template<std::size_t Bits = 10, typename T>
+    void decode_smallest_three(const SmallestThree<Bits> *in, Quaternion<T> *out, std::size_t count) {
+        simd::for_each_pack<T>(count, [&](auto pack, std::size_t i) {
+            using P = decltype(pack);
+            T indexLanes[P::width], otherLanes[3][P::width];
+            detail::unpack_smallest_three<Bits>(in + i, indexLanes, otherLanes);
+
+            const P others[3] = {P::load(otherLanes[0]), P::load(otherLanes[1]), P::load(otherLanes[2])};
+            P x, y, z, w;
+            detail::smallest_three_decode(P::load(indexLanes), others,
+                                          P::broadcast(detail::smallest_three_levels<Bits, T>()), x, y, z, w);
+            detail::store_quaternions(out + i, x, y, z, w);
+        });
+    }
+
+    // Error of decoded values against the originals, in the units of the metric
+    struct EncodingError {
+        double max = 0.0;
+        double mean = 0.0;
+        double rms = 0.0;
+        std::size_t count = 0;
+    };
+
+    namespace detail {
+        template<typename Error>
+        EncodingError measure_error(std::size_t count, Error &&error) {
+            EncodingError result;
+            result.count = count;
+            if (count == 0)
+                return result;
+
+            double sum = 0.0, sumSq = 0.0;
+            for (std::size_t i = 0; i < count; ++i) {
+                const double e = error(i);
+                result.max = e > result.max ? e : result.max;
+                sum += e;
+                sumSq += e * e;
+            }
+            result.mean = sum / double(count);
+            result.rms = std::sqrt(sumSq / double(count));
+            return result;
+        }
+    }
+
+    // |reference - decoded| of scalars
+    template<typename T, typename D>
+    EncodingError absolute_error(const T *reference, const D *decoded, std::size_t count) {
+        return detail::measure_error(count, [&](std::size_t i) {
+            return std::abs(double(reference[i]) - double(decoded[i]));
+        });
+    }
+
+    // Angle in radians between reference and decoded directions
+    template<typename T>
+    EncodingError angular_error(const Vector<T, 3> *reference, const Vector<T, 3> *decoded, std::size_t count) {
+        return detail::measure_error(count, [&](std::size_t i) {
+            const Vector<double, 3> a{double(reference[i].x), double(reference[i].y), double(reference[i].z)};
+            const Vector<double, 3> b{double(decoded[i].x), double(decoded[i].y), double(decoded[i].z)};
+            return std::atan2(Sm::length(Sm::cross(a, b)), Sm::dot(a, b));
+        });
+    }
+
+    // Angle in radians of the rotation between reference and decoded rotations, q and -q count as the same
+    template<typename T>
+    EncodingError angular_error(const Quaternion<T> *reference, const Quaternion<T> *decoded, std::size_t count) {
+        return detail::measure_error(count, [&](std::size_t i) {
+            const Quaternion<double> difference =
+                    reference[i].template Cast<double>().Inverse() * decoded[i].template Cast<double>();
+            const double vector = std::sqrt(difference.x * difference.x + difference.y * difference.y +
+                                            difference.z * difference.z);
+            return 2.0 * std::atan2(vector, std::abs(difference.w));
+        });
+    }
+}
+
+#endif //SLIMEMATHS_ENCODING_H
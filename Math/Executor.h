@@ -0,0 +1,353 @@
+#ifndef SLIMEMATHS_EXECUTOR_H
+#define SLIMEMATHS_EXECUTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Work stealing thread pool behind the parallel batch functions.
+// Sm::parallel_for hands a range out lazily: whoever runs a piece keeps halving it, pushing the upper half on its own
+// deque, until it is no larger than twice the grain. Idle workers steal from the other end of the deques, which holds
+// the oldest and so largest halves, so 32 workers are busy after five splits and uneven kernels balance themselves.
+// The calling thread works on its own call until every chunk is done, which keeps nested calls (the Bvh build,
+// a Gemm inside a parallel_for) deadlock free.
+// Sm::cache_partition cuts at indices where an output array crosses a 64 byte line, so two workers never write
+// the same cache line. Sm::parallel_reduce keeps one padded partial per fixed size chunk and combines them in order,
+// its result does not depend on the thread count.
+//
+//     Executor pool;   // one thread per core, the caller included
+//     Sm::transform_points(pool, mat, in, out, count);
+//     Sm::parallel_for(pool, count, [&](std::size_t begin, std::size_t end) { ... }, Sm::cache_partition(out));
+
+struct Executor;
+
+namespace Sm {
+
+    // How Sm::parallel_for cuts [0, count): pieces of at least grain indices (unless count is smaller), split only at
+    // indices phase + k * step
+    struct Partition {
+        std::size_t grain = 1;
+        std::size_t step = 1;
+        std::size_t phase = 0;
+    };
+
+    namespace detail {
+
+        struct ParallelJob {
+            void (*run)(const void *body, std::size_t begin, std::size_t end);
+            const void *body;
+            Partition partition;
+
+            std::atomic<std::size_t> remaining;   // indices not run yet, the job is done at 0
+            std::atomic<bool> failed{false};
+            std::exception_ptr error;
+
+            // Index to cut [begin, end) at, end or more when the range is not split
+            std::size_t split(std::size_t begin, std::size_t end) const {
+                if (end - begin < 2 * partition.grain)
+                    return end;
+                const std::size_t middle = begin + (end - begin) / 2;
+                std::size_t at = middle < partition.phase ? partition.phase :
+                                 partition.phase + (middle - partition.phase) / partition.step * partition.step;
+
+                /* A piece starting at 0 is not aligned to the steps, its cut may have to move up to keep the grain.
+                 * When the upper half then gets too short the range is run whole */
+                while (at < begin + partition.grain)
+                    at += partition.step;
+                return end - at >= partition.grain ? at : end;
+            }
+        };
+
+        struct ParallelTask {
+            ParallelJob *job;
+            std::size_t begin;
+            std::size_t end;
+        };
+
+        // The executor and deque of the running thread, callers outside a pool use slot 0 of whatever pool they call
+        struct ExecutorContext {
+            const Executor *executor = nullptr;
+            std::size_t slot = 0;
+        };
+
+        inline ExecutorContext &executor_context() {
+            static thread_local ExecutorContext context;
+            return context;
+        }
+    }
+}
+
+struct Executor {
+    // threads counts the calling thread, 0 uses std::thread::hardware_concurrency(), 1 runs everything inline
+    explicit Executor(std::size_t threads = 0) {
+        if (threads == 0)
+            threads = std::thread::hardware_concurrency();
+        threads = std::max<std::size_t>(1, threads);
+
+        _slots.reset(new Slot[threads]);
+        _slotCount = threads;
+        _workers.reserve(threads - 1);
+        for (std::size_t slot = 1; slot < threads; ++slot)
+            _workers.emplace_back([this, slot] { work(slot); });
+    }
+
+    Executor(const Executor &) = delete;
+
+    Executor &operator=(const Executor &) = delete;
+
+    ~Executor() {
+        {
+            std::lock_guard<std::mutex> lock{_sleepMutex};
+            _stop = true;
+        }
+        _wake.notify_all();
+        for (auto &worker: _workers)
+            worker.join();
+    }
+
+    std::size_t threads() const {
+        return _slotCount;
+    }
+
+    // Chunks taken from another thread's deque since construction
+    std::size_t steals() const {
+        return _steals.load(std::memory_order_relaxed);
+    }
+
+    // Runs job over [0, count) and returns once every chunk is done, rethrowing the first exception a chunk threw.
+    // Called by Sm::parallel_for, which owns the job.
+    void run(Sm::detail::ParallelJob &job, std::size_t count) {
+        job.remaining.store(count, std::memory_order_relaxed);
+
+        Sm::detail::ExecutorContext &context = Sm::detail::executor_context();
+        const std::size_t slot = context.executor == this ? context.slot : 0;
+
+        execute(slot, Sm::detail::ParallelTask{&job, 0, count});
+
+        /* Help with whatever is queued, not only this job, until the stolen chunks of this one come back */
+        Sm::detail::ParallelTask task{};
+        while (job.remaining.load(std::memory_order_acquire) != 0) {
+            if (find(slot, task))
+                execute(slot, task);
+            else
+                std::this_thread::yield();
+        }
+
+        if (job.failed.load(std::memory_order_relaxed))
+            std::rethrow_exception(job.error);
+    }
+
+private:
+    struct alignas(64) Slot {
+        std::mutex mutex;
+        std::deque<Sm::detail::ParallelTask> tasks;
+    };
+
+    void work(std::size_t slot) {
+        Sm::detail::executor_context() = Sm::detail::ExecutorContext{this, slot};
+
+        Sm::detail::ParallelTask task{};
+        for (;;) {
+            if (find(slot, task)) {
+                execute(slot, task);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock{_sleepMutex};
+            _wake.wait(lock, [this] { return _stop || _queued.load(std::memory_order_acquire) != 0; });
+            if (_stop)
+                return;
+        }
+    }
+
+    // Splits task down to its grain, queueing the upper halves, then runs what is left
+    void execute(std::size_t slot, Sm::detail::ParallelTask task) {
+        Sm::detail::ParallelJob &job = *task.job;
+        for (std::size_t at = job.split(task.begin, task.end); at < task.end; at = job.split(task.begin, task.end)) {
+            push(slot, Sm::detail::ParallelTask{&job, at, task.end});
+            task.end = at;
+        }
+
+        if (!job.failed.load(std::memory_order_relaxed)) {
+            try {
+                job.run(job.body, task.begin, task.end);
+            } catch (...) {
+                if (!job.failed.exchange(true))
+                    job.error = std::current_exception();
+            }
+        }
+
+        /* The last access to job, the caller may return as soon as it reads 0 */
+        job.remaining.fetch_sub(task.end - task.begin, std::memory_order_acq_rel);
+    }
+
+    void push(std::size_t slot, const Sm::detail::ParallelTask &task) {
+        {
+            std::lock_guard<std::mutex> lock{_slots[slot].mutex};
+            _slots[slot].tasks.push_back(task);
+            _queued.fetch_add(1, std::memory_order_release);
+        }
+
+        /* Taking the lock orders this with a worker that checked _queued and is about to wait */
+        if (!_workers.empty()) {
+            { std::lock_guard<std::mutex> lock{_sleepMutex}; }
+            _wake.notify_one();
+        }
+    }
+
+    // Newest task of our own deque, or else the oldest of someone else's
+    bool find(std::size_t slot, Sm::detail::ParallelTask &task) {
+        if (_queued.load(std::memory_order_acquire) == 0)
+            return false;
+
+        {
+            Slot &own = _slots[slot];
+            std::lock_guard<std::mutex> lock{own.mutex};
+            if (!own.tasks.empty()) {
+                task = own.tasks.back();
+                own.tasks.pop_back();
+                _queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        for (std::size_t i = 1; i < _slotCount; ++i) {
+            Slot &victim = _slots[(slot + i) % _slotCount];
+            std::lock_guard<std::mutex> lock{victim.mutex};
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                _queued.fetch_sub(1, std::memory_order_relaxed);
+                _steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::unique_ptr<Slot[]> _slots;
+    std::size_t _slotCount = 0;
+    std::vector<std::thread> _workers;
+
+    alignas(64) std::atomic<std::size_t> _queued{0};
+    std::atomic<std::size_t> _steals{0};
+
+    std::mutex _sleepMutex;
+    std::condition_variable _wake;
+    bool _stop = false;
+};
+
+namespace Sm {
+
+    // Pool shared by everything that is not given one, one thread per core, started on first use
+    inline Executor &default_executor() {
+        static Executor executor;
+        return executor;
+    }
+
+    // Cuts where out + index starts a 64 byte line, in pieces of at least minBytes of output.
+    // Cut indices are also multiples of multiple (a simd width) so pieces see the same packs as one serial call,
+    // when out is misaligned so both can not hold the line alignment is dropped.
+    template<typename T>
+    Partition cache_partition(const T *out, std::size_t minBytes = 16 * 1024, std::size_t multiple = 1) {
+        const auto gcd = [](std::size_t a, std::size_t b) {
+            while (b != 0) {
+                const std::size_t rest = a % b;
+                a = b;
+                b = rest;
+            }
+            return a;
+        };
+
+        const std::size_t line = 64;
+        const std::size_t lineStep = line / gcd(sizeof(T), line);
+        multiple = std::max<std::size_t>(1, multiple);
+
+        Partition partition;
+        partition.step = multiple;
+        const std::size_t step = lineStep / gcd(lineStep, multiple) * multiple;
+        const auto address = reinterpret_cast<std::uintptr_t>(out);
+        for (std::size_t i = 0; i < step; i += multiple)
+            if ((address + i * sizeof(T)) % line == 0) {
+                partition.step = step;
+                partition.phase = i;
+                break;
+            }
+
+        const std::size_t elements = std::max<std::size_t>(1, minBytes / sizeof(T));
+        partition.grain = (elements + partition.step - 1) / partition.step * partition.step;
+        return partition;
+    }
+
+    // Calls body(begin, end) on disjoint pieces covering [0, count), spread over the executor's threads.
+    // Returns when all are done, an exception thrown by body skips the pieces not started yet and is rethrown here.
+    template<typename Body>
+    void parallel_for(Executor &executor, std::size_t count, Body &&body, const Partition &partition = {}) {
+        if (count == 0)
+            return;
+        if (executor.threads() == 1 || count < 2 * partition.grain) {
+            body(std::size_t(0), count);
+            return;
+        }
+
+        using BodyType = typename std::remove_reference<Body>::type;
+        detail::ParallelJob job;
+        job.run = [](const void *function, std::size_t begin, std::size_t end) {
+            (*static_cast<BodyType *>(const_cast<void *>(function)))(begin, end);
+        };
+        job.body = &body;
+        job.partition = partition;
+        job.partition.grain = std::max<std::size_t>(1, partition.grain);
+        job.partition.step = std::max<std::size_t>(1, partition.step);
+        executor.run(job, count);
+    }
+
+    // combine(... combine(combine(identity, map(0, grain)), map(grain, 2 * grain)) ..., map(.., count)).
+    // The chunks are fixed, so for a given grain the result is the same for every thread count and schedule.
+    template<typename T, typename Map, typename Combine>
+    T parallel_reduce(Executor &executor, std::size_t count, std::size_t grain, const T &identity, Map &&map,
+                      Combine &&combine) {
+        grain = std::max<std::size_t>(1, grain);
+        const std::size_t chunks = (count + grain - 1) / grain;
+
+        /* Every partial on its own cache line, workers finishing neighbouring chunks do not share one */
+        struct alignas(64) Partial {
+            T value;
+        };
+        std::vector<Partial> partials(chunks, Partial{identity});
+
+        parallel_for(executor, chunks, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t c = begin; c < end; ++c)
+                partials[c].value = map(c * grain, std::min(count, (c + 1) * grain));
+        });
+
+        T result = identity;
+        for (const Partial &partial: partials)
+            result = combine(result, partial.value);
+        return result;
+    }
+
+    // Runs first() and second(), possibly at the same time
+    template<typename First, typename Second>
+    void parallel_invoke(Executor &executor, First &&first, Second &&second) {
+        parallel_for(executor, 2, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                if (i == 0)
+                    first();
+                else
+                    second();
+            }
+        });
+    }
+}
+
+#endif //SLIMEMATHS_EXECUTOR_H
@@ -0,0 +1,302 @@
+#ifndef SLIMEMATHS_EXPRESSION_H
+#define SLIMEMATHS_EXPRESSION_H
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include "ForwardDecl.h"
+
+// Opt-in lazy element-wise expressions for Vector and Matrix.
+// The regular operators build a full temporary for every step, so a * s + b * t - c copies three times.
+// Wrapping operands in Sm::lazy() makes the operators build a small expression tree instead,
+// which is evaluated in a single loop with one store per element when it is assigned:
+//
+//     Vec3 r = Sm::lazy(a) * s + Sm::lazy(b) * t - c;
+//
+// Only operators that see an expression are lazy, b * t on its own would still be an eager temporary.
+//
+// Results match the eager operators bit for bit.
+// Expressions hold references to their Vector/Matrix operands, so never keep one in an `auto` variable
+// past the end of the statement; call eval() or assign it to a Vector/Matrix instead.
+//
+// Vectors support + - * / (element-wise and with scalars) and unary -.
+// Matrices support + - and scaling; a matrix product evaluates its expression operands and then multiplies eagerly.
+
+namespace Sm {
+    namespace detail {
+
+        template<typename T>
+        struct ExpressionTraits {
+            static const bool operand = false;
+        };
+
+        template<typename T, std::size_t N>
+        struct ExpressionTraits<Vector<T, N>> {
+            static const bool operand = true;
+            static const bool elementWise = true;
+            static const std::size_t size = N;
+            using ScalarType = T;
+        };
+
+        template<typename T, std::size_t Rows, std::size_t Cols>
+        struct ExpressionTraits<Matrix<T, Rows, Cols>> {
+            static const bool operand = true;
+            static const bool elementWise = false;
+            static const std::size_t size = Rows * Cols;
+            using ScalarType = T;
+        };
+
+        struct ExpressionTag {
+        };
+
+        // CRTP base of every expression node, Derived provides element(i)
+        template<typename Derived, typename Result>
+        struct Expression : ExpressionTag {
+            using ResultType = Result;
+            using ScalarType = typename ExpressionTraits<Result>::ScalarType;
+            static const std::size_t size = ExpressionTraits<Result>::size;
+
+            constexpr ScalarType operator[](std::size_t i) const {
+                return static_cast<const Derived &>(*this).element(i);
+            }
+
+            constexpr Result eval() const {
+                Result result;
+                assign(result, std::make_index_sequence<size>{});
+                return result;
+            }
+
+            constexpr operator Result() const {
+                return eval();
+            }
+
+        private:
+            /* Unrolled at compile time so the whole tree collapses into straight line code per element */
+            template<std::size_t... I>
+            constexpr void assign(Result &result, std::index_sequence<I...>) const {
+                const Derived &self = static_cast<const Derived &>(*this);
+                ((result[I] = self.element(I)), ...);
+            }
+        };
+
+        template<typename Result>
+        struct Terminal : Expression<Terminal<Result>, Result> {
+            const Result &value;
+
+            constexpr explicit Terminal(const Result &value) : value{value} {}
+
+            constexpr typename Terminal::ScalarType element(std::size_t i) const {
+                return value[i];
+            }
+        };
+
+        template<typename L, typename R, typename Op>
+        struct BinaryExpression : Expression<BinaryExpression<L, R, Op>, typename L::ResultType> {
+            L lhs;
+            R rhs;
+
+            constexpr BinaryExpression(const L &lhs, const R &rhs) : lhs{lhs}, rhs{rhs} {}
+
+            constexpr typename BinaryExpression::ScalarType element(std::size_t i) const {
+                return Op::apply(lhs.element(i), rhs.element(i));
+            }
+        };
+
+        // Expression op scalar
+        template<typename E, typename Op>
+        struct ScalarRightExpression : Expression<ScalarRightExpression<E, Op>, typename E::ResultType> {
+            using ScalarType = typename E::ScalarType;
+
+            E lhs;
+            ScalarType rhs;
+
+            constexpr ScalarRightExpression(const E &lhs, const ScalarType &rhs) : lhs{lhs}, rhs{rhs} {}
+
+            constexpr ScalarType element(std::size_t i) const {
+                return Op::apply(lhs.element(i), rhs);
+            }
+        };
+
+        // Scalar op expression
+        template<typename E, typename Op>
+        struct ScalarLeftExpression : Expression<ScalarLeftExpression<E, Op>, typename E::ResultType> {
+            using ScalarType = typename E::ScalarType;
+
+            ScalarType lhs;
+            E rhs;
+
+            constexpr ScalarLeftExpression(const ScalarType &lhs, const E &rhs) : lhs{lhs}, rhs{rhs} {}
+
+            constexpr ScalarType element(std::size_t i) const {
+                return Op::apply(lhs, rhs.element(i));
+            }
+        };
+
+        template<typename E>
+        struct NegateExpression : Expression<NegateExpression<E>, typename E::ResultType> {
+            E value;
+
+            constexpr explicit NegateExpression(const E &value) : value{value} {}
+
+            constexpr typename NegateExpression::ScalarType element(std::size_t i) const {
+                return -value.element(i);
+            }
+        };
+
+        struct AddOp {
+            template<typename T>
+            static constexpr T apply(const T &a, const T &b) { return a + b; }
+        };
+
+        struct SubtractOp {
+            template<typename T>
+            static constexpr T apply(const T &a, const T &b) { return a - b; }
+        };
+
+        struct MultiplyOp {
+            template<typename T>
+            static constexpr T apply(const T &a, const T &b) { return a * b; }
+        };
+
+        struct DivideOp {
+            template<typename T>
+            static constexpr T apply(const T &a, const T &b) { return a / b; }
+        };
+
+        template<typename T>
+        struct IsExpression : std::is_base_of<ExpressionTag, T> {
+        };
+
+        // Vectors and matrices used next to an expression are wrapped in a Terminal, expressions pass through
+        template<typename T, bool = IsExpression<T>::value>
+        struct AsExpression {
+            using Type = Terminal<T>;
+            using ResultType = T;
+        };
+
+        template<typename T>
+        struct AsExpression<T, true> {
+            using Type = T;
+            using ResultType = typename T::ResultType;
+        };
+
+        template<typename E>
+        constexpr const E &as_expression(const E &e, std::true_type) {
+            return e;
+        }
+
+        template<typename R>
+        constexpr Terminal<R> as_expression(const R &r, std::false_type) {
+            return Terminal<R>{r};
+        }
+
+        template<typename T>
+        constexpr typename AsExpression<T>::Type as_expression(const T &value) {
+            return as_expression(value, IsExpression<T>{});
+        }
+
+        template<typename T, bool = IsExpression<T>::value || ExpressionTraits<T>::operand>
+        struct ExpressionResult {
+        };
+
+        template<typename T>
+        struct ExpressionResult<T, true> {
+            using Type = typename AsExpression<T>::ResultType;
+        };
+
+        // Enabled when at least one side is an expression and both sides produce the same type
+        template<typename L, typename R, bool ElementWiseOnly, typename = void>
+        struct EnableBinary {
+        };
+
+        template<typename L, typename R, bool ElementWiseOnly>
+        struct EnableBinary<L, R, ElementWiseOnly, typename std::enable_if<
+                (IsExpression<L>::value || IsExpression<R>::value) &&
+                std::is_same<typename ExpressionResult<L>::Type, typename ExpressionResult<R>::Type>::value &&
+                (!ElementWiseOnly || ExpressionTraits<typename ExpressionResult<L>::Type>::elementWise)>::type> {
+            template<typename Op>
+            using With = BinaryExpression<typename AsExpression<L>::Type, typename AsExpression<R>::Type, Op>;
+        };
+
+        template<typename E, bool ElementWiseOnly>
+        using EnableScalar = typename std::enable_if<
+                IsExpression<E>::value && (!ElementWiseOnly || ExpressionTraits<typename E::ResultType>::elementWise),
+                E>::type;
+
+        // -- Operators, found through argument dependent lookup on the expression operand --
+
+        template<typename L, typename R>
+        constexpr typename EnableBinary<L, R, false>::template With<AddOp> operator+(const L &lhs, const R &rhs) {
+            return {as_expression(lhs), as_expression(rhs)};
+        }
+
+        template<typename L, typename R>
+        constexpr typename EnableBinary<L, R, false>::template With<SubtractOp> operator-(const L &lhs, const R &rhs) {
+            return {as_expression(lhs), as_expression(rhs)};
+        }
+
+        template<typename L, typename R>
+        constexpr typename EnableBinary<L, R, true>::template With<MultiplyOp> operator*(const L &lhs, const R &rhs) {
+            return {as_expression(lhs), as_expression(rhs)};
+        }
+
+        template<typename L, typename R>
+        constexpr typename EnableBinary<L, R, true>::template With<DivideOp> operator/(const L &lhs, const R &rhs) {
+            return {as_expression(lhs), as_expression(rhs)};
+        }
+
+        // Matrix products evaluate their expression operands first and then use the eager product
+        template<typename L, typename R, typename = typename std::enable_if<
+                (IsExpression<L>::value || IsExpression<R>::value) &&
+                !ExpressionTraits<typename ExpressionResult<L>::Type>::elementWise &&
+                !ExpressionTraits<typename ExpressionResult<R>::Type>::elementWise>::type>
+        constexpr auto operator*(const L &lhs, const R &rhs) {
+            const typename ExpressionResult<L>::Type &l = lhs;
+            const typename ExpressionResult<R>::Type &r = rhs;
+            return l * r;
+        }
+
+        template<typename E>
+        constexpr ScalarRightExpression<EnableScalar<E, false>, MultiplyOp>
+        operator*(const E &lhs, const typename E::ScalarType &rhs) {
+            return {lhs, rhs};
+        }
+
+        //! \note Evaluated as (rhs * lhs) like the eager operator.
+        template<typename E>
+        constexpr ScalarRightExpression<EnableScalar<E, false>, MultiplyOp>
+        operator*(const typename E::ScalarType &lhs, const E &rhs) {
+            return {rhs, lhs};
+        }
+
+        template<typename E>
+        constexpr ScalarRightExpression<EnableScalar<E, true>, DivideOp>
+        operator/(const E &lhs, const typename E::ScalarType &rhs) {
+            return {lhs, rhs};
+        }
+
+        template<typename E>
+        constexpr ScalarLeftExpression<EnableScalar<E, true>, DivideOp>
+        operator/(const typename E::ScalarType &lhs, const E &rhs) {
+            return {lhs, rhs};
+        }
+
+        template<typename E>
+        constexpr NegateExpression<EnableScalar<E, true>> operator-(const E &value) {
+            return NegateExpression<E>{value};
+        }
+    }
+
+    // Starts a lazy expression, see the top of this file
+    template<typename T, std::size_t N>
+    constexpr detail::Terminal<Vector<T, N>> lazy(const Vector<T, N> &vec) {
+        return detail::Terminal<Vector<T, N>>{vec};
+    }
+
+    template<typename T, std::size_t Rows, std::size_t Cols>
+    constexpr detail::Terminal<Matrix<T, Rows, Cols>> lazy(const Matrix<T, Rows, Cols> &mat) {
+        return detail::Terminal<Matrix<T, Rows, Cols>>{mat};
+    }
+}
+
+#endif //SLIMEMATHS_EXPRESSION_H
@@ -0,0 +1,345 @@
+#ifndef SLIMEMATHS_FASTMATH_H
+#define SLIMEMATHS_FASTMATH_H
+
+#include <cstddef>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include "SimdPack.h"
+#include "SlimeAlgebra.h"
+#include "VectorArray.h"
+#include "Quaternion.h"
+
+// Approximate versions of the Sm:: functions for hot loops.
+// Everything in Sm::fast mirrors a precise Sm:: function of the same name; the precise defaults are untouched.
+//
+// rsqrt uses the hardware estimate plus one Newton-Raphson step for float (falls back to 1 / sqrt elsewhere).
+// sin/cos reduce to [-pi/2, pi/2] and evaluate an odd minimax polynomial, acos/asin use sqrt(1 - x) * P(x)
+// with a minimax P. Both are fitted per precision, so double gets more terms than float.
+// The *_max_error() functions give the measured worst case over the documented domain, exhaustive for float
+// and densely sampled for double.
+//
+// A single scalar sin/cos/acos is roughly on par with a good libm, the win is in loops: the kernels are
+// branch free and have batch overloads that run a whole simd pack per instruction (several times std::).
+
+namespace Sm {
+    namespace fast {
+
+        // Largest relative error of rsqrt(x) for positive normal x. The float estimate is NaN for 0 and +inf, not
+        // inf and 0, so callers that can see them have to test first like fast::sqrt does.
+        template<typename T>
+        constexpr T rsqrt_max_error() {
+            return std::is_same<T, float>::value ? T(3e-7) : std::numeric_limits<T>::epsilon();
+        }
+
+        // Largest absolute error of sin(x) and cos(x) for |x| <= 8192
+        template<typename T>
+        constexpr T sin_max_error() {
+            return std::is_same<T, float>::value ? T(1.8e-7) : T(6.5e-14);
+        }
+
+        // Largest absolute error of acos(x) for x in [-1, 1], asin adds at most one rounding
+        template<typename T>
+        constexpr T acos_max_error() {
+            return std::is_same<T, float>::value ? T(4.4e-7) : T(3.2e-11);
+        }
+
+        namespace detail {
+
+            // Any other type goes through the standard library
+            template<typename T>
+            struct FastTrig {
+                using S = simd::ScalarPack<T>;
+
+                static S sin(const S &x) { return S{T(std::sin(x.v))}; }
+
+                static S cos(const S &x) { return S{T(std::cos(x.v))}; }
+
+                static S acos(const S &x) { return S{T(std::acos(x.v))}; }
+            };
+
+            // Written once over simd packs, the scalar functions run the same code on a ScalarPack so batch and
+            // scalar results match bit for bit. Every step is plain arithmetic, there are no branches to mispredict.
+            // pi is split in three parts with trailing zero bits so k * pi reduces exactly for moderate k (Cody-Waite)
+            template<typename T, typename Coefficients>
+            struct FastTrigImpl {
+                // sin(r) for r in [-pi/2, pi/2]
+                template<typename P>
+                static P sin_reduced(const P &r) {
+                    const P u = r * r;
+                    P p = P::broadcast(Coefficients::sin[Coefficients::sinTerms - 1]);
+                    for (std::size_t i = Coefficients::sinTerms - 1; i-- > 0;)
+                        p = p * u + P::broadcast(Coefficients::sin[i]);
+                    return p * r;
+                }
+
+                // x - k * pi
+                template<typename P>
+                static P reduce(const P &x, const P &k) {
+                    P r = x - k * P::broadcast(Coefficients::pi0);
+                    r = r - k * P::broadcast(Coefficients::pi1);
+                    return r - k * P::broadcast(Coefficients::pi2);
+                }
+
+                /* Adding 1.5 * 2^mantissa pushes the fraction out of the mantissa, exact for |x| < 2^(mantissa - 1).
+                 * Needs strict IEEE arithmetic, -ffast-math may fold the pair away. */
+                template<typename P>
+                static P round(const P &x) {
+                    const P magic = P::broadcast(Coefficients::roundMagic);
+                    return (x + magic) - magic;
+                }
+
+                // (-1)^n for a whole n
+                template<typename P>
+                static P sign(const P &n) {
+                    const P one = P::broadcast(T(1));
+                    const P two = P::broadcast(T(2));
+                    return one - two * abs(n - two * round(n * P::broadcast(T(0.5))));
+                }
+
+                // sin(x) = (-1)^n sin(x - n * pi)
+                template<typename P>
+                static P sin(const P &x) {
+                    const P n = round(x * P::broadcast(Coefficients::invPi));
+                    return sin_reduced(reduce(x, n)) * sign(n);
+                }
+
+                // cos(x) = (-1)^(n + 1) sin(x - (n + 1/2) * pi)
+                template<typename P>
+                static P cos(const P &x) {
+                    const P half = P::broadcast(T(0.5));
+                    const P n = round(x * P::broadcast(Coefficients::invPi) - half);
+                    return -(sin_reduced(reduce(x, n + half)) * sign(n));
+                }
+
+                template<typename P>
+                static P acos(const P &x) {
+                    const P one = P::broadcast(T(1));
+                    const P a = min(abs(x), one);
+                    P p = P::broadcast(Coefficients::acos[Coefficients::acosTerms - 1]);
+                    for (std::size_t i = Coefficients::acosTerms - 1; i-- > 0;)
+                        p = p * a + P::broadcast(Coefficients::acos[i]);
+                    p = p * sqrt(one - a);
+
+                    /* acos(-x) = pi - acos(x) */
+                    const P pi = P::broadcast(Coefficients::pi0 + Coefficients::pi1 + Coefficients::pi2);
+                    return select(x < P::broadcast(T(0)), pi - p, p);
+                }
+            };
+
+            struct FloatTrigCoefficients {
+                static constexpr float invPi = 0.318309886183790671538f;
+                static constexpr float pi0 = 3.140625f;
+                static constexpr float pi1 = 9.67502593994140625e-4f;
+                static constexpr float pi2 = 1.509957990978376432e-7f;
+                static constexpr float roundMagic = 12582912.0f;
+
+                /* x * P(x^2) on [-pi/2, pi/2], relative error 5.3e-9 */
+                static constexpr std::size_t sinTerms = 5;
+                static constexpr float sin[sinTerms] = {
+                        0.99999999468640395f, -0.16666656684207537f, 0.0083330251417645294f,
+                        -0.00019807418873667883f, 2.6019033247186317e-06f
+                };
+
+                /* acos(x) / sqrt(1 - x) on [0, 1], relative error 1.5e-8 */
+                static constexpr std::size_t acosTerms = 8;
+                static constexpr float acos[acosTerms] = {
+                        1.5707963039207534f, -0.21459869660979079f, 0.088977312159741076f,
+                        -0.050164188267895368f, 0.030862750954287569f, -0.017045101294044395f,
+                        0.006638617826286152f, -0.0012534569101727291f
+                };
+            };
+
+            struct DoubleTrigCoefficients {
+                static constexpr double invPi = 0.318309886183790671538;
+                static constexpr double pi0 = 3.14159250259399414062;
+                static constexpr double pi1 = 1.50995788317231941e-7;
+                static constexpr double pi2 = 1.07806057163162381e-14;
+                static constexpr double roundMagic = 6755399441055744.0;
+
+                /* relative error 6.5e-14 */
+                static constexpr std::size_t sinTerms = 7;
+                static constexpr double sin[sinTerms] = {
+                        0.9999999999999346, -0.16666666666424858, 0.0083333333184456466,
+                        -0.00019841266360208373, 2.7556928127594385e-06, -2.5029387986615887e-08,
+                        1.5399465543115214e-10
+                };
+
+                /* relative error 3.1e-11 */
+                static constexpr std::size_t acosTerms = 14;
+                static constexpr double acos[acosTerms] = {
+                        1.5707963268157575, -0.21460184451662552, 0.089049105953879327,
+                        -0.050804172874159213, 0.033817812325016906, -0.025339344817218689,
+                        0.023007481549724724, -0.027815610594874998, 0.038333293865372651,
+                        -0.045879807141965684, 0.040434667391683174, -0.023738145553593787,
+                        0.0082196924698244712, -0.0012658925436557929
+                };
+            };
+
+            template<>
+            struct FastTrig<float> : FastTrigImpl<float, FloatTrigCoefficients> {
+            };
+
+            template<>
+            struct FastTrig<double> : FastTrigImpl<double, DoubleTrigCoefficients> {
+            };
+        }
+
+        // 1 / sqrt(x), see simd::rsqrt
+        template<typename T>
+        T rsqrt(const T &x) {
+            return simd::rsqrt(x);
+        }
+
+        // 0 for x <= 0, +inf and NaN pass through like std::sqrt
+        template<typename T>
+        T sqrt(const T &x) {
+            if (x > T(0) && x <= std::numeric_limits<T>::max())
+                return x * rsqrt(x);
+            return x > T(0) || x != x ? x : T(0);
+        }
+
+        template<typename T>
+        T sin(const T &x) {
+            return detail::FastTrig<T>::sin(simd::ScalarPack<T>{x}).v;
+        }
+
+        template<typename T>
+        T cos(const T &x) {
+            return detail::FastTrig<T>::cos(simd::ScalarPack<T>{x}).v;
+        }
+
+        // x is clamped to [-1, 1]
+        template<typename T>
+        T acos(const T &x) {
+            return detail::FastTrig<T>::acos(simd::ScalarPack<T>{x}).v;
+        }
+
+        template<typename T>
+        T asin(const T &x) {
+            return T(1.57079632679489661923) - fast::acos(x);
+        }
+
+        template<typename VectorType, typename ScalarType = typename VectorType::ScalarType>
+        ScalarType length(const VectorType &vec) {
+            return fast::sqrt(Sm::length_sq<VectorType, ScalarType>(vec));
+        }
+
+        template<typename VectorType, typename ScalarType = typename VectorType::ScalarType>
+        ScalarType angle(const VectorType &lhs, const VectorType &rhs) {
+            /* One rsqrt per length, the product of the squared lengths leaves the float range far sooner */
+            return fast::acos(Sm::dot<VectorType, ScalarType>(lhs, rhs) *
+                              fast::rsqrt(Sm::length_sq<VectorType, ScalarType>(lhs)) *
+                              fast::rsqrt(Sm::length_sq<VectorType, ScalarType>(rhs)));
+        }
+
+        template<typename VectorType, typename ScalarType = typename VectorType::ScalarType>
+        ScalarType angle_norm(const VectorType &lhs, const VectorType &rhs) {
+            return fast::acos(Sm::dot<VectorType, ScalarType>(lhs, rhs));
+        }
+
+        template<typename VectorType, typename ScalarType = typename VectorType::ScalarType>
+        void normalize(VectorType &vec) {
+            const auto len = Sm::length_sq<VectorType, ScalarType>(vec);
+            if (len != ScalarType(0) && len != ScalarType(1))
+                vec *= fast::rsqrt(len);
+        }
+
+        template<typename VectorType, typename ScalarType = typename VectorType::ScalarType>
+        void resize(VectorType &vec, const ScalarType &length) {
+            const auto len = Sm::length_sq<VectorType, ScalarType>(vec);
+            if (len != ScalarType(0))
+                vec *= length * fast::rsqrt(len);
+        }
+
+        template<typename VectorType, typename ScalarType = typename VectorType::ScalarType>
+        VectorType slerp(const VectorType &from, const VectorType &to, const ScalarType &t) {
+            ScalarType cosom = Sm::dot<VectorType, ScalarType>(from, to);
+            ScalarType scale0, scale1 = ScalarType(1);
+
+            if (cosom < ScalarType(0)) {
+                cosom = -cosom;
+                scale1 = ScalarType(-1);
+            }
+
+            if ((ScalarType(1) - cosom) > std::numeric_limits<ScalarType>::epsilon()) {
+                const ScalarType omega = fast::acos(cosom);
+                const ScalarType invSinom = ScalarType(1) / fast::sin(omega);
+                scale0 = fast::sin((ScalarType(1) - t) * omega) * invSinom;
+                scale1 *= fast::sin(t * omega) * invSinom;
+            } else {
+                scale0 = ScalarType(1) - t;
+                scale1 *= t;
+            }
+
+            return Sm::mix(from, to, scale0, scale1);
+        }
+
+        // Same as Quaternion::get_angle_axis
+        template<typename T>
+        void get_angle_axis(const Quaternion<T> &q, Vector<T, 3> &axis, T &angle) {
+            const T scaleSq = q.x * q.x + q.y * q.y + q.z * q.z;
+
+            if (scaleSq <= std::numeric_limits<T>::epsilon() * std::numeric_limits<T>::epsilon() ||
+                q.w > T(1) || q.w < T(-1)) {
+                axis = Vector<T, 3>{T(0), T(1), T(0)};
+                angle = T(0);
+            } else {
+                const T invScale = fast::rsqrt(scaleSq);
+                axis = Vector<T, 3>{q.x * invScale, q.y * invScale, q.z * invScale};
+                angle = T(2) * fast::acos(q.w);
+            }
+        }
+
+        // Batch versions over plain arrays, output may alias input
+        template<typename T>
+        void sin(const T *input, T *output, std::size_t count) {
+            simd::for_each_pack<T>(count, [&](auto pack, std::size_t i) {
+                using P = decltype(pack);
+                detail::FastTrig<T>::sin(P::load(input + i)).store(output + i);
+            });
+        }
+
+        template<typename T>
+        void cos(const T *input, T *output, std::size_t count) {
+            simd::for_each_pack<T>(count, [&](auto pack, std::size_t i) {
+                using P = decltype(pack);
+                detail::FastTrig<T>::cos(P::load(input + i)).store(output + i);
+            });
+        }
+
+        template<typename T>
+        void acos(const T *input, T *output, std::size_t count) {
+            simd::for_each_pack<T>(count, [&](auto pack, std::size_t i) {
+                using P = decltype(pack);
+                detail::FastTrig<T>::acos(P::load(input + i)).store(output + i);
+            });
+        }
+
+        // Batch normalize, a pack of rsqrt estimates per instruction
+        template<typename T, std::size_t N>
+        void normalize(VectorArray<T, N> &vectors) {
+            simd::for_each_pack<T>(vectors.size(), [&](auto pack, std::size_t i) {
+                using P = decltype(pack);
+
+                P lenSq = P::broadcast(T(0));
+                for (std::size_t c = 0; c < N; ++c) {
+                    const P v = P::load(vectors.component(c) + i);
+                    lenSq = lenSq + v * v;
+                }
+
+                const P zero = P::broadcast(T(0));
+                const P one = P::broadcast(T(1));
+                const auto skip = (lenSq == zero) | (lenSq == one);
+                const P scale = select(skip, one, rsqrt(lenSq));
+
+                for (std::size_t c = 0; c < N; ++c) {
+                    T *stream = vectors.component(c) + i;
+                    (P::load(stream) * scale).store(stream);
+                }
+            });
+        }
+    }
+}
+
+#endif //SLIMEMATHS_FASTMATH_H
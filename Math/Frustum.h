@@ -0,0 +1,297 @@
+#ifndef SLIMEMATHS_FRUSTUM_H
+#define SLIMEMATHS_FRUSTUM_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <type_traits>
+#include <ostream>
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix.h"
+#include "AABB.h"
+#include "VectorArray.h"
+#include "QuaternionConversion.h"
+#include "SimdPack.h"
+
+// Plane dot(normal, p) + d = 0, stored as the Vec4 (normal.x, normal.y, normal.z, d).
+// Positive distances are on the side the normal points to.
+template<typename T>
+struct Plane {
+    static_assert(std::is_floating_point<T>::value, "planes can only be used with floating point types");
+
+    using ScalarType = T;
+
+    // Constructors
+    constexpr Plane() : equation{T(0), T(1), T(0), T(0)} {}
+
+    constexpr Plane(const Plane<T> &rhs) = default;
+
+    explicit constexpr Plane(const Vector<T, 4> &equation) : equation{equation} {}
+
+    constexpr Plane(const Vector<T, 3> &normal, const T &d) : equation{normal, d} {}
+
+    // Plane through point facing normal
+    constexpr Plane(const Vector<T, 3> &normal, const Vector<T, 3> &point) :
+            equation{normal, -Sm::dot(normal, point)} {}
+
+    constexpr Plane<T> &operator=(const Plane<T> &rhs) = default;
+
+    // Functions
+    constexpr Vector<T, 3> normal() const {
+        return Vector<T, 3>{equation.x, equation.y, equation.z};
+    }
+
+    constexpr T d() const {
+        return equation.w;
+    }
+
+    // Signed distance, in units of the normal length
+    constexpr T distance(const Vector<T, 3> &point) const {
+        return equation.x * point.x + equation.y * point.y + equation.z * point.z + equation.w;
+    }
+
+    // Unit normal, so distance() is euclidean
+    void Normalize() {
+        const T length = std::sqrt(equation.x * equation.x + equation.y * equation.y + equation.z * equation.z);
+        if (length == T(0))
+            return;
+
+        equation *= T(1) / length;
+    }
+
+    Plane<T> Normalized() const {
+        auto result = *this;
+        result.Normalize();
+        return result;
+    }
+
+    // OStream Overrider
+    friend std::ostream &operator<<(std::ostream &os, const Plane<T> &plane) {
+        os << "[" << plane.equation.x << ", " << plane.equation.y << ", " << plane.equation.z << "; "
+           << plane.equation.w << "]";
+        return os;
+    }
+
+    Vector<T, 4> equation;
+};
+
+namespace Sm {
+    // Clip space depth range of the projection a frustum is extracted from
+    enum class ClipDepth {
+        NegativeOneToOne, // OpenGL: -w <= z <= w
+        ZeroToOne         // Direct3D, Vulkan, Metal: 0 <= z <= w
+    };
+}
+
+// The six planes of a view volume, normals point inside and are unit length.
+// Planes are extracted from a (view) projection matrix with the Gribb-Hartmann method, the matrix follows
+// the column vector convention of the rest of the library (clip = matrix * point), so world space planes
+// come from a view projection matrix and view space planes from a projection matrix alone.
+template<typename T>
+struct Frustum {
+    static_assert(std::is_floating_point<T>::value, "frustums can only be used with floating point types");
+
+    using ScalarType = T;
+
+    enum PlaneIndex {
+        Left, Right, Bottom, Top, Near, Far
+    };
+
+    static const std::size_t planeCount = 6;
+
+    // Constructors
+    constexpr Frustum() = default;
+
+    explicit Frustum(const Matrix<T, 4, 4> &matrix, Sm::ClipDepth depth = Sm::ClipDepth::NegativeOneToOne) {
+        const auto row = [&matrix](std::size_t r) {
+            return Vector<T, 4>{matrix(r, 0), matrix(r, 1), matrix(r, 2), matrix(r, 3)};
+        };
+        const Vector<T, 4> x = row(0), y = row(1), z = row(2), w = row(3);
+
+        planes[Left] = Plane<T>{w + x};
+        planes[Right] = Plane<T>{w - x};
+        planes[Bottom] = Plane<T>{w + y};
+        planes[Top] = Plane<T>{w - y};
+        planes[Near] = Plane<T>{depth == Sm::ClipDepth::ZeroToOne ? z : w + z};
+        planes[Far] = Plane<T>{w - z};
+
+        for (auto &plane: planes)
+            plane.Normalize();
+    }
+
+    // Functions
+    bool contains(const Vector<T, 3> &point) const {
+        bool inside = true;
+        for (const auto &plane: planes)
+            inside &= plane.distance(point) >= T(0);
+        return inside;
+    }
+
+    // False only when the sphere is completely outside one plane
+    bool intersects_sphere(const Vector<T, 3> &center, const T &radius) const {
+        bool inside = true;
+        for (const auto &plane: planes)
+            inside &= plane.distance(center) >= -radius;
+        return inside;
+    }
+
+    // False only when the box is completely outside one plane, boxes straddling two planes
+    // outside a corner of the frustum are conservatively reported as intersecting
+    bool intersects_aabb(const Vector<T, 3> &min, const Vector<T, 3> &max) const {
+        const Vector<T, 3> center = (min + max) * T(0.5);
+        const Vector<T, 3> extent = (max - min) * T(0.5);
+
+        bool inside = true;
+        for (const auto &plane: planes) {
+            const T reach = std::abs(plane.equation.x) * extent.x + std::abs(plane.equation.y) * extent.y +
+                            std::abs(plane.equation.z) * extent.z;
+            inside &= plane.distance(center) + reach >= T(0);
+        }
+        return inside;
+    }
+
+    bool intersects_aabb(const AABB<T> &box) const {
+        return intersects_aabb(box.min, box.max);
+    }
+
+    Plane<T> planes[planeCount];
+};
+
+using Planef = Plane<float>;
+using Planed = Plane<double>;
+
+using Frustumf = Frustum<float>;
+using Frustumd = Frustum<double>;
+
+// Batch culling, every overload writes the indices of the visible objects to visible (in ascending order,
+// visible must have room for count indices) and returns how many there are.
+// Objects are tested a simd pack at a time against all six planes without early outs, the results match the
+// Frustum member functions exactly.
+namespace Sm {
+    namespace detail {
+
+        // The planes broadcast to every lane
+        template<typename P, typename T>
+        struct FrustumPack {
+            explicit FrustumPack(const Frustum<T> &frustum) {
+                for (std::size_t p = 0; p < Frustum<T>::planeCount; ++p) {
+                    const Vector<T, 4> &e = frustum.planes[p].equation;
+                    nx[p] = P::broadcast(e.x);
+                    ny[p] = P::broadcast(e.y);
+                    nz[p] = P::broadcast(e.z);
+                    d[p] = P::broadcast(e.w);
+                    ax[p] = P::broadcast(std::abs(e.x));
+                    ay[p] = P::broadcast(std::abs(e.y));
+                    az[p] = P::broadcast(std::abs(e.z));
+                }
+            }
+
+            int spheres(const P &x, const P &y, const P &z, const P &radius) const {
+                const P reach = -radius;
+                auto inside = (nx[0] * x + ny[0] * y + nz[0] * z + d[0]) >= reach;
+                for (std::size_t p = 1; p < Frustum<T>::planeCount; ++p)
+                    inside = inside & ((nx[p] * x + ny[p] * y + nz[p] * z + d[p]) >= reach);
+                return bits(inside);
+            }
+
+            int aabbs(const P &minX, const P &minY, const P &minZ, const P &maxX, const P &maxY, const P &maxZ) const {
+                const P half = P::broadcast(T(0.5));
+                const P cx = (minX + maxX) * half, cy = (minY + maxY) * half, cz = (minZ + maxZ) * half;
+                const P ex = (maxX - minX) * half, ey = (maxY - minY) * half, ez = (maxZ - minZ) * half;
+
+                const P zero = P::broadcast(T(0));
+                auto inside = (nx[0] * cx + ny[0] * cy + nz[0] * cz + d[0]) + (ax[0] * ex + ay[0] * ey + az[0] * ez) >= zero;
+                for (std::size_t p = 1; p < Frustum<T>::planeCount; ++p)
+                    inside = inside &
+                             ((nx[p] * cx + ny[p] * cy + nz[p] * cz + d[p]) + (ax[p] * ex + ay[p] * ey + az[p] * ez) >= zero);
+                return bits(inside);
+            }
+
+            P nx[Frustum<T>::planeCount], ny[Frustum<T>::planeCount], nz[Frustum<T>::planeCount];
+            P d[Frustum<T>::planeCount];
+            P ax[Frustum<T>::planeCount], ay[Frustum<T>::planeCount], az[Frustum<T>::planeCount];
+        };
+
+        /* Every lane writes its index, only visible lanes advance the cursor, so there is no branch per object */
+        template<typename P>
+        std::size_t compact(int mask, std::size_t first, std::uint32_t *visible, std::size_t written) {
+            for (std::size_t l = 0; l < P::width; ++l) {
+                visible[written] = static_cast<std::uint32_t>(first + l);
+                written += static_cast<std::size_t>((mask >> l) & 1);
+            }
+            return written;
+        }
+
+        // Runs kernel(planes, pack, i) -> mask over count objects and compacts the visible indices
+        template<typename T, typename Kernel>
+        std::size_t cull(const Frustum<T> &frustum, std::size_t count, std::uint32_t *visible, Kernel &&kernel) {
+            return simd::with_pack<T>([&](auto wide) {
+                using W = decltype(wide);
+                std::size_t written = 0;
+
+                const FrustumPack<W, T> packPlanes{frustum};
+                const FrustumPack<simd::ScalarPack<T>, T> scalarPlanes{frustum};
+                simd::for_each_pack_of<W>(0, count, [&](auto pack, std::size_t i) {
+                    using P = decltype(pack);
+                    if constexpr (std::is_same<P, simd::ScalarPack<T>>::value)
+                        written = compact<P>(kernel(scalarPlanes, pack, i), i, visible, written);
+                    else
+                        written = compact<P>(kernel(packPlanes, pack, i), i, visible, written);
+                });
+                return written;
+            });
+        }
+    }
+
+    // Spheres centers[i] with radii[i]
+    template<typename T>
+    std::size_t cull_spheres(const Frustum<T> &frustum, const Vector<T, 3> *centers, const T *radii,
+                             std::size_t count, std::uint32_t *visible) {
+        return detail::cull(frustum, count, visible, [&](const auto &planes, auto pack, std::size_t i) {
+            using P = decltype(pack);
+            P x, y, z;
+            detail::load_vectors(centers + i, x, y, z);
+            return planes.spheres(x, y, z, P::load(radii + i));
+        });
+    }
+
+    template<typename T>
+    std::size_t cull_spheres(const Frustum<T> &frustum, const VectorArray<T, 3> &centers, const T *radii,
+                             std::uint32_t *visible) {
+        const T *x = centers.component(0), *y = centers.component(1), *z = centers.component(2);
+        return detail::cull(frustum, centers.size(), visible, [&](const auto &planes, auto pack, std::size_t i) {
+            using P = decltype(pack);
+            return planes.spheres(P::load(x + i), P::load(y + i), P::load(z + i), P::load(radii + i));
+        });
+    }
+
+    // Axis aligned boxes [mins[i], maxs[i]]
+    template<typename T>
+    std::size_t cull_aabbs(const Frustum<T> &frustum, const Vector<T, 3> *mins, const Vector<T, 3> *maxs,
+                           std::size_t count, std::uint32_t *visible) {
+        return detail::cull(frustum, count, visible, [&](const auto &planes, auto pack, std::size_t i) {
+            using P = decltype(pack);
+            P minX, minY, minZ, maxX, maxY, maxZ;
+            detail::load_vectors(mins + i, minX, minY, minZ);
+            detail::load_vectors(maxs + i, maxX, maxY, maxZ);
+            return planes.aabbs(minX, minY, minZ, maxX, maxY, maxZ);
+        });
+    }
+
+    template<typename T>
+    std::size_t cull_aabbs(const Frustum<T> &frustum, const VectorArray<T, 3> &mins, const VectorArray<T, 3> &maxs,
+                           std::uint32_t *visible) {
+        assert(mins.size() == maxs.size());
+        const T *minX = mins.component(0), *minY = mins.component(1), *minZ = mins.component(2);
+        const T *maxX = maxs.component(0), *maxY = maxs.component(1), *maxZ = maxs.component(2);
+        return detail::cull(frustum, mins.size(), visible, [&](const auto &planes, auto pack, std::size_t i) {
+            using P = decltype(pack);
+            return planes.aabbs(P::load(minX + i), P::load(minY + i), P::load(minZ + i),
+                                P::load(maxX + i), P::load(maxY + i), P::load(maxZ + i));
+        });
+    }
+}
+
+#endif //SLIMEMATHS_FRUSTUM_H
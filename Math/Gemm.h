@@ -0,0 +1,192 @@
+#ifndef SLIMEMATHS_GEMM_H
+#define SLIMEMATHS_GEMM_H
+
+#include <cstddef>
+#include <algorithm>
+#include <vector>
+#include "SimdPack.h"
+#include "Executor.h"
+
+// Blocked general matrix multiply behind DynamicMatrix.
+// Follows the usual Goto/BLIS layout: B is packed into KC x NC panels of NR wide slivers,
+// A into MC x KC blocks of MR tall slivers, and a register blocked MR x NR micro kernel
+// streams both packed buffers while keeping the whole C tile in registers.
+// C is split into horizontal slabs run on an Executor, each slab packs into buffers of the thread running it, so no
+// synchronisation is needed and repeated products reuse the buffers instead of allocating them again.
+
+namespace Sm {
+
+    struct GemmOptions {
+        // Slabs C is split into, 0 uses one per thread of the executor
+        std::size_t threads = 0;
+
+        // Pool the slabs run on, nullptr uses Sm::default_executor()
+        Executor *executor = nullptr;
+
+        // Products with fewer multiply-adds than this stay on the calling thread
+        std::size_t parallelThreshold = 64 * 64 * 64;
+    };
+
+    namespace detail {
+
+        template<typename T>
+        struct GemmKernel {
+            using P = simd::Pack<T>;
+
+            // Micro tile, MR rows of A times NR columns of B
+            static constexpr std::size_t packs = P::width == 1 ? 4 : 2;
+            static constexpr std::size_t MR = P::width == 1 ? 4 : 6;
+            static constexpr std::size_t NR = P::width * packs;
+
+            // Cache blocking: an A block stays in L2, a B sliver in L1, a B panel in L3
+            static constexpr std::size_t KC = 256;
+            static constexpr std::size_t MC = MR * 16;
+            static constexpr std::size_t NC = 2048;
+
+            // c = a * b, a is m x k, b is k x n, every matrix row major
+            static void multiply(T *c, const T *a, const T *b, std::size_t m, std::size_t n, std::size_t k,
+                                 const GemmOptions &options) {
+                std::fill(c, c + m * n, T(0));
+                if (m == 0 || n == 0 || k == 0)
+                    return;
+
+                if (m * n * k < options.parallelThreshold) {
+                    multiply_rows(c, a, b, 0, m, n, k);
+                    return;
+                }
+
+                Executor &executor = options.executor ? *options.executor : default_executor();
+                std::size_t threads = options.threads ? options.threads : executor.threads();
+                threads = std::max<std::size_t>(1, std::min(threads, (m + MR - 1) / MR));
+
+                /* Slabs are whole micro tiles tall so no two threads touch the same tile */
+                const std::size_t tiles = (m + MR - 1) / MR;
+                parallel_for(executor, threads, [&](std::size_t first, std::size_t last) {
+                    for (std::size_t t = first; t < last; ++t)
+                        multiply_rows(c, a, b, std::min(m, (t * tiles / threads) * MR),
+                                      std::min(m, ((t + 1) * tiles / threads) * MR), n, k);
+                });
+            }
+
+            // Packing buffers of the running thread, grown to the largest product it has run and kept for the next.
+            // multiply_rows never waits on the executor, so no other product can run on the thread while it uses them
+            struct Scratch {
+                std::vector<T> packedA;
+                std::vector<T> packedB;
+            };
+
+            static Scratch &scratch() {
+                static thread_local Scratch buffers;
+                return buffers;
+            }
+
+            // Adds rows [rowBegin, rowEnd) of a * b to c
+            static void multiply_rows(T *c, const T *a, const T *b, std::size_t rowBegin, std::size_t rowEnd,
+                                      std::size_t n, std::size_t k) {
+                /* Only as large as the blocks this call packs, small products do not pay for a full MC x KC block */
+                const std::size_t depth = std::min(KC, k);
+                const std::size_t rows = (std::min(MC, rowEnd - rowBegin) + MR - 1) / MR * MR;
+                const std::size_t columns = (std::min(NC, n) + NR - 1) / NR * NR;
+
+                std::vector<T> &packedA = scratch().packedA;
+                std::vector<T> &packedB = scratch().packedB;
+                if (packedA.size() < rows * depth)
+                    packedA.resize(rows * depth);
+                if (packedB.size() < depth * columns)
+                    packedB.resize(depth * columns);
+
+                for (std::size_t jc = 0; jc < n; jc += NC) {
+                    const std::size_t nc = std::min(NC, n - jc);
+
+                    for (std::size_t pc = 0; pc < k; pc += KC) {
+                        const std::size_t kc = std::min(KC, k - pc);
+                        pack_b(packedB.data(), b + pc * n + jc, n, kc, nc);
+
+                        for (std::size_t ic = rowBegin; ic < rowEnd; ic += MC) {
+                            const std::size_t mc = std::min(MC, rowEnd - ic);
+                            pack_a(packedA.data(), a + ic * k + pc, k, mc, kc);
+
+                            for (std::size_t jr = 0; jr < nc; jr += NR)
+                                for (std::size_t ir = 0; ir < mc; ir += MR)
+                                    micro_kernel(c + (ic + ir) * n + jc + jr, n,
+                                                 packedA.data() + ir * kc, packedB.data() + jr * kc, kc,
+                                                 std::min(MR, mc - ir), std::min(NR, nc - jr));
+                        }
+                    }
+                }
+            }
+
+            // MR tall slivers, each stored column by column, ragged rows padded with zeros
+            static void pack_a(T *out, const T *a, std::size_t lda, std::size_t mc, std::size_t kc) {
+                for (std::size_t ir = 0; ir < mc; ir += MR) {
+                    const std::size_t mr = std::min(MR, mc - ir);
+                    for (std::size_t p = 0; p < kc; ++p) {
+                        for (std::size_t r = 0; r < mr; ++r)
+                            out[r] = a[(ir + r) * lda + p];
+                        for (std::size_t r = mr; r < MR; ++r)
+                            out[r] = T(0);
+                        out += MR;
+                    }
+                }
+            }
+
+            // NR wide slivers, each stored row by row, ragged columns padded with zeros
+            static void pack_b(T *out, const T *b, std::size_t ldb, std::size_t kc, std::size_t nc) {
+                for (std::size_t jr = 0; jr < nc; jr += NR) {
+                    const std::size_t nr = std::min(NR, nc - jr);
+                    for (std::size_t p = 0; p < kc; ++p) {
+                        const T *row = b + p * ldb + jr;
+                        for (std::size_t j = 0; j < nr; ++j)
+                            out[j] = row[j];
+                        for (std::size_t j = nr; j < NR; ++j)
+                            out[j] = T(0);
+                        out += NR;
+                    }
+                }
+            }
+
+            // c[0..mr)[0..nr) += packed A sliver * packed B sliver
+            static void micro_kernel(T *c, std::size_t ldc, const T *a, const T *b, std::size_t kc,
+                                     std::size_t mr, std::size_t nr) {
+                P acc[MR][packs];
+                for (std::size_t r = 0; r < MR; ++r)
+                    for (std::size_t j = 0; j < packs; ++j)
+                        acc[r][j] = P::broadcast(T(0));
+
+                for (std::size_t p = 0; p < kc; ++p) {
+                    P bp[packs];
+                    for (std::size_t j = 0; j < packs; ++j)
+                        bp[j] = P::load(b + j * P::width);
+
+                    for (std::size_t r = 0; r < MR; ++r) {
+                        const P ar = P::broadcast(a[r]);
+                        for (std::size_t j = 0; j < packs; ++j)
+                            acc[r][j] = acc[r][j] + ar * bp[j];
+                    }
+                    a += MR;
+                    b += NR;
+                }
+
+                if (mr == MR && nr == NR) {
+                    for (std::size_t r = 0; r < MR; ++r)
+                        for (std::size_t j = 0; j < packs; ++j) {
+                            T *dst = c + r * ldc + j * P::width;
+                            (P::load(dst) + acc[r][j]).store(dst);
+                        }
+                    return;
+                }
+
+                /* Edge tile, spill the accumulators and add only the valid part */
+                T tile[MR * NR];
+                for (std::size_t r = 0; r < MR; ++r)
+                    for (std::size_t j = 0; j < packs; ++j)
+                        acc[r][j].store(tile + r * NR + j * P::width);
+                for (std::size_t r = 0; r < mr; ++r)
+                    for (std::size_t j = 0; j < nr; ++j)
+                        c[r * ldc + j] += tile[r * NR + j];
+            }
+        };
+    }
+}
+
+#endif //SLIMEMATHS_GEMM_H
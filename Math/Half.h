@@ -0,0 +1,210 @@
+#ifndef SLIMEMATHS_HALF_H
+#define SLIMEMATHS_HALF_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include "Simd.h"
+#include "Vector2.h"
+#include "Vector3.h"
+#include "Vector4.h"
+
+// IEEE 754 binary16 storage type for vertex and network streams, arithmetic is done in float.
+// Conversions round to nearest even, overflow to infinity and keep subnormals. Every NaN becomes the quiet NaN
+// 0x7e00 in software, the F16C batch path keeps the upper payload bits instead.
+// Vector<half, N> works as a storage vector, Sm::to_half / Sm::to_float convert single values, vectors and
+// whole arrays (8 or 4 at a time with F16C or SSE2).
+
+namespace Sm {
+    namespace detail {
+
+        inline std::uint32_t float_bits(float value) {
+            std::uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+
+        inline float bits_float(std::uint32_t bits) {
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        /* Subnormal results come from adding a magic number so the FPU rounds them, normal ones round the
+           mantissa with the carry into the exponent, everything at or above 65520 overflows */
+        inline std::uint16_t float_to_half(float value) {
+            const std::uint32_t infinity = 255u << 23;
+            const std::uint32_t overflow = (127u + 16u) << 23;
+            const std::uint32_t minNormal = (127u - 14u) << 23;
+            const std::uint32_t subnormalMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+            std::uint32_t bits = float_bits(value);
+            const std::uint32_t sign = bits & 0x80000000u;
+            bits ^= sign;
+
+            std::uint32_t result;
+            if (bits >= overflow)
+                result = bits > infinity ? 0x7e00u : 0x7c00u;
+            else if (bits < minNormal)
+                result = float_bits(bits_float(bits) + bits_float(subnormalMagic)) - subnormalMagic;
+            else
+                result = (bits + (0xfffu - ((127u - 15u) << 23)) + ((bits >> 13) & 1u)) >> 13;
+            return static_cast<std::uint16_t>(result | (sign >> 16));
+        }
+
+        /* Shifting into a float exponent and scaling by 2^112 rebiases normals and subnormals alike */
+        inline float half_to_float(std::uint16_t value) {
+            const std::uint32_t magnitude = value & 0x7fffu;
+            std::uint32_t bits = float_bits(bits_float(magnitude << 13) * bits_float((254u - 15u) << 23));
+            if (magnitude > 0x7bffu)
+                bits |= 255u << 23;
+            return bits_float(bits | (static_cast<std::uint32_t>(value & 0x8000u) << 16));
+        }
+    }
+}
+
+struct half {
+    // Constructors
+    constexpr half() : bits{0} {}
+
+    constexpr half(const half &rhs) = default;
+
+    explicit half(float value) : bits{Sm::detail::float_to_half(value)} {}
+
+    constexpr half &operator=(const half &rhs) = default;
+
+    static constexpr half from_bits(std::uint16_t bits) {
+        half result;
+        result.bits = bits;
+        return result;
+    }
+
+    operator float() const {
+        return Sm::detail::half_to_float(bits);
+    }
+
+    // OStream Overrider
+    friend std::ostream &operator<<(std::ostream &os, const half &value) {
+        os << float(value);
+        return os;
+    }
+
+    std::uint16_t bits;
+};
+
+using Vector2h = Vector<half, 2>;
+using Vector3h = Vector<half, 3>;
+using Vector4h = Vector<half, 4>;
+
+namespace Sm {
+    template<std::size_t N>
+    Vector<half, N> to_half(const Vector<float, N> &v) {
+        Vector<half, N> result;
+        for (std::size_t i = 0; i < N; ++i)
+            result[i] = half{v[i]};
+        return result;
+    }
+
+    template<std::size_t N>
+    Vector<float, N> to_float(const Vector<half, N> &v) {
+        Vector<float, N> result;
+        for (std::size_t i = 0; i < N; ++i)
+            result[i] = float(v[i]);
+        return result;
+    }
+
+    namespace detail {
+#if defined(SLIMEMATHS_SSE2) && !defined(SLIMEMATHS_F16C)
+        // detail::float_to_half on 4 lanes, the results are sign extended to 32 bits so packs_epi32 narrows them
+        inline __m128i float_to_half(__m128 value) {
+            const __m128i overflow = _mm_set1_epi32((127 + 16) << 23);
+            const __m128i minNormal = _mm_set1_epi32((127 - 14) << 23);
+            const __m128i subnormalMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+            const __m128i normalBias = _mm_set1_epi32(0xfff - ((127 - 15) << 23));
+
+            const __m128 sign = _mm_and_ps(value, _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(0x80000000u))));
+            const __m128 magnitude = _mm_xor_ps(value, sign);
+            const __m128i bits = _mm_castps_si128(magnitude);
+
+            const __m128i isNan = _mm_castps_si128(_mm_cmpunord_ps(magnitude, magnitude));
+            const __m128i special = _mm_or_si128(_mm_and_si128(isNan, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7c00));
+            const __m128i isRegular = _mm_cmpgt_epi32(overflow, bits);
+            const __m128i isSubnormal = _mm_cmpgt_epi32(minNormal, bits);
+
+            const __m128i subnormal = _mm_sub_epi32(
+                    _mm_castps_si128(_mm_add_ps(magnitude, _mm_castsi128_ps(subnormalMagic))), subnormalMagic);
+            const __m128i odd = _mm_srai_epi32(_mm_slli_epi32(bits, 31 - 13), 31);
+            const __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(bits, normalBias), odd), 13);
+
+            const __m128i finite = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal),
+                                                _mm_andnot_si128(isSubnormal, normal));
+            const __m128i result = _mm_or_si128(_mm_and_si128(isRegular, finite), _mm_andnot_si128(isRegular, special));
+            return _mm_or_si128(result, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+        }
+
+        // detail::half_to_float on 4 lanes holding zero extended halves
+        inline __m128 half_to_float(__m128i value) {
+            const __m128i magnitude = _mm_and_si128(value, _mm_set1_epi32(0x7fff));
+            const __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(magnitude, 13)),
+                                             _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23)));
+            const __m128i isSpecial = _mm_cmpgt_epi32(magnitude, _mm_set1_epi32(0x7bff));
+            const __m128i exponent = _mm_and_si128(isSpecial, _mm_set1_epi32(255 << 23));
+            const __m128i sign = _mm_slli_epi32(_mm_xor_si128(value, magnitude), 16);
+            return _mm_or_ps(scaled, _mm_castsi128_ps(_mm_or_si128(sign, exponent)));
+        }
+#endif
+    }
+
+    // count floats to halves
+    inline void to_half(const float *in, half *out, std::size_t count) {
+        static_assert(sizeof(half) == sizeof(std::uint16_t), "half must be tightly packed");
+        std::size_t i = 0;
+#if defined(SLIMEMATHS_F16C)
+        for (; i + 8 <= count; i += 8)
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                             _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT));
+#elif defined(SLIMEMATHS_SSE2)
+        for (; i + 8 <= count; i += 8) {
+            const __m128i low = detail::float_to_half(_mm_loadu_ps(in + i));
+            const __m128i high = detail::float_to_half(_mm_loadu_ps(in + i + 4));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packs_epi32(low, high));
+        }
+#endif
+        for (; i < count; ++i)
+            out[i] = half{in[i]};
+    }
+
+    // count halves to floats
+    inline void to_float(const half *in, float *out, std::size_t count) {
+        std::size_t i = 0;
+#if defined(SLIMEMATHS_F16C)
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i))));
+#elif defined(SLIMEMATHS_SSE2)
+        for (; i + 8 <= count; i += 8) {
+            const __m128i halves = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+            const __m128i zero = _mm_setzero_si128();
+            _mm_storeu_ps(out + i, detail::half_to_float(_mm_unpacklo_epi16(halves, zero)));
+            _mm_storeu_ps(out + i + 4, detail::half_to_float(_mm_unpackhi_epi16(halves, zero)));
+        }
+#endif
+        for (; i < count; ++i)
+            out[i] = float(in[i]);
+    }
+
+    template<std::size_t N>
+    void to_half(const Vector<float, N> *in, Vector<half, N> *out, std::size_t count) {
+        static_assert(sizeof(Vector<half, N>) == N * sizeof(half), "half vectors must be tightly packed");
+        if (count != 0)
+            to_half(in[0].ptr(), out[0].ptr(), count * N);
+    }
+
+    template<std::size_t N>
+    void to_float(const Vector<half, N> *in, Vector<float, N> *out, std::size_t count) {
+        if (count != 0)
+            to_float(in[0].ptr(), out[0].ptr(), count * N);
+    }
+}
+
+#endif //SLIMEMATHS_HALF_H
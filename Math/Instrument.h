@@ -0,0 +1,310 @@
+#ifndef SLIMEMATHS_INSTRUMENT_H
+#define SLIMEMATHS_INSTRUMENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <vector>
+#include "Simd.h"
+
+#if defined(SLIMEMATHS_INSTRUMENT)
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#if defined(_MSC_VER) && !defined(__clang__) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define SLIMEMATHS_INSTRUMENT_RDTSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define SLIMEMATHS_INSTRUMENT_RDTSC 1
+#endif
+#endif
+
+// Opt-in call counting for the Sm:: functions of SlimeAlgebra.h, the batch functions (VectorArray, BatchTransform,
+// QuaternionBlend, QuaternionConversion, Skinning, SymmetricEigen, Svd, Trs, DynamicMatrix), the Matrix and Quaternion
+// operators and the Quaternion conversions. Vector operators, Sm::fast, DualQuaternion, TransformHierarchy, AABB,
+// Frustum, Ray, Bvh, Half and Encoding have no counting sites.
+// Define SLIMEMATHS_INSTRUMENT (CMake option SLIMEMATHS_INSTRUMENT) before including any SlimeMath header to
+// enable it. Otherwise every site macro expands to nothing and the functions below return empty results, so
+// calling code builds the same either way.
+//
+// Each thread counts into its own counters, a call costs a thread local lookup and a non-atomic increment.
+// Sm::instrument_sample_cycles(n) also times every n-th call of the functions, not of the constexpr operators,
+// with rdtsc (steady_clock nanoseconds off x86). Counts are inclusive: Sm::length counts a Sm::dot too, and a
+// parallel overload counts its own call plus one call of the serial function per chunk.
+//
+//     Sm::instrument_reset();
+//     run_frame();
+//     Sm::instrument_report(std::cerr);
+
+namespace Sm {
+
+    // Totals of one instrumented function over every thread since the last Sm::instrument_reset()
+    struct InstrumentEntry {
+        const char *name = nullptr;
+        std::uint64_t calls = 0;
+        std::uint64_t sampledCalls = 0;   // calls that were timed
+        std::uint64_t cycles = 0;         // summed over the timed calls
+
+        double cycles_per_call() const {
+            return sampledCalls ? double(cycles) / double(sampledCalls) : 0.0;
+        }
+    };
+
+#if defined(SLIMEMATHS_INSTRUMENT)
+    constexpr bool instrument_enabled = true;
+
+    namespace detail {
+
+        struct InstrumentCounter {
+            std::atomic<std::uint64_t> calls{0};
+            std::atomic<std::uint64_t> sampledCalls{0};
+            std::atomic<std::uint64_t> cycles{0};
+        };
+
+        struct InstrumentTotals {
+            std::uint64_t calls = 0;
+            std::uint64_t sampledCalls = 0;
+            std::uint64_t cycles = 0;
+        };
+
+        struct InstrumentBlock;
+
+        struct InstrumentRegistry {
+            std::mutex mutex;
+            std::vector<const char *> names;
+            std::vector<InstrumentBlock *> blocks;
+            std::vector<InstrumentTotals> retired;    // counts of threads that have exited
+            std::vector<InstrumentTotals> baseline;   // totals at the last reset
+            std::atomic<std::uint64_t> sampleEvery{0};
+
+            std::size_t add(const char *name) {
+                std::lock_guard<std::mutex> lock{mutex};
+                names.push_back(name);
+                retired.emplace_back();
+                baseline.emplace_back();
+                return names.size() - 1;
+            }
+        };
+
+        /* Never destroyed, pool threads still exit (and retire their counts) during static destruction */
+        inline InstrumentRegistry &instrument_registry() {
+            static InstrumentRegistry &registry = *new InstrumentRegistry;
+            return registry;
+        }
+
+        // Counters of one thread, in pages that never move so other threads can read them while this one counts
+        struct InstrumentBlock {
+            static const std::size_t pageSize = 256;
+            static const std::size_t pageCount = 64;
+
+            InstrumentBlock() {
+                for (auto &page: pages)
+                    page.store(nullptr, std::memory_order_relaxed);
+                InstrumentRegistry &registry = instrument_registry();
+                std::lock_guard<std::mutex> lock{registry.mutex};
+                registry.blocks.push_back(this);
+            }
+
+            InstrumentBlock(const InstrumentBlock &) = delete;
+
+            InstrumentBlock &operator=(const InstrumentBlock &) = delete;
+
+            ~InstrumentBlock() {
+                InstrumentRegistry &registry = instrument_registry();
+                std::lock_guard<std::mutex> lock{registry.mutex};
+                add_to(registry.retired);
+                registry.blocks.erase(std::find(registry.blocks.begin(), registry.blocks.end(), this));
+                for (auto &page: pages)
+                    delete[] page.load(std::memory_order_relaxed);
+            }
+
+            InstrumentCounter &counter(std::size_t site) {
+                assert(site < pageSize * pageCount);
+                std::atomic<InstrumentCounter *> &slot = pages[site / pageSize];
+                InstrumentCounter *page = slot.load(std::memory_order_relaxed);
+                if (!page) {
+                    page = new InstrumentCounter[pageSize];
+                    slot.store(page, std::memory_order_release);
+                }
+                return page[site % pageSize];
+            }
+
+            // Adds this thread's counts to totals, which has an entry per site
+            void add_to(std::vector<InstrumentTotals> &totals) const {
+                for (std::size_t p = 0; p < pageCount; ++p) {
+                    const InstrumentCounter *page = pages[p].load(std::memory_order_acquire);
+                    for (std::size_t i = 0; page && i < pageSize && p * pageSize + i < totals.size(); ++i) {
+                        InstrumentTotals &total = totals[p * pageSize + i];
+                        total.calls += page[i].calls.load(std::memory_order_relaxed);
+                        total.sampledCalls += page[i].sampledCalls.load(std::memory_order_relaxed);
+                        total.cycles += page[i].cycles.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            std::atomic<InstrumentCounter *> pages[pageCount];
+        };
+
+        inline InstrumentBlock &instrument_block() {
+            static thread_local InstrumentBlock block;
+            return block;
+        }
+
+        // Site index of a tag type, the tags are local classes declared by the SLIMEMATHS_INSTRUMENT_ macros
+        template<typename Tag>
+        std::size_t instrument_site() {
+            static const std::size_t site = instrument_registry().add(Tag::name());
+            return site;
+        }
+
+        /* Only this thread writes its counters, a relaxed load and store is a plain increment */
+        inline void instrument_add(std::atomic<std::uint64_t> &value, std::uint64_t amount) {
+            value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+
+        inline std::uint64_t instrument_ticks() {
+#if defined(SLIMEMATHS_INSTRUMENT_RDTSC)
+            return __rdtsc();
+#else
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+        }
+
+        template<typename Tag>
+        void instrument_count() {
+            instrument_add(instrument_block().counter(instrument_site<Tag>()).calls, 1);
+        }
+
+        // Counts the call on construction and, when it is one to sample, adds the elapsed ticks on destruction
+        template<typename Tag>
+        struct InstrumentScope {
+            InstrumentScope() : _counter{&instrument_block().counter(instrument_site<Tag>())} {
+                const std::uint64_t calls = _counter->calls.load(std::memory_order_relaxed);
+                instrument_add(_counter->calls, 1);
+
+                const std::uint64_t every = instrument_registry().sampleEvery.load(std::memory_order_relaxed);
+                if (every && (calls & (every - 1)) == 0)
+                    _start = instrument_ticks();
+            }
+
+            InstrumentScope(const InstrumentScope &) = delete;
+
+            InstrumentScope &operator=(const InstrumentScope &) = delete;
+
+            ~InstrumentScope() {
+                if (_start) {
+                    instrument_add(_counter->cycles, instrument_ticks() - _start);
+                    instrument_add(_counter->sampledCalls, 1);
+                }
+            }
+
+        private:
+            InstrumentCounter *_counter;
+            std::uint64_t _start = 0;
+        };
+
+        inline std::vector<InstrumentTotals> instrument_totals(InstrumentRegistry &registry) {
+            std::vector<InstrumentTotals> totals = registry.retired;
+            for (const InstrumentBlock *block: registry.blocks)
+                block->add_to(totals);
+            return totals;
+        }
+    }
+
+    // Times every n-th call of each instrumented function and thread (rounded up to a power of two), 0 stops timing
+    inline void instrument_sample_cycles(std::uint64_t every) {
+        std::uint64_t rounded = every ? 1 : 0;
+        while (rounded && rounded < every)
+            rounded *= 2;
+        detail::instrument_registry().sampleEvery.store(rounded, std::memory_order_relaxed);
+    }
+
+    // Totals per function name since the last reset, most called first. Functions never called are left out.
+    inline std::vector<InstrumentEntry> instrument_snapshot() {
+        detail::InstrumentRegistry &registry = detail::instrument_registry();
+        std::lock_guard<std::mutex> lock{registry.mutex};
+        const std::vector<detail::InstrumentTotals> totals = detail::instrument_totals(registry);
+
+        /* Every template instantiation is its own site, entries of the same name are merged */
+        std::vector<InstrumentEntry> entries;
+        for (std::size_t site = 0; site < totals.size(); ++site) {
+            const std::uint64_t calls = totals[site].calls - registry.baseline[site].calls;
+            if (calls == 0)
+                continue;
+            auto entry = std::find_if(entries.begin(), entries.end(), [&](const InstrumentEntry &e) {
+                return !std::strcmp(e.name, registry.names[site]);
+            });
+            if (entry == entries.end())
+                entry = entries.insert(entries.end(), InstrumentEntry{registry.names[site]});
+            entry->calls += calls;
+            entry->sampledCalls += totals[site].sampledCalls - registry.baseline[site].sampledCalls;
+            entry->cycles += totals[site].cycles - registry.baseline[site].cycles;
+        }
+
+        std::stable_sort(entries.begin(), entries.end(), [](const InstrumentEntry &a, const InstrumentEntry &b) {
+            return a.calls > b.calls;
+        });
+        return entries;
+    }
+
+    // Starts every count over, safe while other threads keep counting
+    inline void instrument_reset() {
+        detail::InstrumentRegistry &registry = detail::instrument_registry();
+        std::lock_guard<std::mutex> lock{registry.mutex};
+        registry.baseline = detail::instrument_totals(registry);
+    }
+
+#define SLIMEMATHS_INSTRUMENT_TAG(label) \
+    struct SlimeMathsInstrumentTag { static constexpr const char *name() { return label; } }
+
+// Counts calls, usable in constexpr functions (nothing is counted during constant evaluation)
+#define SLIMEMATHS_INSTRUMENT_CALL(label) \
+    SLIMEMATHS_INSTRUMENT_TAG(label); \
+    if (!SLIMEMATHS_IS_CONSTANT_EVALUATED()) ::Sm::detail::instrument_count<SlimeMathsInstrumentTag>()
+
+// Counts calls and times the sampled ones until the end of the enclosing scope
+#define SLIMEMATHS_INSTRUMENT_SCOPE(label) \
+    SLIMEMATHS_INSTRUMENT_TAG(label); \
+    const ::Sm::detail::InstrumentScope<SlimeMathsInstrumentTag> slimeMathsInstrumentScope
+
+#else
+    constexpr bool instrument_enabled = false;
+
+    inline void instrument_sample_cycles(std::uint64_t) {}
+
+    inline std::vector<InstrumentEntry> instrument_snapshot() {
+        return {};
+    }
+
+    inline void instrument_reset() {}
+
+#define SLIMEMATHS_INSTRUMENT_CALL(label) static_cast<void>(0)
+#define SLIMEMATHS_INSTRUMENT_SCOPE(label) static_cast<void>(0)
+#endif
+
+    // Writes the snapshot as a table, one function per line
+    inline void instrument_report(std::ostream &os) {
+        if (!instrument_enabled) {
+            os << "SlimeMath instrumentation is off, build with SLIMEMATHS_INSTRUMENT\n";
+            return;
+        }
+
+        const std::vector<InstrumentEntry> entries = instrument_snapshot();
+        os << std::left << std::setw(48) << "function" << std::right << std::setw(16) << "calls"
+           << std::setw(12) << "sampled" << std::setw(16) << "cycles/call" << '\n';
+        for (const InstrumentEntry &entry: entries) {
+            os << std::left << std::setw(48) << entry.name << std::right << std::setw(16) << entry.calls
+               << std::setw(12) << entry.sampledCalls << std::setw(16) << std::fixed << std::setprecision(1)
+               << entry.cycles_per_call() << '\n';
+        }
+        os.unsetf(std::ios::floatfield);
+    }
+}
+
+#endif //SLIMEMATHS_INSTRUMENT_H
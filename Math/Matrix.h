@@ -11,6 +11,10 @@
 #include <algorithm>
 #include <sstream>
 #include <ostream>
+#include <type_traits>
+#include "MatrixKernels.h"
+#include "MatrixInverse.h"
+#include "Instrument.h"
 
 template<typename T, std::size_t Rows, std::size_t Cols>
 struct Matrix {
@@ -27,8 +31,16 @@ struct Matrix {
     using TransposedType = Matrix<T, Cols, Rows>;
 
     // Constructors
-    Matrix() { load_identity(); };                        //Default Constructor
-    Matrix(const ThisType &rhs) { *this = rhs; };          // Copy Constructor
+    constexpr Matrix() : _element{} { load_identity(); }              //Default Constructor
+    constexpr Matrix(const ThisType &rhs) = default;                 // Copy Constructor
+
+    // Row major element list, missing elements are zero
+    constexpr Matrix(std::initializer_list<T> values) : _element{} {
+        assert(values.size() <= ThisType::elements);
+        std::size_t i = 0;
+        for (const T &value : values)
+            _element[i++] = value;
+    }
 
     // Overriders
     // Output
@@ -49,13 +61,13 @@ struct Matrix {
     }
 
     // Element getters/setters
-    T &operator()(std::size_t row, std::size_t col) {
+    constexpr T &operator()(std::size_t row, std::size_t col) {
         assert(row < Rows);
         assert(col < Cols);
         return _element[row * Cols + col];
     }
 
-    const T &operator()(std::size_t row, std::size_t col) const {
+    constexpr const T &operator()(std::size_t row, std::size_t col) const {
         assert(row < Rows);
         assert(col < Cols);
 
@@ -63,86 +75,80 @@ struct Matrix {
     }
 
 
-    T &operator[](std::size_t element) {
+    constexpr T &operator[](std::size_t element) {
         return _element[element];
     }
 
-    const T &operator[](std::size_t element) const {
+    constexpr const T &operator[](std::size_t element) const {
         return _element[element];
     }
 
-    T *ptr() {
+    constexpr T *ptr() {
         return &(_element[0]);
     }
 
-    const T *ptr() const {
+    constexpr const T *ptr() const {
         return &(_element[0]);
     }
 
     // Matrix Math
-    ThisType &operator+=(const ThisType &rhs) {
+    constexpr ThisType &operator+=(const ThisType &rhs) {
         for (std::size_t i = 0; i < ThisType::elements; ++i)
             _element[i] += rhs._element[i];
         return *this;
     }
 
-    ThisType &operator-=(const ThisType &rhs) {
+    constexpr ThisType &operator-=(const ThisType &rhs) {
         for (std::size_t i = 0; i < ThisType::elements; ++i)
             _element[i] -= rhs._element[i];
         return *this;
     }
 
-    ThisType &operator*=(const ThisType &rhs) {
+    constexpr ThisType &operator*=(const ThisType &rhs) {
         *this = (*this * rhs);
         return *this;
     }
 
-    ThisType &operator*=(const T &rhs) {
+    constexpr ThisType &operator*=(const T &rhs) {
         for (std::size_t i = 0; i < ThisType::elements; ++i)
             _element[i] *= rhs;
         return *this;
     }
 
-    ThisType &operator=(const ThisType &rhs) {
-        if (this == &rhs)
-            return *this;
-
-        for (std::size_t i = 0; i < ThisType::elements; ++i)
-            _element[i] = rhs._element[i];
-        return *this;
-    }
+    constexpr ThisType &operator=(const ThisType &rhs) = default;
 
     // Get element AT
-    T &at(std::size_t col, std::size_t row) {
+    constexpr T &at(std::size_t col, std::size_t row) {
         return (*this)(row, col);
     }
 
-    const T &at(std::size_t col, std::size_t row) const {
+    constexpr const T &at(std::size_t col, std::size_t row) const {
         return (*this)(row, col);
     }
 
     // Functions
-    void load_identity() {
+    constexpr void load_identity() {
         for (std::size_t r = 0; r < Rows; ++r)
             for (std::size_t c = 0; c < Cols; ++c) {
                 (*this)(r, c) = (r == c ? T(1) : T(0));
             }
     }
 
-    static ThisType identity() {
+    static constexpr ThisType identity() {
         ThisType result;
         result.load_identity();
         return result;
     }
 
-    void reset() {
+    constexpr void reset() {
         for (std::size_t i = 0; i < ThisType::elements; ++i)
             _element[i] = T(0);
     }
 
     //Returns a transposed matrix
-    TransposedType transposed() const {
-        TransposedType result;
+    constexpr TransposedType transposed() const {
+        SLIMEMATHS_INSTRUMENT_CALL("Matrix::transposed");
+        TransposedType result{typename TransposedType::NoIdentity{}};
 
         for (std::size_t r = 0; r < Rows; ++r)
             for (std::size_t c = 0; c < Cols; ++c) {
@@ -153,18 +159,17 @@ struct Matrix {
     }
 
     // Transposes current matrix.
-    void transpose() {
+    constexpr void transpose() {
         for (std::size_t i = 0; i + 1 < Cols; ++i) {
             for (std::size_t j = 1; j + i < Cols; ++j) {
-                std::swap(
-                        _element[i * (Cols + 1) + j],
-                        _element[(j + i) * Cols + i]
-                );
+                const T swap = _element[i * (Cols + 1) + j];
+                _element[i * (Cols + 1) + j] = _element[(j + i) * Cols + i];
+                _element[(j + i) * Cols + i] = swap;
             }
         }
     }
 
-    T trace() const {
+    constexpr T trace() const {
         T trace = T(0);
 
         for (std::size_t i = 0; i < Rows; ++i)
@@ -173,9 +178,68 @@ struct Matrix {
         return trace;
     }
 
+    // Determinant of a 2x2, 3x3 or 4x4 matrix
+    constexpr T determinant() const {
+        SLIMEMATHS_INSTRUMENT_CALL("Matrix::determinant");
+        static_assert(Rows == Cols, "determinant is only defined for square matrices");
+        return Sm::detail::MatrixInverseKernel<T, Rows>::determinant(_element);
+    }
+
+    // Inverse of a 2x2, 3x3 or 4x4 matrix, the matrix must not be singular
+    constexpr ThisType inverse() const {
+        SLIMEMATHS_INSTRUMENT_CALL("Matrix::inverse");
+        static_assert(Rows == Cols, "inverse is only defined for square matrices");
+        static_assert(std::is_floating_point<T>::value, "inverse requires a floating point matrix");
+
+        ThisType result{NoIdentity{}};
+        const T det = Sm::detail::MatrixInverseKernel<T, Rows>::adjugate(result._element, _element);
+        assert(det != T(0));
+        result *= T(1) / det;
+        return result;
+    }
+
+    // Writes the inverse to out and returns true, unless |determinant| <= epsilon or the determinant is NaN
+    constexpr bool try_inverse(ThisType &out, const T &epsilon = T(0)) const {
+        SLIMEMATHS_INSTRUMENT_CALL("Matrix::try_inverse");
+        static_assert(Rows == Cols, "inverse is only defined for square matrices");
+        static_assert(std::is_floating_point<T>::value, "inverse requires a floating point matrix");
+
+        ThisType result{NoIdentity{}};
+        const T det = Sm::detail::MatrixInverseKernel<T, Rows>::adjugate(result._element, _element);
+        /* !(|det| > epsilon) without std::abs, which is not constexpr; a NaN determinant fails it too */
+        if (!(det > epsilon || -det > epsilon))
+            return false;
+
+        result *= T(1) / det;
+        out = result;
+        return true;
+    }
+
+    // Inverse of an affine transform [A | t; 0 1], only inverts the upper left block
+    constexpr ThisType inverse_affine() const {
+        SLIMEMATHS_INSTRUMENT_CALL("Matrix::inverse_affine");
+        static_assert(Rows == Cols, "inverse is only defined for square matrices");
+        static_assert(std::is_floating_point<T>::value, "inverse requires a floating point matrix");
+
+        ThisType result{NoIdentity{}};
+        Sm::detail::AffineInverseKernel<T, Rows>::affine(result._element, _element);
+        return result;
+    }
+
+    // Inverse of a rigid transform [R | t; 0 1] where R is a pure rotation
+    constexpr ThisType inverse_rigid() const {
+        SLIMEMATHS_INSTRUMENT_CALL("Matrix::inverse_rigid");
+        static_assert(Rows == Cols, "inverse is only defined for square matrices");
+        static_assert(std::is_floating_point<T>::value, "inverse requires a floating point matrix");
+
+        ThisType result{NoIdentity{}};
+        Sm::detail::AffineInverseKernel<T, Rows>::rigid(result._element, _element);
+        return result;
+    }
+
 
     template<typename C>
-    Matrix<C, Rows, Cols> Cast() const {
+    constexpr Matrix<C, Rows, Cols> Cast() const {
         Matrix<C, Rows, Cols> result{};
 
         for (std::size_t i = 0; i < ThisType::elements; ++i)
@@ -186,6 +250,17 @@ struct Matrix {
 
 
 private:
+    template<typename U, std::size_t R, std::size_t C>
+    friend struct Matrix;
+
+    template<typename U, std::size_t R, std::size_t CR, std::size_t C>
+    friend constexpr Matrix<U, R, C> operator*(const Matrix<U, R, CR> &lhs, const Matrix<U, CR, C> &rhs);
+
+    // Zeroed elements for results a kernel overwrites completely, skips the identity fill of the default constructor
+    struct NoIdentity {};
+
+    constexpr explicit Matrix(NoIdentity) : _element{} {}
+
     T _element[ThisType::elements];
 };
 
@@ -193,45 +268,45 @@ private:
 // Global Operators
 
 template<typename T, std::size_t Rows, std::size_t Cols>
-Matrix<T, Rows, Cols> operator+(const Matrix<T, Rows, Cols> &lhs, const Matrix<T, Rows, Cols> &rhs) {
+constexpr Matrix<T, Rows, Cols> operator+(const Matrix<T, Rows, Cols> &lhs, const Matrix<T, Rows, Cols> &rhs) {
+    SLIMEMATHS_INSTRUMENT_CALL("Matrix::operator+");
     auto result = lhs;
     result += rhs;
     return result;
 }
 
 template<typename T, std::size_t Rows, std::size_t Cols>
-Matrix<T, Rows, Cols> operator-(const Matrix<T, Rows, Cols> &lhs, const Matrix<T, Rows, Cols> &rhs) {
+constexpr Matrix<T, Rows, Cols> operator-(const Matrix<T, Rows, Cols> &lhs, const Matrix<T, Rows, Cols> &rhs) {
+    SLIMEMATHS_INSTRUMENT_CALL("Matrix::operator-");
     auto result = lhs;
     result -= rhs;
     return result;
 }
 
 template<typename T, std::size_t Rows, std::size_t Cols>
-Matrix<T, Rows, Cols> operator*(const Matrix<T, Rows, Cols> &lhs, const T &rhs) {
+constexpr Matrix<T, Rows, Cols> operator*(const Matrix<T, Rows, Cols> &lhs, const T &rhs) {
+    SLIMEMATHS_INSTRUMENT_CALL("Matrix::operator*(scalar)");
     auto result = lhs;
     result *= rhs;
     return result;
 }
 
 template<typename T, std::size_t Rows, std::size_t Cols>
-Matrix<T, Rows, Cols> operator*(const T &lhs, const Matrix<T, Rows, Cols> &rhs) {
+constexpr Matrix<T, Rows, Cols> operator*(const T &lhs, const Matrix<T, Rows, Cols> &rhs) {
+    SLIMEMATHS_INSTRUMENT_CALL("Matrix::operator*(scalar)");
     auto result = rhs;
     result *= lhs;
     return result;
 }
 
 template<typename T, std::size_t Rows, std::size_t ColsRows, std::size_t Cols>
-Matrix<T, Rows, Cols> operator*(const Matrix<T, Rows, ColsRows> &lhs, const Matrix<T, ColsRows, Cols> &rhs) {
-    Matrix<T, Rows, Cols> result{};
-    result.reset();
-
-    for (std::size_t r = 0; r < Rows; ++r)
-        for (std::size_t c = 0; c < Cols; ++c) {
-            result(r, c) = T(0);
-            for (std::size_t i = 0; i < ColsRows; ++i)
-                result(r, c) += lhs(r, i) * rhs(i, c);
-        }
-
+constexpr Matrix<T, Rows, Cols> operator*(const Matrix<T, Rows, ColsRows> &lhs, const Matrix<T, ColsRows, Cols> &rhs) {
+    SLIMEMATHS_INSTRUMENT_CALL("Matrix::operator*");
+    Matrix<T, Rows, Cols> result{typename Matrix<T, Rows, Cols>::NoIdentity{}};
+    if (SLIMEMATHS_IS_CONSTANT_EVALUATED())
+        Sm::detail::MatrixMultiplyScalar<T, Rows, ColsRows, Cols>::apply(result.ptr(), lhs.ptr(), rhs.ptr());
+    else
+        Sm::detail::MatrixMultiplyKernel<T, Rows, ColsRows, Cols>::apply(result.ptr(), lhs.ptr(), rhs.ptr());
     return result;
 }
 
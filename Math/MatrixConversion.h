@@ -16,37 +16,37 @@ namespace Sm {
         );
 
         /* Only get the trace of the 3x3 upper left matrix */
-        const T trace = in.At(0, 0) + in.At(1, 1) + in.At(2, 2) + T(1);
+        const T trace = in(0, 0) + in(1, 1) + in(2, 2) + T(1);
 
         if (trace > T(0)) {
             const T s = T(2) * std::sqrt(trace);
-            out.x = (in.At(2, 1) - in.At(1, 2)) / s;
-            out.y = (in.At(0, 2) - in.At(2, 0)) / s;
-            out.z = (in.At(1, 0) - in.At(0, 1)) / s;
+            out.x = (in(2, 1) - in(1, 2)) / s;
+            out.y = (in(0, 2) - in(2, 0)) / s;
+            out.z = (in(1, 0) - in(0, 1)) / s;
             out.w = T(0.25) * s;
         } else {
-            if (in.At(0, 0) > in.At(1, 1) && in.At(0, 0) > in.At(2, 2)) {
-                const T s = T(2) * std::sqrt(T(1) + in.At(0, 0) - in.At(1, 1) - in.At(2, 2));
+            if (in(0, 0) > in(1, 1) && in(0, 0) > in(2, 2)) {
+                const T s = T(2) * std::sqrt(T(1) + in(0, 0) - in(1, 1) - in(2, 2));
                 out.x = T(0.25) * s;
-                out.y = (in.At(0, 1) + in.At(1, 0)) / s;
-                out.z = (in.At(2, 0) + in.At(0, 2)) / s;
-                out.w = (in.At(2, 1) - in.At(1, 2)) / s;
-            } else if (in.At(1, 1) > in.At(2, 2)) {
-                const T s = T(2) * std::sqrt(T(1) + in.At(1, 1) - in.At(0, 0) - in.At(2, 2));
-                out.x = (in.At(0, 1) + in.At(1, 0)) / s;
+                out.y = (in(0, 1) + in(1, 0)) / s;
+                out.z = (in(2, 0) + in(0, 2)) / s;
+                out.w = (in(2, 1) - in(1, 2)) / s;
+            } else if (in(1, 1) > in(2, 2)) {
+                const T s = T(2) * std::sqrt(T(1) + in(1, 1) - in(0, 0) - in(2, 2));
+                out.x = (in(0, 1) + in(1, 0)) / s;
                 out.y = T(0.25) * s;
-                out.z = (in.At(1, 2) + in.At(2, 1)) / s;
-                out.w = (in.At(0, 2) - in.At(2, 0)) / s;
+                out.z = (in(1, 2) + in(2, 1)) / s;
+                out.w = (in(0, 2) - in(2, 0)) / s;
             } else {
-                const T s = T(2) * std::sqrt(T(1) + in.At(2, 2) - in.At(0, 0) - in.At(1, 1));
-                out.x = (in.At(0, 2) + in.At(2, 0)) / s;
-                out.y = (in.At(1, 2) + in.At(2, 1)) / s;
+                const T s = T(2) * std::sqrt(T(1) + in(2, 2) - in(0, 0) - in(1, 1));
+                out.x = (in(0, 2) + in(2, 0)) / s;
+                out.y = (in(1, 2) + in(2, 1)) / s;
                 out.z = T(0.25) * s;
-                out.w = (in.At(1, 0) - in.At(0, 1)) / s;
+                out.w = (in(1, 0) - in(0, 1)) / s;
             }
         }
 
-        Normalize(out);
+        out.Normalize();
     }
 
     template<class M, template<typename> class Q, typename T>
@@ -61,17 +61,17 @@ namespace Sm {
         const auto &z = in.z;
         const auto &w = in.w;
 
-        out.At(0, 0) = T(1) - T(2) * y * y - T(2) * z * z;
-        out.At(1, 0) = T(2) * x * y + T(2) * z * w;
-        out.At(2, 0) = T(2) * x * z - T(2) * y * w;
+        out(0, 0) = T(1) - T(2) * y * y - T(2) * z * z;
+        out(1, 0) = T(2) * x * y + T(2) * z * w;
+        out(2, 0) = T(2) * x * z - T(2) * y * w;
 
-        out.At(0, 1) = T(2) * x * y - T(2) * z * w;
-        out.At(1, 1) = T(1) - T(2) * x * x - T(2) * z * z;
-        out.At(2, 1) = T(2) * z * y + T(2) * x * w;
+        out(0, 1) = T(2) * x * y - T(2) * z * w;
+        out(1, 1) = T(1) - T(2) * x * x - T(2) * z * z;
+        out(2, 1) = T(2) * z * y + T(2) * x * w;
 
-        out.At(0, 2) = T(2) * x * z + T(2) * y * w;
-        out.At(1, 2) = T(2) * z * y - T(2) * x * w;
-        out.At(2, 2) = T(1) - T(2) * x * x - T(2) * y * y;
+        out(0, 2) = T(2) * x * z + T(2) * y * w;
+        out(1, 2) = T(2) * z * y - T(2) * x * w;
+        out(2, 2) = T(1) - T(2) * x * x - T(2) * y * y;
     }
 
     template<class M, template<typename> class Q, typename T>
@@ -86,17 +86,18 @@ namespace Sm {
         const auto &z = in.z;
         const auto &w = in.w;
 
-        out.At(0, 0) = T(1) - T(2) * y * y - T(2) * z * z;
-        out.At(0, 1) = T(2) * x * y - T(2) * z * w;
-        out.At(0, 2) = T(2) * x * z + T(2) * y * w;
+        /* quaternion_to_matrix with every (row, column) swapped */
+        out(0, 0) = T(1) - T(2) * y * y - T(2) * z * z;
+        out(0, 1) = T(2) * x * y + T(2) * z * w;
+        out(0, 2) = T(2) * x * z - T(2) * y * w;
 
-        out.At(1, 0) = T(2) * x * y + T(2) * z * w;
-        out.At(1, 1) = T(1) - T(2) * x * x - T(2) * z * z;
-        out.At(1, 2) = T(2) * z * y - T(2) * x * w;
+        out(1, 0) = T(2) * x * y - T(2) * z * w;
+        out(1, 1) = T(1) - T(2) * x * x - T(2) * z * z;
+        out(1, 2) = T(2) * z * y + T(2) * x * w;
 
-        out.At(2, 0) = T(2) * x * z - T(2) * y * w;
-        out.At(2, 1) = T(2) * z * y + T(2) * x * w;
-        out.At(2, 2) = T(1) - T(2) * x * x - T(2) * y * y;
+        out(2, 0) = T(2) * x * z + T(2) * y * w;
+        out(2, 1) = T(2) * z * y - T(2) * x * w;
+        out(2, 2) = T(1) - T(2) * x * x - T(2) * y * y;
     }
 };
 
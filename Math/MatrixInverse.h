@@ -0,0 +1,216 @@
+#ifndef SLIMEMATHS_MATRIXINVERSE_H
+#define SLIMEMATHS_MATRIXINVERSE_H
+
+#include <cstddef>
+
+// Unrolled cofactor kernels behind Matrix::determinant/inverse.
+// Every kernel works on row major element pointers. adjugate() writes the adjugate matrix
+// and returns the determinant, so the inverse is the adjugate scaled by 1 / determinant.
+
+namespace Sm {
+    namespace detail {
+
+        template<typename T, std::size_t N>
+        struct MatrixInverseKernel {
+            static_assert(N >= 2 && N <= 4, "determinant and inverse are only implemented for 2x2, 3x3 and 4x4 matrices");
+        };
+
+        template<typename T>
+        struct MatrixInverseKernel<T, 2> {
+            static constexpr T determinant(const T *m) {
+                return m[0] * m[3] - m[1] * m[2];
+            }
+
+            static constexpr T adjugate(T *out, const T *m) {
+                const T det = determinant(m);
+                const T m0 = m[0], m1 = m[1], m2 = m[2], m3 = m[3];
+                out[0] = m3;
+                out[1] = -m1;
+                out[2] = -m2;
+                out[3] = m0;
+                return det;
+            }
+        };
+
+        template<typename T>
+        struct MatrixInverseKernel<T, 3> {
+            static constexpr T determinant(const T *m) {
+                return m[0] * (m[4] * m[8] - m[5] * m[7]) +
+                       m[1] * (m[5] * m[6] - m[3] * m[8]) +
+                       m[2] * (m[3] * m[7] - m[4] * m[6]);
+            }
+
+            static constexpr T adjugate(T *out, const T *m) {
+                const T m0 = m[0], m1 = m[1], m2 = m[2];
+                const T m3 = m[3], m4 = m[4], m5 = m[5];
+                const T m6 = m[6], m7 = m[7], m8 = m[8];
+
+                /* Cofactors of the first row double as the first column of the adjugate */
+                const T c0 = m4 * m8 - m5 * m7;
+                const T c1 = m5 * m6 - m3 * m8;
+                const T c2 = m3 * m7 - m4 * m6;
+
+                out[0] = c0;
+                out[1] = m2 * m7 - m1 * m8;
+                out[2] = m1 * m5 - m2 * m4;
+                out[3] = c1;
+                out[4] = m0 * m8 - m2 * m6;
+                out[5] = m2 * m3 - m0 * m5;
+                out[6] = c2;
+                out[7] = m1 * m6 - m0 * m7;
+                out[8] = m0 * m4 - m1 * m3;
+
+                return m0 * c0 + m1 * c1 + m2 * c2;
+            }
+        };
+
+        template<typename T>
+        struct MatrixInverseKernel<T, 4> {
+            // 2x2 minors of the top two rows (s) and bottom two rows (c), shared by every cofactor
+            struct Minors {
+                T s0, s1, s2, s3, s4, s5;
+                T c0, c1, c2, c3, c4, c5;
+            };
+
+            static constexpr Minors minors(const T *m) {
+                return Minors{
+                        m[0] * m[5] - m[4] * m[1],
+                        m[0] * m[6] - m[4] * m[2],
+                        m[0] * m[7] - m[4] * m[3],
+                        m[1] * m[6] - m[5] * m[2],
+                        m[1] * m[7] - m[5] * m[3],
+                        m[2] * m[7] - m[6] * m[3],
+                        m[8] * m[13] - m[12] * m[9],
+                        m[8] * m[14] - m[12] * m[10],
+                        m[8] * m[15] - m[12] * m[11],
+                        m[9] * m[14] - m[13] * m[10],
+                        m[9] * m[15] - m[13] * m[11],
+                        m[10] * m[15] - m[14] * m[11]
+                };
+            }
+
+            static constexpr T determinant(const Minors &n) {
+                return n.s0 * n.c5 - n.s1 * n.c4 + n.s2 * n.c3 + n.s3 * n.c2 - n.s4 * n.c1 + n.s5 * n.c0;
+            }
+
+            static constexpr T determinant(const T *m) {
+                return determinant(minors(m));
+            }
+
+            static constexpr T adjugate(T *out, const T *m) {
+                const Minors n = minors(m);
+                const T a00 = m[0], a01 = m[1], a02 = m[2], a03 = m[3];
+                const T a10 = m[4], a11 = m[5], a12 = m[6], a13 = m[7];
+                const T a20 = m[8], a21 = m[9], a22 = m[10], a23 = m[11];
+                const T a30 = m[12], a31 = m[13], a32 = m[14], a33 = m[15];
+
+                out[0] = a11 * n.c5 - a12 * n.c4 + a13 * n.c3;
+                out[1] = -a01 * n.c5 + a02 * n.c4 - a03 * n.c3;
+                out[2] = a31 * n.s5 - a32 * n.s4 + a33 * n.s3;
+                out[3] = -a21 * n.s5 + a22 * n.s4 - a23 * n.s3;
+
+                out[4] = -a10 * n.c5 + a12 * n.c2 - a13 * n.c1;
+                out[5] = a00 * n.c5 - a02 * n.c2 + a03 * n.c1;
+                out[6] = -a30 * n.s5 + a32 * n.s2 - a33 * n.s1;
+                out[7] = a20 * n.s5 - a22 * n.s2 + a23 * n.s1;
+
+                out[8] = a10 * n.c4 - a11 * n.c2 + a13 * n.c0;
+                out[9] = -a00 * n.c4 + a01 * n.c2 - a03 * n.c0;
+                out[10] = a30 * n.s4 - a31 * n.s2 + a33 * n.s0;
+                out[11] = -a20 * n.s4 + a21 * n.s2 - a23 * n.s0;
+
+                out[12] = -a10 * n.c3 + a11 * n.c1 - a12 * n.c0;
+                out[13] = a00 * n.c3 - a01 * n.c1 + a02 * n.c0;
+                out[14] = -a30 * n.s3 + a31 * n.s1 - a32 * n.s0;
+                out[15] = a20 * n.s3 - a21 * n.s1 + a22 * n.s0;
+
+                return determinant(n);
+            }
+        };
+
+        // Inverse of [A | t; 0 1] as [A^-1 | -A^-1 t; 0 1].
+        // rigid() assumes A is a pure rotation so A^-1 = A^T and no determinant is needed.
+        template<typename T, std::size_t N>
+        struct AffineInverseKernel {
+            static_assert(N == 3 || N == 4, "affine inverses are only implemented for 3x3 and 4x4 matrices");
+        };
+
+        template<typename T>
+        struct AffineInverseKernel<T, 3> {
+            static constexpr void finish(T *out, const T *m, T a00, T a01, T a10, T a11) {
+                const T tx = m[2], ty = m[5];
+                out[0] = a00;
+                out[1] = a01;
+                out[2] = -(a00 * tx + a01 * ty);
+                out[3] = a10;
+                out[4] = a11;
+                out[5] = -(a10 * tx + a11 * ty);
+                out[6] = T(0);
+                out[7] = T(0);
+                out[8] = T(1);
+            }
+
+            static constexpr void affine(T *out, const T *m) {
+                const T invDet = T(1) / (m[0] * m[4] - m[1] * m[3]);
+                finish(out, m, m[4] * invDet, -m[1] * invDet, -m[3] * invDet, m[0] * invDet);
+            }
+
+            static constexpr void rigid(T *out, const T *m) {
+                finish(out, m, m[0], m[3], m[1], m[4]);
+            }
+        };
+
+        template<typename T>
+        struct AffineInverseKernel<T, 4> {
+            // a holds the inverted 3x3 block row major
+            static constexpr void finish(T *out, const T *m, const T *a) {
+                const T tx = m[3], ty = m[7], tz = m[11];
+                out[0] = a[0];
+                out[1] = a[1];
+                out[2] = a[2];
+                out[3] = -(a[0] * tx + a[1] * ty + a[2] * tz);
+                out[4] = a[3];
+                out[5] = a[4];
+                out[6] = a[5];
+                out[7] = -(a[3] * tx + a[4] * ty + a[5] * tz);
+                out[8] = a[6];
+                out[9] = a[7];
+                out[10] = a[8];
+                out[11] = -(a[6] * tx + a[7] * ty + a[8] * tz);
+                out[12] = T(0);
+                out[13] = T(0);
+                out[14] = T(0);
+                out[15] = T(1);
+            }
+
+            static constexpr void affine(T *out, const T *m) {
+                const T m0 = m[0], m1 = m[1], m2 = m[2];
+                const T m3 = m[4], m4 = m[5], m5 = m[6];
+                const T m6 = m[8], m7 = m[9], m8 = m[10];
+
+                const T c0 = m4 * m8 - m5 * m7;
+                const T c1 = m5 * m6 - m3 * m8;
+                const T c2 = m3 * m7 - m4 * m6;
+                const T invDet = T(1) / (m0 * c0 + m1 * c1 + m2 * c2);
+
+                const T a[9] = {
+                        c0 * invDet, (m2 * m7 - m1 * m8) * invDet, (m1 * m5 - m2 * m4) * invDet,
+                        c1 * invDet, (m0 * m8 - m2 * m6) * invDet, (m2 * m3 - m0 * m5) * invDet,
+                        c2 * invDet, (m1 * m6 - m0 * m7) * invDet, (m0 * m4 - m1 * m3) * invDet
+                };
+                finish(out, m, a);
+            }
+
+            static constexpr void rigid(T *out, const T *m) {
+                const T a[9] = {
+                        m[0], m[4], m[8],
+                        m[1], m[5], m[9],
+                        m[2], m[6], m[10]
+                };
+                finish(out, m, a);
+            }
+        };
+    }
+}
+
+#endif //SLIMEMATHS_MATRIXINVERSE_H
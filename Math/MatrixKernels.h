@@ -0,0 +1,243 @@
+#ifndef SLIMEMATHS_MATRIXKERNELS_H
+#define SLIMEMATHS_MATRIXKERNELS_H
+
+#include <cstddef>
+#include "Simd.h"
+
+// Raw multiply kernels shared by the Matrix and Sm:: operators.
+// Every kernel works on row major element pointers, the generic templates are the scalar fallback
+// and the specializations below replace them for the hot float/double sizes when SIMD is available.
+// The SIMD versions accumulate in the same order as the scalar loops so results match bit for bit.
+
+namespace Sm {
+    namespace detail {
+
+        // out = lhs * rhs
+        template<typename T, std::size_t Rows, std::size_t ColsRows, std::size_t Cols>
+        struct MatrixMultiplyScalar {
+            static constexpr void apply(T *out, const T *lhs, const T *rhs) {
+                for (std::size_t r = 0; r < Rows; ++r)
+                    for (std::size_t c = 0; c < Cols; ++c) {
+                        T sum = T(0);
+                        for (std::size_t i = 0; i < ColsRows; ++i)
+                            sum += lhs[r * ColsRows + i] * rhs[i * Cols + c];
+                        out[r * Cols + c] = sum;
+                    }
+            }
+        };
+
+        template<typename T, std::size_t Rows, std::size_t ColsRows, std::size_t Cols>
+        struct MatrixMultiplyKernel : MatrixMultiplyScalar<T, Rows, ColsRows, Cols> {
+        };
+
+        // out = mat * vec (column vector)
+        template<typename T, std::size_t Rows, std::size_t Cols>
+        struct MatrixVectorKernel {
+            static void apply(T *out, const T *mat, const T *vec) {
+                for (std::size_t r = 0; r < Rows; ++r) {
+                    T sum = T(0);
+                    for (std::size_t c = 0; c < Cols; ++c)
+                        sum += mat[r * Cols + c] * vec[c];
+                    out[r] = sum;
+                }
+            }
+        };
+
+        // out = vec * mat (row vector)
+        template<typename T, std::size_t Rows, std::size_t Cols>
+        struct VectorMatrixKernel {
+            static void apply(T *out, const T *vec, const T *mat) {
+                for (std::size_t c = 0; c < Cols; ++c) {
+                    T sum = T(0);
+                    for (std::size_t r = 0; r < Rows; ++r)
+                        sum += mat[r * Cols + c] * vec[r];
+                    out[c] = sum;
+                }
+            }
+        };
+
+#if defined(SLIMEMATHS_SSE2)
+
+        // Loads x, y, z into the low lanes and zeroes w without touching memory past p[2].
+        inline __m128 load_float3(const float *p) {
+            const __m128 xy = _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)));
+            return _mm_movelh_ps(xy, _mm_load_ss(p + 2));
+        }
+
+        inline void store_float3(float *p, const __m128 &v) {
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(p), _mm_castps_si128(v));
+            _mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+        }
+
+        template<>
+        struct MatrixMultiplyKernel<float, 4, 4, 4> {
+            static void apply(float *out, const float *lhs, const float *rhs) {
+                const __m128 b0 = _mm_loadu_ps(rhs);
+                const __m128 b1 = _mm_loadu_ps(rhs + 4);
+                const __m128 b2 = _mm_loadu_ps(rhs + 8);
+                const __m128 b3 = _mm_loadu_ps(rhs + 12);
+
+                for (std::size_t r = 0; r < 4; ++r) {
+                    const float *a = lhs + r * 4;
+                    __m128 row = _mm_mul_ps(_mm_set1_ps(a[0]), b0);
+                    row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a[1]), b1));
+                    row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a[2]), b2));
+                    row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a[3]), b3));
+                    _mm_storeu_ps(out + r * 4, row);
+                }
+            }
+        };
+
+        template<>
+        struct MatrixMultiplyKernel<float, 3, 3, 3> {
+            static void apply(float *out, const float *lhs, const float *rhs) {
+                const __m128 b0 = load_float3(rhs);
+                const __m128 b1 = load_float3(rhs + 3);
+                const __m128 b2 = load_float3(rhs + 6);
+
+                for (std::size_t r = 0; r < 3; ++r) {
+                    const float *a = lhs + r * 3;
+                    __m128 row = _mm_mul_ps(_mm_set1_ps(a[0]), b0);
+                    row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a[1]), b1));
+                    row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a[2]), b2));
+                    store_float3(out + r * 3, row);
+                }
+            }
+        };
+
+        template<>
+        struct MatrixMultiplyKernel<double, 4, 4, 4> {
+            static void apply(double *out, const double *lhs, const double *rhs) {
+#if defined(SLIMEMATHS_AVX)
+                const __m256d b0 = _mm256_loadu_pd(rhs);
+                const __m256d b1 = _mm256_loadu_pd(rhs + 4);
+                const __m256d b2 = _mm256_loadu_pd(rhs + 8);
+                const __m256d b3 = _mm256_loadu_pd(rhs + 12);
+
+                for (std::size_t r = 0; r < 4; ++r) {
+                    const double *a = lhs + r * 4;
+                    __m256d row = _mm256_mul_pd(_mm256_set1_pd(a[0]), b0);
+                    row = _mm256_add_pd(row, _mm256_mul_pd(_mm256_set1_pd(a[1]), b1));
+                    row = _mm256_add_pd(row, _mm256_mul_pd(_mm256_set1_pd(a[2]), b2));
+                    row = _mm256_add_pd(row, _mm256_mul_pd(_mm256_set1_pd(a[3]), b3));
+                    _mm256_storeu_pd(out + r * 4, row);
+                }
+#else
+                __m128d lo[4], hi[4];
+                for (std::size_t i = 0; i < 4; ++i) {
+                    lo[i] = _mm_loadu_pd(rhs + i * 4);
+                    hi[i] = _mm_loadu_pd(rhs + i * 4 + 2);
+                }
+
+                for (std::size_t r = 0; r < 4; ++r) {
+                    const double *a = lhs + r * 4;
+                    __m128d s = _mm_set1_pd(a[0]);
+                    __m128d rowLo = _mm_mul_pd(s, lo[0]);
+                    __m128d rowHi = _mm_mul_pd(s, hi[0]);
+                    for (std::size_t i = 1; i < 4; ++i) {
+                        s = _mm_set1_pd(a[i]);
+                        rowLo = _mm_add_pd(rowLo, _mm_mul_pd(s, lo[i]));
+                        rowHi = _mm_add_pd(rowHi, _mm_mul_pd(s, hi[i]));
+                    }
+                    _mm_storeu_pd(out + r * 4, rowLo);
+                    _mm_storeu_pd(out + r * 4 + 2, rowHi);
+                }
+#endif
+            }
+        };
+
+        template<>
+        struct MatrixVectorKernel<float, 4, 4> {
+            static void apply(float *out, const float *mat, const float *vec) {
+                const __m128 v = _mm_loadu_ps(vec);
+                __m128 p0 = _mm_mul_ps(_mm_loadu_ps(mat), v);
+                __m128 p1 = _mm_mul_ps(_mm_loadu_ps(mat + 4), v);
+                __m128 p2 = _mm_mul_ps(_mm_loadu_ps(mat + 8), v);
+                __m128 p3 = _mm_mul_ps(_mm_loadu_ps(mat + 12), v);
+
+                /* Lane i of pN now holds term N of row i */
+                _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+                _mm_storeu_ps(out, _mm_add_ps(_mm_add_ps(_mm_add_ps(p0, p1), p2), p3));
+            }
+        };
+
+        template<>
+        struct MatrixVectorKernel<float, 3, 3> {
+            static void apply(float *out, const float *mat, const float *vec) {
+                const __m128 v = load_float3(vec);
+                __m128 p0 = _mm_mul_ps(load_float3(mat), v);
+                __m128 p1 = _mm_mul_ps(load_float3(mat + 3), v);
+                __m128 p2 = _mm_mul_ps(load_float3(mat + 6), v);
+                __m128 p3 = _mm_setzero_ps();
+
+                _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+                store_float3(out, _mm_add_ps(_mm_add_ps(p0, p1), p2));
+            }
+        };
+
+        template<>
+        struct MatrixVectorKernel<double, 4, 4> {
+            static void apply(double *out, const double *mat, const double *vec) {
+#if defined(SLIMEMATHS_AVX)
+                const __m256d v = _mm256_loadu_pd(vec);
+                const __m256d p0 = _mm256_mul_pd(_mm256_loadu_pd(mat), v);
+                const __m256d p1 = _mm256_mul_pd(_mm256_loadu_pd(mat + 4), v);
+                const __m256d p2 = _mm256_mul_pd(_mm256_loadu_pd(mat + 8), v);
+                const __m256d p3 = _mm256_mul_pd(_mm256_loadu_pd(mat + 12), v);
+
+                const __m256d t0 = _mm256_unpacklo_pd(p0, p1);
+                const __m256d t1 = _mm256_unpackhi_pd(p0, p1);
+                const __m256d t2 = _mm256_unpacklo_pd(p2, p3);
+                const __m256d t3 = _mm256_unpackhi_pd(p2, p3);
+
+                const __m256d c0 = _mm256_permute2f128_pd(t0, t2, 0x20);
+                const __m256d c1 = _mm256_permute2f128_pd(t1, t3, 0x20);
+                const __m256d c2 = _mm256_permute2f128_pd(t0, t2, 0x31);
+                const __m256d c3 = _mm256_permute2f128_pd(t1, t3, 0x31);
+
+                _mm256_storeu_pd(out, _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(c0, c1), c2), c3));
+#else
+                const __m128d vLo = _mm_loadu_pd(vec);
+                const __m128d vHi = _mm_loadu_pd(vec + 2);
+
+                for (std::size_t r = 0; r < 4; r += 2) {
+                    const __m128d lo0 = _mm_mul_pd(_mm_loadu_pd(mat + r * 4), vLo);
+                    const __m128d hi0 = _mm_mul_pd(_mm_loadu_pd(mat + r * 4 + 2), vHi);
+                    const __m128d lo1 = _mm_mul_pd(_mm_loadu_pd(mat + r * 4 + 4), vLo);
+                    const __m128d hi1 = _mm_mul_pd(_mm_loadu_pd(mat + r * 4 + 6), vHi);
+
+                    __m128d sum = _mm_add_pd(_mm_unpacklo_pd(lo0, lo1), _mm_unpackhi_pd(lo0, lo1));
+                    sum = _mm_add_pd(sum, _mm_unpacklo_pd(hi0, hi1));
+                    sum = _mm_add_pd(sum, _mm_unpackhi_pd(hi0, hi1));
+                    _mm_storeu_pd(out + r, sum);
+                }
+#endif
+            }
+        };
+
+        template<>
+        struct VectorMatrixKernel<float, 4, 4> {
+            static void apply(float *out, const float *vec, const float *mat) {
+                __m128 row = _mm_mul_ps(_mm_loadu_ps(mat), _mm_set1_ps(vec[0]));
+                row = _mm_add_ps(row, _mm_mul_ps(_mm_loadu_ps(mat + 4), _mm_set1_ps(vec[1])));
+                row = _mm_add_ps(row, _mm_mul_ps(_mm_loadu_ps(mat + 8), _mm_set1_ps(vec[2])));
+                row = _mm_add_ps(row, _mm_mul_ps(_mm_loadu_ps(mat + 12), _mm_set1_ps(vec[3])));
+                _mm_storeu_ps(out, row);
+            }
+        };
+
+        template<>
+        struct VectorMatrixKernel<float, 3, 3> {
+            static void apply(float *out, const float *vec, const float *mat) {
+                __m128 row = _mm_mul_ps(load_float3(mat), _mm_set1_ps(vec[0]));
+                row = _mm_add_ps(row, _mm_mul_ps(load_float3(mat + 3), _mm_set1_ps(vec[1])));
+                row = _mm_add_ps(row, _mm_mul_ps(load_float3(mat + 6), _mm_set1_ps(vec[2])));
+                store_float3(out, row);
+            }
+        };
+
+#endif
+    }
+}
+
+#endif //SLIMEMATHS_MATRIXKERNELS_H
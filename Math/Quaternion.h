@@ -5,9 +5,12 @@
 #ifndef SLIMEMATHS_QUATERNION_H
 #define SLIMEMATHS_QUATERNION_H
 
+#include <type_traits>
+#include "Simd.h"
 #include "SlimeAlgebra.h"
 #include "Matrix.h"
 #include "MatrixConversion.h"
+#include "Instrument.h"
 
 template<typename T>
 struct Quaternion {
@@ -17,21 +20,16 @@ struct Quaternion {
     static const std::size_t components = 4;
 
 
-    Quaternion() :
+    constexpr Quaternion() :
             x{T(0)},
             y{T(0)},
             z{T(0)},
             w{T(1)} {
     }
 
-    Quaternion(const Quaternion<T> &rhs) :
-            x{rhs.x},
-            y{rhs.y},
-            z{rhs.z},
-            w{rhs.w} {
-    }
+    constexpr Quaternion(const Quaternion<T> &rhs) = default;
 
-    Quaternion(const T &x, const T &y, const T &z, const T &w) :
+    constexpr Quaternion(const T &x, const T &y, const T &z, const T &w) :
             x{x},
             y{y},
             z{z},
@@ -43,7 +41,7 @@ struct Quaternion {
         Sm::matrix_to_quaternion(*this, matrix);
     }
 
-    Quaternion<T> &operator+=(const Quaternion<T> &rhs) {
+    constexpr Quaternion<T> &operator+=(const Quaternion<T> &rhs) {
         x += rhs.x;
         y += rhs.y;
         z += rhs.z;
@@ -51,7 +49,7 @@ struct Quaternion {
         return *this;
     }
 
-    Quaternion<T> &operator-=(const Quaternion<T> &rhs) {
+    constexpr Quaternion<T> &operator-=(const Quaternion<T> &rhs) {
         x -= rhs.x;
         y -= rhs.y;
         z -= rhs.z;
@@ -59,12 +57,12 @@ struct Quaternion {
         return *this;
     }
 
-    Quaternion<T> &operator*=(const Quaternion<T> &rhs) {
+    constexpr Quaternion<T> &operator*=(const Quaternion<T> &rhs) {
         *this = (*this * rhs);
         return *this;
     }
 
-    Quaternion<T> &operator*=(const T &rhs) {
+    constexpr Quaternion<T> &operator*=(const T &rhs) {
         x *= rhs;
         y *= rhs;
         z *= rhs;
@@ -72,15 +70,20 @@ struct Quaternion {
         return *this;
     }
 
-    T &operator[](std::size_t component) {
+    constexpr T &operator[](std::size_t component) {
+        if (SLIMEMATHS_IS_CONSTANT_EVALUATED())
+            return component == 0 ? x : component == 1 ? y : component == 2 ? z : w;
         return *((&x) + component);
     }
 
-    const T &operator[](std::size_t component) const {
+    constexpr const T &operator[](std::size_t component) const {
+        if (SLIMEMATHS_IS_CONSTANT_EVALUATED())
+            return component == 0 ? x : component == 1 ? y : component == 2 ? z : w;
         return *((&x) + component);
     }
 
     void Normalize() {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Quaternion::Normalize");
         Sm::normalize(*this);
     }
 
@@ -90,26 +93,28 @@ struct Quaternion {
         return quat;
     }
 
-    void LoadIdentity() {
+    constexpr void LoadIdentity() {
         x = y = z = T(0);
         w = T(1);
     }
 
-    void MakeInverse() {
+    constexpr void MakeInverse() {
         x = -x;
         y = -y;
         z = -z;
     }
 
-    Quaternion<T> Inverse() const {
+    constexpr Quaternion<T> Inverse() const {
         return Quaternion<T>{-x, -y, -z, w};
     }
 
     void slerp(const Quaternion<T> &from, Quaternion<T> to, const T &t) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Quaternion::slerp");
         *this = Sm::slerp(from, to, t);
     }
 
     void set_euler_angles(const Vector<T, 3> &angles) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Quaternion::set_euler_angles");
         const T cr = std::cos(angles.x / T(2));
         const T cp = std::cos(angles.y / T(2));
         const T cy = std::cos(angles.z / T(2));
@@ -138,11 +143,12 @@ struct Quaternion {
         const T ww = w * w;
 
         angles.x = std::atan2(T(2) * (y * z + x * w), -xx - yy + zz + ww);
-        angles.y = std::asin(Clamp(T(2) * (y * w - x * z), T(-1), T(1)));
+        angles.y = std::asin(Sm::clamp(T(2) * (y * w - x * z), T(-1), T(1)));
         angles.z = std::atan2(T(2) * (x * y + z * w), xx - yy - zz + ww);
     }
 
     void set_angle_axis(const Vector<T, 3> &axis, const T &angle) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Quaternion::set_angle_axis");
         const T halfAngle = angle / T(2);
         const T sine = std::sin(halfAngle);
 
@@ -169,20 +175,22 @@ struct Quaternion {
         }
     }
 
-    Mat3 ToMatrix3() const {
-        Mat3 result{};
+    Matrix<T, 3, 3> ToMatrix3() const {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Quaternion::ToMatrix3");
+        Matrix<T, 3, 3> result{};
         Sm::quaternion_to_matrix(result, *this);
         return result;
     }
 
-    Mat3 ToMatrix3Transposed() const {
-        Mat3 result{};
+    Matrix<T, 3, 3> ToMatrix3Transposed() const {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Quaternion::ToMatrix3Transposed");
+        Matrix<T, 3, 3> result{};
         Sm::quaternion_to_matrix_transposed(result, *this);
         return result;
     }
 
     template<typename C>
-    Quaternion<C> Cast() const {
+    constexpr Quaternion<C> Cast() const {
         return Quaternion<C>(
                 static_cast<C>(x),
                 static_cast<C>(y),
@@ -191,23 +199,23 @@ struct Quaternion {
         );
     }
 
-    T *Ptr() {
+    constexpr T *Ptr() {
         return &x;
     }
 
-    const T *Ptr() const {
+    constexpr const T *Ptr() const {
         return &x;
     }
 
     static Quaternion<T> EulerAngles(const Vector<T, 3> &angles) {
         Quaternion<T> result;
-        result.SetEulerAngles(angles);
+        result.set_euler_angles(angles);
         return result;
     }
 
     static Quaternion<T> AngleAxis(const Vector<T, 3> &axis, const T &angle) {
         Quaternion<T> result;
-        result.SetAngleAxis(axis, angle);
+        result.set_angle_axis(axis, angle);
         return result;
     }
 
@@ -216,21 +224,24 @@ struct Quaternion {
 };
 
 template<typename T>
-Quaternion<T> operator+(const Quaternion<T> &lhs, const Quaternion<T> &rhs) {
+constexpr Quaternion<T> operator+(const Quaternion<T> &lhs, const Quaternion<T> &rhs) {
+    SLIMEMATHS_INSTRUMENT_CALL("Quaternion::operator+");
     auto result = lhs;
     result += rhs;
     return result;
 }
 
 template<typename T>
-Quaternion<T> operator-(const Quaternion<T> &lhs, const Quaternion<T> &rhs) {
+constexpr Quaternion<T> operator-(const Quaternion<T> &lhs, const Quaternion<T> &rhs) {
+    SLIMEMATHS_INSTRUMENT_CALL("Quaternion::operator-");
     auto result = lhs;
     result -= rhs;
     return result;
 }
 
 template<typename T>
-Quaternion<T> operator*(const Quaternion<T> &lhs, const Quaternion<T> &rhs) {
+constexpr Quaternion<T> operator*(const Quaternion<T> &lhs, const Quaternion<T> &rhs) {
+    SLIMEMATHS_INSTRUMENT_CALL("Quaternion::operator*");
     return Quaternion<T>
             {
                     ((lhs.x * rhs.w) + (lhs.w * rhs.x) + (lhs.z * rhs.y) - (lhs.y * rhs.z)),
@@ -241,25 +252,28 @@ Quaternion<T> operator*(const Quaternion<T> &lhs, const Quaternion<T> &rhs) {
 }
 
 template<typename T>
-Quaternion<T> operator*(const Quaternion<T> &lhs, const T &rhs) {
+constexpr Quaternion<T> operator*(const Quaternion<T> &lhs, const T &rhs) {
+    SLIMEMATHS_INSTRUMENT_CALL("Quaternion::operator*(scalar)");
     auto result = lhs;
     result *= rhs;
     return result;
 }
 
 template<typename T>
-Quaternion<T> operator*(const T &lhs, const Quaternion<T> &rhs) {
+constexpr Quaternion<T> operator*(const T &lhs, const Quaternion<T> &rhs) {
+    SLIMEMATHS_INSTRUMENT_CALL("Quaternion::operator*(scalar)");
     auto result = rhs;
     result *= lhs;
     return result;
 }
 
 template<typename T>
-Vector<T, 3> operator*(const Quaternion<T> &lhs, const Vector<T, 3> &rhs) {
+constexpr Vector<T, 3> operator*(const Quaternion<T> &lhs, const Vector<T, 3> &rhs) {
+    SLIMEMATHS_INSTRUMENT_CALL("Quaternion::operator*(Vector)");
     Vector<T, 3> qvec{lhs.x, lhs.y, lhs.z};
 
-    auto uv = Cross(qvec, rhs);
-    auto uuv = Cross(qvec, uv);
+    auto uv = Sm::cross(qvec, rhs);
+    auto uuv = Sm::cross(qvec, uv);
 
     uv *= (T(2) * lhs.w);
     uuv *= T(2);
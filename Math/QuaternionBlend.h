@@ -0,0 +1,210 @@
+#ifndef SLIMEMATHS_QUATERNIONBLEND_H
+#define SLIMEMATHS_QUATERNIONBLEND_H
+
+#include <cstddef>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include "Quaternion.h"
+#include "FastMath.h"
+#include "SimdPack.h"
+#include "Executor.h"
+#include "Instrument.h"
+
+// Batch quaternion blending for animation.
+// Quaternions are transposed into packs so one call evaluates several joints per instruction.
+//
+// SlerpMode::Accurate evaluates the slerp formula on whole packs with the Sm::fast trig kernels, only the scalar
+// tail runs one element at a time. It returns exactly what Sm::fast::slerp returns for every element and its rotation
+// error against Sm::slerp is at most slerp_accurate_max_error(), about what std::acos and std::sin lose in float.
+// Its results are unit length to within the same bound, they are not renormalized.
+// SlerpMode::Fast is a corrected nlerp: the blend factor is warped by a cubic fitted to slerp
+// (Kapoulkine, "Approximating slerp") and the result is renormalized. It needs no trig at all and
+// always returns a unit quaternion. Its rotation error against slerp is at most slerp_fast_max_error().
+
+namespace Sm {
+
+    enum class SlerpMode {
+        Accurate,
+        Fast
+    };
+
+    // Largest rotation angle (radians) between SlerpMode::Accurate and Sm::slerp for unit inputs, and the largest
+    // amount its results are off unit length. Measured over 2M random unit quaternion pairs, a third of them less
+    // than 0.01 apart, and t in [0, 1]: float 4.5e-7 and 3.6e-7 (Sm::slerp itself is 3.0e-7 off a long double slerp
+    // and 3.3e-7 off unit length), double 4.6e-12 and 1.2e-11.
+    template<typename T>
+    constexpr T slerp_accurate_max_error() {
+        return std::is_same<T, float>::value ? T(6e-7) : T(2e-11);
+    }
+
+    // Largest rotation angle (radians) between SlerpMode::Fast and Sm::slerp for unit inputs.
+    // Measured over 2M random unit quaternion pairs and t in [0, 1], worst case 1.29e-3.
+    template<typename T>
+    constexpr T slerp_fast_max_error() {
+        return T(1.5e-3);
+    }
+
+    namespace detail {
+
+        template<typename P, typename T>
+        void load_quaternions(const Quaternion<T> *q, P &x, P &y, P &z, P &w) {
+            T xs[P::width], ys[P::width], zs[P::width], ws[P::width];
+            for (std::size_t l = 0; l < P::width; ++l) {
+                xs[l] = q[l].x;
+                ys[l] = q[l].y;
+                zs[l] = q[l].z;
+                ws[l] = q[l].w;
+            }
+            x = P::load(xs);
+            y = P::load(ys);
+            z = P::load(zs);
+            w = P::load(ws);
+        }
+
+        template<typename P, typename T>
+        void store_quaternions(Quaternion<T> *q, const P &x, const P &y, const P &z, const P &w) {
+            T xs[P::width], ys[P::width], zs[P::width], ws[P::width];
+            x.store(xs);
+            y.store(ys);
+            z.store(zs);
+            w.store(ws);
+            for (std::size_t l = 0; l < P::width; ++l) {
+                q[l].x = xs[l];
+                q[l].y = ys[l];
+                q[l].z = zs[l];
+                q[l].w = ws[l];
+            }
+        }
+
+#if defined(SLIMEMATHS_SSE2)
+        inline void load_quaternions(const Quaternion<float> *q, simd::Float4 &x, simd::Float4 &y,
+                                     simd::Float4 &z, simd::Float4 &w) {
+            x.v = _mm_loadu_ps(q[0].Ptr());
+            y.v = _mm_loadu_ps(q[1].Ptr());
+            z.v = _mm_loadu_ps(q[2].Ptr());
+            w.v = _mm_loadu_ps(q[3].Ptr());
+            _MM_TRANSPOSE4_PS(x.v, y.v, z.v, w.v);
+        }
+
+        inline void store_quaternions(Quaternion<float> *q, simd::Float4 x, simd::Float4 y,
+                                      simd::Float4 z, simd::Float4 w) {
+            _MM_TRANSPOSE4_PS(x.v, y.v, z.v, w.v);
+            _mm_storeu_ps(q[0].Ptr(), x.v);
+            _mm_storeu_ps(q[1].Ptr(), y.v);
+            _mm_storeu_ps(q[2].Ptr(), z.v);
+            _mm_storeu_ps(q[3].Ptr(), w.v);
+        }
+
+        inline void load_quaternions(const Quaternion<double> *q, simd::Double2 &x, simd::Double2 &y,
+                                     simd::Double2 &z, simd::Double2 &w) {
+            const __m128d xy0 = _mm_loadu_pd(q[0].Ptr()), zw0 = _mm_loadu_pd(q[0].Ptr() + 2);
+            const __m128d xy1 = _mm_loadu_pd(q[1].Ptr()), zw1 = _mm_loadu_pd(q[1].Ptr() + 2);
+            x.v = _mm_unpacklo_pd(xy0, xy1);
+            y.v = _mm_unpackhi_pd(xy0, xy1);
+            z.v = _mm_unpacklo_pd(zw0, zw1);
+            w.v = _mm_unpackhi_pd(zw0, zw1);
+        }
+#endif
+
+        // blend factor for element i comes from weight(pack, i)
+        template<typename T, typename Weight>
+        void blend_quaternions(const Quaternion<T> *from, const Quaternion<T> *to, Quaternion<T> *out,
+                               std::size_t count, SlerpMode mode, Weight &&weight) {
+            simd::for_each_pack<T>(count, [&](auto pack, std::size_t i) {
+                using P = decltype(pack);
+
+                P ax, ay, az, aw, bx, by, bz, bw;
+                load_quaternions(from + i, ax, ay, az, aw);
+                load_quaternions(to + i, bx, by, bz, bw);
+                const P t = weight(pack, i);
+
+                const P one = P::broadcast(T(1));
+                P cosom = ax * bx + ay * by + az * bz + aw * bw;
+                const auto flip = cosom < P::broadcast(T(0));
+                cosom = select(flip, -cosom, cosom);
+                const P sign = select(flip, -one, one);
+
+                P scale0, scale1;
+                if (mode == SlerpMode::Fast) {
+                    const P d = cosom;
+                    const P a = P::broadcast(T(1.0904)) + d * (P::broadcast(T(-3.2452)) +
+                            d * (P::broadcast(T(3.55645)) - d * P::broadcast(T(1.43519))));
+                    const P b = P::broadcast(T(0.848013)) + d * (P::broadcast(T(-1.06021)) +
+                            d * P::broadcast(T(0.215638)));
+                    const P half = t - P::broadcast(T(0.5));
+                    const P k = a * half * half + b;
+                    const P ot = t + t * half * (t - one) * k;
+
+                    scale0 = one - ot;
+                    scale1 = sign * ot;
+                } else {
+                    /* The lanes close enough to blend linearly pick that afterwards, their trig is thrown away */
+                    using Trig = fast::detail::FastTrig<T>;
+                    const auto spherical = (one - cosom) > P::broadcast(std::numeric_limits<T>::epsilon());
+                    const P omega = Trig::acos(cosom);
+                    const P invSinom = one / Trig::sin(omega);
+
+                    scale0 = select(spherical, Trig::sin((one - t) * omega) * invSinom, one - t);
+                    scale1 = sign * select(spherical, Trig::sin(t * omega) * invSinom, t);
+                }
+
+                P rx = ax * scale0 + bx * scale1;
+                P ry = ay * scale0 + by * scale1;
+                P rz = az * scale0 + bz * scale1;
+                P rw = aw * scale0 + bw * scale1;
+
+                if (mode == SlerpMode::Fast) {
+                    const P invLen = one / sqrt(rx * rx + ry * ry + rz * rz + rw * rw);
+                    rx = rx * invLen;
+                    ry = ry * invLen;
+                    rz = rz * invLen;
+                    rw = rw * invLen;
+                }
+
+                store_quaternions(out + i, rx, ry, rz, rw);
+            });
+        }
+    }
+
+    // out[i] = slerp(from[i], to[i], t)
+    template<typename T>
+    void slerp(const Quaternion<T> *from, const Quaternion<T> *to, const T &t, Quaternion<T> *out,
+               std::size_t count, SlerpMode mode = SlerpMode::Accurate) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::slerp(batch)");
+        detail::blend_quaternions(from, to, out, count, mode, [&](auto pack, std::size_t) {
+            return decltype(pack)::broadcast(t);
+        });
+    }
+
+    // out[i] = slerp(from[i], to[i], t[i])
+    template<typename T>
+    void slerp(const Quaternion<T> *from, const Quaternion<T> *to, const T *t, Quaternion<T> *out,
+               std::size_t count, SlerpMode mode = SlerpMode::Accurate) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::slerp(batch)");
+        detail::blend_quaternions(from, to, out, count, mode, [&](auto pack, std::size_t i) {
+            return decltype(pack)::load(t + i);
+        });
+    }
+
+    // Sm::slerp spread over executor
+    template<typename T>
+    void slerp(Executor &executor, const Quaternion<T> *from, const Quaternion<T> *to, const T &t, Quaternion<T> *out,
+               std::size_t count, SlerpMode mode = SlerpMode::Accurate) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::slerp(Executor)");
+        parallel_for(executor, count, [&](std::size_t begin, std::size_t end) {
+            slerp(from + begin, to + begin, t, out + begin, end - begin, mode);
+        }, cache_partition(out, 16 * 1024, simd::WidestPack<T>::width));
+    }
+
+    template<typename T>
+    void slerp(Executor &executor, const Quaternion<T> *from, const Quaternion<T> *to, const T *t, Quaternion<T> *out,
+               std::size_t count, SlerpMode mode = SlerpMode::Accurate) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::slerp(Executor)");
+        parallel_for(executor, count, [&](std::size_t begin, std::size_t end) {
+            slerp(from + begin, to + begin, t + begin, out + begin, end - begin, mode);
+        }, cache_partition(out, 16 * 1024, simd::WidestPack<T>::width));
+    }
+}
+
+#endif //SLIMEMATHS_QUATERNIONBLEND_H
@@ -0,0 +1,277 @@
+#ifndef SLIMEMATHS_QUATERNIONCONVERSION_H
+#define SLIMEMATHS_QUATERNIONCONVERSION_H
+
+#include <cstddef>
+#include "Matrix.h"
+#include "Vector3.h"
+#include "Quaternion.h"
+#include "QuaternionBlend.h"
+#include "SimdPack.h"
+#include "Instrument.h"
+
+// Batch quaternion to matrix conversion, mainly for building skinning palettes every frame.
+// Rotations are transposed into packs so each instruction converts several quaternions, the matrices are
+// written straight into the caller's buffer; nothing is constructed or returned per element.
+//
+// The rotation part matches Sm::quaternion_to_matrix bit for bit. Palettes use the column vector
+// convention of the rest of the library, out[i] = Translate(t) * Rotate(q) * Scale(s), so a 3x4 palette
+// entry is the top three rows of the equivalent 4x4 and can be uploaded as is.
+// Quaternions are expected to be unit length, like Sm::quaternion_to_matrix.
+
+namespace Sm {
+    namespace detail {
+
+        template<typename P, typename T>
+        void load_vectors(const Vector<T, 3> *v, P &x, P &y, P &z) {
+            T xs[P::width], ys[P::width], zs[P::width];
+            for (std::size_t l = 0; l < P::width; ++l) {
+                xs[l] = v[l].x;
+                ys[l] = v[l].y;
+                zs[l] = v[l].z;
+            }
+            x = P::load(xs);
+            y = P::load(ys);
+            z = P::load(zs);
+        }
+
+        template<typename P, typename T>
+        void store_vectors(Vector<T, 3> *v, const P &x, const P &y, const P &z) {
+            T xs[P::width], ys[P::width], zs[P::width];
+            x.store(xs);
+            y.store(ys);
+            z.store(zs);
+            for (std::size_t l = 0; l < P::width; ++l) {
+                v[l].x = xs[l];
+                v[l].y = ys[l];
+                v[l].z = zs[l];
+            }
+        }
+
+        // Lane l of elements[k] is element k of in[l]
+        template<typename P, typename T, std::size_t Rows, std::size_t Cols>
+        void load_matrices(const Matrix<T, Rows, Cols> *in, P *elements) {
+            T lanes[Rows * Cols][P::width];
+            for (std::size_t l = 0; l < P::width; ++l) {
+                const T *src = in[l].ptr();
+                for (std::size_t k = 0; k < Rows * Cols; ++k)
+                    lanes[k][l] = src[k];
+            }
+            for (std::size_t k = 0; k < Rows * Cols; ++k)
+                elements[k] = P::load(lanes[k]);
+        }
+
+        // Writes element k of out[l] from lane l of elements[k]
+        template<typename P, typename T, std::size_t Rows, std::size_t Cols>
+        void store_matrices(Matrix<T, Rows, Cols> *out, const P *elements) {
+            T lanes[Rows * Cols][P::width];
+            for (std::size_t k = 0; k < Rows * Cols; ++k)
+                elements[k].store(lanes[k]);
+            for (std::size_t l = 0; l < P::width; ++l) {
+                T *dst = out[l].ptr();
+                for (std::size_t k = 0; k < Rows * Cols; ++k)
+                    dst[k] = lanes[k][l];
+            }
+        }
+
+#if defined(SLIMEMATHS_SSE2)
+        /* Three loads and six shuffles instead of twelve scalar copies */
+        inline void load_vectors(const Vector<float, 3> *v, simd::Float4 &x, simd::Float4 &y, simd::Float4 &z) {
+            const __m128 a = _mm_loadu_ps(v[0].ptr());     // x0 y0 z0 x1
+            const __m128 b = _mm_loadu_ps(v[0].ptr() + 4); // y1 z1 x2 y2
+            const __m128 c = _mm_loadu_ps(v[0].ptr() + 8); // z2 x3 y3 z3
+
+            x.v = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+            y.v = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+                                 _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+            z.v = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)),
+                                 _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+        }
+
+        inline void store_vectors(Vector<float, 3> *v, const simd::Float4 &x, const simd::Float4 &y,
+                                  const simd::Float4 &z) {
+            const __m128 xy = _mm_unpacklo_ps(x.v, y.v);                            // x0 y0 x1 y1
+            const __m128 zx = _mm_shuffle_ps(z.v, x.v, _MM_SHUFFLE(1, 1, 0, 0));    // z0 z0 x1 x1
+            const __m128 yz = _mm_shuffle_ps(y.v, z.v, _MM_SHUFFLE(1, 1, 1, 1));    // y1 y1 z1 z1
+            const __m128 xy2 = _mm_shuffle_ps(x.v, y.v, _MM_SHUFFLE(2, 2, 2, 2));   // x2 x2 y2 y2
+            const __m128 zx3 = _mm_shuffle_ps(z.v, x.v, _MM_SHUFFLE(3, 3, 2, 2));   // z2 z2 x3 x3
+            const __m128 yz3 = _mm_shuffle_ps(y.v, z.v, _MM_SHUFFLE(3, 3, 3, 3));   // y3 y3 z3 z3
+
+            _mm_storeu_ps(v[0].ptr(), _mm_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 1, 0)));
+            _mm_storeu_ps(v[0].ptr() + 4, _mm_shuffle_ps(yz, xy2, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(v[0].ptr() + 8, _mm_shuffle_ps(zx3, yz3, _MM_SHUFFLE(2, 0, 2, 0)));
+        }
+
+        inline void load_vectors(const Vector<double, 3> *v, simd::Double2 &x, simd::Double2 &y, simd::Double2 &z) {
+            const __m128d a = _mm_loadu_pd(v[0].ptr());     // x0 y0
+            const __m128d b = _mm_loadu_pd(v[0].ptr() + 2); // z0 x1
+            const __m128d c = _mm_loadu_pd(v[0].ptr() + 4); // y1 z1
+
+            x.v = _mm_shuffle_pd(a, b, 2);
+            y.v = _mm_shuffle_pd(a, c, 1);
+            z.v = _mm_shuffle_pd(b, c, 2);
+        }
+
+        inline void store_vectors(Vector<double, 3> *v, const simd::Double2 &x, const simd::Double2 &y,
+                                  const simd::Double2 &z) {
+            _mm_storeu_pd(v[0].ptr(), _mm_unpacklo_pd(x.v, y.v));     // x0 y0
+            _mm_storeu_pd(v[0].ptr() + 2, _mm_shuffle_pd(z.v, x.v, 2)); // z0 x1
+            _mm_storeu_pd(v[0].ptr() + 4, _mm_unpackhi_pd(y.v, z.v));   // y1 z1
+        }
+
+        // Every four elements of four matrices are one 4x4 transpose and four stores, leftovers go lane by lane
+        template<std::size_t Rows, std::size_t Cols>
+        void store_matrices(Matrix<float, Rows, Cols> *out, const simd::Float4 *elements) {
+            constexpr std::size_t size = Rows * Cols;
+            for (std::size_t k = 0; k + 4 <= size; k += 4) {
+                __m128 c0 = elements[k].v, c1 = elements[k + 1].v, c2 = elements[k + 2].v, c3 = elements[k + 3].v;
+                _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+                _mm_storeu_ps(out[0].ptr() + k, c0);
+                _mm_storeu_ps(out[1].ptr() + k, c1);
+                _mm_storeu_ps(out[2].ptr() + k, c2);
+                _mm_storeu_ps(out[3].ptr() + k, c3);
+            }
+            if constexpr (size % 4 != 0)
+                for (std::size_t k = size - size % 4; k < size; ++k) {
+                    const __m128 e = elements[k].v;
+                    _mm_store_ss(out[0].ptr() + k, e);
+                    _mm_store_ss(out[1].ptr() + k, _mm_shuffle_ps(e, e, _MM_SHUFFLE(1, 1, 1, 1)));
+                    _mm_store_ss(out[2].ptr() + k, _mm_shuffle_ps(e, e, _MM_SHUFFLE(2, 2, 2, 2)));
+                    _mm_store_ss(out[3].ptr() + k, _mm_shuffle_ps(e, e, _MM_SHUFFLE(3, 3, 3, 3)));
+                }
+        }
+
+        // Pairs of elements of two matrices are one unpack and two stores
+        template<std::size_t Rows, std::size_t Cols>
+        void store_matrices(Matrix<double, Rows, Cols> *out, const simd::Double2 *elements) {
+            constexpr std::size_t size = Rows * Cols;
+            for (std::size_t k = 0; k + 2 <= size; k += 2) {
+                _mm_storeu_pd(out[0].ptr() + k, _mm_unpacklo_pd(elements[k].v, elements[k + 1].v));
+                _mm_storeu_pd(out[1].ptr() + k, _mm_unpackhi_pd(elements[k].v, elements[k + 1].v));
+            }
+            if constexpr (size % 2 != 0) {
+                _mm_store_sd(out[0].ptr() + size - 1, elements[size - 1].v);
+                _mm_storeh_pd(out[1].ptr() + size - 1, elements[size - 1].v);
+            }
+        }
+#endif
+
+        // Row major rotation matrix of (x, y, z, w), the same expressions as Sm::quaternion_to_matrix
+        template<typename P, typename T>
+        void rotation_elements(const P &x, const P &y, const P &z, const P &w, P (&m)[9]) {
+            const P one = P::broadcast(T(1));
+            const P two = P::broadcast(T(2));
+
+            m[0] = one - two * y * y - two * z * z;
+            m[1] = two * x * y - two * z * w;
+            m[2] = two * x * z + two * y * w;
+
+            m[3] = two * x * y + two * z * w;
+            m[4] = one - two * x * x - two * z * z;
+            m[5] = two * z * y - two * x * w;
+
+            m[6] = two * x * z - two * y * w;
+            m[7] = two * z * y + two * x * w;
+            m[8] = one - two * x * x - two * y * y;
+        }
+
+        // out[i] = Translate(translations[i]) * Rotate(rotations[i]) * Scale(scales[i]), null spans are skipped
+        template<typename T, std::size_t Rows>
+        void compose_palette(const Quaternion<T> *rotations, const Vector<T, 3> *translations,
+                             const Vector<T, 3> *scales, Matrix<T, Rows, 4> *out, std::size_t count) {
+            static_assert(Rows == 3 || Rows == 4, "palettes are 3x4 or 4x4");
+
+            simd::for_each_pack<T>(count, [&](auto pack, std::size_t i) {
+                using P = decltype(pack);
+
+                P x, y, z, w;
+                load_quaternions(rotations + i, x, y, z, w);
+                P rot[9];
+                rotation_elements<P, T>(x, y, z, w, rot);
+
+                P m[Rows * 4];
+                if (scales) {
+                    P sx, sy, sz;
+                    load_vectors(scales + i, sx, sy, sz);
+                    for (std::size_t r = 0; r < 3; ++r) {
+                        m[r * 4] = rot[r * 3] * sx;
+                        m[r * 4 + 1] = rot[r * 3 + 1] * sy;
+                        m[r * 4 + 2] = rot[r * 3 + 2] * sz;
+                    }
+                } else {
+                    for (std::size_t r = 0; r < 3; ++r)
+                        for (std::size_t c = 0; c < 3; ++c)
+                            m[r * 4 + c] = rot[r * 3 + c];
+                }
+
+                const P zero = P::broadcast(T(0));
+                if (translations)
+                    load_vectors(translations + i, m[3], m[7], m[11]);
+                else
+                    m[3] = m[7] = m[11] = zero;
+
+                if constexpr (Rows == 4) {
+                    m[12] = m[13] = m[14] = zero;
+                    m[15] = P::broadcast(T(1));
+                }
+
+                store_matrices(out + i, m);
+            });
+        }
+    }
+
+    // out[i] = rotation matrix of in[i]
+    template<typename T>
+    void quaternion_to_matrix(const Quaternion<T> *in, Matrix<T, 3, 3> *out, std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::quaternion_to_matrix");
+        simd::for_each_pack<T>(count, [&](auto pack, std::size_t i) {
+            using P = decltype(pack);
+
+            P x, y, z, w;
+            detail::load_quaternions(in + i, x, y, z, w);
+            P m[9];
+            detail::rotation_elements<P, T>(x, y, z, w, m);
+            detail::store_matrices(out + i, m);
+        });
+    }
+
+    // out[i] = rotation of in[i] with no translation
+    template<typename T>
+    void quaternion_to_matrix(const Quaternion<T> *in, Matrix<T, 4, 4> *out, std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::quaternion_to_matrix");
+        detail::compose_palette<T, 4>(in, nullptr, nullptr, out, count);
+    }
+
+    // out[i] = Translate(translations[i]) * Rotate(rotations[i]), the top three rows of the 4x4
+    template<typename T>
+    void compose_palette(const Quaternion<T> *rotations, const Vector<T, 3> *translations,
+                         Matrix<T, 3, 4> *out, std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::compose_palette");
+        detail::compose_palette<T>(rotations, translations, nullptr, out, count);
+    }
+
+    // out[i] = Translate(translations[i]) * Rotate(rotations[i]) * Scale(scales[i]), the top three rows of the 4x4
+    template<typename T>
+    void compose_palette(const Quaternion<T> *rotations, const Vector<T, 3> *translations,
+                         const Vector<T, 3> *scales, Matrix<T, 3, 4> *out, std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::compose_palette");
+        detail::compose_palette(rotations, translations, scales, out, count);
+    }
+
+    // out[i] = Translate(translations[i]) * Rotate(rotations[i])
+    template<typename T>
+    void compose_palette(const Quaternion<T> *rotations, const Vector<T, 3> *translations,
+                         Matrix<T, 4, 4> *out, std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::compose_palette");
+        detail::compose_palette<T>(rotations, translations, nullptr, out, count);
+    }
+
+    // out[i] = Translate(translations[i]) * Rotate(rotations[i]) * Scale(scales[i])
+    template<typename T>
+    void compose_palette(const Quaternion<T> *rotations, const Vector<T, 3> *translations,
+                         const Vector<T, 3> *scales, Matrix<T, 4, 4> *out, std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::compose_palette");
+        detail::compose_palette(rotations, translations, scales, out, count);
+    }
+}
+
+#endif //SLIMEMATHS_QUATERNIONCONVERSION_H
@@ -0,0 +1,483 @@
+#ifndef SLIMEMATHS_RAY_H
+#define SLIMEMATHS_RAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <ostream>
+#include "Vector3.h"
+#include "AABB.h"
+#include "QuaternionConversion.h"
+#include "SimdPack.h"
+
+// Ray origin + t * direction for t in [tMin, tMax]. The direction does not have to be unit length,
+// t is then measured in multiples of it.
+// Closest hit queries shrink tMax to the distance of the hit, so the same ray can be passed on to the next
+// primitive and only nearer hits are reported.
+template<typename T>
+struct Ray {
+    static_assert(std::is_floating_point<T>::value, "rays can only be used with floating point types");
+
+    using ScalarType = T;
+    using Vec = Vector<T, 3>;
+
+    // Constructors
+    constexpr Ray() : origin{}, direction{T(0), T(0), T(1)}, tMin{T(0)}, tMax{std::numeric_limits<T>::infinity()} {}
+
+    constexpr Ray(const Ray<T> &rhs) = default;
+
+    constexpr Ray(const Vec &origin, const Vec &direction, const T &tMin = T(0),
+                  const T &tMax = std::numeric_limits<T>::infinity()) :
+            origin{origin}, direction{direction}, tMin{tMin}, tMax{tMax} {}
+
+    constexpr Ray<T> &operator=(const Ray<T> &rhs) = default;
+
+    // Functions
+    constexpr Vec at(const T &t) const {
+        return origin + direction * t;
+    }
+
+    // Component wise 1 / direction, infinite on axes the ray is parallel to
+    constexpr Vec inverse_direction() const {
+        return Vec{T(1) / direction.x, T(1) / direction.y, T(1) / direction.z};
+    }
+
+    template<typename C>
+    constexpr Ray<C> Cast() const {
+        return Ray<C>{Vector<C, 3>{C(origin.x), C(origin.y), C(origin.z)},
+                      Vector<C, 3>{C(direction.x), C(direction.y), C(direction.z)}, C(tMin), C(tMax)};
+    }
+
+    // OStream Overrider
+    friend std::ostream &operator<<(std::ostream &os, const Ray<T> &ray) {
+        os << "[" << ray.origin.x << ", " << ray.origin.y << ", " << ray.origin.z << "] + t["
+           << ray.direction.x << ", " << ray.direction.y << ", " << ray.direction.z << "], t in ["
+           << ray.tMin << ", " << ray.tMax << "]";
+        return os;
+    }
+
+    Vec origin;
+    Vec direction;
+    T tMin;
+    T tMax;
+};
+
+// What a closest hit query found besides the distance, which is left in the ray's tMax.
+// u and v are the barycentric weights of the second and third triangle corner.
+template<typename T>
+struct RayHit {
+    static constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+
+    T u = T(0);
+    T v = T(0);
+    std::uint32_t primitive = none;
+};
+
+// N rays (4 or 8) in SoA layout, lane i of every array belongs to ray i.
+// Lanes are filled with set(), which also caches the inverse direction used by the box tests.
+template<typename T, std::size_t N>
+struct RayPacket {
+    static_assert(std::is_floating_point<T>::value, "rays can only be used with floating point types");
+    static_assert(N == 4 || N == 8, "ray packets hold 4 or 8 rays");
+
+    using ScalarType = T;
+
+    static const std::size_t size = N;
+
+    // Mask with every lane set
+    static const int allLanes = (1 << N) - 1;
+
+    // Constructors
+    RayPacket() {
+        for (std::size_t lane = 0; lane < N; ++lane)
+            set(lane, Ray<T>{});
+    }
+
+    // Lanes from rays[0] to rays[N - 1]
+    explicit RayPacket(const Ray<T> *rays) {
+        for (std::size_t lane = 0; lane < N; ++lane)
+            set(lane, rays[lane]);
+    }
+
+    // Functions
+    void set(std::size_t lane, const Ray<T> &ray) {
+        const Vector<T, 3> inv = ray.inverse_direction();
+        for (std::size_t a = 0; a < 3; ++a) {
+            origin[a][lane] = ray.origin[a];
+            direction[a][lane] = ray.direction[a];
+            inverse[a][lane] = inv[a];
+        }
+        tMin[lane] = ray.tMin;
+        tMax[lane] = ray.tMax;
+    }
+
+    Ray<T> get(std::size_t lane) const {
+        return Ray<T>{Vector<T, 3>{origin[0][lane], origin[1][lane], origin[2][lane]},
+                      Vector<T, 3>{direction[0][lane], direction[1][lane], direction[2][lane]},
+                      tMin[lane], tMax[lane]};
+    }
+
+    alignas(sizeof(T) * N) T origin[3][N];
+    alignas(sizeof(T) * N) T direction[3][N];
+    alignas(sizeof(T) * N) T inverse[3][N];
+    alignas(sizeof(T) * N) T tMin[N];
+    alignas(sizeof(T) * N) T tMax[N];
+};
+
+// Closest hit data of every lane of a packet
+template<typename T, std::size_t N>
+struct RayPacketHit {
+    RayPacketHit() {
+        for (std::size_t lane = 0; lane < N; ++lane) {
+            u[lane] = v[lane] = T(0);
+            primitive[lane] = RayHit<T>::none;
+        }
+    }
+
+    T u[N];
+    T v[N];
+    std::uint32_t primitive[N];
+};
+
+using Rayf = Ray<float>;
+using Rayd = Ray<double>;
+
+using RayHitf = RayHit<float>;
+using RayHitd = RayHit<double>;
+
+using RayPacket4f = RayPacket<float, 4>;
+using RayPacket8f = RayPacket<float, 8>;
+using RayPacket4d = RayPacket<double, 4>;
+using RayPacket8d = RayPacket<double, 8>;
+
+// Ray-triangle (Moller-Trumbore) and ray-box (slab) tests.
+// The same kernels run one ray against one primitive, one primitive against every lane of a packet, or one
+// ray against a pack of primitives at a time, so all of them agree exactly on what is hit.
+// Triangles are hit from both sides, rays (nearly) parallel to the triangle plane miss. A hit counts when
+// tMin <= t < tMax for triangles and when the ray's [tMin, tMax] overlaps the box slabs for boxes.
+// Packet functions take a mask of active lanes (bit i for ray i) and return the lanes that hit, groups of
+// lanes without an active ray are skipped and every kernel stops once no lane of a pack is left.
+namespace Sm {
+    namespace detail {
+
+        // Widest simd pack up to P that fits in N lanes
+        template<typename P, std::size_t N, bool Fits = (P::width <= N)>
+        struct LanePack {
+            using type = P;
+        };
+
+        template<typename P, std::size_t N>
+        struct LanePack<P, N, false> {
+            using type = typename LanePack<typename simd::NarrowerPack<P>::type, N>::type;
+        };
+
+        // Rays against triangles a + u * e1 + v * e2, any operand may be a broadcast.
+        // Writes t, u and v and returns the lanes with a hit, lanes that drop out early are left undefined.
+        template<typename P>
+        typename P::Mask moller_trumbore(const P (&origin)[3], const P (&direction)[3], const P (&a)[3],
+                                         const P (&e1)[3], const P (&e2)[3], const P &tMin, const P &tMax,
+                                         P &t, P &u, P &v) {
+            using T = typename P::ScalarType;
+            const P zero = P::broadcast(T(0)), one = P::broadcast(T(1));
+
+            const P px = direction[1] * e2[2] - direction[2] * e2[1];
+            const P py = direction[2] * e2[0] - direction[0] * e2[2];
+            const P pz = direction[0] * e2[1] - direction[1] * e2[0];
+            const P det = e1[0] * px + e1[1] * py + e1[2] * pz;
+            auto valid = abs(det) >= P::broadcast(std::numeric_limits<T>::epsilon());
+            if (!bits(valid))
+                return valid;
+
+            const P inverse = one / det;
+            const P sx = origin[0] - a[0], sy = origin[1] - a[1], sz = origin[2] - a[2];
+            u = (sx * px + sy * py + sz * pz) * inverse;
+            valid = valid & (u >= zero) & (u <= one);
+            if (!bits(valid))
+                return valid;
+
+            const P qx = sy * e1[2] - sz * e1[1];
+            const P qy = sz * e1[0] - sx * e1[2];
+            const P qz = sx * e1[1] - sy * e1[0];
+            v = (direction[0] * qx + direction[1] * qy + direction[2] * qz) * inverse;
+            t = (e2[0] * qx + e2[1] * qy + e2[2] * qz) * inverse;
+            return valid & (v >= zero) & (u + v <= one) & (t >= tMin) & (t < tMax);
+        }
+
+        // Rays against boxes, writes the entry distance and returns the lanes that overlap.
+        // min / max return their second operand for NaN, the order below makes a NaN slab (origin on a face of
+        // a box the ray is parallel to) leave the interval unchanged.
+        template<typename P>
+        typename P::Mask slab(const P (&origin)[3], const P (&inverse)[3], const P (&lower)[3], const P (&upper)[3],
+                              const P &tMin, const P &tMax, P &near) {
+            P entry = tMin, exit = tMax;
+            for (std::size_t a = 0; a < 3; ++a) {
+                const P t0 = (lower[a] - origin[a]) * inverse[a];
+                const P t1 = (upper[a] - origin[a]) * inverse[a];
+                entry = max(min(t1, t0), entry);
+                exit = min(max(t0, t1), exit);
+            }
+            near = entry;
+            return entry <= exit;
+        }
+
+        template<typename P, typename T>
+        void broadcast_vector(const Vector<T, 3> &vector, P (&out)[3]) {
+            out[0] = P::broadcast(vector.x);
+            out[1] = P::broadcast(vector.y);
+            out[2] = P::broadcast(vector.z);
+        }
+
+        template<typename P, typename T, std::size_t N>
+        void load_lanes(const T (&lanes)[3][N], std::size_t first, P (&out)[3]) {
+            for (std::size_t a = 0; a < 3; ++a)
+                out[a] = P::load(lanes[a] + first);
+        }
+
+        // Calls kernel(P{}, lane, laneMask) for every group of lanes with an active ray
+        template<typename T, std::size_t N, typename Kernel>
+        void for_each_lane_pack(int active, Kernel &&kernel) {
+            simd::with_pack<T>([&](auto wide) {
+                using P = typename LanePack<decltype(wide), N>::type;
+                const int laneMask = (1 << P::width) - 1;
+                for (std::size_t lane = 0; lane < N; lane += P::width)
+                    if ((active >> lane) & laneMask)
+                        kernel(P{}, lane, (active >> lane) & laneMask);
+            });
+        }
+    }
+
+    // One ray and one triangle abc, fills t, u and v on a hit
+    template<typename T>
+    bool intersect_triangle(const Ray<T> &ray, const Vector<T, 3> &a, const Vector<T, 3> &b,
+                            const Vector<T, 3> &c, T &t, T &u, T &v) {
+        using P = simd::ScalarPack<T>;
+        P origin[3], direction[3], corner[3], e1[3], e2[3];
+        detail::broadcast_vector(ray.origin, origin);
+        detail::broadcast_vector(ray.direction, direction);
+        detail::broadcast_vector(a, corner);
+        detail::broadcast_vector(b - a, e1);
+        detail::broadcast_vector(c - a, e2);
+
+        P hitT, hitU, hitV;
+        if (!bits(detail::moller_trumbore(origin, direction, corner, e1, e2, P::broadcast(ray.tMin),
+                                          P::broadcast(ray.tMax), hitT, hitU, hitV)))
+            return false;
+        t = hitT.v;
+        u = hitU.v;
+        v = hitV.v;
+        return true;
+    }
+
+    // One ray and one box, fills the entry distance (tMin when the ray starts inside) on a hit
+    template<typename T>
+    bool intersect_aabb(const Ray<T> &ray, const AABB<T> &box, T &near) {
+        using P = simd::ScalarPack<T>;
+        P origin[3], inverse[3], min[3], max[3];
+        detail::broadcast_vector(ray.origin, origin);
+        detail::broadcast_vector(ray.inverse_direction(), inverse);
+        detail::broadcast_vector(box.min, min);
+        detail::broadcast_vector(box.max, max);
+
+        P entry;
+        if (!bits(detail::slab(origin, inverse, min, max, P::broadcast(ray.tMin), P::broadcast(ray.tMax), entry)))
+            return false;
+        near = entry.v;
+        return true;
+    }
+
+    // Every active lane against triangle abc, returns the lanes that hit it
+    template<typename T, std::size_t N>
+    int intersect_triangle(const RayPacket<T, N> &rays, const Vector<T, 3> &a, const Vector<T, 3> &b,
+                           const Vector<T, 3> &c, int active = RayPacket<T, N>::allLanes) {
+        int hits = 0;
+        detail::for_each_lane_pack<T, N>(active, [&](auto pack, std::size_t lane, int laneMask) {
+            using P = decltype(pack);
+            P origin[3], direction[3], corner[3], e1[3], e2[3];
+            detail::load_lanes(rays.origin, lane, origin);
+            detail::load_lanes(rays.direction, lane, direction);
+            detail::broadcast_vector(a, corner);
+            detail::broadcast_vector(b - a, e1);
+            detail::broadcast_vector(c - a, e2);
+
+            P t, u, v;
+            const auto mask = detail::moller_trumbore(origin, direction, corner, e1, e2, P::load(rays.tMin + lane),
+                                                      P::load(rays.tMax + lane), t, u, v);
+            hits |= (bits(mask) & laneMask) << lane;
+        });
+        return hits;
+    }
+
+    // Closest hit update: lanes that hit triangle abc nearer than their tMax take it as the new tMax and
+    // record primitive with its barycentrics in hits. Returns those lanes
+    template<typename T, std::size_t N>
+    int intersect_triangle(RayPacket<T, N> &rays, const Vector<T, 3> &a, const Vector<T, 3> &b,
+                           const Vector<T, 3> &c, std::uint32_t primitive, RayPacketHit<T, N> &hits,
+                           int active = RayPacket<T, N>::allLanes) {
+        int hitLanes = 0;
+        detail::for_each_lane_pack<T, N>(active, [&](auto pack, std::size_t lane, int laneMask) {
+            using P = decltype(pack);
+            P origin[3], direction[3], corner[3], e1[3], e2[3];
+            detail::load_lanes(rays.origin, lane, origin);
+            detail::load_lanes(rays.direction, lane, direction);
+            detail::broadcast_vector(a, corner);
+            detail::broadcast_vector(b - a, e1);
+            detail::broadcast_vector(c - a, e2);
+
+            P t, u, v;
+            const int mask = bits(detail::moller_trumbore(origin, direction, corner, e1, e2,
+                                                          P::load(rays.tMin + lane), P::load(rays.tMax + lane),
+                                                          t, u, v)) & laneMask;
+            if (!mask)
+                return;
+
+            T ts[P::width], us[P::width], vs[P::width];
+            t.store(ts);
+            u.store(us);
+            v.store(vs);
+            for (std::size_t l = 0; l < P::width; ++l)
+                if ((mask >> l) & 1) {
+                    rays.tMax[lane + l] = ts[l];
+                    hits.u[lane + l] = us[l];
+                    hits.v[lane + l] = vs[l];
+                    hits.primitive[lane + l] = primitive;
+                }
+            hitLanes |= mask << lane;
+        });
+        return hitLanes;
+    }
+
+    // Every active lane against box, returns the lanes that overlap it and writes their entry distances
+    // to near when given
+    template<typename T, std::size_t N>
+    int intersect_aabb(const RayPacket<T, N> &rays, const AABB<T> &box, int active = RayPacket<T, N>::allLanes,
+                       T *near = nullptr) {
+        int hits = 0;
+        detail::for_each_lane_pack<T, N>(active, [&](auto pack, std::size_t lane, int laneMask) {
+            using P = decltype(pack);
+            P origin[3], inverse[3], min[3], max[3];
+            detail::load_lanes(rays.origin, lane, origin);
+            detail::load_lanes(rays.inverse, lane, inverse);
+            detail::broadcast_vector(box.min, min);
+            detail::broadcast_vector(box.max, max);
+
+            P entry;
+            const auto mask = detail::slab(origin, inverse, min, max, P::load(rays.tMin + lane),
+                                           P::load(rays.tMax + lane), entry);
+            if (near)
+                entry.store(near + lane);
+            hits |= (bits(mask) & laneMask) << lane;
+        });
+        return hits;
+    }
+
+    // Closest of count triangles a[i] b[i] c[i] along ray, a pack of triangles at a time.
+    // On a hit the ray's tMax becomes its distance and hit names triangle i with its barycentrics,
+    // ties go to the lower index.
+    template<typename T>
+    bool intersect_triangles(Ray<T> &ray, const Vector<T, 3> *a, const Vector<T, 3> *b, const Vector<T, 3> *c,
+                             std::size_t count, RayHit<T> &hit) {
+        bool found = false;
+        simd::for_each_pack<T>(count, [&](auto pack, std::size_t i) {
+            using P = decltype(pack);
+            P origin[3], direction[3], corner[3], e1[3], e2[3], second[3], third[3];
+            detail::broadcast_vector(ray.origin, origin);
+            detail::broadcast_vector(ray.direction, direction);
+            detail::load_vectors(a + i, corner[0], corner[1], corner[2]);
+            detail::load_vectors(b + i, second[0], second[1], second[2]);
+            detail::load_vectors(c + i, third[0], third[1], third[2]);
+            for (std::size_t k = 0; k < 3; ++k) {
+                e1[k] = second[k] - corner[k];
+                e2[k] = third[k] - corner[k];
+            }
+
+            P t, u, v;
+            const int mask = bits(detail::moller_trumbore(origin, direction, corner, e1, e2, P::broadcast(ray.tMin),
+                                                          P::broadcast(ray.tMax), t, u, v));
+            if (!mask)
+                return;
+
+            T ts[P::width], us[P::width], vs[P::width];
+            t.store(ts);
+            u.store(us);
+            v.store(vs);
+            for (std::size_t l = 0; l < P::width; ++l)
+                if (((mask >> l) & 1) && ts[l] < ray.tMax) {
+                    ray.tMax = ts[l];
+                    hit.u = us[l];
+                    hit.v = vs[l];
+                    hit.primitive = static_cast<std::uint32_t>(i + l);
+                    found = true;
+                }
+        });
+        return found;
+    }
+
+    // True as soon as any of count triangles a[i] b[i] c[i] blocks ray, for shadow and visibility rays
+    template<typename T>
+    bool occluded_triangles(const Ray<T> &ray, const Vector<T, 3> *a, const Vector<T, 3> *b,
+                            const Vector<T, 3> *c, std::size_t count) {
+        const auto any = [&](auto pack, std::size_t i) {
+            using Q = decltype(pack);
+            Q origin[3], direction[3], corner[3], e1[3], e2[3], second[3], third[3];
+            detail::broadcast_vector(ray.origin, origin);
+            detail::broadcast_vector(ray.direction, direction);
+            detail::load_vectors(a + i, corner[0], corner[1], corner[2]);
+            detail::load_vectors(b + i, second[0], second[1], second[2]);
+            detail::load_vectors(c + i, third[0], third[1], third[2]);
+            for (std::size_t k = 0; k < 3; ++k) {
+                e1[k] = second[k] - corner[k];
+                e2[k] = third[k] - corner[k];
+            }
+
+            Q t, u, v;
+            return bits(detail::moller_trumbore(origin, direction, corner, e1, e2, Q::broadcast(ray.tMin),
+                                                Q::broadcast(ray.tMax), t, u, v)) != 0;
+        };
+
+        return simd::with_pack<T>([&](auto wide) {
+            using P = decltype(wide);
+            std::size_t i = 0;
+            for (; i < count && count - i >= P::width; i += P::width)
+                if (any(P{}, i))
+                    return true;
+            for (; i < count; ++i)
+                if (any(simd::ScalarPack<T>{}, i))
+                    return true;
+            return false;
+        });
+    }
+
+    // Boxes [mins[i], maxs[i]] along ray, a pack of boxes at a time. Writes the indices of the boxes that are
+    // hit to hits and their entry distances to distances (in ascending index order, both need room for count
+    // entries) and returns how many there are
+    template<typename T>
+    std::size_t intersect_aabbs(const Ray<T> &ray, const Vector<T, 3> *mins, const Vector<T, 3> *maxs,
+                                std::size_t count, std::uint32_t *hits, T *distances) {
+        const Vector<T, 3> inv = ray.inverse_direction();
+        std::size_t written = 0;
+        simd::for_each_pack<T>(count, [&](auto pack, std::size_t i) {
+            using P = decltype(pack);
+            P origin[3], inverse[3], min[3], max[3];
+            detail::broadcast_vector(ray.origin, origin);
+            detail::broadcast_vector(inv, inverse);
+            detail::load_vectors(mins + i, min[0], min[1], min[2]);
+            detail::load_vectors(maxs + i, max[0], max[1], max[2]);
+
+            P entry;
+            const int mask = bits(detail::slab(origin, inverse, min, max, P::broadcast(ray.tMin),
+                                               P::broadcast(ray.tMax), entry));
+            T near[P::width];
+            entry.store(near);
+            /* Every lane is written, only hits advance the cursor */
+            for (std::size_t l = 0; l < P::width; ++l) {
+                hits[written] = static_cast<std::uint32_t>(i + l);
+                distances[written] = near[l];
+                written += static_cast<std::size_t>((mask >> l) & 1);
+            }
+        });
+        return written;
+    }
+}
+
+#endif //SLIMEMATHS_RAY_H
@@ -0,0 +1,67 @@
+#ifndef SLIMEMATHS_SIMD_H
+#define SLIMEMATHS_SIMD_H
+
+// Compile time SIMD selection.
+// Define SLIMEMATHS_NO_SIMD before including any SlimeMath header to force the scalar fallbacks.
+
+#if !defined(SLIMEMATHS_NO_SIMD)
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SLIMEMATHS_SSE2 1
+#endif
+
+#if defined(__AVX__)
+#define SLIMEMATHS_AVX 1
+#endif
+
+// Hardware half <-> float conversion, MSVC has no flag for it but every AVX2 target supports it
+#if defined(SLIMEMATHS_AVX) && (defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__)))
+#define SLIMEMATHS_F16C 1
+#endif
+
+#endif
+
+// Run time dispatch (Dispatch.h): on x86 the batch kernels for wider instruction sets are compiled next to the
+// baseline ones with per function target attributes, so one binary picks the best of them on the running CPU.
+// Define SLIMEMATHS_NO_DISPATCH to only use what the compiler flags enable.
+#if defined(SLIMEMATHS_SSE2) && !defined(SLIMEMATHS_NO_DISPATCH) && \
+    (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#define SLIMEMATHS_DISPATCH 1
+#if defined(__GNUC__) || defined(__clang__)
+#define SLIMEMATHS_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define SLIMEMATHS_TARGET_AVX512 __attribute__((target("avx512f")))
+// The simd pack kernels leave FMA out, so the compiler cannot contract them and every set gives the same bits
+#define SLIMEMATHS_TARGET_AVX2_PACKS __attribute__((target("avx2")))
+#define SLIMEMATHS_FLATTEN __attribute__((flatten))
+#else
+#define SLIMEMATHS_TARGET_AVX2
+#define SLIMEMATHS_TARGET_AVX512
+#define SLIMEMATHS_TARGET_AVX2_PACKS
+#define SLIMEMATHS_FLATTEN
+#endif
+#endif
+
+#if defined(SLIMEMATHS_SSE2)
+#include <immintrin.h>
+#endif
+
+// True while the compiler evaluates a constant expression.
+// Intrinsics and pointer tricks are not allowed there, so constexpr functions branch on this to the plain scalar code.
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define SLIMEMATHS_HAS_IS_CONSTANT_EVALUATED 1
+#endif
+#endif
+
+#if !defined(SLIMEMATHS_HAS_IS_CONSTANT_EVALUATED) && \
+    ((defined(__GNUC__) && __GNUC__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925))
+#define SLIMEMATHS_HAS_IS_CONSTANT_EVALUATED 1
+#endif
+
+#if defined(SLIMEMATHS_HAS_IS_CONSTANT_EVALUATED)
+#define SLIMEMATHS_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+#define SLIMEMATHS_IS_CONSTANT_EVALUATED() false
+#endif
+
+#endif //SLIMEMATHS_SIMD_H
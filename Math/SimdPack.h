@@ -0,0 +1,690 @@
+#ifndef SLIMEMATHS_SIMDPACK_H
+#define SLIMEMATHS_SIMDPACK_H
+
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include "Simd.h"
+#include "Dispatch.h"
+
+// Thin lane-wise wrappers used to write batch kernels once for every width.
+// ScalarPack is always available and handles both the non-SIMD build and the tail of each batch,
+// Pack<T> resolves to the widest register the build targets (AVX, SSE2 or scalar).
+// for_each_pack and with_pack run a kernel with the pack of the active instruction set instead (Dispatch.h), every
+// pack computes lane by lane with the same operations, so all of them give the same bits.
+
+namespace Sm {
+    namespace simd {
+
+        // 1 / sqrt(a). The float version refines the hardware estimate with one Newton-Raphson step (about 23 bits),
+        // the packs below use the same sequence so batch and scalar results match.
+        template<typename T>
+        inline T rsqrt(const T &a) {
+            return T(1) / T(std::sqrt(a));
+        }
+
+#if defined(SLIMEMATHS_SSE2)
+        inline float rsqrt(const float &a) {
+            const float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(a)));
+            return y * (1.5f - 0.5f * a * y * y);
+        }
+#endif
+
+        template<typename T>
+        struct ScalarPack {
+            using ScalarType = T;
+            static const std::size_t width = 1;
+
+            struct Mask {
+                bool v;
+
+                friend Mask operator&(const Mask &lhs, const Mask &rhs) { return Mask{lhs.v && rhs.v}; }
+
+                friend Mask operator|(const Mask &lhs, const Mask &rhs) { return Mask{lhs.v || rhs.v}; }
+
+                friend Mask operator~(const Mask &m) { return Mask{!m.v}; }
+
+                friend int bits(const Mask &m) { return m.v ? 1 : 0; }
+            };
+
+            static ScalarPack load(const T *p) { return ScalarPack{*p}; }
+
+            static ScalarPack broadcast(const T &s) { return ScalarPack{s}; }
+
+            void store(T *p) const { *p = v; }
+
+            friend ScalarPack operator+(const ScalarPack &a, const ScalarPack &b) { return ScalarPack{a.v + b.v}; }
+
+            friend ScalarPack operator-(const ScalarPack &a, const ScalarPack &b) { return ScalarPack{a.v - b.v}; }
+
+            friend ScalarPack operator*(const ScalarPack &a, const ScalarPack &b) { return ScalarPack{a.v * b.v}; }
+
+            friend ScalarPack operator/(const ScalarPack &a, const ScalarPack &b) { return ScalarPack{a.v / b.v}; }
+
+            friend ScalarPack operator-(const ScalarPack &a) { return ScalarPack{-a.v}; }
+
+            friend Mask operator==(const ScalarPack &a, const ScalarPack &b) { return Mask{a.v == b.v}; }
+
+            friend Mask operator!=(const ScalarPack &a, const ScalarPack &b) { return Mask{a.v != b.v}; }
+
+            friend Mask operator<(const ScalarPack &a, const ScalarPack &b) { return Mask{a.v < b.v}; }
+
+            friend Mask operator<=(const ScalarPack &a, const ScalarPack &b) { return Mask{a.v <= b.v}; }
+
+            friend Mask operator>(const ScalarPack &a, const ScalarPack &b) { return Mask{a.v > b.v}; }
+
+            friend Mask operator>=(const ScalarPack &a, const ScalarPack &b) { return Mask{a.v >= b.v}; }
+
+            friend ScalarPack sqrt(const ScalarPack &a) { return ScalarPack{T(std::sqrt(a.v))}; }
+
+            friend ScalarPack rsqrt(const ScalarPack &a) { return ScalarPack{simd::rsqrt(a.v)}; }
+
+            friend ScalarPack abs(const ScalarPack &a) { return ScalarPack{T(std::abs(a.v))}; }
+
+            // Same operand order as minps / maxps, b is returned when either is NaN
+            friend ScalarPack min(const ScalarPack &a, const ScalarPack &b) { return ScalarPack{a.v < b.v ? a.v : b.v}; }
+
+            friend ScalarPack max(const ScalarPack &a, const ScalarPack &b) { return ScalarPack{a.v > b.v ? a.v : b.v}; }
+
+            friend ScalarPack select(const Mask &m, const ScalarPack &a, const ScalarPack &b) {
+                return m.v ? a : b;
+            }
+
+            T v;
+        };
+
+#if defined(SLIMEMATHS_SSE2)
+
+        struct Float4 {
+            using ScalarType = float;
+            static const std::size_t width = 4;
+
+            struct Mask {
+                __m128 v;
+
+                friend Mask operator&(const Mask &lhs, const Mask &rhs) { return Mask{_mm_and_ps(lhs.v, rhs.v)}; }
+
+                friend Mask operator|(const Mask &lhs, const Mask &rhs) { return Mask{_mm_or_ps(lhs.v, rhs.v)}; }
+
+                friend Mask operator~(const Mask &m) {
+                    return Mask{_mm_xor_ps(m.v, _mm_castsi128_ps(_mm_set1_epi32(-1)))};
+                }
+
+                friend int bits(const Mask &m) { return _mm_movemask_ps(m.v); }
+            };
+
+            static Float4 load(const float *p) { return Float4{_mm_loadu_ps(p)}; }
+
+            static Float4 broadcast(const float &s) { return Float4{_mm_set1_ps(s)}; }
+
+            void store(float *p) const { _mm_storeu_ps(p, v); }
+
+            friend Float4 operator+(const Float4 &a, const Float4 &b) { return Float4{_mm_add_ps(a.v, b.v)}; }
+
+            friend Float4 operator-(const Float4 &a, const Float4 &b) { return Float4{_mm_sub_ps(a.v, b.v)}; }
+
+            friend Float4 operator*(const Float4 &a, const Float4 &b) { return Float4{_mm_mul_ps(a.v, b.v)}; }
+
+            friend Float4 operator/(const Float4 &a, const Float4 &b) { return Float4{_mm_div_ps(a.v, b.v)}; }
+
+            friend Float4 operator-(const Float4 &a) { return Float4{_mm_xor_ps(a.v, _mm_set1_ps(-0.0f))}; }
+
+            friend Mask operator==(const Float4 &a, const Float4 &b) { return Mask{_mm_cmpeq_ps(a.v, b.v)}; }
+
+            friend Mask operator!=(const Float4 &a, const Float4 &b) { return Mask{_mm_cmpneq_ps(a.v, b.v)}; }
+
+            friend Mask operator<(const Float4 &a, const Float4 &b) { return Mask{_mm_cmplt_ps(a.v, b.v)}; }
+
+            friend Mask operator<=(const Float4 &a, const Float4 &b) { return Mask{_mm_cmple_ps(a.v, b.v)}; }
+
+            friend Mask operator>(const Float4 &a, const Float4 &b) { return Mask{_mm_cmpgt_ps(a.v, b.v)}; }
+
+            friend Mask operator>=(const Float4 &a, const Float4 &b) { return Mask{_mm_cmpge_ps(a.v, b.v)}; }
+
+            friend Float4 sqrt(const Float4 &a) { return Float4{_mm_sqrt_ps(a.v)}; }
+
+            friend Float4 rsqrt(const Float4 &a) {
+                const __m128 y = _mm_rsqrt_ps(a.v);
+                const __m128 ayy = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), a.v), y), y);
+                return Float4{_mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), ayy))};
+            }
+
+            friend Float4 abs(const Float4 &a) { return Float4{_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)}; }
+
+            friend Float4 min(const Float4 &a, const Float4 &b) { return Float4{_mm_min_ps(a.v, b.v)}; }
+
+            friend Float4 max(const Float4 &a, const Float4 &b) { return Float4{_mm_max_ps(a.v, b.v)}; }
+
+            friend Float4 select(const Mask &m, const Float4 &a, const Float4 &b) {
+                return Float4{_mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v))};
+            }
+
+            __m128 v;
+        };
+
+        struct Double2 {
+            using ScalarType = double;
+            static const std::size_t width = 2;
+
+            struct Mask {
+                __m128d v;
+
+                friend Mask operator&(const Mask &lhs, const Mask &rhs) { return Mask{_mm_and_pd(lhs.v, rhs.v)}; }
+
+                friend Mask operator|(const Mask &lhs, const Mask &rhs) { return Mask{_mm_or_pd(lhs.v, rhs.v)}; }
+
+                friend Mask operator~(const Mask &m) {
+                    return Mask{_mm_xor_pd(m.v, _mm_castsi128_pd(_mm_set1_epi32(-1)))};
+                }
+
+                friend int bits(const Mask &m) { return _mm_movemask_pd(m.v); }
+            };
+
+            static Double2 load(const double *p) { return Double2{_mm_loadu_pd(p)}; }
+
+            static Double2 broadcast(const double &s) { return Double2{_mm_set1_pd(s)}; }
+
+            void store(double *p) const { _mm_storeu_pd(p, v); }
+
+            friend Double2 operator+(const Double2 &a, const Double2 &b) { return Double2{_mm_add_pd(a.v, b.v)}; }
+
+            friend Double2 operator-(const Double2 &a, const Double2 &b) { return Double2{_mm_sub_pd(a.v, b.v)}; }
+
+            friend Double2 operator*(const Double2 &a, const Double2 &b) { return Double2{_mm_mul_pd(a.v, b.v)}; }
+
+            friend Double2 operator/(const Double2 &a, const Double2 &b) { return Double2{_mm_div_pd(a.v, b.v)}; }
+
+            friend Double2 operator-(const Double2 &a) { return Double2{_mm_xor_pd(a.v, _mm_set1_pd(-0.0))}; }
+
+            friend Mask operator==(const Double2 &a, const Double2 &b) { return Mask{_mm_cmpeq_pd(a.v, b.v)}; }
+
+            friend Mask operator!=(const Double2 &a, const Double2 &b) { return Mask{_mm_cmpneq_pd(a.v, b.v)}; }
+
+            friend Mask operator<(const Double2 &a, const Double2 &b) { return Mask{_mm_cmplt_pd(a.v, b.v)}; }
+
+            friend Mask operator<=(const Double2 &a, const Double2 &b) { return Mask{_mm_cmple_pd(a.v, b.v)}; }
+
+            friend Mask operator>(const Double2 &a, const Double2 &b) { return Mask{_mm_cmpgt_pd(a.v, b.v)}; }
+
+            friend Mask operator>=(const Double2 &a, const Double2 &b) { return Mask{_mm_cmpge_pd(a.v, b.v)}; }
+
+            friend Double2 sqrt(const Double2 &a) { return Double2{_mm_sqrt_pd(a.v)}; }
+
+            friend Double2 rsqrt(const Double2 &a) { return Double2{_mm_div_pd(_mm_set1_pd(1.0), _mm_sqrt_pd(a.v))}; }
+
+            friend Double2 abs(const Double2 &a) { return Double2{_mm_andnot_pd(_mm_set1_pd(-0.0), a.v)}; }
+
+            friend Double2 min(const Double2 &a, const Double2 &b) { return Double2{_mm_min_pd(a.v, b.v)}; }
+
+            friend Double2 max(const Double2 &a, const Double2 &b) { return Double2{_mm_max_pd(a.v, b.v)}; }
+
+            friend Double2 select(const Mask &m, const Double2 &a, const Double2 &b) {
+                return Double2{_mm_or_pd(_mm_and_pd(m.v, a.v), _mm_andnot_pd(m.v, b.v))};
+            }
+
+            __m128d v;
+        };
+
+#endif
+
+#if defined(SLIMEMATHS_AVX) || defined(SLIMEMATHS_DISPATCH)
+
+// In builds without AVX the 256 bit packs only run inside the dispatched AVX2 kernels: every member is compiled for
+// AVX2 and the lanes live in an array, since a __m256 passed between functions compiled with and without AVX is not
+// in the same place. Once the kernel is flattened into its AVX2 entry point the array stays in registers.
+#if defined(SLIMEMATHS_AVX)
+#define SLIMEMATHS_PACK256
+#else
+#define SLIMEMATHS_PACK256 SLIMEMATHS_TARGET_AVX2_PACKS
+#endif
+
+        struct Float8 {
+            using ScalarType = float;
+            static const std::size_t width = 8;
+
+            struct Mask {
+                SLIMEMATHS_PACK256 static Mask of(__m256 r) {
+#if defined(SLIMEMATHS_AVX)
+                    return Mask{r};
+#else
+                    Mask m;
+                    _mm256_storeu_ps(m.v, r);
+                    return m;
+#endif
+                }
+
+                SLIMEMATHS_PACK256 __m256 reg() const {
+#if defined(SLIMEMATHS_AVX)
+                    return v;
+#else
+                    return _mm256_loadu_ps(v);
+#endif
+                }
+
+                friend SLIMEMATHS_PACK256 Mask operator&(const Mask &lhs, const Mask &rhs) {
+                    return of(_mm256_and_ps(lhs.reg(), rhs.reg()));
+                }
+
+                friend SLIMEMATHS_PACK256 Mask operator|(const Mask &lhs, const Mask &rhs) {
+                    return of(_mm256_or_ps(lhs.reg(), rhs.reg()));
+                }
+
+                friend SLIMEMATHS_PACK256 Mask operator~(const Mask &m) {
+                    return of(_mm256_xor_ps(m.reg(), _mm256_castsi256_ps(_mm256_set1_epi32(-1))));
+                }
+
+                friend SLIMEMATHS_PACK256 int bits(const Mask &m) { return _mm256_movemask_ps(m.reg()); }
+
+#if defined(SLIMEMATHS_AVX)
+                __m256 v;
+#else
+                float v[8];
+#endif
+            };
+
+            SLIMEMATHS_PACK256 static Float8 of(__m256 r) {
+#if defined(SLIMEMATHS_AVX)
+                return Float8{r};
+#else
+                Float8 p;
+                _mm256_storeu_ps(p.v, r);
+                return p;
+#endif
+            }
+
+            SLIMEMATHS_PACK256 __m256 reg() const {
+#if defined(SLIMEMATHS_AVX)
+                return v;
+#else
+                return _mm256_loadu_ps(v);
+#endif
+            }
+
+            SLIMEMATHS_PACK256 static Float8 load(const float *p) { return of(_mm256_loadu_ps(p)); }
+
+            SLIMEMATHS_PACK256 static Float8 broadcast(const float &s) { return of(_mm256_set1_ps(s)); }
+
+            SLIMEMATHS_PACK256 void store(float *p) const { _mm256_storeu_ps(p, reg()); }
+
+            friend SLIMEMATHS_PACK256 Float8 operator+(const Float8 &a, const Float8 &b) {
+                return of(_mm256_add_ps(a.reg(), b.reg()));
+            }
+
+            friend SLIMEMATHS_PACK256 Float8 operator-(const Float8 &a, const Float8 &b) {
+                return of(_mm256_sub_ps(a.reg(), b.reg()));
+            }
+
+            friend SLIMEMATHS_PACK256 Float8 operator*(const Float8 &a, const Float8 &b) {
+                return of(_mm256_mul_ps(a.reg(), b.reg()));
+            }
+
+            friend SLIMEMATHS_PACK256 Float8 operator/(const Float8 &a, const Float8 &b) {
+                return of(_mm256_div_ps(a.reg(), b.reg()));
+            }
+
+            friend SLIMEMATHS_PACK256 Float8 operator-(const Float8 &a) {
+                return of(_mm256_xor_ps(a.reg(), _mm256_set1_ps(-0.0f)));
+            }
+
+            friend SLIMEMATHS_PACK256 Mask operator==(const Float8 &a, const Float8 &b) {
+                return Mask::of(_mm256_cmp_ps(a.reg(), b.reg(), _CMP_EQ_OQ));
+            }
+
+            friend SLIMEMATHS_PACK256 Mask operator!=(const Float8 &a, const Float8 &b) {
+                return Mask::of(_mm256_cmp_ps(a.reg(), b.reg(), _CMP_NEQ_UQ));
+            }
+
+            friend SLIMEMATHS_PACK256 Mask operator<(const Float8 &a, const Float8 &b) {
+                return Mask::of(_mm256_cmp_ps(a.reg(), b.reg(), _CMP_LT_OQ));
+            }
+
+            friend SLIMEMATHS_PACK256 Mask operator<=(const Float8 &a, const Float8 &b) {
+                return Mask::of(_mm256_cmp_ps(a.reg(), b.reg(), _CMP_LE_OQ));
+            }
+
+            friend SLIMEMATHS_PACK256 Mask operator>(const Float8 &a, const Float8 &b) {
+                return Mask::of(_mm256_cmp_ps(a.reg(), b.reg(), _CMP_GT_OQ));
+            }
+
+            friend SLIMEMATHS_PACK256 Mask operator>=(const Float8 &a, const Float8 &b) {
+                return Mask::of(_mm256_cmp_ps(a.reg(), b.reg(), _CMP_GE_OQ));
+            }
+
+            friend SLIMEMATHS_PACK256 Float8 sqrt(const Float8 &a) { return of(_mm256_sqrt_ps(a.reg())); }
+
+            friend SLIMEMATHS_PACK256 Float8 rsqrt(const Float8 &a) {
+                const __m256 y = _mm256_rsqrt_ps(a.reg());
+                const __m256 ayy = _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), a.reg()), y), y);
+                return of(_mm256_mul_ps(y, _mm256_sub_ps(_mm256_set1_ps(1.5f), ayy)));
+            }
+
+            friend SLIMEMATHS_PACK256 Float8 abs(const Float8 &a) {
+                return of(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.reg()));
+            }
+
+            friend SLIMEMATHS_PACK256 Float8 min(const Float8 &a, const Float8 &b) {
+                return of(_mm256_min_ps(a.reg(), b.reg()));
+            }
+
+            friend SLIMEMATHS_PACK256 Float8 max(const Float8 &a, const Float8 &b) {
+                return of(_mm256_max_ps(a.reg(), b.reg()));
+            }
+
+            friend SLIMEMATHS_PACK256 Float8 select(const Mask &m, const Float8 &a, const Float8 &b) {
+                return of(_mm256_blendv_ps(b.reg(), a.reg(), m.reg()));
+            }
+
+#if defined(SLIMEMATHS_AVX)
+            __m256 v;
+#else
+            float v[8];
+#endif
+        };
+
+        struct Double4 {
+            using ScalarType = double;
+            static const std::size_t width = 4;
+
+            struct Mask {
+                SLIMEMATHS_PACK256 static Mask of(__m256d r) {
+#if defined(SLIMEMATHS_AVX)
+                    return Mask{r};
+#else
+                    Mask m;
+                    _mm256_storeu_pd(m.v, r);
+                    return m;
+#endif
+                }
+
+                SLIMEMATHS_PACK256 __m256d reg() const {
+#if defined(SLIMEMATHS_AVX)
+                    return v;
+#else
+                    return _mm256_loadu_pd(v);
+#endif
+                }
+
+                friend SLIMEMATHS_PACK256 Mask operator&(const Mask &lhs, const Mask &rhs) {
+                    return of(_mm256_and_pd(lhs.reg(), rhs.reg()));
+                }
+
+                friend SLIMEMATHS_PACK256 Mask operator|(const Mask &lhs, const Mask &rhs) {
+                    return of(_mm256_or_pd(lhs.reg(), rhs.reg()));
+                }
+
+                friend SLIMEMATHS_PACK256 Mask operator~(const Mask &m) {
+                    return of(_mm256_xor_pd(m.reg(), _mm256_castsi256_pd(_mm256_set1_epi32(-1))));
+                }
+
+                friend SLIMEMATHS_PACK256 int bits(const Mask &m) { return _mm256_movemask_pd(m.reg()); }
+
+#if defined(SLIMEMATHS_AVX)
+                __m256d v;
+#else
+                double v[4];
+#endif
+            };
+
+            SLIMEMATHS_PACK256 static Double4 of(__m256d r) {
+#if defined(SLIMEMATHS_AVX)
+                return Double4{r};
+#else
+                Double4 p;
+                _mm256_storeu_pd(p.v, r);
+                return p;
+#endif
+            }
+
+            SLIMEMATHS_PACK256 __m256d reg() const {
+#if defined(SLIMEMATHS_AVX)
+                return v;
+#else
+                return _mm256_loadu_pd(v);
+#endif
+            }
+
+            SLIMEMATHS_PACK256 static Double4 load(const double *p) { return of(_mm256_loadu_pd(p)); }
+
+            SLIMEMATHS_PACK256 static Double4 broadcast(const double &s) { return of(_mm256_set1_pd(s)); }
+
+            SLIMEMATHS_PACK256 void store(double *p) const { _mm256_storeu_pd(p, reg()); }
+
+            friend SLIMEMATHS_PACK256 Double4 operator+(const Double4 &a, const Double4 &b) {
+                return of(_mm256_add_pd(a.reg(), b.reg()));
+            }
+
+            friend SLIMEMATHS_PACK256 Double4 operator-(const Double4 &a, const Double4 &b) {
+                return of(_mm256_sub_pd(a.reg(), b.reg()));
+            }
+
+            friend SLIMEMATHS_PACK256 Double4 operator*(const Double4 &a, const Double4 &b) {
+                return of(_mm256_mul_pd(a.reg(), b.reg()));
+            }
+
+            friend SLIMEMATHS_PACK256 Double4 operator/(const Double4 &a, const Double4 &b) {
+                return of(_mm256_div_pd(a.reg(), b.reg()));
+            }
+
+            friend SLIMEMATHS_PACK256 Double4 operator-(const Double4 &a) {
+                return of(_mm256_xor_pd(a.reg(), _mm256_set1_pd(-0.0)));
+            }
+
+            friend SLIMEMATHS_PACK256 Mask operator==(const Double4 &a, const Double4 &b) {
+                return Mask::of(_mm256_cmp_pd(a.reg(), b.reg(), _CMP_EQ_OQ));
+            }
+
+            friend SLIMEMATHS_PACK256 Mask operator!=(const Double4 &a, const Double4 &b) {
+                return Mask::of(_mm256_cmp_pd(a.reg(), b.reg(), _CMP_NEQ_UQ));
+            }
+
+            friend SLIMEMATHS_PACK256 Mask operator<(const Double4 &a, const Double4 &b) {
+                return Mask::of(_mm256_cmp_pd(a.reg(), b.reg(), _CMP_LT_OQ));
+            }
+
+            friend SLIMEMATHS_PACK256 Mask operator<=(const Double4 &a, const Double4 &b) {
+                return Mask::of(_mm256_cmp_pd(a.reg(), b.reg(), _CMP_LE_OQ));
+            }
+
+            friend SLIMEMATHS_PACK256 Mask operator>(const Double4 &a, const Double4 &b) {
+                return Mask::of(_mm256_cmp_pd(a.reg(), b.reg(), _CMP_GT_OQ));
+            }
+
+            friend SLIMEMATHS_PACK256 Mask operator>=(const Double4 &a, const Double4 &b) {
+                return Mask::of(_mm256_cmp_pd(a.reg(), b.reg(), _CMP_GE_OQ));
+            }
+
+            friend SLIMEMATHS_PACK256 Double4 sqrt(const Double4 &a) { return of(_mm256_sqrt_pd(a.reg())); }
+
+            friend SLIMEMATHS_PACK256 Double4 rsqrt(const Double4 &a) {
+                return of(_mm256_div_pd(_mm256_set1_pd(1.0), _mm256_sqrt_pd(a.reg())));
+            }
+
+            friend SLIMEMATHS_PACK256 Double4 abs(const Double4 &a) {
+                return of(_mm256_andnot_pd(_mm256_set1_pd(-0.0), a.reg()));
+            }
+
+            friend SLIMEMATHS_PACK256 Double4 min(const Double4 &a, const Double4 &b) {
+                return of(_mm256_min_pd(a.reg(), b.reg()));
+            }
+
+            friend SLIMEMATHS_PACK256 Double4 max(const Double4 &a, const Double4 &b) {
+                return of(_mm256_max_pd(a.reg(), b.reg()));
+            }
+
+            friend SLIMEMATHS_PACK256 Double4 select(const Mask &m, const Double4 &a, const Double4 &b) {
+                return of(_mm256_blendv_pd(b.reg(), a.reg(), m.reg()));
+            }
+
+#if defined(SLIMEMATHS_AVX)
+            __m256d v;
+#else
+            double v[4];
+#endif
+        };
+
+#undef SLIMEMATHS_PACK256
+
+#endif
+
+        // Widest pack for a scalar type in this build
+        template<typename T>
+        struct NativePack {
+            using type = ScalarPack<T>;
+        };
+
+#if defined(SLIMEMATHS_AVX)
+        template<>
+        struct NativePack<float> {
+            using type = Float8;
+        };
+
+        template<>
+        struct NativePack<double> {
+            using type = Double4;
+        };
+#elif defined(SLIMEMATHS_SSE2)
+        template<>
+        struct NativePack<float> {
+            using type = Float4;
+        };
+
+        template<>
+        struct NativePack<double> {
+            using type = Double2;
+        };
+#endif
+
+        template<typename T>
+        using Pack = typename NativePack<T>::type;
+
+        // Half as wide, down to ScalarPack
+        template<typename P>
+        struct NarrowerPack {
+            using type = ScalarPack<typename P::ScalarType>;
+        };
+
+#if defined(SLIMEMATHS_AVX) || defined(SLIMEMATHS_DISPATCH)
+        template<>
+        struct NarrowerPack<Float8> {
+            using type = Float4;
+        };
+
+        template<>
+        struct NarrowerPack<Double4> {
+            using type = Double2;
+        };
+#endif
+
+        // Pack the batch kernels use for each instruction set of Dispatch.h, AVX-512 runs the AVX2 packs
+        template<typename T, Isa isa>
+        struct IsaPack {
+            using type = ScalarPack<T>;
+        };
+
+#if defined(SLIMEMATHS_DISPATCH)
+        template<>
+        struct IsaPack<float, Isa::Sse2> {
+            using type = Float4;
+        };
+
+        template<>
+        struct IsaPack<double, Isa::Sse2> {
+            using type = Double2;
+        };
+
+        template<Isa isa>
+        struct IsaPack<float, isa> {
+            using type = typename std::conditional<(isa >= Isa::Avx2), Float8, ScalarPack<float>>::type;
+        };
+
+        template<Isa isa>
+        struct IsaPack<double, isa> {
+            using type = typename std::conditional<(isa >= Isa::Avx2), Double4, ScalarPack<double>>::type;
+        };
+#else
+        template<Isa isa>
+        struct IsaPack<float, isa> {
+            using type = typename std::conditional<(isa > Isa::Scalar), Pack<float>, ScalarPack<float>>::type;
+        };
+
+        template<Isa isa>
+        struct IsaPack<double, isa> {
+            using type = typename std::conditional<(isa > Isa::Scalar), Pack<double>, ScalarPack<double>>::type;
+        };
+#endif
+
+        // Widest pack for_each_pack may run, batches split across threads at multiples of its width
+        template<typename T>
+        using WidestPack = typename IsaPack<T, Isa::Avx512>::type;
+
+        namespace detail {
+            template<typename P, typename Func>
+            auto run_with_pack(Func &func) -> decltype(func(P{})) {
+                return func(P{});
+            }
+
+#if defined(SLIMEMATHS_DISPATCH)
+            // Everything func calls is inlined, so the whole kernel is compiled for AVX2
+            template<typename P, typename Func>
+            SLIMEMATHS_TARGET_AVX2_PACKS SLIMEMATHS_FLATTEN auto run_with_pack_avx2(Func &func) -> decltype(func(P{})) {
+                return func(P{});
+            }
+#endif
+
+            // func instantiated for the pack of every instruction set
+            template<typename T, typename Func>
+            struct PackKernelTable {
+                using Entry = decltype(std::declval<Func &>()(ScalarPack<T>{})) (*)(Func &);
+
+                static Entry entry(Isa isa) {
+#if defined(SLIMEMATHS_DISPATCH)
+                    static const Entry entries[] = {
+                            &run_with_pack<typename IsaPack<T, Isa::Scalar>::type, Func>,
+                            &run_with_pack<typename IsaPack<T, Isa::Sse2>::type, Func>,
+                            &run_with_pack_avx2<typename IsaPack<T, Isa::Avx2>::type, Func>,
+                            &run_with_pack_avx2<typename IsaPack<T, Isa::Avx512>::type, Func>};
+                    return entries[static_cast<std::size_t>(isa)];
+#else
+                    return isa == Isa::Scalar ? &run_with_pack<ScalarPack<T>, Func> : &run_with_pack<Pack<T>, Func>;
+#endif
+                }
+            };
+        }
+
+        // Calls func(P{}) once with the pack of the active instruction set (Dispatch.h) and returns its result.
+        // The set is looked up once per call, batch kernels loop inside func.
+        template<typename T, typename Func>
+        auto with_pack(Func &&func) {
+            return detail::PackKernelTable<T, typename std::remove_reference<Func>::type>::entry(active_isa())(func);
+        }
+
+        // Calls kernel(P{}, i) over [begin, end), using P for whole packs and ScalarPack for the tail.
+        template<typename P, typename Kernel>
+        void for_each_pack_of(std::size_t begin, std::size_t end, Kernel &&kernel) {
+            std::size_t i = begin;
+
+            for (; i < end && end - i >= P::width; i += P::width)
+                kernel(P{}, i);
+
+            for (; i < end; ++i)
+                kernel(ScalarPack<typename P::ScalarType>{}, i);
+        }
+
+        // Calls kernel(P{}, i) over [begin, end) with the pack of the active instruction set for whole packs
+        template<typename T, typename Kernel>
+        void for_each_pack(std::size_t begin, std::size_t end, Kernel &&kernel) {
+            with_pack<T>([&](auto pack) {
+                for_each_pack_of<decltype(pack)>(begin, end, kernel);
+            });
+        }
+
+        template<typename T, typename Kernel>
+        void for_each_pack(std::size_t count, Kernel &&kernel) {
+            for_each_pack<T>(std::size_t(0), count, kernel);
+        }
+    }
+}
+
+#endif //SLIMEMATHS_SIMDPACK_H
@@ -0,0 +1,367 @@
+#ifndef SLIMEMATHS_SKINNING_H
+#define SLIMEMATHS_SKINNING_H
+
+#include <cstddef>
+#include "Matrix.h"
+#include "Vector3.h"
+#include "DualQuaternion.h"
+#include "QuaternionConversion.h"
+#include "SimdPack.h"
+#include "Executor.h"
+#include "Instrument.h"
+
+// Batch vertex skinning with four bone influences per vertex.
+// Vertex i uses bones indices[i * 4 + k] with weights weights[i * 4 + k], unused slots carry weight 0.
+// Vertices are processed a simd pack at a time, the bones of every lane are gathered and transposed so
+// the blend and transform run lane-wise.
+//
+// Sm::skin with DualQuaternion bones is dual quaternion skinning (Kavan et al. 2008): the bones are blended
+// with their signs aligned to the first influence, normalized, and applied as one rigid transform, so joints
+// keep their volume instead of collapsing like linear blending does.
+// Sm::skin with Matrix<T, 3, 4> bones is classic linear blend skinning over a palette from Sm::compose_palette.
+//
+// normals and outNormals may be null to skip normals, positions and normals may be skinned in place.
+// The overloads taking an Executor split the vertices across its threads.
+
+namespace Sm {
+
+    // Bone influences per vertex
+    static const std::size_t skinInfluences = 4;
+
+    namespace detail {
+
+        // Gathers bones[indices[l * skinInfluences]] for every lane l into transposed packs
+        template<typename P, typename T, typename Index>
+        void gather_bones(const DualQuaternion<T> *bones, const Index *indices, P *components) {
+            T lanes[8][P::width];
+            for (std::size_t l = 0; l < P::width; ++l) {
+                const T *bone = bones[indices[l * skinInfluences]].Ptr();
+                for (std::size_t c = 0; c < 8; ++c)
+                    lanes[c][l] = bone[c];
+            }
+            for (std::size_t c = 0; c < 8; ++c)
+                components[c] = P::load(lanes[c]);
+        }
+
+        template<typename P, typename T, typename Index>
+        void gather_bones(const Matrix<T, 3, 4> *bones, const Index *indices, P *components) {
+            T lanes[12][P::width];
+            for (std::size_t l = 0; l < P::width; ++l) {
+                const T *bone = bones[indices[l * skinInfluences]].ptr();
+                for (std::size_t c = 0; c < 12; ++c)
+                    lanes[c][l] = bone[c];
+            }
+            for (std::size_t c = 0; c < 12; ++c)
+                components[c] = P::load(lanes[c]);
+        }
+
+#if defined(SLIMEMATHS_SSE2)
+        /* One unaligned load per four components of every lane and a 4x4 transpose */
+        template<typename Index>
+        void gather_bones(const DualQuaternion<float> *bones, const Index *indices, simd::Float4 *components) {
+            const float *b0 = bones[indices[0]].Ptr();
+            const float *b1 = bones[indices[skinInfluences]].Ptr();
+            const float *b2 = bones[indices[2 * skinInfluences]].Ptr();
+            const float *b3 = bones[indices[3 * skinInfluences]].Ptr();
+            for (std::size_t c = 0; c < 8; c += 4) {
+                __m128 r0 = _mm_loadu_ps(b0 + c), r1 = _mm_loadu_ps(b1 + c);
+                __m128 r2 = _mm_loadu_ps(b2 + c), r3 = _mm_loadu_ps(b3 + c);
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                components[c].v = r0;
+                components[c + 1].v = r1;
+                components[c + 2].v = r2;
+                components[c + 3].v = r3;
+            }
+        }
+
+        template<typename Index>
+        void gather_bones(const Matrix<float, 3, 4> *bones, const Index *indices, simd::Float4 *components) {
+            const float *b0 = bones[indices[0]].ptr();
+            const float *b1 = bones[indices[skinInfluences]].ptr();
+            const float *b2 = bones[indices[2 * skinInfluences]].ptr();
+            const float *b3 = bones[indices[3 * skinInfluences]].ptr();
+            for (std::size_t c = 0; c < 12; c += 4) {
+                __m128 r0 = _mm_loadu_ps(b0 + c), r1 = _mm_loadu_ps(b1 + c);
+                __m128 r2 = _mm_loadu_ps(b2 + c), r3 = _mm_loadu_ps(b3 + c);
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                components[c].v = r0;
+                components[c + 1].v = r1;
+                components[c + 2].v = r2;
+                components[c + 3].v = r3;
+            }
+        }
+
+        /* Two lanes of doubles are one unpack per two components */
+        template<std::size_t Components>
+        void gather_lanes(const double *b0, const double *b1, simd::Double2 *components) {
+            for (std::size_t c = 0; c < Components; c += 2) {
+                const __m128d r0 = _mm_loadu_pd(b0 + c), r1 = _mm_loadu_pd(b1 + c);
+                components[c].v = _mm_unpacklo_pd(r0, r1);
+                components[c + 1].v = _mm_unpackhi_pd(r0, r1);
+            }
+        }
+
+        template<typename Index>
+        void gather_bones(const DualQuaternion<double> *bones, const Index *indices, simd::Double2 *components) {
+            gather_lanes<8>(bones[indices[0]].Ptr(), bones[indices[skinInfluences]].Ptr(), components);
+        }
+
+        template<typename Index>
+        void gather_bones(const Matrix<double, 3, 4> *bones, const Index *indices, simd::Double2 *components) {
+            gather_lanes<12>(bones[indices[0]].ptr(), bones[indices[skinInfluences]].ptr(), components);
+        }
+#endif
+
+        // weights[k] of every lane in w[k]
+        template<typename P, typename T>
+        void load_weights(const T *weights, P (&w)[skinInfluences]) {
+            T lanes[skinInfluences][P::width];
+            for (std::size_t l = 0; l < P::width; ++l)
+                for (std::size_t k = 0; k < skinInfluences; ++k)
+                    lanes[k][l] = weights[l * skinInfluences + k];
+            for (std::size_t k = 0; k < skinInfluences; ++k)
+                w[k] = P::load(lanes[k]);
+        }
+
+#if defined(SLIMEMATHS_SSE2)
+        inline void load_weights(const float *weights, simd::Float4 (&w)[skinInfluences]) {
+            __m128 w0 = _mm_loadu_ps(weights), w1 = _mm_loadu_ps(weights + 4);
+            __m128 w2 = _mm_loadu_ps(weights + 8), w3 = _mm_loadu_ps(weights + 12);
+            _MM_TRANSPOSE4_PS(w0, w1, w2, w3);
+            w[0].v = w0;
+            w[1].v = w1;
+            w[2].v = w2;
+            w[3].v = w3;
+        }
+
+        inline void load_weights(const double *weights, simd::Double2 (&w)[skinInfluences]) {
+            for (std::size_t k = 0; k < skinInfluences; k += 2) {
+                const __m128d a = _mm_loadu_pd(weights + k), b = _mm_loadu_pd(weights + skinInfluences + k);
+                w[k].v = _mm_unpacklo_pd(a, b);
+                w[k + 1].v = _mm_unpackhi_pd(a, b);
+            }
+        }
+#endif
+
+        // Blended bone transform of a pack of vertices
+        template<typename P, typename T, typename Index>
+        void blend_bones(const DualQuaternion<T> *bones, const Index *indices, const T *weights, P (&blend)[8]) {
+            P bone[8], w[skinInfluences];
+            load_weights(weights, w);
+            gather_bones(bones, indices, bone);
+            const P pivot[4] = {bone[0], bone[1], bone[2], bone[3]};
+            for (std::size_t c = 0; c < 8; ++c)
+                blend[c] = bone[c] * w[0];
+
+            const P zero = P::broadcast(T(0));
+            for (std::size_t k = 1; k < skinInfluences; ++k) {
+                gather_bones(bones, indices + k, bone);
+
+                /* q and -q are the same rotation, take the one on the same side as the first influence */
+                const P side = bone[0] * pivot[0] + bone[1] * pivot[1] + bone[2] * pivot[2] + bone[3] * pivot[3];
+                const P weight = select(side < zero, -w[k], w[k]);
+
+                for (std::size_t c = 0; c < 8; ++c)
+                    blend[c] = blend[c] + bone[c] * weight;
+            }
+        }
+
+        template<typename P, typename T, typename Index>
+        void blend_bones(const Matrix<T, 3, 4> *bones, const Index *indices, const T *weights, P (&blend)[12]) {
+            P bone[12], w[skinInfluences];
+            load_weights(weights, w);
+            gather_bones(bones, indices, blend);
+            for (std::size_t c = 0; c < 12; ++c)
+                blend[c] = blend[c] * w[0];
+
+            for (std::size_t k = 1; k < skinInfluences; ++k) {
+                gather_bones(bones, indices + k, bone);
+                for (std::size_t c = 0; c < 12; ++c)
+                    blend[c] = blend[c] + bone[c] * w[k];
+            }
+        }
+
+#if defined(SLIMEMATHS_SSE2)
+        /* Linear blending is cheaper in rows: every lane blends its own matrix four elements at a time and
+         * only the blended matrices are transposed, instead of transposing every influence */
+        template<typename Index>
+        void blend_bones(const Matrix<float, 3, 4> *bones, const Index *indices, const float *weights,
+                         simd::Float4 (&blend)[12]) {
+            __m128 rows[3][4];
+            for (std::size_t l = 0; l < 4; ++l) {
+                const Index *index = indices + l * skinInfluences;
+                const float *weight = weights + l * skinInfluences;
+                const float *bone = bones[index[0]].ptr();
+                __m128 w = _mm_set1_ps(weight[0]);
+                for (std::size_t r = 0; r < 3; ++r)
+                    rows[r][l] = _mm_mul_ps(_mm_loadu_ps(bone + r * 4), w);
+                for (std::size_t k = 1; k < skinInfluences; ++k) {
+                    bone = bones[index[k]].ptr();
+                    w = _mm_set1_ps(weight[k]);
+                    for (std::size_t r = 0; r < 3; ++r)
+                        rows[r][l] = _mm_add_ps(rows[r][l], _mm_mul_ps(_mm_loadu_ps(bone + r * 4), w));
+                }
+            }
+            for (std::size_t r = 0; r < 3; ++r) {
+                _MM_TRANSPOSE4_PS(rows[r][0], rows[r][1], rows[r][2], rows[r][3]);
+                for (std::size_t c = 0; c < 4; ++c)
+                    blend[r * 4 + c].v = rows[r][c];
+            }
+        }
+
+        template<typename Index>
+        void blend_bones(const Matrix<double, 3, 4> *bones, const Index *indices, const double *weights,
+                         simd::Double2 (&blend)[12]) {
+            __m128d pairs[6][2];
+            for (std::size_t l = 0; l < 2; ++l) {
+                const Index *index = indices + l * skinInfluences;
+                const double *weight = weights + l * skinInfluences;
+                const double *bone = bones[index[0]].ptr();
+                __m128d w = _mm_set1_pd(weight[0]);
+                for (std::size_t c = 0; c < 6; ++c)
+                    pairs[c][l] = _mm_mul_pd(_mm_loadu_pd(bone + c * 2), w);
+                for (std::size_t k = 1; k < skinInfluences; ++k) {
+                    bone = bones[index[k]].ptr();
+                    w = _mm_set1_pd(weight[k]);
+                    for (std::size_t c = 0; c < 6; ++c)
+                        pairs[c][l] = _mm_add_pd(pairs[c][l], _mm_mul_pd(_mm_loadu_pd(bone + c * 2), w));
+                }
+            }
+            for (std::size_t c = 0; c < 6; ++c) {
+                blend[c * 2].v = _mm_unpacklo_pd(pairs[c][0], pairs[c][1]);
+                blend[c * 2 + 1].v = _mm_unpackhi_pd(pairs[c][0], pairs[c][1]);
+            }
+        }
+#endif
+
+        // v + 2 * r x (r x v + w * v) for the unit quaternion (r, w)
+        template<typename P>
+        void rotate(const P &rx, const P &ry, const P &rz, const P &rw, P &x, P &y, P &z) {
+            const P tx = ry * z - rz * y + rw * x;
+            const P ty = rz * x - rx * z + rw * y;
+            const P tz = rx * y - ry * x + rw * z;
+            const P two = P::broadcast(typename P::ScalarType(2));
+            x = x + (ry * tz - rz * ty) * two;
+            y = y + (rz * tx - rx * tz) * two;
+            z = z + (rx * ty - ry * tx) * two;
+        }
+
+        template<typename T, typename Index>
+        void skin_dual_quaternion(const DualQuaternion<T> *bones, const Index *indices, const T *weights,
+                                  const Vector<T, 3> *positions, const Vector<T, 3> *normals,
+                                  Vector<T, 3> *outPositions, Vector<T, 3> *outNormals, std::size_t count) {
+            simd::for_each_pack<T>(count, [&](auto pack, std::size_t i) {
+                using P = decltype(pack);
+
+                P b[8];
+                blend_bones(bones, indices + i * skinInfluences, weights + i * skinInfluences, b);
+
+                /* Normalizing by the real part length is enough, the translation formula below
+                 * only needs real and dual scaled alike (Kavan et al.) */
+                const P two = P::broadcast(T(2));
+                const P invLength = P::broadcast(T(1)) / sqrt(b[0] * b[0] + b[1] * b[1] + b[2] * b[2] + b[3] * b[3]);
+                const P rx = b[0] * invLength, ry = b[1] * invLength, rz = b[2] * invLength, rw = b[3] * invLength;
+                const P dx = b[4] * invLength, dy = b[5] * invLength, dz = b[6] * invLength, dw = b[7] * invLength;
+
+                const P tx = (dx * rw - rx * dw + (ry * dz - rz * dy)) * two;
+                const P ty = (dy * rw - ry * dw + (rz * dx - rx * dz)) * two;
+                const P tz = (dz * rw - rz * dw + (rx * dy - ry * dx)) * two;
+
+                P x, y, z;
+                load_vectors(positions + i, x, y, z);
+                rotate(rx, ry, rz, rw, x, y, z);
+                store_vectors(outPositions + i, x + tx, y + ty, z + tz);
+
+                if (normals && outNormals) {
+                    load_vectors(normals + i, x, y, z);
+                    rotate(rx, ry, rz, rw, x, y, z);
+                    store_vectors(outNormals + i, x, y, z);
+                }
+            });
+        }
+
+        template<typename T, typename Index>
+        void skin_linear(const Matrix<T, 3, 4> *bones, const Index *indices, const T *weights,
+                         const Vector<T, 3> *positions, const Vector<T, 3> *normals,
+                         Vector<T, 3> *outPositions, Vector<T, 3> *outNormals, std::size_t count) {
+            simd::for_each_pack<T>(count, [&](auto pack, std::size_t i) {
+                using P = decltype(pack);
+
+                P m[12];
+                blend_bones(bones, indices + i * skinInfluences, weights + i * skinInfluences, m);
+
+                P x, y, z;
+                load_vectors(positions + i, x, y, z);
+                store_vectors(outPositions + i,
+                              m[0] * x + m[1] * y + m[2] * z + m[3],
+                              m[4] * x + m[5] * y + m[6] * z + m[7],
+                              m[8] * x + m[9] * y + m[10] * z + m[11]);
+
+                if (normals && outNormals) {
+                    load_vectors(normals + i, x, y, z);
+                    store_vectors(outNormals + i,
+                                  m[0] * x + m[1] * y + m[2] * z,
+                                  m[4] * x + m[5] * y + m[6] * z,
+                                  m[8] * x + m[9] * y + m[10] * z);
+                }
+            });
+        }
+    }
+
+    // Dual quaternion skinning, bones are unit dual quaternions
+    template<typename T, typename Index>
+    void skin(const DualQuaternion<T> *bones, const Index *indices, const T *weights,
+              const Vector<T, 3> *positions, const Vector<T, 3> *normals,
+              Vector<T, 3> *outPositions, Vector<T, 3> *outNormals, std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::skin");
+        detail::skin_dual_quaternion(bones, indices, weights, positions, normals, outPositions, outNormals, count);
+    }
+
+    template<typename T, typename Index>
+    void skin(const DualQuaternion<T> *bones, const Index *indices, const T *weights,
+              const Vector<T, 3> *positions, Vector<T, 3> *outPositions, std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::skin");
+        detail::skin_dual_quaternion(bones, indices, weights, positions, static_cast<const Vector<T, 3> *>(nullptr),
+                                     outPositions, static_cast<Vector<T, 3> *>(nullptr), count);
+    }
+
+    // Linear blend skinning, bones are a 3x4 palette such as the output of Sm::compose_palette.
+    // Normals are transformed by the blended matrix without renormalizing.
+    template<typename T, typename Index>
+    void skin(const Matrix<T, 3, 4> *bones, const Index *indices, const T *weights,
+              const Vector<T, 3> *positions, const Vector<T, 3> *normals,
+              Vector<T, 3> *outPositions, Vector<T, 3> *outNormals, std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::skin");
+        detail::skin_linear(bones, indices, weights, positions, normals, outPositions, outNormals, count);
+    }
+
+    template<typename T, typename Index>
+    void skin(const Matrix<T, 3, 4> *bones, const Index *indices, const T *weights,
+              const Vector<T, 3> *positions, Vector<T, 3> *outPositions, std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::skin");
+        detail::skin_linear(bones, indices, weights, positions, static_cast<const Vector<T, 3> *>(nullptr),
+                            outPositions, static_cast<Vector<T, 3> *>(nullptr), count);
+    }
+
+    // Sm::skin spread over executor, bones are DualQuaternion<T> or Matrix<T, 3, 4>
+    template<typename Bone, typename T, typename Index>
+    void skin(Executor &executor, const Bone *bones, const Index *indices, const T *weights,
+              const Vector<T, 3> *positions, const Vector<T, 3> *normals,
+              Vector<T, 3> *outPositions, Vector<T, 3> *outNormals, std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::skin(Executor)");
+        parallel_for(executor, count, [&](std::size_t begin, std::size_t end) {
+            skin(bones, indices + begin * skinInfluences, weights + begin * skinInfluences, positions + begin,
+                 normals ? normals + begin : normals, outPositions + begin,
+                 outNormals ? outNormals + begin : outNormals, end - begin);
+        }, cache_partition(outPositions, 16 * 1024, simd::WidestPack<T>::width));
+    }
+
+    template<typename Bone, typename T, typename Index>
+    void skin(Executor &executor, const Bone *bones, const Index *indices, const T *weights,
+              const Vector<T, 3> *positions, Vector<T, 3> *outPositions, std::size_t count) {
+        skin(executor, bones, indices, weights, positions, static_cast<const Vector<T, 3> *>(nullptr),
+             outPositions, static_cast<Vector<T, 3> *>(nullptr), count);
+    }
+}
+
+#endif //SLIMEMATHS_SKINNING_H
@@ -6,13 +6,18 @@
 #define SLIMEMATHS_SLIMEALGEBRA_H
 
 #include <cmath>
+#include <limits>
+#include <algorithm>
 #include "ForwardDecl.h"
+#include "MatrixKernels.h"
+#include "Instrument.h"
 
 
 namespace Sm {
 
     template<typename VectorType, typename ScalarType = typename VectorType::ScalarType>
-    ScalarType dot(const VectorType &lhs, const VectorType &rhs) {
+    constexpr ScalarType dot(const VectorType &lhs, const VectorType &rhs) {
+        SLIMEMATHS_INSTRUMENT_CALL("Sm::dot");
         ScalarType result = ScalarType(0);
 
         for (std::size_t i = 0; i < VectorType::components; ++i)
@@ -22,7 +27,8 @@ namespace Sm {
     }
 
     template<typename VectorType>
-    VectorType cross(const VectorType &lhs, const VectorType &rhs) {
+    constexpr VectorType cross(const VectorType &lhs, const VectorType &rhs) {
+        SLIMEMATHS_INSTRUMENT_CALL("Sm::cross");
         static_assert(VectorType::components == 3, "Vector type must have exactly three components");
         return VectorType
                 {
@@ -33,28 +39,33 @@ namespace Sm {
     }
 
     template<typename VectorType, typename ScalarType = typename VectorType::ScalarType>
-    ScalarType length_sq(const VectorType &vec) {
+    constexpr ScalarType length_sq(const VectorType &vec) {
+        SLIMEMATHS_INSTRUMENT_CALL("Sm::length_sq");
         return dot<VectorType, ScalarType>(vec, vec);
     }
 
     template<typename VectorType, typename ScalarType = typename VectorType::ScalarType>
     ScalarType length(const VectorType &vec) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::length");
         return std::sqrt(length_sq<VectorType, ScalarType>(vec));
     }
 
     template<typename VectorType, typename ScalarType = typename VectorType::ScalarType>
     ScalarType angle(const VectorType &lhs, const VectorType &rhs) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::angle");
         return std::acos(dot<VectorType, ScalarType>(lhs, rhs) /
                          (length<VectorType, ScalarType>(lhs) * length<VectorType, ScalarType>(rhs)));
     }
 
     template<typename VectorType, typename ScalarType = typename VectorType::ScalarType>
     ScalarType angle_norm(const VectorType &lhs, const VectorType &rhs) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::angle_norm");
         return std::acos(dot<VectorType, ScalarType>(lhs, rhs));
     }
 
     template<typename VectorType, typename ScalarType = typename VectorType::ScalarType>
-    ScalarType distance_sq(const VectorType &lhs, const VectorType &rhs) {
+    constexpr ScalarType distance_sq(const VectorType &lhs, const VectorType &rhs) {
+        SLIMEMATHS_INSTRUMENT_CALL("Sm::distance_sq");
         auto result = rhs;
         result -= lhs;
         return length_sq<VectorType, ScalarType>(result);
@@ -62,13 +73,15 @@ namespace Sm {
 
     template<typename VectorType, typename ScalarType = typename VectorType::ScalarType>
     ScalarType distance(const VectorType &lhs, const VectorType &rhs) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::distance");
         auto result = rhs;
         result -= lhs;
         return length<VectorType, ScalarType>(result);
     }
 
     template<typename VectorType, typename ScalarType = typename VectorType::ScalarType>
-    VectorType reflect(const VectorType &incident, const VectorType &normal) {
+    constexpr VectorType reflect(const VectorType &incident, const VectorType &normal) {
+        SLIMEMATHS_INSTRUMENT_CALL("Sm::reflect");
         auto v = normal;
         v *= (dot<VectorType, ScalarType>(normal, incident) * ScalarType(-2));
         v += incident;
@@ -77,6 +90,7 @@ namespace Sm {
 
     template<typename VectorType, typename ScalarType = typename VectorType::ScalarType>
     void normalize(VectorType &vec) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::normalize");
         auto len = length_sq<VectorType, ScalarType>(vec);
         if (len != ScalarType(0) && len != ScalarType(1)) {
             len = ScalarType(1) / std::sqrt(len);
@@ -86,6 +100,7 @@ namespace Sm {
 
     template<typename VectorType, typename ScalarType = typename VectorType::ScalarType>
     void resize(VectorType &vec, const ScalarType &length) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::resize");
         auto len = length_sq<VectorType, ScalarType>(vec);
         if (len != ScalarType(0)) {
             len = length / std::sqrt(len);
@@ -94,7 +109,8 @@ namespace Sm {
     }
 
     template<typename T, typename I>
-    void lerp(T &x, const T &a, const T &b, const I &t) {
+    constexpr void lerp(T &x, const T &a, const T &b, const I &t) {
+        SLIMEMATHS_INSTRUMENT_CALL("Sm::lerp");
         x = b;
         x -= a;
         x *= t;
@@ -102,7 +118,8 @@ namespace Sm {
     }
 
     template<typename T, typename I>
-    T lerp(const T &a, const T &b, const I &t) {
+    constexpr T lerp(const T &a, const T &b, const I &t) {
+        SLIMEMATHS_INSTRUMENT_CALL("Sm::lerp");
         /* Return (b - a) * t + a */
         T x = b;
         x -= a;
@@ -111,8 +128,15 @@ namespace Sm {
         return x;
     }
 
+    template<typename T, typename I>
+    constexpr T mix(const T &v0, const T &v1, const I &scale0, const I &scale1) {
+        SLIMEMATHS_INSTRUMENT_CALL("Sm::mix");
+        return v0 * scale0 + v1 * scale1;
+    }
+
     template<typename VectorType, typename ScalarType = typename VectorType::ScalarType>
     VectorType slerp(const VectorType &from, const VectorType &to, const ScalarType &t) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::slerp");
         ScalarType omega, cosom, sinom;
         ScalarType scale0, scale1;
 
@@ -140,21 +164,17 @@ namespace Sm {
         }
 
         /* Calculate final values */
-        return Mix(from, to, scale0, scale1);
-    }
-
-    template<typename T, typename I>
-    T mix(const T &v0, const T &v1, const I &scale0, const I &scale1) {
-        return v0 * scale0 + v1 * scale1;
+        return mix(from, to, scale0, scale1);
     }
 
     template<typename T>
-    T saturate(const T &x) {
+    constexpr T saturate(const T &x) {
         return (std::max)(T(0), (std::min)(x, T(1)));
     }
 
     template<typename T>
-    T clamp(const T &x, const T &minima, const T &maxima) {
+    constexpr T clamp(const T &x, const T &minima, const T &maxima) {
+        SLIMEMATHS_INSTRUMENT_CALL("Sm::clamp");
         if (x <= minima)
             return minima;
         if (x >= maxima)
@@ -163,22 +183,22 @@ namespace Sm {
     }
 
     template<typename T>
-    T smooth_step(const T &x) {
+    constexpr T smooth_step(const T &x) {
         return x * x * (T(3) - x * T(2));
     }
 
     template<typename T>
-    T smoother_step(const T &x) {
+    constexpr T smoother_step(const T &x) {
         return x * x * x * (x * (x * T(6) - T(15)) + T(10));
     }
 
     template<typename T>
-    T reciprocal(const T &x) {
+    constexpr T reciprocal(const T &x) {
         return T(1) / x;
     }
 
     template<typename T, std::size_t N>
-    Vector<T, N> reciprocal(const Vector<T, N> &vec) {
+    constexpr Vector<T, N> reciprocal(const Vector<T, N> &vec) {
         Vector<T, N> vecRcp{};
 
         for (std::size_t i = 0; i < N; ++i)
@@ -188,7 +208,7 @@ namespace Sm {
     }
 
     template<typename T, std::size_t N, std::size_t M>
-    Matrix<T, N, M> reciprocal(const Matrix<T, N, M> &mat) {
+    constexpr Matrix<T, N, M> reciprocal(const Matrix<T, N, M> &mat) {
         Matrix<T, N, M> matRcp{};
 
         for (std::size_t i = 0; i < N * M; ++i)
@@ -198,7 +218,7 @@ namespace Sm {
     }
 
     template<typename T, typename I>
-    T rescale(const T &t, const I &lower0, const I &upper0, const I &lower1, const I &upper1) {
+    constexpr T rescale(const T &t, const I &lower0, const I &upper0, const I &lower1, const I &upper1) {
         /* Return (((t - lower0) / (upper0 - lower0)) * (upper1 - lower1) + lower1) */
         T x = t;
         x -= T(lower0);
@@ -209,28 +229,38 @@ namespace Sm {
     }
 
     template<typename T, std::size_t Rows, std::size_t Cols>
-    Vector<T, Cols> operator*(const Vector<T, Rows> &lhs, const Matrix<T, Rows, Cols> &rhs) {
+    constexpr Vector<T, Cols> operator*(const Vector<T, Rows> &lhs, const Matrix<T, Rows, Cols> &rhs) {
+        SLIMEMATHS_INSTRUMENT_CALL("Sm::operator*(Vector,Matrix)");
         Vector<T, Cols> result;
 
-        for (std::size_t c = 0; c < Cols; ++c) {
-            result[c] = T(0);
-            for (std::size_t r = 0; r < Rows; ++r)
-                result[c] += rhs(r, c) * lhs[r];
-        }
+        if (SLIMEMATHS_IS_CONSTANT_EVALUATED()) {
+            for (std::size_t c = 0; c < Cols; ++c) {
+                T sum = T(0);
+                for (std::size_t r = 0; r < Rows; ++r)
+                    sum += rhs(r, c) * lhs[r];
+                result[c] = sum;
+            }
+        } else
+            detail::VectorMatrixKernel<T, Rows, Cols>::apply(result.ptr(), lhs.ptr(), rhs.ptr());
 
         return result;
     }
 
 
     template<typename T, std::size_t Rows, std::size_t Cols>
-    Vector<T, Rows> operator*(const Matrix<T, Rows, Cols> &lhs, const Vector<T, Cols> &rhs) {
+    constexpr Vector<T, Rows> operator*(const Matrix<T, Rows, Cols> &lhs, const Vector<T, Cols> &rhs) {
+        SLIMEMATHS_INSTRUMENT_CALL("Sm::operator*(Matrix,Vector)");
         Vector<T, Rows> result;
 
-        for (std::size_t r = 0; r < Rows; ++r) {
-            result[r] = T(0);
-            for (std::size_t c = 0; c < Cols; ++c)
-                result[r] += lhs(r, c) * rhs[c];
-        }
+        if (SLIMEMATHS_IS_CONSTANT_EVALUATED()) {
+            for (std::size_t r = 0; r < Rows; ++r) {
+                T sum = T(0);
+                for (std::size_t c = 0; c < Cols; ++c)
+                    sum += lhs(r, c) * rhs[c];
+                result[r] = sum;
+            }
+        } else
+            detail::MatrixVectorKernel<T, Rows, Cols>::apply(result.ptr(), lhs.ptr(), rhs.ptr());
 
         return result;
     }
@@ -10,6 +10,29 @@
 #include "Vector4.h"
 #include "Matrix.h"
 #include "Quaternion.h"
+#include "VectorArray.h"
+#include "Dispatch.h"
+#include "Executor.h"
+#include "Instrument.h"
+#include "BatchTransform.h"
+#include "QuaternionBlend.h"
+#include "QuaternionConversion.h"
+#include "Expression.h"
+#include "DynamicMatrix.h"
+#include "Aligned.h"
+#include "FastMath.h"
+#include "TransformHierarchy.h"
+#include "DualQuaternion.h"
+#include "Skinning.h"
+#include "AABB.h"
+#include "Ray.h"
+#include "Frustum.h"
+#include "Bvh.h"
+#include "Half.h"
+#include "Encoding.h"
+#include "SymmetricEigen.h"
+#include "Svd.h"
+#include "Trs.h"
 
 #include "SlimeAlgebra.h"
 
@@ -0,0 +1,352 @@
+#ifndef SLIMEMATHS_SVD_H
+#define SLIMEMATHS_SVD_H
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <ostream>
+#include "Vector3.h"
+#include "Matrix.h"
+#include "Quaternion.h"
+#include "QuaternionBlend.h"
+#include "QuaternionConversion.h"
+#include "SimdPack.h"
+#include "Executor.h"
+#include "Instrument.h"
+
+// Singular value and polar decomposition of 3x3 matrices, for shape matching and deformation.
+//
+// Sm::svd follows McAdams et al., "Computing the Singular Value Decomposition of 3x3 matrices with minimal branching
+// and elementary floating point operations": a fixed number of Jacobi sweeps diagonalizes transposed(m) * m with
+// approximate Givens rotations (one rsqrt each, no trig) accumulated as a quaternion, the columns of m * v are sorted
+// by length, and Givens QR of the sorted columns gives u and the singular values. Nothing branches on the values,
+// so one kernel runs a simd pack of independent matrices per instruction.
+//
+// u and v are rotations (determinant +1) and m = u * diag(sigma) * transposed(v). The singular values come out in
+// descending order of magnitude; sigma.z is negative when m reflects (determinant < 0), the other two never are.
+// Sm::polar_rotation is u * transposed(v) as a unit quaternion: the rotation closest to m, the stretch being
+// transposed(rotation) * m.
+// transposed(m) * m is formed explicitly, so its elements must neither overflow nor underflow the type.
+//
+//     Quaternionf rotation = Sm::polar_rotation(deformation);
+
+template<typename T>
+struct Svd {
+    static_assert(std::is_floating_point<T>::value, "singular value decompositions need a floating point type");
+
+    using ScalarType = T;
+
+    // u * diag(sigma) * transposed(v), the decomposed matrix
+    Matrix<T, 3, 3> matrix() const {
+        Matrix<T, 3, 3> result;
+        for (std::size_t r = 0; r < 3; ++r)
+            for (std::size_t c = 0; c < 3; ++c)
+                result(r, c) = u(r, 0) * sigma.x * v(c, 0) + u(r, 1) * sigma.y * v(c, 1) +
+                               u(r, 2) * sigma.z * v(c, 2);
+        return result;
+    }
+
+    // OStream Overrider
+    friend std::ostream &operator<<(std::ostream &os, const Svd<T> &svd) {
+        os << "sigma: [" << svd.sigma.x << ", " << svd.sigma.y << ", " << svd.sigma.z << "]\nu:\n" << svd.u
+           << "v:\n" << svd.v;
+        return os;
+    }
+
+    Matrix<T, 3, 3> u;
+    Vector<T, 3> sigma;
+    Matrix<T, 3, 3> v;
+};
+
+using Svdf = Svd<float>;
+using Svdd = Svd<double>;
+
+namespace Sm {
+    namespace detail {
+
+        // Jacobi sweeps for the approximate rotations. McAdams et al. stop at four for float, which leaves a few in a
+        // hundred thousand random matrices far from converged; these are the counts after which more sweeps stop
+        // improving the worst reconstruction error.
+        template<typename T>
+        struct SvdSweeps {
+            static const std::size_t value = 8;
+        };
+
+        template<>
+        struct SvdSweeps<float> {
+            static const std::size_t value = 6;
+        };
+
+        // Turns the rotation quat by the angle with half angle cosine ch and sine sh in the (p, q) plane: with c and s
+        // of the full angle, column p of its matrix becomes c * p + s * q and column q becomes c * q - s * p.
+        // ch and sh need not be normalized, the quaternion then grows by their length.
+        template<std::size_t p, std::size_t q, typename P>
+        void rotate_quaternion(P (&quat)[4], const P &ch, const P &sh) {
+            constexpr std::size_t k = 3 - p - q, k1 = (k + 1) % 3, k2 = (k + 2) % 3;
+            /* The plane rotation is about +x and +z but about -y */
+            const P s = k == 1 ? -sh : sh;
+
+            const P x = quat[k], y = quat[k1], z = quat[k2], w = quat[3];
+            quat[k] = ch * x + s * w;
+            quat[k1] = ch * y + s * z;
+            quat[k2] = ch * z - s * y;
+            quat[3] = ch * w - s * x;
+        }
+
+        // One approximate Jacobi rotation of the symmetric s in the (p, q) plane, r is the third index. The half angle
+        // comes from the first order estimate (2 (app - aqq), apq), falling back to pi / 8 where that estimate would
+        // be past it. A negligible apq (the Numerical Recipes test) turns into the identity rotation.
+        template<std::size_t p, std::size_t q, typename P>
+        void svd_jacobi(P &app, P &aqq, P &apq, P &arp, P &arq, P (&v)[4]) {
+            using T = typename P::ScalarType;
+            const P zero = P::broadcast(T(0));
+            const P one = P::broadcast(T(1));
+
+            const P gap = P::broadcast(T(100)) * abs(apq);
+            const auto negligible = (abs(app) + gap == abs(app)) & (abs(aqq) + gap == abs(aqq));
+            P ch = select(negligible, one, P::broadcast(T(2)) * (app - aqq));
+            P sh = select(negligible, zero, apq);
+
+            /* gamma = 3 + 2 sqrt(2) is tan^2(pi / 8) inverted */
+            const auto estimate = P::broadcast(T(5.828427124746190)) * sh * sh < ch * ch;
+            const P w = rsqrt(ch * ch + sh * sh);
+            ch = select(estimate, w * ch, P::broadcast(T(0.9238795325112867)));
+            sh = select(estimate, w * sh, P::broadcast(T(0.3826834323650898)));
+
+            const P c = ch * ch - sh * sh;
+            const P s = P::broadcast(T(2)) * ch * sh;
+            const P cc = c * c, ss = s * s, cs = c * s;
+
+            const P pp = app, qq = aqq, pq = apq;
+            const P twice = P::broadcast(T(2)) * cs * pq;
+            app = cc * pp + twice + ss * qq;
+            aqq = ss * pp - twice + cc * qq;
+            apq = cs * (qq - pp) + (cc - ss) * pq;
+
+            const P rp = arp, rq = arq;
+            arp = c * rp + s * rq;
+            arq = c * rq - s * rp;
+
+            rotate_quaternion<p, q>(v, ch, sh);
+        }
+
+        // Moves column q of b in front of column p when it is longer, negating one so v stays a rotation
+        template<std::size_t p, std::size_t q, typename P>
+        void svd_order(P (&b)[9], P (&lengths)[3], P (&v)[4]) {
+            using T = typename P::ScalarType;
+            const auto swap = lengths[q] > lengths[p];
+            const P lp = lengths[p], lq = lengths[q];
+            lengths[p] = select(swap, lq, lp);
+            lengths[q] = select(swap, lp, lq);
+
+            for (std::size_t r = 0; r < 3; ++r) {
+                const P bp = b[r * 3 + p], bq = b[r * 3 + q];
+                b[r * 3 + p] = select(swap, bq, bp);
+                b[r * 3 + q] = select(swap, -bp, bq);
+            }
+
+            /* A quarter turn in the plane, unnormalized (ch = sh = 1) */
+            const P one = P::broadcast(T(1));
+            rotate_quaternion<p, q>(v, one, select(swap, one, P::broadcast(T(0))));
+        }
+
+        // Givens rotation of rows p and q of b that zeroes b(q, p) and leaves b(p, p) >= 0, accumulated into u.
+        // The half angle is taken from (|bpp| + length, bqp), or the two swapped for a negative bpp, which never
+        // cancels.
+        template<std::size_t p, std::size_t q, typename P>
+        void svd_givens(P (&b)[9], P (&u)[4]) {
+            using T = typename P::ScalarType;
+            const P tiny = P::broadcast(std::sqrt(std::numeric_limits<T>::min()));
+
+            const P a1 = b[p * 3 + p], a2 = b[q * 3 + p];
+            const P length = sqrt(a1 * a1 + a2 * a2);
+            P sh = select(length > tiny, a2, P::broadcast(T(0)));
+            P ch = abs(a1) + max(length, tiny);
+
+            const auto flip = a1 < P::broadcast(T(0));
+            const P swapped = sh;
+            sh = select(flip, ch, sh);
+            ch = select(flip, swapped, ch);
+
+            const P w = rsqrt(ch * ch + sh * sh);
+            ch = ch * w;
+            sh = sh * w;
+
+            const P c = ch * ch - sh * sh;
+            const P s = P::broadcast(T(2)) * ch * sh;
+            for (std::size_t col = 0; col < 3; ++col) {
+                const P bp = b[p * 3 + col], bq = b[q * 3 + col];
+                b[p * 3 + col] = c * bp + s * bq;
+                b[q * 3 + col] = c * bq - s * bp;
+            }
+
+            rotate_quaternion<p, q>(u, ch, sh);
+        }
+
+        template<typename P>
+        void normalize_quaternion(P (&quat)[4]) {
+            const P scale = rsqrt(quat[0] * quat[0] + quat[1] * quat[1] + quat[2] * quat[2] + quat[3] * quat[3]);
+            for (auto &component: quat)
+                component = component * scale;
+        }
+
+        // a is the row major matrix. Writes the rotations u and v as quaternions (x, y, z, w) and the singular
+        // values sigma so that a = u * diag(sigma) * transposed(v).
+        template<typename P>
+        void svd(const P (&a)[9], P (&u)[4], P (&sigma)[3], P (&v)[4]) {
+            using T = typename P::ScalarType;
+            const P zero = P::broadcast(T(0));
+            const P one = P::broadcast(T(1));
+
+            /* s = transposed(a) * a, symmetric, so only the diagonal and the upper triangle */
+            P s00 = a[0] * a[0] + a[3] * a[3] + a[6] * a[6];
+            P s11 = a[1] * a[1] + a[4] * a[4] + a[7] * a[7];
+            P s22 = a[2] * a[2] + a[5] * a[5] + a[8] * a[8];
+            P s01 = a[0] * a[1] + a[3] * a[4] + a[6] * a[7];
+            P s02 = a[0] * a[2] + a[3] * a[5] + a[6] * a[8];
+            P s12 = a[1] * a[2] + a[4] * a[5] + a[7] * a[8];
+
+            v[0] = v[1] = v[2] = zero;
+            v[3] = one;
+            for (std::size_t sweep = 0; sweep < SvdSweeps<T>::value; ++sweep) {
+                svd_jacobi<0, 1>(s00, s11, s01, s02, s12, v);
+                svd_jacobi<0, 2>(s00, s22, s02, s01, s12, v);
+                svd_jacobi<1, 2>(s11, s22, s12, s01, s02, v);
+            }
+            normalize_quaternion(v);
+
+            /* b = a * v has orthogonal columns of the singular values' lengths */
+            P rotation[9], b[9], lengths[3];
+            rotation_elements<P, T>(v[0], v[1], v[2], v[3], rotation);
+            for (std::size_t r = 0; r < 3; ++r)
+                for (std::size_t c = 0; c < 3; ++c)
+                    b[r * 3 + c] = a[r * 3] * rotation[c] + a[r * 3 + 1] * rotation[3 + c] +
+                                   a[r * 3 + 2] * rotation[6 + c];
+            for (std::size_t c = 0; c < 3; ++c)
+                lengths[c] = b[c] * b[c] + b[3 + c] * b[3 + c] + b[6 + c] * b[6 + c];
+
+            svd_order<0, 1>(b, lengths, v);
+            svd_order<0, 2>(b, lengths, v);
+            svd_order<1, 2>(b, lengths, v);
+            normalize_quaternion(v);
+
+            u[0] = u[1] = u[2] = zero;
+            u[3] = one;
+            svd_givens<0, 1>(b, u);
+            svd_givens<0, 2>(b, u);
+            svd_givens<1, 2>(b, u);
+            normalize_quaternion(u);
+
+            sigma[0] = b[0];
+            sigma[1] = b[4];
+            sigma[2] = b[8];
+        }
+
+        // u * transposed(v) of the svd of a, with w >= 0
+        template<typename P>
+        void polar_rotation(const P (&a)[9], P &x, P &y, P &z, P &w) {
+            P u[4], sigma[3], v[4];
+            svd(a, u, sigma, v);
+
+            x = u[0] * v[3] - u[3] * v[0] - u[1] * v[2] + u[2] * v[1];
+            y = u[1] * v[3] - u[3] * v[1] - u[2] * v[0] + u[0] * v[2];
+            z = u[2] * v[3] - u[3] * v[2] - u[0] * v[1] + u[1] * v[0];
+            w = u[3] * v[3] + u[0] * v[0] + u[1] * v[1] + u[2] * v[2];
+
+            const auto flip = w < P::broadcast(typename P::ScalarType(0));
+            x = select(flip, -x, x);
+            y = select(flip, -y, y);
+            z = select(flip, -z, z);
+            w = select(flip, -w, w);
+        }
+
+        template<typename P, typename T>
+        void store_svd(Svd<T> *out, const P (&u)[4], const P (&sigma)[3], const P (&v)[4]) {
+            P us[9], vs[9];
+            rotation_elements<P, T>(u[0], u[1], u[2], u[3], us);
+            rotation_elements<P, T>(v[0], v[1], v[2], v[3], vs);
+
+            T lanes[21][P::width];
+            for (std::size_t k = 0; k < 9; ++k) {
+                us[k].store(lanes[k]);
+                vs[k].store(lanes[9 + k]);
+            }
+            for (std::size_t k = 0; k < 3; ++k)
+                sigma[k].store(lanes[18 + k]);
+
+            for (std::size_t l = 0; l < P::width; ++l) {
+                for (std::size_t k = 0; k < 9; ++k) {
+                    out[l].u[k] = lanes[k][l];
+                    out[l].v[k] = lanes[9 + k][l];
+                }
+                for (std::size_t k = 0; k < 3; ++k)
+                    out[l].sigma[k] = lanes[18 + k][l];
+            }
+        }
+    }
+
+    // Singular value decomposition of m
+    template<typename T>
+    Svd<T> svd(const Matrix<T, 3, 3> &m) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::svd");
+        using P = simd::ScalarPack<T>;
+        P a[9], u[4], sigma[3], v[4];
+        for (std::size_t k = 0; k < 9; ++k)
+            a[k] = P::broadcast(m[k]);
+        detail::svd(a, u, sigma, v);
+
+        Svd<T> result;
+        detail::store_svd(&result, u, sigma, v);
+        return result;
+    }
+
+    // out[i] = Sm::svd(in[i]), a simd pack of matrices per instruction
+    template<typename T>
+    void svd(const Matrix<T, 3, 3> *in, Svd<T> *out, std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::svd(batch)");
+        simd::for_each_pack<T>(count, [&](auto pack, std::size_t i) {
+            using P = decltype(pack);
+            P a[9], u[4], sigma[3], v[4];
+            detail::load_matrices(in + i, a);
+            detail::svd(a, u, sigma, v);
+            detail::store_svd(out + i, u, sigma, v);
+        });
+    }
+
+    // Rotation of the polar decomposition of m, u * transposed(v) of its svd
+    template<typename T>
+    Quaternion<T> polar_rotation(const Matrix<T, 3, 3> &m) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::polar_rotation");
+        using P = simd::ScalarPack<T>;
+        P a[9], x, y, z, w;
+        for (std::size_t k = 0; k < 9; ++k)
+            a[k] = P::broadcast(m[k]);
+        detail::polar_rotation(a, x, y, z, w);
+        return Quaternion<T>{x.v, y.v, z.v, w.v};
+    }
+
+    // out[i] = Sm::polar_rotation(in[i]), a simd pack of matrices per instruction
+    template<typename T>
+    void polar_rotation(const Matrix<T, 3, 3> *in, Quaternion<T> *out, std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::polar_rotation(batch)");
+        simd::for_each_pack<T>(count, [&](auto pack, std::size_t i) {
+            using P = decltype(pack);
+            P a[9], x, y, z, w;
+            detail::load_matrices(in + i, a);
+            detail::polar_rotation(a, x, y, z, w);
+            detail::store_quaternions(out + i, x, y, z, w);
+        });
+    }
+
+    // Sm::polar_rotation spread over executor
+    template<typename T>
+    void polar_rotation(Executor &executor, const Matrix<T, 3, 3> *in, Quaternion<T> *out, std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::polar_rotation(Executor)");
+        parallel_for(executor, count, [&](std::size_t begin, std::size_t end) {
+            polar_rotation(in + begin, out + begin, end - begin);
+        }, cache_partition(out, 16 * 1024, simd::WidestPack<T>::width));
+    }
+}
+
+#endif //SLIMEMATHS_SVD_H
@@ -0,0 +1,482 @@
+#ifndef SLIMEMATHS_SYMMETRICEIGEN_H
+#define SLIMEMATHS_SYMMETRICEIGEN_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <ostream>
+#include "Vector3.h"
+#include "Matrix.h"
+#include "VectorArray.h"
+#include "QuaternionConversion.h"
+#include "SimdPack.h"
+#include "Executor.h"
+#include "Instrument.h"
+
+// Eigen decomposition of symmetric 3x3 matrices and covariance of point sets, for principal axes and oriented boxes.
+//
+// Sm::eigen_symmetric runs cyclic Jacobi with a fixed number of sweeps and no convergence test. Every rotation is
+// branch free (a zero off diagonal element turns into the identity rotation), so one kernel runs a simd pack of
+// independent matrices per instruction and a single matrix costs the same whatever its values.
+// Only the diagonal and the upper triangle are read. Eigenvalues come out in descending order, the eigenvectors are
+// the columns of a rotation matrix (right handed, determinant +1): matrix = vectors * diag(values) * transposed(vectors).
+//
+// Covariance accumulates count, mean and the co-moments sum((p - mean) * transposed(p - mean)) of the points added.
+// Spans are summed a pack at a time in two passes per block (mean first, then moments about it), blocks and
+// accumulators are merged with the pairwise update of Chan et al., so partial results of threads combine exactly
+// like one long stream.
+//
+//     Covariance<float> points;
+//     points.add(vertices.data(), vertices.size());
+//     SymmetricEigen<float> axes = Sm::principal_axes(points);   // axes.vectors columns, longest spread first
+
+template<typename T>
+struct SymmetricEigen {
+    static_assert(std::is_floating_point<T>::value, "eigen decompositions need a floating point type");
+
+    using ScalarType = T;
+
+    // Eigenvector i, the unit column i of vectors
+    constexpr Vector<T, 3> axis(std::size_t i) const {
+        return Vector<T, 3>{vectors(0, i), vectors(1, i), vectors(2, i)};
+    }
+
+    // OStream Overrider
+    friend std::ostream &operator<<(std::ostream &os, const SymmetricEigen<T> &eigen) {
+        os << "values: [" << eigen.values.x << ", " << eigen.values.y << ", " << eigen.values.z << "]\n"
+           << eigen.vectors;
+        return os;
+    }
+
+    Vector<T, 3> values;
+    Matrix<T, 3, 3> vectors;
+};
+
+using SymmetricEigenf = SymmetricEigen<float>;
+using SymmetricEigend = SymmetricEigen<double>;
+
+template<typename T>
+struct Covariance {
+    static_assert(std::is_floating_point<T>::value, "covariance needs a floating point type");
+
+    using ScalarType = T;
+
+    // Constructors
+    constexpr Covariance() = default;
+
+    constexpr Covariance(const Covariance<T> &rhs) = default;
+
+    // count points with the given mean and co-moments (xx, yy, zz) on the diagonal and (xy, xz, yz) above it
+    constexpr Covariance(std::size_t count, const Vector<T, 3> &mean, const Vector<T, 3> &diagonal,
+                         const Vector<T, 3> &offDiagonal) :
+            _count{count}, _mean{mean}, _diagonal{diagonal}, _offDiagonal{offDiagonal} {}
+
+    constexpr Covariance<T> &operator=(const Covariance<T> &rhs) = default;
+
+    // Functions
+    constexpr std::size_t count() const {
+        return _count;
+    }
+
+    constexpr bool empty() const {
+        return _count == 0;
+    }
+
+    constexpr const Vector<T, 3> &mean() const {
+        return _mean;
+    }
+
+    // Population covariance, co-moments / count, zero when empty
+    constexpr Matrix<T, 3, 3> covariance() const {
+        const T scale = _count ? T(1) / T(_count) : T(0);
+        return Matrix<T, 3, 3>{_diagonal.x * scale, _offDiagonal.x * scale, _offDiagonal.y * scale,
+                               _offDiagonal.x * scale, _diagonal.y * scale, _offDiagonal.z * scale,
+                               _offDiagonal.y * scale, _offDiagonal.z * scale, _diagonal.z * scale};
+    }
+
+    // One point, Welford's update
+    constexpr void add(const Vector<T, 3> &point) {
+        ++_count;
+        const Vector<T, 3> before = point - _mean;
+        _mean += before * (T(1) / T(_count));
+        const Vector<T, 3> after = point - _mean;
+
+        _diagonal.x += before.x * after.x;
+        _diagonal.y += before.y * after.y;
+        _diagonal.z += before.z * after.z;
+        _offDiagonal.x += before.x * after.y;
+        _offDiagonal.y += before.x * after.z;
+        _offDiagonal.z += before.y * after.z;
+    }
+
+    void add(const Vector<T, 3> *points, std::size_t count);
+
+    void add(const VectorArray<T, 3> &points);
+
+    // Adds every point rhs has seen
+    constexpr void merge(const Covariance<T> &rhs) {
+        if (rhs._count == 0)
+            return;
+
+        const std::size_t count = _count + rhs._count;
+        const Vector<T, 3> delta = rhs._mean - _mean;
+        const T weight = T(rhs._count) / T(count);
+        const T cross = T(_count) * weight;
+
+        _mean += delta * weight;
+        _diagonal += rhs._diagonal;
+        _offDiagonal += rhs._offDiagonal;
+        _diagonal.x += delta.x * delta.x * cross;
+        _diagonal.y += delta.y * delta.y * cross;
+        _diagonal.z += delta.z * delta.z * cross;
+        _offDiagonal.x += delta.x * delta.y * cross;
+        _offDiagonal.y += delta.x * delta.z * cross;
+        _offDiagonal.z += delta.y * delta.z * cross;
+        _count = count;
+    }
+
+    // OStream Overrider
+    friend std::ostream &operator<<(std::ostream &os, const Covariance<T> &covariance) {
+        os << covariance._count << " points, mean [" << covariance._mean.x << ", " << covariance._mean.y << ", "
+           << covariance._mean.z << "]\n" << covariance.covariance();
+        return os;
+    }
+
+private:
+    std::size_t _count = 0;
+    Vector<T, 3> _mean;
+    Vector<T, 3> _diagonal;      // xx, yy, zz co-moments
+    Vector<T, 3> _offDiagonal;   // xy, xz, yz co-moments
+};
+
+using Covariancef = Covariance<float>;
+using Covarianced = Covariance<double>;
+
+namespace Sm {
+    namespace detail {
+
+        // Jacobi sweeps over the three off diagonal elements. Each sweep about squares the off diagonal norm,
+        // so these reach the last bit of the type from any start.
+        template<typename T>
+        struct JacobiSweeps {
+            static const std::size_t value = 5;
+        };
+
+        template<>
+        struct JacobiSweeps<float> {
+            static const std::size_t value = 4;
+        };
+
+        // Rotates rows and columns p and q so that apq becomes zero, r is the third index.
+        // t is the tangent of the smaller angle that does it, Numerical Recipes' expression multiplied through by
+        // |2 apq| so it has no division by apq and gives t = 0 for an already diagonal pair. An apq too small to
+        // change either diagonal element is zeroed first (the Numerical Recipes test), which stops converged
+        // elements from decaying into denormals in the sweeps that follow.
+        template<std::size_t p, std::size_t q, typename P>
+        void jacobi_rotate(P &app, P &aqq, P &apq, P &arp, P &arq, P (&v)[9]) {
+            using T = typename P::ScalarType;
+            const P zero = P::broadcast(T(0));
+            const P one = P::broadcast(T(1));
+
+            const P gap = P::broadcast(T(100)) * abs(apq);
+            const auto negligible = (abs(app) + gap == abs(app)) & (abs(aqq) + gap == abs(aqq));
+            const P twice = select(negligible, zero, apq + apq);
+
+            const P difference = aqq - app;
+            const P denominator = abs(difference) + sqrt(difference * difference + twice * twice);
+            P t = twice / select(denominator > zero, denominator, one);
+            t = select(difference < zero, -t, t);
+
+            const P c = rsqrt(one + t * t);
+            const P s = t * c;
+
+            app = app - t * apq;
+            aqq = aqq + t * apq;
+            apq = zero;
+
+            const P rp = arp, rq = arq;
+            arp = c * rp - s * rq;
+            arq = s * rp + c * rq;
+
+            for (std::size_t r = 0; r < 3; ++r) {
+                const P vrp = v[r * 3 + p], vrq = v[r * 3 + q];
+                v[r * 3 + p] = c * vrp - s * vrq;
+                v[r * 3 + q] = s * vrp + c * vrq;
+            }
+        }
+
+        // Swaps eigenpairs i and j where values[j] is the larger
+        template<typename P>
+        void eigen_order(P (&values)[3], P (&v)[9], std::size_t i, std::size_t j) {
+            const auto swap = values[j] > values[i];
+            const P vi = values[i], vj = values[j];
+            values[i] = select(swap, vj, vi);
+            values[j] = select(swap, vi, vj);
+
+            for (std::size_t r = 0; r < 3; ++r) {
+                const P ci = v[r * 3 + i], cj = v[r * 3 + j];
+                v[r * 3 + i] = select(swap, cj, ci);
+                v[r * 3 + j] = select(swap, ci, cj);
+            }
+        }
+
+        // a holds (a00, a11, a22, a01, a02, a12). Writes the eigenvalues in descending order and the eigenvectors
+        // as the columns of the row major v.
+        template<typename P>
+        void eigen_symmetric(const P (&a)[6], P (&values)[3], P (&v)[9]) {
+            using T = typename P::ScalarType;
+            const P zero = P::broadcast(T(0));
+            const P one = P::broadcast(T(1));
+
+            P a00 = a[0], a11 = a[1], a22 = a[2], a01 = a[3], a02 = a[4], a12 = a[5];
+            for (std::size_t k = 0; k < 9; ++k)
+                v[k] = k % 4 == 0 ? one : zero;
+
+            for (std::size_t sweep = 0; sweep < JacobiSweeps<T>::value; ++sweep) {
+                jacobi_rotate<0, 1>(a00, a11, a01, a02, a12, v);
+                jacobi_rotate<0, 2>(a00, a22, a02, a01, a12, v);
+                jacobi_rotate<1, 2>(a11, a22, a12, a01, a02, v);
+            }
+
+            values[0] = a00;
+            values[1] = a11;
+            values[2] = a22;
+            eigen_order(values, v, 0, 1);
+            eigen_order(values, v, 0, 2);
+            eigen_order(values, v, 1, 2);
+
+            /* Swapping columns can flip the handedness, the cross product of the first two restores a rotation */
+            v[2] = v[3] * v[7] - v[6] * v[4];
+            v[5] = v[6] * v[1] - v[0] * v[7];
+            v[8] = v[0] * v[4] - v[3] * v[1];
+        }
+
+        template<typename P, typename T>
+        void load_symmetric(const Matrix<T, 3, 3> *m, P (&a)[6]) {
+            static const std::size_t elements[6] = {0, 4, 8, 1, 2, 5};
+            T lanes[6][P::width];
+            for (std::size_t l = 0; l < P::width; ++l)
+                for (std::size_t k = 0; k < 6; ++k)
+                    lanes[k][l] = m[l][elements[k]];
+            for (std::size_t k = 0; k < 6; ++k)
+                a[k] = P::load(lanes[k]);
+        }
+
+        template<typename P, typename T>
+        void store_eigen(SymmetricEigen<T> *out, const P (&values)[3], const P (&v)[9]) {
+            T lanes[12][P::width];
+            for (std::size_t k = 0; k < 3; ++k)
+                values[k].store(lanes[k]);
+            for (std::size_t k = 0; k < 9; ++k)
+                v[k].store(lanes[3 + k]);
+
+            for (std::size_t l = 0; l < P::width; ++l) {
+                for (std::size_t k = 0; k < 3; ++k)
+                    out[l].values[k] = lanes[k][l];
+                for (std::size_t k = 0; k < 9; ++k)
+                    out[l].vectors[k] = lanes[3 + k][l];
+            }
+        }
+
+        // Adds the sums kernel(pack, i, sums) accumulates over [begin, end) to totals, whole packs first and then the
+        // tail lane by lane. The pack sums are locals so they stay in registers for the whole loop.
+        // The order of the sums follows the pack width, so this keeps the pack of the build instead of the dispatched
+        // one and a covariance is the same whatever instruction set runs.
+        template<typename T, std::size_t N, typename Kernel>
+        void accumulate(std::size_t begin, std::size_t end, T (&totals)[N], Kernel &&kernel) {
+            using P = simd::Pack<T>;
+            using S = simd::ScalarPack<T>;
+            std::size_t i = begin;
+
+            P sums[N];
+            for (auto &sum: sums)
+                sum = P::broadcast(T(0));
+            for (; end - i >= P::width; i += P::width)
+                kernel(P{}, i, sums);
+
+            S tail[N];
+            for (auto &sum: tail)
+                sum = S::broadcast(T(0));
+            for (; i < end; ++i)
+                kernel(S{}, i, tail);
+
+            for (std::size_t k = 0; k < N; ++k) {
+                T lanes[P::width];
+                sums[k].store(lanes);
+                T total = tail[k].v;
+                for (std::size_t l = 0; l < P::width; ++l)
+                    total += lanes[l];
+                totals[k] += total;
+            }
+        }
+
+        // Points summed per block, small enough that the second pass reads them from L1
+        static const std::size_t covarianceBlock = 1024;
+
+        // Two pass covariance of the points [begin, end), load(pack, i, x, y, z) reads the points at i
+        template<typename T, typename Load>
+        Covariance<T> block_covariance(std::size_t begin, std::size_t end, Load &&load) {
+            T sums[3] = {};
+            accumulate(begin, end, sums, [&](auto pack, std::size_t i, auto (&sum)[3]) {
+                using P = decltype(pack);
+                P x, y, z;
+                load(pack, i, x, y, z);
+                sum[0] = sum[0] + x;
+                sum[1] = sum[1] + y;
+                sum[2] = sum[2] + z;
+            });
+
+            const T scale = T(1) / T(end - begin);
+            const Vector<T, 3> mean{sums[0] * scale, sums[1] * scale, sums[2] * scale};
+
+            T moments[6] = {};
+            accumulate(begin, end, moments, [&](auto pack, std::size_t i, auto (&sum)[6]) {
+                using P = decltype(pack);
+                P x, y, z;
+                load(pack, i, x, y, z);
+                x = x - P::broadcast(mean.x);
+                y = y - P::broadcast(mean.y);
+                z = z - P::broadcast(mean.z);
+                sum[0] = sum[0] + x * x;
+                sum[1] = sum[1] + y * y;
+                sum[2] = sum[2] + z * z;
+                sum[3] = sum[3] + x * y;
+                sum[4] = sum[4] + x * z;
+                sum[5] = sum[5] + y * z;
+            });
+
+            return Covariance<T>{end - begin, mean, Vector<T, 3>{moments[0], moments[1], moments[2]},
+                                 Vector<T, 3>{moments[3], moments[4], moments[5]}};
+        }
+
+        template<typename T, typename Load>
+        Covariance<T> range_covariance(std::size_t begin, std::size_t end, Load &&load) {
+            Covariance<T> result;
+            for (std::size_t block = begin; block < end; block += covarianceBlock)
+                result.merge(block_covariance<T>(block, std::min(end, block + covarianceBlock), load));
+            return result;
+        }
+
+        template<typename T>
+        auto covariance_loader(const Vector<T, 3> *points) {
+            return [points](auto, std::size_t i, auto &x, auto &y, auto &z) {
+                load_vectors(points + i, x, y, z);
+            };
+        }
+
+        template<typename T>
+        auto covariance_loader(const VectorArray<T, 3> &points) {
+            const T *xs = points.component(0), *ys = points.component(1), *zs = points.component(2);
+            return [xs, ys, zs](auto pack, std::size_t i, auto &x, auto &y, auto &z) {
+                using P = decltype(pack);
+                x = P::load(xs + i);
+                y = P::load(ys + i);
+                z = P::load(zs + i);
+            };
+        }
+
+        /* One block per chunk, merged in order into an empty accumulator like range_covariance does, so the result
+         * is bitwise the one of a serial add */
+        template<typename T, typename Load>
+        Covariance<T> parallel_covariance(Executor &executor, std::size_t count, const Load &load) {
+            return parallel_reduce(executor, count, covarianceBlock, Covariance<T>{},
+                                   [&](std::size_t begin, std::size_t end) {
+                                       return block_covariance<T>(begin, end, load);
+                                   }, [](Covariance<T> lhs, const Covariance<T> &rhs) {
+                        lhs.merge(rhs);
+                        return lhs;
+                    });
+        }
+    }
+
+    // Eigenvalues and eigenvectors of the symmetric matrix m
+    template<typename T>
+    SymmetricEigen<T> eigen_symmetric(const Matrix<T, 3, 3> &m) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::eigen_symmetric");
+        using P = simd::ScalarPack<T>;
+        const P a[6] = {P::broadcast(m(0, 0)), P::broadcast(m(1, 1)), P::broadcast(m(2, 2)),
+                        P::broadcast(m(0, 1)), P::broadcast(m(0, 2)), P::broadcast(m(1, 2))};
+        P values[3], v[9];
+        detail::eigen_symmetric(a, values, v);
+
+        SymmetricEigen<T> result;
+        detail::store_eigen(&result, values, v);
+        return result;
+    }
+
+    // out[i] = Sm::eigen_symmetric(in[i]), a simd pack of matrices per instruction
+    template<typename T>
+    void eigen_symmetric(const Matrix<T, 3, 3> *in, SymmetricEigen<T> *out, std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::eigen_symmetric(batch)");
+        simd::for_each_pack<T>(count, [&](auto pack, std::size_t i) {
+            using P = decltype(pack);
+            P a[6], values[3], v[9];
+            detail::load_symmetric(in + i, a);
+            detail::eigen_symmetric(a, values, v);
+            detail::store_eigen(out + i, values, v);
+        });
+    }
+
+    // Structure of arrays: matrix i has diagonal.get(i) on its diagonal and offDiagonal.get(i) = (m01, m02, m12).
+    // values receives the eigenvalues and axes[k] eigenvector k of every matrix, the outputs are resized to fit.
+    template<typename T>
+    void eigen_symmetric(const VectorArray<T, 3> &diagonal, const VectorArray<T, 3> &offDiagonal,
+                         VectorArray<T, 3> &values, VectorArray<T, 3> (&axes)[3]) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::eigen_symmetric(VectorArray)");
+        assert(diagonal.size() == offDiagonal.size());
+        const std::size_t count = diagonal.size();
+        values.resize(count);
+        for (auto &axis: axes)
+            axis.resize(count);
+
+        simd::for_each_pack<T>(count, [&](auto pack, std::size_t i) {
+            using P = decltype(pack);
+            P a[6], eigenvalues[3], v[9];
+            for (std::size_t k = 0; k < 3; ++k) {
+                a[k] = P::load(diagonal.component(k) + i);
+                a[3 + k] = P::load(offDiagonal.component(k) + i);
+            }
+            detail::eigen_symmetric(a, eigenvalues, v);
+
+            for (std::size_t k = 0; k < 3; ++k) {
+                eigenvalues[k].store(values.component(k) + i);
+                for (std::size_t r = 0; r < 3; ++r)
+                    v[r * 3 + k].store(axes[k].component(r) + i);
+            }
+        });
+    }
+
+    // Eigen decomposition of the covariance, axis(0) is the direction the points spread the most along
+    template<typename T>
+    SymmetricEigen<T> principal_axes(const Covariance<T> &covariance) {
+        return eigen_symmetric(covariance.covariance());
+    }
+
+    // Covariance of count points spread over executor, bitwise what Covariance::add gives an empty accumulator
+    template<typename T>
+    Covariance<T> covariance(Executor &executor, const Vector<T, 3> *points, std::size_t count) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::covariance(Executor)");
+        return detail::parallel_covariance<T>(executor, count, detail::covariance_loader(points));
+    }
+
+    template<typename T>
+    Covariance<T> covariance(Executor &executor, const VectorArray<T, 3> &points) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::covariance(Executor,VectorArray)");
+        return detail::parallel_covariance<T>(executor, points.size(), detail::covariance_loader(points));
+    }
+}
+
+template<typename T>
+void Covariance<T>::add(const Vector<T, 3> *points, std::size_t count) {
+    SLIMEMATHS_INSTRUMENT_SCOPE("Covariance::add(batch)");
+    merge(Sm::detail::range_covariance<T>(0, count, Sm::detail::covariance_loader(points)));
+}
+
+template<typename T>
+void Covariance<T>::add(const VectorArray<T, 3> &points) {
+    SLIMEMATHS_INSTRUMENT_SCOPE("Covariance::add(VectorArray)");
+    merge(Sm::detail::range_covariance<T>(0, points.size(), Sm::detail::covariance_loader(points)));
+}
+
+#endif //SLIMEMATHS_SYMMETRICEIGEN_H
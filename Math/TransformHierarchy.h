@@ -0,0 +1,397 @@
+#ifndef SLIMEMATHS_TRANSFORMHIERARCHY_H
+#define SLIMEMATHS_TRANSFORMHIERARCHY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <vector>
+#include "Matrix.h"
+#include "Vector3.h"
+#include "Quaternion.h"
+#include "QuaternionConversion.h"
+#include "Executor.h"
+
+// Local to world transform propagation through a parent/child hierarchy.
+// Nodes keep their local translation, rotation and scale in separate arrays (SoA) stored in breadth-first order,
+// so every parent comes before its children and the children of a node are contiguous.
+// Setting a local transform only marks the node dirty. update() then walks just the dirty subtrees level by
+// level and recomputes their world matrices in batches; untouched parts of the hierarchy cost nothing.
+// Nodes in one level never depend on each other, so large levels can be split across threads.
+//
+//     TransformHierarchyf scene;
+//     auto root = scene.add();
+//     auto arm = scene.add(root, Vec3{0, 1, 0});
+//     scene.set_rotation(root, spin);
+//     scene.update();
+//     Mat4 armToWorld = scene.world(arm);
+
+namespace Sm {
+
+    struct TransformHierarchyOptions {
+        // Slices a level is split into, 0 uses one per thread of the executor, 1 stays on the calling thread
+        std::size_t threads = 1;
+
+        // Pool the slices run on, nullptr uses Sm::default_executor()
+        Executor *executor = nullptr;
+
+        // Levels with fewer dirty nodes than this stay on the calling thread
+        std::size_t parallelThreshold = 4096;
+    };
+
+    // What the last update() did
+    struct TransformHierarchyStats {
+        std::size_t nodes = 0;          // nodes in the hierarchy
+        std::size_t dirty = 0;          // nodes whose local transform was changed
+        std::size_t worldUpdated = 0;   // world matrices recomputed, dirty nodes and their descendants
+        std::size_t levels = 0;         // hierarchy levels that had work
+        std::size_t threads = 1;        // most threads used for a single level
+        bool reordered = false;         // nodes were added and the breadth-first order was rebuilt
+    };
+}
+
+template<typename T>
+struct TransformHierarchy {
+    using ThisType = TransformHierarchy<T>;
+    using Vec = Vector<T, 3>;
+    using Quat = Quaternion<T>;
+    using Mat = Matrix<T, 4, 4>;
+
+    // Handle of a node, stable for the lifetime of the hierarchy
+    using Node = std::size_t;
+    static constexpr Node none = std::numeric_limits<std::size_t>::max();
+
+    // Adds a node below parent (none for a root), the world matrix is valid after the next update()
+    Node add(Node parent = none, const Vec &translation = Vec{}, const Quat &rotation = Quat{},
+             const Vec &scale = Vec{T(1)}) {
+        assert(parent == none || parent < _slot.size());
+
+        const Node node = _slot.size();
+        _slot.push_back(_translation.size());
+        _node.push_back(node);
+        _parent.push_back(parent == none ? none : _slot[parent]);
+        _translation.push_back(translation);
+        _rotation.push_back(rotation);
+        _scale.push_back(scale);
+        _world.emplace_back();
+        _dirtyFlag.push_back(0);
+        _firstChild.push_back(0);
+        _childCount.push_back(0);
+        _depth.push_back(parent == none ? 0 : _depth[_slot[parent]] + 1);
+
+        _reorder = true;
+        mark_dirty(node);
+        return node;
+    }
+
+    // Local transform setters, the change shows up in world() after the next update()
+    void set_translation(Node node, const Vec &translation) {
+        _translation[_slot[node]] = translation;
+        mark_dirty(node);
+    }
+
+    void set_rotation(Node node, const Quat &rotation) {
+        _rotation[_slot[node]] = rotation;
+        mark_dirty(node);
+    }
+
+    void set_scale(Node node, const Vec &scale) {
+        _scale[_slot[node]] = scale;
+        mark_dirty(node);
+    }
+
+    void set_local(Node node, const Vec &translation, const Quat &rotation, const Vec &scale) {
+        const std::size_t slot = _slot[node];
+        _translation[slot] = translation;
+        _rotation[slot] = rotation;
+        _scale[slot] = scale;
+        mark_dirty(node);
+    }
+
+    // Getters
+    const Vec &translation(Node node) const {
+        return _translation[_slot[node]];
+    }
+
+    const Quat &rotation(Node node) const {
+        return _rotation[_slot[node]];
+    }
+
+    const Vec &scale(Node node) const {
+        return _scale[_slot[node]];
+    }
+
+    Node parent(Node node) const {
+        const std::size_t parentSlot = _parent[_slot[node]];
+        return parentSlot == none ? none : _node[parentSlot];
+    }
+
+    // Translate * Rotate * Scale of the node and all its ancestors, as of the last update()
+    const Mat &world(Node node) const {
+        return _world[_slot[node]];
+    }
+
+    // World matrices in breadth-first order, node_at(i) is the node of world_matrices()[i]
+    const Mat *world_matrices() const {
+        return _world.data();
+    }
+
+    Node node_at(std::size_t index) const {
+        return _node[index];
+    }
+
+    std::size_t size() const {
+        return _node.size();
+    }
+
+    const Sm::TransformHierarchyStats &stats() const {
+        return _stats;
+    }
+
+    // Recomputes the world matrix of every dirty node and its descendants
+    const Sm::TransformHierarchyStats &update(const Sm::TransformHierarchyOptions &options = {}) {
+        _stats = Sm::TransformHierarchyStats{};
+        _stats.nodes = size();
+        _stats.dirty = _dirty.size();
+
+        if (_reorder) {
+            reorder();
+            _stats.reordered = true;
+        }
+
+        /* The shared pool is only started when something may run on it */
+        Executor *executor = options.executor;
+        if (!executor && options.threads != 1)
+            executor = &Sm::default_executor();
+        std::size_t threads = options.threads ? options.threads : executor->threads();
+        threads = std::max<std::size_t>(1, threads);
+        if (_scratch.size() < threads)
+            _scratch.resize(threads);
+
+        /* Sorting the dirty list only pays off while it is small, otherwise one pass over every flag is cheaper */
+        if (_dirty.size() * 8 < size())
+            update_sparse(executor, threads, options.parallelThreshold);
+        else
+            update_dense(executor, threads, options.parallelThreshold);
+
+        for (const std::size_t slot: _dirty)
+            _dirtyFlag[slot] = 0;
+        _dirty.clear();
+
+        return _stats;
+    }
+
+private:
+    // Per thread gather buffers for one batch of nodes
+    struct Scratch {
+        static constexpr std::size_t batch = 64;
+
+        Vec translation[batch];
+        Quat rotation[batch];
+        Vec scale[batch];
+        Mat local[batch];
+    };
+
+    void mark_dirty(Node node) {
+        const std::size_t slot = _slot[node];
+        if (!_dirtyFlag[slot]) {
+            _dirtyFlag[slot] = 1;
+            _dirty.push_back(slot);
+        }
+    }
+
+    // Walks outwards from the dirty nodes only, touching nothing outside the dirty subtrees
+    void update_sparse(Executor *executor, std::size_t threads, std::size_t parallelThreshold) {
+        /* Sorted by breadth-first position, so grouped by level and ascending within one */
+        std::sort(_dirty.begin(), _dirty.end());
+        auto nextDirty = _dirty.begin();
+
+        _level.clear();
+        while (!_level.empty() || nextDirty != _dirty.end()) {
+            /* The next level is the children of the current one plus the dirty nodes that live there.
+             * Children ranges of ascending parents are ascending, so both lists stay sorted. */
+            const std::size_t depth = _level.empty() ? _depth[*nextDirty] : _depth[_level.front()] + 1;
+
+            _children.clear();
+            for (const std::size_t slot: _level)
+                for (std::size_t c = 0; c < _childCount[slot]; ++c)
+                    _children.push_back(_firstChild[slot] + c);
+
+            const auto levelEnd = std::find_if(nextDirty, _dirty.end(), [&](std::size_t slot) {
+                return _depth[slot] != depth;
+            });
+
+            _level.clear();
+            std::set_union(_children.begin(), _children.end(), nextDirty, levelEnd, std::back_inserter(_level));
+            nextDirty = levelEnd;
+
+            if (!_level.empty())
+                update_level(_level.data(), _level.size(), executor, threads, parallelThreshold);
+        }
+    }
+
+    // One pass over every node in breadth-first order, a node is affected when it or its parent is
+    void update_dense(Executor *executor, std::size_t threads, std::size_t parallelThreshold) {
+        _level.clear();
+        for (std::size_t slot = 0; slot < size(); ++slot) {
+            if (_parent[slot] != none && _dirtyFlag[_parent[slot]])
+                _dirtyFlag[slot] = 1;
+            if (!_dirtyFlag[slot])
+                continue;
+
+            /* Parents of this level were all finished with the previous one */
+            if (!_level.empty() && _depth[_level.front()] != _depth[slot]) {
+                update_level(_level.data(), _level.size(), executor, threads, parallelThreshold);
+                _level.clear();
+            }
+            _level.push_back(slot);
+        }
+        if (!_level.empty())
+            update_level(_level.data(), _level.size(), executor, threads, parallelThreshold);
+
+        std::fill(_dirtyFlag.begin(), _dirtyFlag.end(), std::uint8_t(0));
+    }
+
+    void update_level(const std::size_t *slots, std::size_t count, Executor *executor, std::size_t threads,
+                      std::size_t parallelThreshold) {
+        _stats.worldUpdated += count;
+        ++_stats.levels;
+
+        if (count < parallelThreshold)
+            threads = 1;
+        threads = std::min(threads, (count + Scratch::batch - 1) / Scratch::batch);
+
+        if (threads <= 1) {
+            update_range(slots, count, _scratch[0]);
+            return;
+        }
+
+        _stats.threads = std::max(_stats.threads, threads);
+
+        Sm::parallel_for(*executor, threads, [&](std::size_t first, std::size_t last) {
+            for (std::size_t t = first; t < last; ++t) {
+                const std::size_t begin = t * count / threads, end = (t + 1) * count / threads;
+                update_range(slots + begin, end - begin, _scratch[t]);
+            }
+        });
+    }
+
+    // world = parent world * Translate * Rotate * Scale for nodes of one level
+    void update_range(const std::size_t *slots, std::size_t count, Scratch &scratch) {
+        for (std::size_t b = 0; b < count; b += Scratch::batch) {
+            const std::size_t n = std::min(Scratch::batch, count - b);
+
+            for (std::size_t i = 0; i < n; ++i) {
+                const std::size_t slot = slots[b + i];
+                scratch.translation[i] = _translation[slot];
+                scratch.rotation[i] = _rotation[slot];
+                scratch.scale[i] = _scale[slot];
+            }
+
+            Sm::compose_palette(scratch.rotation, scratch.translation, scratch.scale, scratch.local, n);
+
+            for (std::size_t i = 0; i < n; ++i) {
+                const std::size_t slot = slots[b + i];
+                const std::size_t parentSlot = _parent[slot];
+                _world[slot] = parentSlot == none ? scratch.local[i] : _world[parentSlot] * scratch.local[i];
+            }
+        }
+    }
+
+    // Rebuilds the breadth-first order after nodes were added
+    void reorder() {
+        const std::size_t count = size();
+
+        /* Parents always have smaller handles than their children, so counting children in handle order is enough */
+        std::vector<std::size_t> parentNode(count), childCount(count, 0), firstChild(count + 1, 0);
+        for (std::size_t node = 0; node < count; ++node) {
+            const std::size_t parentSlot = _parent[_slot[node]];
+            parentNode[node] = parentSlot == none ? none : _node[parentSlot];
+            if (parentNode[node] != none)
+                ++childCount[parentNode[node]];
+        }
+        for (std::size_t node = 0; node < count; ++node)
+            firstChild[node + 1] = firstChild[node] + childCount[node];
+
+        std::vector<std::size_t> children(firstChild[count]), filled(count, 0);
+        for (std::size_t node = 0; node < count; ++node)
+            if (parentNode[node] != none)
+                children[firstChild[parentNode[node]] + filled[parentNode[node]]++] = node;
+
+        /* Roots first, then every node's children in the order their parents were visited */
+        std::vector<std::size_t> order;
+        order.reserve(count);
+        for (std::size_t node = 0; node < count; ++node)
+            if (parentNode[node] == none)
+                order.push_back(node);
+        for (std::size_t i = 0; i < order.size(); ++i)
+            for (std::size_t c = firstChild[order[i]]; c < firstChild[order[i] + 1]; ++c)
+                order.push_back(children[c]);
+
+        std::vector<std::size_t> newSlot(count);
+        for (std::size_t i = 0; i < count; ++i)
+            newSlot[order[i]] = i;
+
+        permute(_translation, order);
+        permute(_rotation, order);
+        permute(_scale, order);
+        permute(_world, order);
+        permute(_dirtyFlag, order);
+        permute(_depth, order);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::size_t node = order[i];
+            _parent[i] = parentNode[node] == none ? none : newSlot[parentNode[node]];
+            _childCount[i] = childCount[node];
+            _firstChild[i] = childCount[node] ? newSlot[children[firstChild[node]]] : 0;
+        }
+
+        for (auto &slot: _dirty)
+            slot = newSlot[_node[slot]];
+        _node = order;
+        _slot = newSlot;
+        _reorder = false;
+    }
+
+    // values[i] = old values[order[i]], order is in node handles
+    template<typename V>
+    void permute(std::vector<V> &values, const std::vector<std::size_t> &order) const {
+        std::vector<V> result;
+        result.reserve(values.size());
+        for (const std::size_t node: order)
+            result.push_back(values[_slot[node]]);
+        values.swap(result);
+    }
+
+    // Indexed by handle
+    std::vector<std::size_t> _slot;
+
+    // Indexed by breadth-first slot
+    std::vector<Node> _node;
+    std::vector<std::size_t> _parent;
+    std::vector<std::size_t> _firstChild;
+    std::vector<std::size_t> _childCount;
+    std::vector<std::size_t> _depth;
+    std::vector<Vec> _translation;
+    std::vector<Quat> _rotation;
+    std::vector<Vec> _scale;
+    std::vector<Mat> _world;
+    std::vector<std::uint8_t> _dirtyFlag;
+
+    // Update state
+    std::vector<std::size_t> _dirty;
+    std::vector<std::size_t> _level;
+    std::vector<std::size_t> _children;
+    std::vector<Scratch> _scratch;
+    Sm::TransformHierarchyStats _stats;
+    bool _reorder = false;
+};
+
+// --Default types--
+
+using TransformHierarchyf = TransformHierarchy<float>;
+using TransformHierarchyd = TransformHierarchy<double>;
+
+#endif //SLIMEMATHS_TRANSFORMHIERARCHY_H
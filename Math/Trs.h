@@ -0,0 +1,222 @@
+#ifndef SLIMEMATHS_TRS_H
+#define SLIMEMATHS_TRS_H
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <ostream>
+#include "Vector3.h"
+#include "Matrix.h"
+#include "Quaternion.h"
+#include "VectorArray.h"
+#include "QuaternionConversion.h"
+#include "SimdPack.h"
+#include "Instrument.h"
+
+// Model matrices straight from translation, rotation and scale and back, without building and multiplying the
+// three 4x4 factors.
+//
+// Sm::compose_trs writes Translate(t) * Rotate(q) * Scale(s) element by element: the rotation's shared products are
+// computed once and each column is scaled as it is written, about 30 flops against the more than 200 of two
+// generic 4x4 products. q is expected to be unit length, like Sm::quaternion_to_matrix.
+// Sm::decompose_trs reads an affine matrix without shear: the translation is the last column, the scales are the
+// lengths of the first three columns and the rotation is taken from the normalized columns by Shepperd's method,
+// using whichever of w, x, y, z is largest with selects instead of branches. A matrix that reflects comes out with a
+// negative scale.x. Scales must not be zero.
+//
+// The batch overloads take and return structure of arrays, rotations as VectorArray<T, 4> of (x, y, z, w), and
+// run a simd pack of transforms per instruction.
+//
+//     Mat4 model = Sm::compose_trs(position, orientation, Vec3{2, 2, 2});
+//     Trsf parts = Sm::decompose_trs(model);
+
+template<typename T>
+struct Trs {
+    static_assert(std::is_floating_point<T>::value, "transforms need a floating point type");
+
+    using ScalarType = T;
+
+    // OStream Overrider
+    friend std::ostream &operator<<(std::ostream &os, const Trs<T> &trs) {
+        os << "translation: [" << trs.translation.x << ", " << trs.translation.y << ", " << trs.translation.z
+           << "] rotation: [" << trs.rotation.x << ", " << trs.rotation.y << ", " << trs.rotation.z << ", "
+           << trs.rotation.w << "] scale: [" << trs.scale.x << ", " << trs.scale.y << ", " << trs.scale.z << "]";
+        return os;
+    }
+
+    Vector<T, 3> translation;
+    Quaternion<T> rotation;
+    Vector<T, 3> scale{T(1), T(1), T(1)};
+};
+
+using Trsf = Trs<float>;
+using Trsd = Trs<double>;
+
+namespace Sm {
+    namespace detail {
+
+        // Row major elements of Translate(t) * Rotate(q) * Scale(s)
+        template<typename P>
+        void trs_elements(const P (&t)[3], const P (&q)[4], const P (&s)[3], P (&m)[16]) {
+            using T = typename P::ScalarType;
+            const P zero = P::broadcast(T(0));
+            const P one = P::broadcast(T(1));
+
+            const P x2 = q[0] + q[0], y2 = q[1] + q[1], z2 = q[2] + q[2];
+            const P xx = q[0] * x2, yy = q[1] * y2, zz = q[2] * z2;
+            const P xy = q[0] * y2, xz = q[0] * z2, yz = q[1] * z2;
+            const P wx = q[3] * x2, wy = q[3] * y2, wz = q[3] * z2;
+
+            m[0] = (one - (yy + zz)) * s[0];
+            m[1] = (xy - wz) * s[1];
+            m[2] = (xz + wy) * s[2];
+            m[3] = t[0];
+
+            m[4] = (xy + wz) * s[0];
+            m[5] = (one - (xx + zz)) * s[1];
+            m[6] = (yz - wx) * s[2];
+            m[7] = t[1];
+
+            m[8] = (xz - wy) * s[0];
+            m[9] = (yz + wx) * s[1];
+            m[10] = (one - (xx + yy)) * s[2];
+            m[11] = t[2];
+
+            m[12] = m[13] = m[14] = zero;
+            m[15] = one;
+        }
+
+        // Translation, unit rotation and scale of the top three rows of the row major m
+        template<typename P>
+        void trs_decompose(const P *m, P (&t)[3], P (&q)[4], P (&s)[3]) {
+            using T = typename P::ScalarType;
+            const P one = P::broadcast(T(1));
+
+            t[0] = m[3];
+            t[1] = m[7];
+            t[2] = m[11];
+
+            P inverse[3];
+            for (std::size_t c = 0; c < 3; ++c) {
+                const P lengthSq = m[c] * m[c] + m[4 + c] * m[4 + c] + m[8 + c] * m[8 + c];
+                inverse[c] = rsqrt(lengthSq);
+                s[c] = lengthSq * inverse[c];
+            }
+
+            /* A negative determinant is a reflection, it goes to the x axis */
+            const P det = m[0] * (m[5] * m[10] - m[9] * m[6]) - m[4] * (m[1] * m[10] - m[9] * m[2]) +
+                          m[8] * (m[1] * m[6] - m[5] * m[2]);
+            const auto reflect = det < P::broadcast(T(0));
+            s[0] = select(reflect, -s[0], s[0]);
+            inverse[0] = select(reflect, -inverse[0], inverse[0]);
+
+            P r[9];
+            for (std::size_t row = 0; row < 3; ++row)
+                for (std::size_t c = 0; c < 3; ++c)
+                    r[row * 3 + c] = m[row * 4 + c] * inverse[c];
+
+            /* 4 w^2, 4 x^2, 4 y^2 and 4 z^2, the largest gives the best conditioned expressions */
+            const P tw = one + r[0] + r[4] + r[8];
+            const P tx = one + r[0] - r[4] - r[8];
+            const P ty = one - r[0] + r[4] - r[8];
+            const P tz = one - r[0] - r[4] + r[8];
+            const auto useW = (tw >= tx) & (tw >= ty) & (tw >= tz);
+            const auto useX = (tx >= ty) & (tx >= tz);
+            const auto useY = ty >= tz;
+
+            const P wx = r[7] - r[5], wy = r[2] - r[6], wz = r[3] - r[1];
+            const P xy = r[1] + r[3], xz = r[2] + r[6], yz = r[5] + r[7];
+
+            const P largest = select(useW, tw, select(useX, tx, select(useY, ty, tz)));
+            const P scale = P::broadcast(T(0.5)) * rsqrt(largest);
+            q[0] = select(useW, wx, select(useX, tx, select(useY, xy, xz))) * scale;
+            q[1] = select(useW, wy, select(useX, xy, select(useY, ty, yz))) * scale;
+            q[2] = select(useW, wz, select(useX, xz, select(useY, yz, tz))) * scale;
+            q[3] = select(useW, tw, select(useX, wx, select(useY, wy, wz))) * scale;
+        }
+    }
+
+    // Translate(translation) * Rotate(rotation) * Scale(scale)
+    template<typename T>
+    Matrix<T, 4, 4> compose_trs(const Vector<T, 3> &translation, const Quaternion<T> &rotation,
+                                const Vector<T, 3> &scale) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::compose_trs");
+        using P = simd::ScalarPack<T>;
+        const P t[3] = {P::broadcast(translation.x), P::broadcast(translation.y), P::broadcast(translation.z)};
+        const P q[4] = {P::broadcast(rotation.x), P::broadcast(rotation.y), P::broadcast(rotation.z),
+                        P::broadcast(rotation.w)};
+        const P s[3] = {P::broadcast(scale.x), P::broadcast(scale.y), P::broadcast(scale.z)};
+        P m[16];
+        detail::trs_elements(t, q, s, m);
+
+        Matrix<T, 4, 4> result;
+        for (std::size_t k = 0; k < 16; ++k)
+            result[k] = m[k].v;
+        return result;
+    }
+
+    template<typename T>
+    Matrix<T, 4, 4> compose_trs(const Trs<T> &trs) {
+        return compose_trs(trs.translation, trs.rotation, trs.scale);
+    }
+
+    // Translation, rotation and scale of an affine matrix without shear, compose_trs(decompose_trs(m)) gives m back
+    template<typename T>
+    Trs<T> decompose_trs(const Matrix<T, 4, 4> &m) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::decompose_trs");
+        using P = simd::ScalarPack<T>;
+        P elements[12], t[3], q[4], s[3];
+        for (std::size_t k = 0; k < 12; ++k)
+            elements[k] = P::broadcast(m[k]);
+        detail::trs_decompose(elements, t, q, s);
+
+        return Trs<T>{Vector<T, 3>{t[0].v, t[1].v, t[2].v}, Quaternion<T>{q[0].v, q[1].v, q[2].v, q[3].v},
+                      Vector<T, 3>{s[0].v, s[1].v, s[2].v}};
+    }
+
+    // out[i] = Sm::compose_trs(translations.get(i), rotation i, scales.get(i)), rotations holds (x, y, z, w)
+    template<typename T>
+    void compose_trs(const VectorArray<T, 3> &translations, const VectorArray<T, 4> &rotations,
+                     const VectorArray<T, 3> &scales, Matrix<T, 4, 4> *out) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::compose_trs(VectorArray)");
+        assert(translations.size() == rotations.size() && translations.size() == scales.size());
+        simd::for_each_pack<T>(translations.size(), [&](auto pack, std::size_t i) {
+            using P = decltype(pack);
+            P t[3], q[4], s[3], m[16];
+            for (std::size_t k = 0; k < 3; ++k) {
+                t[k] = P::load(translations.component(k) + i);
+                s[k] = P::load(scales.component(k) + i);
+            }
+            for (std::size_t k = 0; k < 4; ++k)
+                q[k] = P::load(rotations.component(k) + i);
+            detail::trs_elements(t, q, s, m);
+            detail::store_matrices(out + i, m);
+        });
+    }
+
+    // Sm::decompose_trs of in[0, count) into structure of arrays, the outputs are resized to fit
+    template<typename T>
+    void decompose_trs(const Matrix<T, 4, 4> *in, std::size_t count, VectorArray<T, 3> &translations,
+                       VectorArray<T, 4> &rotations, VectorArray<T, 3> &scales) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::decompose_trs(VectorArray)");
+        translations.resize(count);
+        rotations.resize(count);
+        scales.resize(count);
+
+        simd::for_each_pack<T>(count, [&](auto pack, std::size_t i) {
+            using P = decltype(pack);
+            P m[16], t[3], q[4], s[3];
+            detail::load_matrices(in + i, m);
+            detail::trs_decompose(m, t, q, s);
+
+            for (std::size_t k = 0; k < 3; ++k) {
+                t[k].store(translations.component(k) + i);
+                s[k].store(scales.component(k) + i);
+            }
+            for (std::size_t k = 0; k < 4; ++k)
+                q[k].store(rotations.component(k) + i);
+        });
+    }
+}
+
+#endif //SLIMEMATHS_TRS_H
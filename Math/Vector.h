@@ -6,7 +6,9 @@
 #define SLIMEMATHS_VECTOR_H
 
 #include <cstdlib>
-#include <algorithm>
+#include <cassert>
+#include <ostream>
+#include <sstream>
 
 template<typename T, std::size_t N>
 struct Vector {
@@ -15,69 +17,68 @@ struct Vector {
     static const std::size_t components = N;
 
     // Constructors
-    Vector() {
-        std::fill(std::begin(_element), std::end(_element), T(0));
-    }
+    constexpr Vector() : _element{} {}
 
-    Vector(const Vector<T, N> &rhs) {
-        std::copy(std::begin(rhs._element), std::end(rhs._element), _element);
-    }
+    constexpr Vector(const Vector<T, N> &rhs) = default;
 
-    explicit Vector(const T &scalar) {
-        std::fill(std::begin(_element), std::end(_element), scalar);
+    constexpr Vector<T, N> &operator=(const Vector<T, N> &rhs) = default;
+
+    explicit constexpr Vector(const T &scalar) : _element{} {
+        for (std::size_t i = 0; i < N; ++i)
+            _element[i] = scalar;
     }
 
     //Overriders
 
     // Math operators
-    Vector<T, N> &operator+=(const Vector<T, N> &rhs) {
+    constexpr Vector<T, N> &operator+=(const Vector<T, N> &rhs) {
         for (std::size_t i = 0; i < N; ++i)
             _element[i] += rhs[i];
         return *this;
     }
 
-    Vector<T, N> &operator-=(const Vector<T, N> &rhs) {
+    constexpr Vector<T, N> &operator-=(const Vector<T, N> &rhs) {
         for (std::size_t i = 0; i < N; ++i)
             _element[i] -= rhs[i];
         return *this;
     }
 
-    Vector<T, N> &operator*=(const Vector<T, N> &rhs) {
+    constexpr Vector<T, N> &operator*=(const Vector<T, N> &rhs) {
         for (std::size_t i = 0; i < N; ++i)
             _element[i] *= rhs[i];
         return *this;
     }
 
-    Vector<T, N> &operator/=(const Vector<T, N> &rhs) {
+    constexpr Vector<T, N> &operator/=(const Vector<T, N> &rhs) {
         for (std::size_t i = 0; i < N; ++i)
             _element[i] /= rhs[i];
         return *this;
     }
 
-    Vector<T, N> &operator*=(const T rhs) {
+    constexpr Vector<T, N> &operator*=(const T rhs) {
         for (std::size_t i = 0; i < N; ++i)
             _element[i] *= rhs;
         return *this;
     }
 
-    Vector<T, N> &operator/=(const T rhs) {
+    constexpr Vector<T, N> &operator/=(const T rhs) {
         for (std::size_t i = 0; i < N; ++i)
             _element[i] /= rhs;
         return *this;
     }
 
     // Getter/Setter operators
-    T &operator[](std::size_t component) {
-        static_assert(component < N);
+    constexpr T &operator[](std::size_t component) {
+        assert(component < N);
         return _element[component];
     }
 
-    const T &operator[](std::size_t component) const {
-        static_assert(component < N);
+    constexpr const T &operator[](std::size_t component) const {
+        assert(component < N);
         return _element[component];
     }
 
-    Vector<T, N> operator-() const {
+    constexpr Vector<T, N> operator-() const {
         auto result = *this;
         for (std::size_t i = 0; i < N; ++i)
             result[i] = -result[i];
@@ -85,7 +86,7 @@ struct Vector {
     }
 
     template<typename C>
-    Vector<C, N> Cast() const {
+    constexpr Vector<C, N> Cast() const {
         Vector<C, N> result{};
 
         for (std::size_t i = 0; i < N; ++i)
@@ -94,11 +95,11 @@ struct Vector {
         return result;
     }
 
-    T *ptr() {
+    constexpr T *ptr() {
         return _element;
     }
 
-    const T *ptr() const {
+    constexpr const T *ptr() const {
         return _element;
     }
 
@@ -122,35 +123,35 @@ private:
 // Global Operators
 
 template<typename T, std::size_t N>
-Vector<T, N> operator+(const Vector<T, N> &lhs, const Vector<T, N> &rhs) {
+constexpr Vector<T, N> operator+(const Vector<T, N> &lhs, const Vector<T, N> &rhs) {
     auto result = lhs;
     result += rhs;
     return result;
 }
 
 template<typename T, std::size_t N>
-Vector<T, N> operator-(const Vector<T, N> &lhs, const Vector<T, N> &rhs) {
+constexpr Vector<T, N> operator-(const Vector<T, N> &lhs, const Vector<T, N> &rhs) {
     auto result = lhs;
     result -= rhs;
     return result;
 }
 
 template<typename T, std::size_t N>
-Vector<T, N> operator*(const Vector<T, N> &lhs, const Vector<T, N> &rhs) {
+constexpr Vector<T, N> operator*(const Vector<T, N> &lhs, const Vector<T, N> &rhs) {
     auto result = lhs;
     result *= rhs;
     return result;
 }
 
 template<typename T, std::size_t N>
-Vector<T, N> operator/(const Vector<T, N> &lhs, const Vector<T, N> &rhs) {
+constexpr Vector<T, N> operator/(const Vector<T, N> &lhs, const Vector<T, N> &rhs) {
     auto result = lhs;
     result /= rhs;
     return result;
 }
 
 template<typename T, std::size_t N>
-Vector<T, N> operator*(const Vector<T, N> &lhs, const T &rhs) {
+constexpr Vector<T, N> operator*(const Vector<T, N> &lhs, const T &rhs) {
     auto result = lhs;
     result *= rhs;
     return result;
@@ -158,21 +159,21 @@ Vector<T, N> operator*(const Vector<T, N> &lhs, const T &rhs) {
 
 //! \note This implementation is equivavlent to (rhs * lhs) for optimization purposes.
 template<typename T, std::size_t N>
-Vector<T, N> operator*(const T &lhs, const Vector<T, N> &rhs) {
+constexpr Vector<T, N> operator*(const T &lhs, const Vector<T, N> &rhs) {
     auto result = rhs;
     result *= lhs;
     return result;
 }
 
 template<typename T, std::size_t N>
-Vector<T, N> operator/(const Vector<T, N> &lhs, const T &rhs) {
+constexpr Vector<T, N> operator/(const Vector<T, N> &lhs, const T &rhs) {
     auto result = lhs;
     result /= rhs;
     return result;
 }
 
 template<typename T, std::size_t N>
-Vector<T, N> operator/(const T &lhs, const Vector<T, N> &rhs) {
+constexpr Vector<T, N> operator/(const T &lhs, const Vector<T, N> &rhs) {
     auto result = Vector<T, N>{lhs};
     result /= rhs;
     return result;
@@ -9,6 +9,7 @@
 #include <ostream>
 #include <sstream>
 #include "Vector.h"
+#include "Simd.h"
 #include "SlimeAlgebra.h"
 
 template<typename T>
@@ -18,100 +19,102 @@ struct Vector<T, 2> {
     static const std::size_t components = 2;
 
     // -- Constructors --
-    Vector() :
+    constexpr Vector() :
             x{T(0)},
             y{T(0)} {}
 
-    Vector(const Vector<T, 2> &rhs) :
-            x{rhs.x},
-            y{rhs.y} {}
+    constexpr Vector(const Vector<T, 2> &rhs) = default;
 
-    explicit Vector(const Vector<T, 3> &rhs) :
+    explicit constexpr Vector(const Vector<T, 3> &rhs) :
             x{rhs.x},
             y{rhs.y} {}
 
-    explicit Vector(const Vector<T, 4> &rhs) :
+    explicit constexpr Vector(const Vector<T, 4> &rhs) :
             x{rhs.x},
             y{rhs.y} {}
 
 
-    explicit Vector(const T &scalar) :
+    explicit constexpr Vector(const T &scalar) :
             x{scalar},
             y{scalar} {}
 
-    Vector(const T &x, const T &y) :
+    constexpr Vector(const T &x, const T &y) :
             x{x},
             y{y} {}
 
     // -- Math Operators --
-    Vector<T, 2> &operator+=(const Vector<T, 2> &rhs) {
+    constexpr Vector<T, 2> &operator+=(const Vector<T, 2> &rhs) {
         x += rhs.x;
         y += rhs.y;
         return *this;
     }
 
-    Vector<T, 2> &operator-=(const Vector<T, 2> &rhs) {
+    constexpr Vector<T, 2> &operator-=(const Vector<T, 2> &rhs) {
         x -= rhs.x;
         y -= rhs.y;
         return *this;
     }
 
-    Vector<T, 2> &operator*=(const Vector<T, 2> &rhs) {
+    constexpr Vector<T, 2> &operator*=(const Vector<T, 2> &rhs) {
         x *= rhs.x;
         y *= rhs.y;
         return *this;
     }
 
-    Vector<T, 2> &operator/=(const Vector<T, 2> &rhs) {
+    constexpr Vector<T, 2> &operator/=(const Vector<T, 2> &rhs) {
         x /= rhs.x;
         y /= rhs.y;
         return *this;
     }
 
-    Vector<T, 2> &operator*=(const T rhs) {
+    constexpr Vector<T, 2> &operator*=(const T rhs) {
         x *= rhs;
         y *= rhs;
         return *this;
     }
 
-    Vector<T, 2> &operator/=(const T rhs) {
+    constexpr Vector<T, 2> &operator/=(const T rhs) {
         x /= rhs;
         y /= rhs;
         return *this;
     }
 
-    Vector<T, 2> operator-() const {
+    constexpr Vector<T, 2> operator-() const {
         return Vector<T, 2>{-x, -y};
     }
 
 
     // -- Getter/Setter Operators --
-    T &operator[](std::size_t component) {
+    constexpr T &operator[](std::size_t component) {
+        if (SLIMEMATHS_IS_CONSTANT_EVALUATED())
+            return component == 0 ? x : y;
         return *((&x) + component);
     }
 
-    const T &operator[](std::size_t component) const {
+    constexpr const T &operator[](std::size_t component) const {
+        if (SLIMEMATHS_IS_CONSTANT_EVALUATED())
+            return component == 0 ? x : y;
         return *((&x) + component);
     }
 
     template<typename C>
-    Vector<C, 2> cast() const {
+    constexpr Vector<C, 2> cast() const {
         return Vector<C, 2>(
                 static_cast<C>(x),
                 static_cast<C>(y)
         );
     }
 
-    T *ptr() {
+    constexpr T *ptr() {
         return &x;
     }
 
-    const T *ptr() const {
+    constexpr const T *ptr() const {
         return &x;
     }
 
     // -- Math Functions --
-    T length_sq() const {
+    constexpr T length_sq() const {
         return Sm::length_sq(*this);
     }
 
@@ -160,6 +163,8 @@ using Vector2i = Vector2T<std::int32_t>;
 using Vector2ui = Vector2T<std::uint32_t>;
 using Vector2b = Vector2T<std::int8_t>;
 using Vector2ub = Vector2T<std::uint8_t>;
+using Vector2s = Vector2T<std::int16_t>;
+using Vector2us = Vector2T<std::uint16_t>;
 using Vec2 = Vector2f;
 
 
@@ -9,6 +9,7 @@
 #include <ostream>
 #include <sstream>
 #include "Vector.h"
+#include "Simd.h"
 #include "SlimeAlgebra.h"
 
 template<typename T>
@@ -18,99 +19,100 @@ struct Vector<T, 3> {
     static const std::size_t components = 3;
 
     // -- Constructors --
-    Vector() :
+    constexpr Vector() :
             x{T(0)},
             y{T(0)},
             z{T(0)} {}
 
-    Vector(const Vector<T, 3> &rhs) :
-            x{rhs.x},
-            y{rhs.y},
-            z{rhs.z} {}
+    constexpr Vector(const Vector<T, 3> &rhs) = default;
 
-    explicit Vector(const Vector<T, 4> &rhs) :
+    explicit constexpr Vector(const Vector<T, 4> &rhs) :
             x{rhs.x},
             y{rhs.y},
             z{rhs.z} {
     }
 
-    explicit Vector(const Vector<T, 2> &xy, const T &z) :
+    explicit constexpr Vector(const Vector<T, 2> &xy, const T &z) :
             x{xy.x},
             y{xy.y},
             z{z} {
     }
 
-    explicit Vector(const T &scalar) :
+    explicit constexpr Vector(const T &scalar) :
             x{scalar},
             y{scalar},
             z{scalar} {
     }
 
-    Vector(const T &x, const T &y, const T &z) :
+    constexpr Vector(const T &x, const T &y, const T &z) :
             x{x},
             y{y},
             z{z} {
     }
 
     // -- Math Operators --
-    Vector<T, 3> &operator+=(const Vector<T, 3> &rhs) {
+    constexpr Vector<T, 3> &operator+=(const Vector<T, 3> &rhs) {
         x += rhs.x;
         y += rhs.y;
         z += rhs.z;
         return *this;
     }
 
-    Vector<T, 3> &operator-=(const Vector<T, 3> &rhs) {
+    constexpr Vector<T, 3> &operator-=(const Vector<T, 3> &rhs) {
         x -= rhs.x;
         y -= rhs.y;
         z -= rhs.z;
         return *this;
     }
 
-    Vector<T, 3> &operator*=(const Vector<T, 3> &rhs) {
+    constexpr Vector<T, 3> &operator*=(const Vector<T, 3> &rhs) {
         x *= rhs.x;
         y *= rhs.y;
         z *= rhs.z;
         return *this;
     }
 
-    Vector<T, 3> &operator/=(const Vector<T, 3> &rhs) {
+    constexpr Vector<T, 3> &operator/=(const Vector<T, 3> &rhs) {
         x /= rhs.x;
         y /= rhs.y;
         z /= rhs.z;
         return *this;
     }
 
-    Vector<T, 3> &operator*=(const T rhs) {
+    constexpr Vector<T, 3> &operator*=(const T rhs) {
         x *= rhs;
         y *= rhs;
         z *= rhs;
         return *this;
     }
 
-    Vector<T, 3> &operator/=(const T rhs) {
+    constexpr Vector<T, 3> &operator/=(const T rhs) {
         x /= rhs;
         y /= rhs;
         z /= rhs;
         return *this;
     }
 
-    Vector<T, 3> operator-() const {
+    constexpr Vector<T, 3> operator-() const {
         return Vector<T, 3>{-x, -y, -z};
     }
 
 
     // -- Getter/Setter Operators --
-    T &operator[](std::size_t component) {
+    constexpr T &operator[](std::size_t component) {
+        if (SLIMEMATHS_IS_CONSTANT_EVALUATED())
+            return component == 0 ? x : component == 1 ? y : z;
         return *((&x) + component);
     }
 
-    const T &operator[](std::size_t component) const {
+    constexpr const T &operator[](std::size_t component) const {
+        if (SLIMEMATHS_IS_CONSTANT_EVALUATED())
+            return component == 0 ? x : component == 1 ? y : z;
         return *((&x) + component);
     }
 
     template<typename C>
-    Vector<C, 3> cast() const {
+    constexpr Vector<C, 3> cast() const {
         return Vector<C, 3>(
                 static_cast<C>(x),
                 static_cast<C>(y),
@@ -118,16 +120,16 @@ struct Vector<T, 3> {
         );
     }
 
-    T *ptr() {
+    constexpr T *ptr() {
         return &x;
     }
 
-    const T *ptr() const {
+    constexpr const T *ptr() const {
         return &x;
     }
 
     // -- Math Functions --
-    T length_sq() const {
+    constexpr T length_sq() const {
         return Sm::length_sq(*this);
     }
 
@@ -177,6 +179,8 @@ using Vector3i = Vector3T<std::int32_t>;
 using Vector3ui = Vector3T<std::uint32_t>;
 using Vector3b = Vector3T<std::int8_t>;
 using Vector3ub = Vector3T<std::uint8_t>;
+using Vector3s = Vector3T<std::int16_t>;
+using Vector3us = Vector3T<std::uint16_t>;
 using Vec3 = Vector3f;
 
 #endif //SLIMEMATHS_VECTOR3_H
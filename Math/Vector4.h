@@ -10,6 +10,7 @@
 #include <ostream>
 #include <sstream>
 #include "Vector.h"
+#include "Simd.h"
 #include "SlimeAlgebra.h"
 
 template<typename T>
@@ -19,50 +20,46 @@ struct Vector<T, 4> {
     static const std::size_t components = 4;
 
     // -- Constructors --
-    Vector() :
+    constexpr Vector() :
             x{T(0)},
             y{T(0)},
             z{T(0)},
             w{T(1)} {}
 
-    Vector(const Vector<T, 4> &rhs) :
-            x{rhs.x},
-            y{rhs.y},
-            z{rhs.y},
-            w{rhs.z} {}
+    constexpr Vector(const Vector<T, 4> &rhs) = default;
 
-    explicit Vector(const Vector<T, 2> &xy, const Vector<T, 2> &zw) :
+    explicit constexpr Vector(const Vector<T, 2> &xy, const Vector<T, 2> &zw) :
             x{xy.x},
             y{xy.y},
             z{zw.x},
             w{zw.y} {}
 
-    explicit Vector(const Vector<T, 2> &xy, const T &z, const T &w) :
+    explicit constexpr Vector(const Vector<T, 2> &xy, const T &z, const T &w) :
             x{xy.x},
             y{xy.y},
             z{z},
             w{w} {}
 
-    explicit Vector(const Vector<T, 3> &xyz, const T &w) :
+    explicit constexpr Vector(const Vector<T, 3> &xyz, const T &w) :
             x{xyz.x},
             y{xyz.y},
             z{xyz.z},
             w{w} {}
 
-    explicit Vector(const T &scalar) :
+    explicit constexpr Vector(const T &scalar) :
             x{scalar},
             y{scalar},
             z{scalar},
             w{scalar} {}
 
-    Vector(const T &x, const T &y, const T &z, const T &w) :
+    constexpr Vector(const T &x, const T &y, const T &z, const T &w) :
             x{x},
             y{y},
             z{z},
             w{w} {}
 
     // -- Math Operators --
-    Vector<T, 4> &operator+=(const Vector<T, 4> &rhs) {
+    constexpr Vector<T, 4> &operator+=(const Vector<T, 4> &rhs) {
         x += rhs.x;
         y += rhs.y;
         z += rhs.z;
@@ -70,7 +67,7 @@ struct Vector<T, 4> {
         return *this;
     }
 
-    Vector<T, 4> &operator-=(const Vector<T, 4> &rhs) {
+    constexpr Vector<T, 4> &operator-=(const Vector<T, 4> &rhs) {
         x -= rhs.x;
         y -= rhs.y;
         z -= rhs.z;
@@ -78,7 +75,7 @@ struct Vector<T, 4> {
         return *this;
     }
 
-    Vector<T, 4> &operator*=(const Vector<T, 4> &rhs) {
+    constexpr Vector<T, 4> &operator*=(const Vector<T, 4> &rhs) {
         x *= rhs.x;
         y *= rhs.y;
         z *= rhs.z;
@@ -86,7 +83,7 @@ struct Vector<T, 4> {
         return *this;
     }
 
-    Vector<T, 4> &operator/=(const Vector<T, 4> &rhs) {
+    constexpr Vector<T, 4> &operator/=(const Vector<T, 4> &rhs) {
         x /= rhs.x;
         y /= rhs.y;
         z /= rhs.z;
@@ -94,7 +91,7 @@ struct Vector<T, 4> {
         return *this;
     }
 
-    Vector<T, 4> &operator*=(const T rhs) {
+    constexpr Vector<T, 4> &operator*=(const T rhs) {
         x *= rhs;
         y *= rhs;
         z *= rhs;
@@ -102,7 +99,7 @@ struct Vector<T, 4> {
         return *this;
     }
 
-    Vector<T, 4> &operator/=(const T rhs) {
+    constexpr Vector<T, 4> &operator/=(const T rhs) {
         x /= rhs;
         y /= rhs;
         z /= rhs;
@@ -110,21 +107,25 @@ struct Vector<T, 4> {
         return *this;
     }
 
-    Vector<T, 4> operator-() const {
+    constexpr Vector<T, 4> operator-() const {
         return Vector<T, 4>{-x, -y, -z, -w};
     }
 
     // -- Getter/Setter Operators --
-    T &operator[](std::size_t component) {
+    constexpr T &operator[](std::size_t component) {
+        if (SLIMEMATHS_IS_CONSTANT_EVALUATED())
+            return component == 0 ? x : component == 1 ? y : component == 2 ? z : w;
         return *((&x) + component);
     }
 
-    const T &operator[](std::size_t component) const {
+    constexpr const T &operator[](std::size_t component) const {
+        if (SLIMEMATHS_IS_CONSTANT_EVALUATED())
+            return component == 0 ? x : component == 1 ? y : component == 2 ? z : w;
         return *((&x) + component);
     }
 
     template<typename C>
-    Vector<C, 4> cast() const {
+    constexpr Vector<C, 4> cast() const {
         return Vector<C, 4>(
                 static_cast<C>(x),
                 static_cast<C>(y),
@@ -133,16 +134,16 @@ struct Vector<T, 4> {
         );
     }
 
-    T *ptr() {
+    constexpr T *ptr() {
         return &x;
     }
 
-    const T *ptr() const {
+    constexpr const T *ptr() const {
         return &x;
     }
 
     // -- Math Functions --
-    T length_sq() const {
+    constexpr T length_sq() const {
         return Sm::length_sq(*this);
     }
 
@@ -192,6 +193,8 @@ using Vector4i = Vector4T<std::int32_t>;
 using Vector4ui = Vector4T<std::uint32_t>;
 using Vector4b = Vector4T<std::int8_t>;
 using Vector4ub = Vector4T<std::uint8_t>;
+using Vector4s = Vector4T<std::int16_t>;
+using Vector4us = Vector4T<std::uint16_t>;
 using Vec4 = Vector4f;
 
 
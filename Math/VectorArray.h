@@ -0,0 +1,277 @@
+#ifndef SLIMEMATHS_VECTORARRAY_H
+#define SLIMEMATHS_VECTORARRAY_H
+
+#include <cstddef>
+#include <cassert>
+#include <new>
+#include <algorithm>
+#include "Vector.h"
+#include "SlimeAlgebra.h"
+#include "SimdPack.h"
+#include "Executor.h"
+#include "Instrument.h"
+
+// Structure of arrays storage for Vector<T, N>.
+// Each component lives in its own stream, every stream starts on a 64 byte boundary,
+// so the Sm:: overloads below can run whole packs of vectors per instruction.
+template<typename T, std::size_t N>
+struct VectorArray {
+    static_assert(N > 0, "VectorArray needs at least one component");
+
+    using ScalarType = T;
+    using VectorType = Vector<T, N>;
+    using ThisType = VectorArray<T, N>;
+
+    static const std::size_t components = N;
+    static const std::size_t alignment = 64;
+
+    // Constructors
+    VectorArray() = default;
+
+    explicit VectorArray(std::size_t size) {
+        resize(size);
+    }
+
+    VectorArray(const VectorType *data, std::size_t count) {
+        assign(data, count);
+    }
+
+    VectorArray(const ThisType &rhs) {
+        *this = rhs;
+    }
+
+    VectorArray(ThisType &&rhs) noexcept {
+        swap(rhs);
+    }
+
+    ~VectorArray() {
+        deallocate(_data);
+    }
+
+    ThisType &operator=(const ThisType &rhs) {
+        if (this == &rhs)
+            return *this;
+
+        clear();
+        reserve(rhs._size);
+        for (std::size_t c = 0; c < N; ++c)
+            std::copy(rhs.component(c), rhs.component(c) + rhs._size, component(c));
+        _size = rhs._size;
+        return *this;
+    }
+
+    ThisType &operator=(ThisType &&rhs) noexcept {
+        if (this != &rhs) {
+            ThisType moved{static_cast<ThisType &&>(rhs)};
+            swap(moved);
+        }
+        return *this;
+    }
+
+    void swap(ThisType &rhs) noexcept {
+        std::swap(_data, rhs._data);
+        std::swap(_size, rhs._size);
+        std::swap(_capacity, rhs._capacity);
+    }
+
+    // Size
+    std::size_t size() const {
+        return _size;
+    }
+
+    std::size_t capacity() const {
+        return _capacity;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    void reserve(std::size_t capacity) {
+        if (capacity <= _capacity)
+            return;
+
+        /* Round up so every stream keeps the array alignment */
+        const std::size_t lanes = (std::max)(alignment / sizeof(T), std::size_t(1));
+        capacity = (capacity + lanes - 1) / lanes * lanes;
+
+        T *data = allocate(capacity * N);
+        for (std::size_t c = 0; c < N; ++c)
+            std::copy(component(c), component(c) + _size, data + c * capacity);
+
+        deallocate(_data);
+        _data = data;
+        _capacity = capacity;
+    }
+
+    void resize(std::size_t size) {
+        reserve(size);
+        for (std::size_t c = 0; c < N; ++c)
+            for (std::size_t i = _size; i < size; ++i)
+                component(c)[i] = VectorType{}[c];
+        _size = size;
+    }
+
+    void clear() {
+        _size = 0;
+    }
+
+    // Element access
+    void push_back(const VectorType &vec) {
+        if (_size == _capacity)
+            reserve(_capacity == 0 ? alignment / sizeof(T) : _capacity * 2);
+
+        set(_size++, vec);
+    }
+
+    VectorType get(std::size_t index) const {
+        assert(index < _size);
+        VectorType result;
+        for (std::size_t c = 0; c < N; ++c)
+            result[c] = component(c)[index];
+        return result;
+    }
+
+    void set(std::size_t index, const VectorType &vec) {
+        assert(index < _capacity);
+        for (std::size_t c = 0; c < N; ++c)
+            component(c)[index] = vec[c];
+    }
+
+    // Returns the stream holding every value of one component
+    T *component(std::size_t c) {
+        assert(c < N);
+        return _data + c * _capacity;
+    }
+
+    const T *component(std::size_t c) const {
+        assert(c < N);
+        return _data + c * _capacity;
+    }
+
+    // Converts from/to array of structures
+    void assign(const VectorType *data, std::size_t count) {
+        clear();
+        reserve(count);
+        _size = count;
+        for (std::size_t i = 0; i < count; ++i)
+            set(i, data[i]);
+    }
+
+    void store(VectorType *out) const {
+        for (std::size_t i = 0; i < _size; ++i)
+            for (std::size_t c = 0; c < N; ++c)
+                out[i][c] = component(c)[i];
+    }
+
+private:
+    static T *allocate(std::size_t count) {
+        return static_cast<T *>(::operator new(count * sizeof(T), std::align_val_t(alignment)));
+    }
+
+    static void deallocate(T *data) {
+        if (data)
+            ::operator delete(data, std::align_val_t(alignment));
+    }
+
+    T *_data = nullptr;
+    std::size_t _size = 0;
+    std::size_t _capacity = 0;
+};
+
+// --Default types--
+using Vec2Array = VectorArray<float, 2>;
+using Vec3Array = VectorArray<float, 3>;
+using Vec4Array = VectorArray<float, 4>;
+using Vec3dArray = VectorArray<double, 3>;
+
+// Batch overloads of the SlimeAlgebra functions.
+// Every output pointer needs room for lhs.size() values.
+namespace Sm {
+
+    template<typename T, std::size_t N>
+    void dot(const VectorArray<T, N> &lhs, const VectorArray<T, N> &rhs, T *out) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::dot(VectorArray)");
+        assert(lhs.size() == rhs.size());
+
+        simd::for_each_pack<T>(lhs.size(), [&](auto pack, std::size_t i) {
+            using P = decltype(pack);
+            P sum = P::load(lhs.component(0) + i) * P::load(rhs.component(0) + i);
+            for (std::size_t c = 1; c < N; ++c)
+                sum = sum + P::load(lhs.component(c) + i) * P::load(rhs.component(c) + i);
+            sum.store(out + i);
+        });
+    }
+
+    template<typename T, std::size_t N>
+    void length_sq(const VectorArray<T, N> &vec, T *out) {
+        dot(vec, vec, out);
+    }
+
+    template<typename T, std::size_t N>
+    void length(const VectorArray<T, N> &vec, T *out) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::length(VectorArray)");
+        simd::for_each_pack<T>(vec.size(), [&](auto pack, std::size_t i) {
+            using P = decltype(pack);
+            P sum = P::load(vec.component(0) + i) * P::load(vec.component(0) + i);
+            for (std::size_t c = 1; c < N; ++c)
+                sum = sum + P::load(vec.component(c) + i) * P::load(vec.component(c) + i);
+            sqrt(sum).store(out + i);
+        });
+    }
+
+    namespace detail {
+
+        template<typename T, std::size_t N>
+        void normalize_range(VectorArray<T, N> &vec, std::size_t begin, std::size_t end) {
+            simd::for_each_pack<T>(begin, end, [&](auto pack, std::size_t i) {
+                using P = decltype(pack);
+                P len = P::load(vec.component(0) + i) * P::load(vec.component(0) + i);
+                for (std::size_t c = 1; c < N; ++c)
+                    len = len + P::load(vec.component(c) + i) * P::load(vec.component(c) + i);
+
+                /* Same rules as the single vector version, zero and unit vectors are left untouched */
+                const P one = P::broadcast(T(1));
+                const auto mask = (len != P::broadcast(T(0))) & (len != one);
+                const P scale = select(mask, one / sqrt(len), one);
+
+                for (std::size_t c = 0; c < N; ++c)
+                    (P::load(vec.component(c) + i) * scale).store(vec.component(c) + i);
+            });
+        }
+    }
+
+    template<typename T, std::size_t N>
+    void normalize(VectorArray<T, N> &vec) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::normalize(VectorArray)");
+        detail::normalize_range(vec, 0, vec.size());
+    }
+
+    // Sm::normalize spread over executor, every component stream splits on the same cache line boundaries
+    template<typename T, std::size_t N>
+    void normalize(Executor &executor, VectorArray<T, N> &vec) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::normalize(Executor,VectorArray)");
+        parallel_for(executor, vec.size(), [&](std::size_t begin, std::size_t end) {
+            detail::normalize_range(vec, begin, end);
+        }, cache_partition(vec.component(0), 16 * 1024 / N));
+    }
+
+    template<typename T, std::size_t N>
+    void resize(VectorArray<T, N> &vec, const T &length) {
+        SLIMEMATHS_INSTRUMENT_SCOPE("Sm::resize(VectorArray)");
+        simd::for_each_pack<T>(vec.size(), [&](auto pack, std::size_t i) {
+            using P = decltype(pack);
+            P len = P::load(vec.component(0) + i) * P::load(vec.component(0) + i);
+            for (std::size_t c = 1; c < N; ++c)
+                len = len + P::load(vec.component(c) + i) * P::load(vec.component(c) + i);
+
+            const auto mask = len != P::broadcast(T(0));
+            const P scale = select(mask, P::broadcast(length) / sqrt(len), P::broadcast(T(1)));
+
+            for (std::size_t c = 0; c < N; ++c)
+                (P::load(vec.component(c) + i) * scale).store(vec.component(c) + i);
+        });
+    }
+}
+
+#endif //SLIMEMATHS_VECTORARRAY_H
@@ -0,0 +1,231 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Test.h"
+#include "ArrayFile.h"
+
+// ArrayFileWriter and ArrayFileReader: every layout round-trips bitwise, spans start on 64 byte boundaries, and files
+// that are unfinished, truncated or read with the wrong element type are rejected instead of read half way.
+namespace Test {
+    namespace {
+        std::string temp_path(const std::string &name) {
+            return (std::filesystem::temp_directory_path() / ("slimemaths_test_" + name + ".smaf")).string();
+        }
+
+        bool aligned(const void *pointer) {
+            return reinterpret_cast<std::uintptr_t>(pointer) % 64 == 0;
+        }
+
+        template<typename T, std::size_t N>
+        bool equal(const Vector<T, N> &lhs, const Vector<T, N> &rhs) {
+            return std::memcmp(&lhs, &rhs, sizeof(lhs)) == 0;
+        }
+
+        template<typename T, std::size_t N>
+        std::vector<Vector<T, N>> random_vectors(std::size_t count) {
+            std::vector<Vector<T, N>> result(count);
+            for (auto &vec: result)
+                vec = random_vector<T, N>();
+            return result;
+        }
+
+        // Expects opening path to throw Error
+        template<typename Error>
+        void check_rejected(Context &context, const std::string &path, const std::string &what) {
+            try {
+                ArrayFileReader reader{path};
+                context.check(false, what + ": read without an error");
+            } catch (const Error &) {
+                context.check(true, what);
+            } catch (...) {
+                context.check(false, what + ": threw the wrong exception type");
+            }
+        }
+
+        template<typename T>
+        void round_trips(Context &context) {
+            context.section(std::string("ArrayFile round trips<") + type_name<T>() + ">");
+            const std::string path = temp_path(std::string("round_trip_") + type_name<T>());
+
+            /* Odd counts so no stream ends on an alignment boundary by accident */
+            const std::vector<Vector<T, 3>> points = random_vectors<T, 3>(1001);
+            const std::vector<Vector<T, 4>> colours = random_vectors<T, 4>(77);
+            std::vector<Matrix<T, 4, 4>> matrices(13);
+            for (auto &matrix: matrices)
+                matrix = random_matrix<T, 4, 4>();
+            VectorArray<T, 3> chunked(points.data(), points.size());
+
+            {
+                ArrayFileWriter writer{path};
+                writer.write("points", points.data(), points.size());
+
+                /* Chunks of uneven sizes into both layouts */
+                writer.begin<Vector<T, 4>>("colours");
+                for (std::size_t first = 0; first < colours.size(); first += 10)
+                    writer.append(colours.data() + first, std::min<std::size_t>(10, colours.size() - first));
+                writer.end();
+
+                writer.write_soa("soa", points.data(), points.size());
+
+                writer.begin_soa<T, 3>("soa_chunks", points.size());
+                for (std::size_t first = 0; first < points.size(); first += 300) {
+                    const std::size_t n = std::min<std::size_t>(300, points.size() - first);
+                    writer.append(VectorArray<T, 3>(points.data() + first, n));
+                }
+                writer.end();
+
+                writer.write_soa("soa_array", chunked);
+                writer.write("matrices", matrices.data(), matrices.size());
+                writer.finish();
+            }
+
+            ArrayFileReader reader{path};
+            context.check(reader.size() == 6, "six arrays in the directory");
+
+            const ArraySpan<Vector<T, 3>> pointSpan = reader.array<Vector<T, 3>>("points");
+            bool same = pointSpan.size() == points.size();
+            for (std::size_t i = 0; same && i < points.size(); ++i)
+                same = equal(pointSpan[i], points[i]);
+            context.check(same, "AoS points read back bitwise");
+            context.check(aligned(pointSpan.data()), "AoS points start on 64 bytes");
+
+            const ArraySpan<Vector<T, 4>> colourSpan = reader.array<Vector<T, 4>>("colours");
+            same = colourSpan.size() == colours.size();
+            for (std::size_t i = 0; same && i < colours.size(); ++i)
+                same = equal(colourSpan[i], colours[i]);
+            context.check(same, "chunked AoS colours read back bitwise");
+            context.check(aligned(colourSpan.data()), "chunked AoS colours start on 64 bytes");
+
+            const ArraySpan<Matrix<T, 4, 4>> matrixSpan = reader.array<Matrix<T, 4, 4>>("matrices");
+            same = matrixSpan.size() == matrices.size();
+            for (std::size_t i = 0; same && i < matrices.size(); ++i)
+                same = std::memcmp(&matrixSpan[i], &matrices[i], sizeof(matrices[i])) == 0;
+            context.check(same, "AoS matrices read back bitwise");
+
+            for (const char *name: {"soa", "soa_chunks", "soa_array"}) {
+                const SoASpan<T, 3> span = reader.soa<T, 3>(name);
+                same = span.size() == points.size();
+                for (std::size_t i = 0; same && i < points.size(); ++i)
+                    same = equal(span.get(i), points[i]);
+                context.check(same, std::string(name) + " read back bitwise");
+
+                bool streamsAligned = true;
+                for (std::size_t c = 0; c < 3; ++c)
+                    streamsAligned = streamsAligned && aligned(span.component(c));
+                context.check(streamsAligned, std::string(name) + " streams start on 64 bytes");
+
+                VectorArray<T, 3> stored;
+                span.store(stored);
+                same = stored.size() == points.size();
+                for (std::size_t i = 0; same && i < points.size(); ++i)
+                    same = equal(stored.get(i), points[i]);
+                context.check(same, std::string(name) + " stores into a VectorArray");
+            }
+
+            /* The wrong element type or layout is a usage error, not a corrupt file */
+            bool rejected = false;
+            try {
+                reader.array<Vector<T, 4>>("points");
+            } catch (const std::invalid_argument &) {
+                rejected = true;
+            }
+            context.check(rejected, "AoS array read with another element type throws invalid_argument");
+
+            rejected = false;
+            try {
+                reader.array<Vector<T, 3>>("soa");
+            } catch (const std::invalid_argument &) {
+                rejected = true;
+            }
+            context.check(rejected, "SoA array read as AoS throws invalid_argument");
+
+            rejected = false;
+            try {
+                reader.array<Vector<T, 3>>("missing");
+            } catch (const std::invalid_argument &) {
+                rejected = true;
+            }
+            context.check(rejected, "missing array throws invalid_argument");
+            context.check(reader.find("missing") == nullptr, "find returns nullptr for a missing array");
+
+            std::remove(path.c_str());
+        }
+
+        void rejected_files(Context &context) {
+            context.section("ArrayFile rejected files");
+            const std::vector<Vector<float, 3>> points = random_vectors<float, 3>(500);
+
+            const std::string unfinished = temp_path("unfinished");
+            {
+                ArrayFileWriter writer{unfinished};
+                writer.write("points", points.data(), points.size());
+            }
+            check_rejected<std::runtime_error>(context, unfinished, "writer destroyed without finish()");
+
+            /* Cut a finished file inside the last array, its directory entry then points past the end */
+            const std::string truncated = temp_path("truncated");
+            {
+                ArrayFileWriter writer{truncated};
+                writer.write("points", points.data(), points.size());
+                writer.finish();
+            }
+            const std::uintmax_t finished = std::filesystem::file_size(truncated);
+            std::filesystem::resize_file(truncated, finished / 2);
+            check_rejected<std::runtime_error>(context, truncated, "file cut in half");
+            std::filesystem::resize_file(truncated, 32);
+            check_rejected<std::runtime_error>(context, truncated, "file shorter than the header");
+
+            const std::string foreign = temp_path("foreign");
+            {
+                std::ofstream file{foreign, std::ios::binary | std::ios::trunc};
+                const std::vector<char> bytes(256, 'x');
+                file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            }
+            check_rejected<std::runtime_error>(context, foreign, "file without the magic");
+
+            /* The data source fails mid stream and unwinds through the writer, which must not publish the partial
+             * array as if it were complete */
+            const std::string unwound = temp_path("unwound");
+            bool thrown = false;
+            try {
+                ArrayFileWriter writer{unwound};
+                writer.write("complete", points.data(), points.size());
+                writer.begin<Vector<float, 3>>("partial");
+                writer.append(points.data(), points.size() / 2);
+                throw std::runtime_error("source failed");
+            } catch (const std::runtime_error &) {
+                thrown = true;
+            }
+            context.check(thrown, "the source error reaches the caller");
+            check_rejected<std::runtime_error>(context, unwound, "file of a writer destroyed by an exception");
+
+            /* Misuse inside the writer unwinds the same way */
+            const std::string overlong = temp_path("overlong");
+            thrown = false;
+            try {
+                ArrayFileWriter writer{overlong};
+                writer.begin_soa<float, 3>("partial", points.size());
+                writer.append(points.data(), points.size() / 2);
+                writer.append(points.data(), points.size());    // more than declared
+            } catch (const std::logic_error &) {
+                thrown = true;
+            }
+            context.check(thrown, "overlong SoA append throws logic_error");
+            check_rejected<std::runtime_error>(context, overlong, "file of a writer destroyed by a misuse error");
+
+            for (const std::string &path: {unfinished, truncated, foreign, unwound, overlong})
+                std::remove(path.c_str());
+        }
+    }
+
+    void run_array_file_tests(Context &context) {
+        round_trips<float>(context);
+        round_trips<double>(context);
+        rejected_files(context);
+    }
+}
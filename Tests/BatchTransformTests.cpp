@@ -0,0 +1,154 @@
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "Test.h"
+#include "BatchTransform.h"
+#include "Dispatch.h"
+
+// The Sm::transform* batches against Sm::operator*(matrix, vector) for every instruction set this build and CPU can
+// run, in place and out of place, and spread over an Executor. The kernels without fused multiply adds do the same
+// operations in the same order as the scalar kernel and have to match it bitwise.
+namespace Test {
+    namespace {
+        template<typename T>
+        struct Outputs {
+            std::vector<Vector<T, 3>> points, directions, projected, mat3;
+            std::vector<Vector<T, 4>> mat4;
+        };
+
+        template<typename T>
+        bool same_bits(const std::vector<T> &lhs, const std::vector<T> &rhs) {
+            return lhs.size() == rhs.size() &&
+                   (lhs.empty() || std::memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(T)) == 0);
+        }
+
+        template<typename T>
+        bool same_bits(const Outputs<T> &lhs, const Outputs<T> &rhs) {
+            return same_bits(lhs.points, rhs.points) && same_bits(lhs.directions, rhs.directions) &&
+                   same_bits(lhs.projected, rhs.projected) && same_bits(lhs.mat3, rhs.mat3) &&
+                   same_bits(lhs.mat4, rhs.mat4);
+        }
+
+        template<typename T>
+        Outputs<T> transform_all(const Matrix<T, 4, 4> &mat4, const Matrix<T, 3, 3> &mat3,
+                                 const std::vector<Vector<T, 3>> &in3, const std::vector<Vector<T, 4>> &in4) {
+            const std::size_t count = in3.size();
+            Outputs<T> out{std::vector<Vector<T, 3>>(count), std::vector<Vector<T, 3>>(count),
+                           std::vector<Vector<T, 3>>(count), std::vector<Vector<T, 3>>(count),
+                           std::vector<Vector<T, 4>>(count)};
+            Sm::transform_points(mat4, in3.data(), out.points.data(), count);
+            Sm::transform_directions(mat4, in3.data(), out.directions.data(), count);
+            Sm::transform_points_projected(mat4, in3.data(), out.projected.data(), count);
+            Sm::transform(mat3, in3.data(), out.mat3.data(), count);
+            Sm::transform(mat4, in4.data(), out.mat4.data(), count);
+            return out;
+        }
+
+        template<typename T>
+        Vector<T, 3> xyz(const Vector<T, 4> &v) {
+            return Vector<T, 3>{v.x, v.y, v.z};
+        }
+
+        template<typename T>
+        void transforms(Context &context) {
+            context.section(std::string("Sm::transform*<") + type_name<T>() + ">");
+            const double tolerance = Test::tolerance<T>();
+
+            /* w of the projected points stays between 2 and 10 */
+            Matrix<T, 4, 4> mat4 = random_matrix<T, 4, 4>();
+            for (std::size_t c = 0; c < 3; ++c)
+                mat4(3, c) = random_value<T>(T(-0.5), T(0.5));
+            mat4(3, 3) = random_value<T>(T(8), T(10));
+            const Matrix<T, 3, 3> mat3 = random_matrix<T, 3, 3>();
+
+            /* Every count up to a few packs covers the unrolled loops and their tails, the last batch is large.
+             * The same inputs go through every instruction set */
+            std::vector<std::vector<Vector<T, 3>>> inputs3;
+            std::vector<std::vector<Vector<T, 4>>> inputs4;
+            for (std::size_t count = 0; count <= 20; ++count) {
+                const std::size_t size = count == 20 ? 1000 : count;
+                inputs3.emplace_back(size);
+                inputs4.emplace_back(size);
+                for (std::size_t i = 0; i < size; ++i) {
+                    inputs3.back()[i] = random_vector<T, 3>();
+                    inputs4.back()[i] = random_vector<T, 4>();
+                }
+            }
+
+            const Sm::Isa isas[] = {Sm::Isa::Scalar, Sm::Isa::Sse2, Sm::Isa::Avx2, Sm::Isa::Avx512};
+            std::vector<Outputs<T>> scalar;
+            Sm::Isa previous = Sm::Isa::Scalar;
+            for (Sm::Isa isa: isas) {
+                const Sm::Isa active = Sm::force_isa(isa);
+                if (isa != Sm::Isa::Scalar && active == previous)
+                    continue;
+                previous = active;
+                const std::string name = Sm::isa_name(active);
+
+                for (std::size_t count = 0; count < inputs3.size(); ++count) {
+                    const std::vector<Vector<T, 3>> &in3 = inputs3[count];
+                    const std::vector<Vector<T, 4>> &in4 = inputs4[count];
+                    const std::size_t size = in3.size();
+                    const Outputs<T> out = transform_all(mat4, mat3, in3, in4);
+                    const std::string what = name + ", " + std::to_string(size) + " vectors";
+
+                    double points = 0, directions = 0, projected = 0, mat3Error = 0, mat4Error = 0;
+                    for (std::size_t i = 0; i < size; ++i) {
+                        const Vector<T, 4> point = Sm::operator*(mat4, Vector<T, 4>{in3[i], T(1)});
+                        points = std::max(points, max_difference(out.points[i], xyz(point)));
+                        directions = std::max(directions, max_difference(
+                                out.directions[i], xyz(Sm::operator*(mat4, Vector<T, 4>{in3[i], T(0)}))));
+                        projected = std::max(projected, max_difference(out.projected[i], xyz(point) / point.w));
+                        mat3Error = std::max(mat3Error, max_difference(out.mat3[i], Sm::operator*(mat3, in3[i])));
+                        mat4Error = std::max(mat4Error, max_difference(out.mat4[i], Sm::operator*(mat4, in4[i])));
+                    }
+                    check_near(context, points, 0.0, tolerance, what + ": transform_points");
+                    check_near(context, directions, 0.0, tolerance, what + ": transform_directions");
+                    check_near(context, projected, 0.0, tolerance, what + ": transform_points_projected");
+                    check_near(context, mat3Error, 0.0, tolerance, what + ": transform(Mat3)");
+                    check_near(context, mat4Error, 0.0, tolerance, what + ": transform(Mat4)");
+
+                    /* The kernels without fused multiply adds round exactly like the scalar one */
+                    if (active == Sm::Isa::Scalar)
+                        scalar.push_back(out);
+                    else if (active == Sm::Isa::Sse2)
+                        context.check(same_bits(out, scalar[count]), what + ": bitwise the scalar kernel");
+
+                    /* In place gives the same as out of place */
+                    Outputs<T> inPlace{in3, in3, in3, in3, in4};
+                    Sm::transform_points(mat4, inPlace.points.data(), inPlace.points.data(), size);
+                    Sm::transform_directions(mat4, inPlace.directions.data(), inPlace.directions.data(), size);
+                    Sm::transform_points_projected(mat4, inPlace.projected.data(), inPlace.projected.data(), size);
+                    Sm::transform(mat3, inPlace.mat3.data(), inPlace.mat3.data(), size);
+                    Sm::transform(mat4, inPlace.mat4.data(), inPlace.mat4.data(), size);
+                    context.check(same_bits(inPlace, out), what + ": in place matches out of place");
+                }
+
+                /* Enough vectors for several cache line aligned chunks per thread */
+                const std::size_t size = 20011;
+                std::vector<Vector<T, 3>> in3(size);
+                std::vector<Vector<T, 4>> in4(size);
+                for (std::size_t i = 0; i < size; ++i) {
+                    in3[i] = random_vector<T, 3>();
+                    in4[i] = random_vector<T, 4>();
+                }
+                const Outputs<T> serial = transform_all(mat4, mat3, in3, in4);
+                Outputs<T> parallel = serial;
+                Executor executor{4};
+                Sm::transform_points(executor, mat4, in3.data(), parallel.points.data(), size);
+                Sm::transform_directions(executor, mat4, in3.data(), parallel.directions.data(), size);
+                Sm::transform_points_projected(executor, mat4, in3.data(), parallel.projected.data(), size);
+                Sm::transform(executor, mat3, in3.data(), parallel.mat3.data(), size);
+                Sm::transform(executor, mat4, in4.data(), parallel.mat4.data(), size);
+                context.check(same_bits(parallel, serial), name + ": the Executor overloads match the serial batches");
+            }
+            Sm::reset_isa();
+        }
+    }
+
+    void run_batch_transform_tests(Context &context) {
+        transforms<float>(context);
+        transforms<double>(context);
+    }
+}
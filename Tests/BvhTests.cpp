@@ -0,0 +1,260 @@
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "Test.h"
+#include "AABB.h"
+#include "Bvh.h"
+#include "Ray.h"
+
+// AABB basics, and Bvh query / raycast against brute force over the same triangles for serial and parallel builds,
+// after refit and for the degenerate inputs: no primitives, one primitive and every centroid on one point.
+namespace Test {
+    namespace {
+        template<typename T>
+        void aabb(Context &context) {
+            using Vec = Vector<T, 3>;
+            context.section(std::string("AABB<") + type_name<T>() + ">");
+
+            AABB<T> box;
+            context.check(box.is_empty(), "a default box is empty");
+            context.check(box.surface_area() == T(0), "an empty box has no area");
+            box.expand(Vec{T(1), T(2), T(3)});
+            box.expand(Vec{T(-1), T(0), T(5)});
+            context.check(!box.is_empty(), "a box holding points is not empty");
+            check_near(context, box.min, Vec{T(-1), T(0), T(3)}, 0.0, "expand grows min");
+            check_near(context, box.max, Vec{T(1), T(2), T(5)}, 0.0, "expand grows max");
+            check_near(context, box.center(), Vec{T(0), T(1), T(4)}, 0.0, "center");
+            check_near(context, box.surface_area(), T(24), 0.0, "surface area of a 2x2x2 box");
+            check_near(context, box.volume(), T(8), 0.0, "volume of a 2x2x2 box");
+            context.check(box.contains(Vec{T(0), T(1), T(4)}) && !box.contains(Vec{T(0), T(3), T(4)}), "contains");
+
+            const AABB<T> touching{Vec{T(1), T(2), T(5)}, Vec{T(2), T(3), T(6)}};
+            const AABB<T> apart{Vec{T(1.5), T(2), T(5)}, Vec{T(2), T(3), T(6)}};
+            context.check(box.overlaps(touching) && touching.overlaps(box), "touching boxes overlap");
+            context.check(!box.overlaps(apart), "disjoint boxes do not overlap");
+            context.check(Sm::intersection(box, apart).is_empty(), "disjoint boxes have an empty intersection");
+            context.check(Sm::merge(box, apart).contains(box) && Sm::merge(box, apart).contains(apart),
+                          "merge holds both boxes");
+            context.check(Sm::merge(AABB<T>{}, box).contains(box) && !Sm::merge(AABB<T>{}, box).is_empty(),
+                          "merging with an empty box gives the other box");
+        }
+
+        template<typename T>
+        struct Mesh {
+            std::vector<Vector<T, 3>> vertices;
+            std::vector<std::uint32_t> indices;
+            std::vector<AABB<T>> bounds;
+
+            std::size_t triangles() const {
+                return indices.size() / 3;
+            }
+
+            void update_bounds() {
+                bounds.resize(triangles());
+                for (std::size_t i = 0; i < triangles(); ++i) {
+                    AABB<T> box{vertices[indices[3 * i]]};
+                    box.expand(vertices[indices[3 * i + 1]]);
+                    box.expand(vertices[indices[3 * i + 2]]);
+                    bounds[i] = box;
+                }
+            }
+
+            // Closest hit along the ray with tMax shrinking like Bvh::raycast expects
+            T hit(std::uint32_t triangle, const Vector<T, 3> &origin, const Vector<T, 3> &direction, T tMax) const {
+                const Ray<T> ray{origin, direction, T(0), tMax};
+                T t, u, v;
+                return Sm::intersect_triangle(ray, vertices[indices[3 * triangle]],
+                                              vertices[indices[3 * triangle + 1]],
+                                              vertices[indices[3 * triangle + 2]], t, u, v) ? t : tMax;
+            }
+        };
+
+        // Small random triangles scattered through a cube
+        template<typename T>
+        Mesh<T> random_mesh(std::size_t count) {
+            Mesh<T> mesh;
+            for (std::size_t i = 0; i < count; ++i) {
+                const Vector<T, 3> center = random_vector<T, 3>(T(-50), T(50));
+                for (std::size_t k = 0; k < 3; ++k) {
+                    mesh.indices.push_back(std::uint32_t(mesh.vertices.size()));
+                    mesh.vertices.push_back(center + random_vector<T, 3>(T(-2), T(2)));
+                }
+            }
+            mesh.update_bounds();
+            return mesh;
+        }
+
+        // Every primitive overlapping the box is reported exactly once, extra primitives of overlapping leaves
+        // are allowed since query does not test primitives
+        template<typename T>
+        void check_queries(Context &context, const Bvh<T> &bvh, const Mesh<T> &mesh, const std::string &what) {
+            for (std::size_t round = 0; round < 50; ++round) {
+                const Vector<T, 3> corner = random_vector<T, 3>(T(-60), T(60));
+                const AABB<T> box{corner, corner + random_vector<T, 3>(T(0), T(20))};
+
+                std::vector<std::uint32_t> reported;
+                bvh.query(box, [&](std::uint32_t primitive) { reported.push_back(primitive); });
+                std::sort(reported.begin(), reported.end());
+
+                bool exact = std::adjacent_find(reported.begin(), reported.end()) == reported.end();
+                for (std::uint32_t i = 0; i < mesh.triangles(); ++i)
+                    if (mesh.bounds[i].overlaps(box))
+                        exact = exact && std::binary_search(reported.begin(), reported.end(), i);
+                context.check(exact, what + ": query round " + std::to_string(round));
+            }
+        }
+
+        template<typename T>
+        void check_raycasts(Context &context, const Bvh<T> &bvh, const Mesh<T> &mesh, const std::string &what) {
+            const T inf = std::numeric_limits<T>::infinity();
+            for (std::size_t round = 0; round < 200; ++round) {
+                const Vector<T, 3> origin = random_vector<T, 3>(T(-80), T(80));
+                /* Aimed into the cloud most of the time, so both hits and misses are covered */
+                const Vector<T, 3> direction = random_vector<T, 3>(T(-40), T(40)) - origin;
+
+                T expected = inf;
+                for (std::uint32_t i = 0; i < mesh.triangles(); ++i)
+                    expected = mesh.hit(i, origin, direction, expected);
+
+                const T found = bvh.raycast(origin, direction, inf, [&](std::uint32_t primitive, T tMax) {
+                    return mesh.hit(primitive, origin, direction, tMax);
+                });
+                std::ostringstream message;
+                message << what << ": raycast round " << round << " found " << found << ", brute force " << expected;
+                context.check(found == expected, message.str());
+            }
+        }
+
+        template<typename T>
+        void queries(Context &context) {
+            context.section(std::string("Bvh<") + type_name<T>() + ">");
+            Mesh<T> mesh = random_mesh<T>(3000);
+
+            Bvh<T> serial;
+            serial.build(mesh.vertices.data(), mesh.indices.data(), mesh.triangles());
+            check_queries(context, serial, mesh, "serial");
+            check_raycasts(context, serial, mesh, "serial");
+
+            Executor executor{4};
+            Sm::BvhOptions options;
+            options.threads = 4;
+            options.executor = &executor;
+            options.parallelThreshold = 256;
+            Bvh<T> parallel;
+            parallel.build(mesh.vertices.data(), mesh.indices.data(), mesh.triangles(), options);
+            check_queries(context, parallel, mesh, "parallel");
+            check_raycasts(context, parallel, mesh, "parallel");
+
+            std::vector<std::uint32_t> leafOrder(parallel.primitives(),
+                                                 parallel.primitives() + parallel.primitive_count());
+            std::sort(leafOrder.begin(), leafOrder.end());
+            bool permutation = leafOrder.size() == mesh.triangles();
+            for (std::size_t i = 0; permutation && i < leafOrder.size(); ++i)
+                permutation = leafOrder[i] == i;
+            context.check(permutation, "the leaves hold every primitive once");
+
+            /* Every vertex moves, the tree keeps its shape but has to bound the new positions */
+            for (auto &vertex: mesh.vertices)
+                vertex += random_vector<T, 3>(T(-3), T(3));
+            mesh.update_bounds();
+            serial.refit(mesh.vertices.data(), mesh.indices.data());
+            parallel.refit(mesh.bounds.data());
+            check_queries(context, serial, mesh, "serial after refit");
+            check_raycasts(context, serial, mesh, "serial after refit");
+            check_queries(context, parallel, mesh, "parallel after refit");
+            check_raycasts(context, parallel, mesh, "parallel after refit");
+        }
+
+        template<typename T>
+        void degenerate(Context &context) {
+            context.section(std::string("Bvh<") + type_name<T>() + "> degenerate input");
+            const T inf = std::numeric_limits<T>::infinity();
+            const Vector<T, 3> origin{T(0), T(0), T(-10)}, direction{T(0), T(0), T(1)};
+
+            Bvh<T> empty;
+            empty.build(static_cast<const AABB<T> *>(nullptr), 0);
+            std::size_t calls = 0;
+            empty.query(AABB<T>{Vector<T, 3>{T(-1e6), T(-1e6), T(-1e6)}, Vector<T, 3>{T(1e6), T(1e6), T(1e6)}},
+                        [&](std::uint32_t) { ++calls; });
+            const T emptyHit = empty.raycast(origin, direction, inf, [&](std::uint32_t, T tMax) {
+                ++calls;
+                return tMax;
+            });
+            context.check(calls == 0 && emptyHit == inf && empty.bounds().is_empty() && empty.node_count() == 0,
+                          "an empty build reports nothing");
+
+            const AABB<T> single{Vector<T, 3>{T(-1), T(-1), T(-1)}, Vector<T, 3>{T(1), T(1), T(1)}};
+            Bvh<T> one;
+            one.build(&single, 1);
+            std::vector<std::uint32_t> reported;
+            one.query(single, [&](std::uint32_t primitive) { reported.push_back(primitive); });
+            const T oneHit = one.raycast(origin, direction, inf, [&](std::uint32_t primitive, T tMax) {
+                T near;
+                return primitive == 0 && Sm::intersect_aabb(Ray<T>{origin, direction}, single, near) ? near : tMax;
+            });
+            context.check(one.node_count() == 1 && reported.size() == 1 && reported[0] == 0,
+                          "a single primitive is one leaf");
+            check_near(context, oneHit, T(9), 0.0, "a single primitive is hit");
+
+            /* 500 copies of one box: no split can separate them, leaves must still stay small */
+            std::vector<AABB<T>> coincident(500, single);
+            Bvh<T> stacked;
+            stacked.build(coincident.data(), coincident.size());
+            std::size_t largestLeaf = 0;
+            for (std::size_t i = 0; i < stacked.node_count(); ++i)
+                if (stacked.nodes()[i].is_leaf())
+                    largestLeaf = std::max<std::size_t>(largestLeaf, stacked.nodes()[i].count);
+            reported.clear();
+            stacked.query(single, [&](std::uint32_t primitive) { reported.push_back(primitive); });
+            context.check(largestLeaf <= Sm::BvhOptions{}.maxLeafSize, "coincident centroids still split");
+            context.check(reported.size() == coincident.size(), "coincident primitives are all reported");
+        }
+
+        // A ray that misses must not test any primitive, also with the infinite tMax of a default Ray
+        template<typename T>
+        void missing_ray(Context &context) {
+            context.section(std::string("Bvh<") + type_name<T>() + "> missing ray");
+            const std::size_t size = 100;
+            Mesh<T> heightfield;
+            for (std::size_t z = 0; z <= size; ++z)
+                for (std::size_t x = 0; x <= size; ++x)
+                    heightfield.vertices.push_back(Vector<T, 3>{T(x), random_value<T>(T(0), T(1)), T(z)});
+            for (std::size_t z = 0; z < size; ++z)
+                for (std::size_t x = 0; x < size; ++x) {
+                    const auto corner = std::uint32_t(z * (size + 1) + x);
+                    const auto below = std::uint32_t(corner + size + 1);
+                    for (std::uint32_t index: {corner, below, corner + 1, corner + 1, below, below + 1})
+                        heightfield.indices.push_back(index);
+                }
+
+            Bvh<T> bvh;
+            bvh.build(heightfield.vertices.data(), heightfield.indices.data(), heightfield.triangles());
+
+            for (const T tMax: {std::numeric_limits<T>::infinity(), T(1000)}) {
+                std::size_t calls = 0;
+                const auto count = [&](std::uint32_t, T distance) {
+                    ++calls;
+                    return distance;
+                };
+                bvh.raycast(Vector<T, 3>{T(50), T(5), T(50)}, Vector<T, 3>{T(0), T(1), T(0)}, tMax, count);
+                bvh.raycast(Vector<T, 3>{T(-10), T(0.5), T(-10)}, Vector<T, 3>{T(-1), T(0), T(-1)}, tMax, count);
+                std::ostringstream message;
+                message << "rays away from the heightfield with tMax " << tMax << " tested " << calls
+                        << " primitives";
+                context.check(calls == 0, message.str());
+            }
+        }
+    }
+
+    void run_bvh_tests(Context &context) {
+        aabb<float>(context);
+        aabb<double>(context);
+        queries<float>(context);
+        queries<double>(context);
+        degenerate<float>(context);
+        degenerate<double>(context);
+        missing_ray<float>(context);
+        missing_ray<double>(context);
+    }
+}
@@ -0,0 +1,148 @@
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include "Test.h"
+#include "SlimeAlgebra.h"
+
+// The constexpr surface evaluated by the compiler: identity, transpose, the Mat4, Mat3 and Mat4d products, dot,
+// cross, matrix vector products, the quaternion product, determinant and inverse. The inputs are small integers so
+// every result is exact, and the same expressions evaluated at run time through the SIMD kernels have to give the
+// same bits. With SLIMEMATHS_INSTRUMENT the counting sites are skipped during constant evaluation, so the asserts
+// hold in both builds.
+namespace Test {
+    namespace {
+        template<typename T, std::size_t R, std::size_t C>
+        constexpr bool same(const Matrix<T, R, C> &lhs, const Matrix<T, R, C> &rhs) {
+            for (std::size_t i = 0; i < R * C; ++i)
+                if (lhs[i] != rhs[i])
+                    return false;
+            return true;
+        }
+
+        template<typename T, std::size_t N>
+        constexpr bool same(const Vector<T, N> &lhs, const Vector<T, N> &rhs) {
+            for (std::size_t i = 0; i < N; ++i)
+                if (lhs[i] != rhs[i])
+                    return false;
+            return true;
+        }
+
+        template<typename T>
+        constexpr bool same(const Quaternion<T> &lhs, const Quaternion<T> &rhs) {
+            return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z && lhs.w == rhs.w;
+        }
+
+        constexpr Mat4 a{1, 2, 0, 0,
+                         0, 1, 3, 0,
+                         0, 0, 1, 4,
+                         0, 0, 0, 1};
+        constexpr Mat4 b{2, 0, 0, 1,
+                         0, 1, 0, 2,
+                         1, 0, 1, 0,
+                         0, 0, 0, 1};
+        constexpr Mat3 m{2, 0, 1,
+                         1, 3, 0,
+                         0, 1, 4};
+        constexpr Mat3 n{1, 2, 0,
+                         0, 1, 1,
+                         1, 0, 2};
+        constexpr Mat4d c{2, 0, 0, 0,
+                          0, 4, 0, 0,
+                          0, 0, 8, 0,
+                          1, 2, 3, 1};
+        constexpr Vec3 u{1, 2, 3}, v{4, 5, 6};
+        constexpr Vec4 point{1, 2, 3, 1};
+        constexpr Quaternion<float> p{1, 2, 3, 4}, q{5, 6, 7, 8};
+
+#if defined(SLIMEMATHS_HAS_IS_CONSTANT_EVALUATED)
+        /* Identity and transpose */
+        static_assert(same(Mat4::identity(), Mat4{}), "identity() is the default matrix");
+        static_assert(same(Mat4{} * a, a) && same(a * Mat4{}, a), "the identity is neutral");
+        static_assert(same(a.transposed(), Mat4{1, 0, 0, 0,
+                                                2, 1, 0, 0,
+                                                0, 3, 1, 0,
+                                                0, 0, 4, 1}), "transposed");
+        static_assert(same(a.transposed().transposed(), a), "transposed twice");
+
+        /* Products */
+        static_assert(same(a * b, Mat4{2, 2, 0, 5,
+                                       3, 1, 3, 2,
+                                       1, 0, 1, 4,
+                                       0, 0, 0, 1}), "Mat4 product");
+        static_assert(same(m * n, Mat3{3, 4, 2,
+                                       1, 5, 3,
+                                       4, 1, 9}), "Mat3 product");
+        static_assert(same(c * c, Mat4d{4, 0, 0, 0,
+                                        0, 16, 0, 0,
+                                        0, 0, 64, 0,
+                                        3, 10, 27, 1}), "Mat4d product");
+
+        /* Vectors */
+        static_assert(Sm::dot(u, v) == 32, "dot");
+        static_assert(same(Sm::cross(u, v), Vec3{-3, 6, -3}), "cross");
+        static_assert(same(Sm::cross(Vec3{1, 0, 0}, Vec3{0, 1, 0}), Vec3{0, 0, 1}), "x cross y is z");
+        static_assert(same(Sm::operator*(a, point), Vec4{5, 11, 7, 1}), "matrix * column vector");
+        static_assert(same(Sm::operator*(point, a), Vec4{1, 4, 9, 13}), "row vector * matrix");
+
+        /* Quaternions, in the order this library composes them */
+        static_assert(same(p * q, Quaternion<float>{32, 32, 56, -6}), "quaternion product");
+        static_assert(same(p * Quaternion<float>{}, p), "the identity quaternion is neutral");
+
+        /* Determinant and inverse, the inverses are exact because their determinants are powers of two */
+        static_assert(a.determinant() == 1 && m.determinant() == 25 && c.determinant() == 64, "determinant");
+        static_assert(same(a.inverse(), Mat4{1, -2, 6, -24,
+                                             0, 1, -3, 12,
+                                             0, 0, 1, -4,
+                                             0, 0, 0, 1}), "Mat4 inverse");
+        static_assert(same(c.inverse(), Mat4d{0.5, 0, 0, 0,
+                                              0, 0.25, 0, 0,
+                                              0, 0, 0.125, 0,
+                                              -0.5, -0.5, -0.375, 1}), "Mat4d inverse");
+        static_assert(same(a * a.inverse(), Mat4{}), "a matrix times its inverse");
+#endif
+
+        // Compiler evaluated values next to the same expressions run through the kernels
+        template<typename V>
+        void check_bits(Context &context, const V &baked, const V &computed, const std::string &what) {
+            context.check(std::memcmp(&baked, &computed, sizeof(V)) == 0, what + " is the same at run time");
+        }
+
+        void run_time(Context &context) {
+            context.section("constexpr");
+
+            /* Non const copies, so the right hand sides are not constant expressions */
+            Mat4 ra = a, rb = b;
+            Mat3 rm = m, rn = n;
+            Mat4d rc = c;
+            Vec3 ru = u, rv = v;
+            Vec4 rpoint = point;
+            Quaternion<float> rp = p, rq = q;
+
+            constexpr Mat4 ab = a * b, transposed = a.transposed(), inverse = a.inverse();
+            constexpr Mat3 mn = m * n;
+            constexpr Mat4d cc = c * c, cInverse = c.inverse();
+            constexpr Vec3 uv = Sm::cross(u, v);
+            constexpr Vec4 column = Sm::operator*(a, point), row = Sm::operator*(point, a);
+            constexpr Quaternion<float> pq = p * q;
+            constexpr float uDotV = Sm::dot(u, v);
+            constexpr float determinant = a.determinant();
+
+            check_bits(context, ab, ra * rb, "Mat4 product");
+            check_bits(context, mn, rm * rn, "Mat3 product");
+            check_bits(context, cc, rc * rc, "Mat4d product");
+            check_bits(context, transposed, ra.transposed(), "transposed");
+            check_bits(context, inverse, ra.inverse(), "Mat4 inverse");
+            check_bits(context, cInverse, rc.inverse(), "Mat4d inverse");
+            check_bits(context, uv, Sm::cross(ru, rv), "cross");
+            check_bits(context, column, Sm::operator*(ra, rpoint), "matrix * column vector");
+            check_bits(context, row, Sm::operator*(rpoint, ra), "row vector * matrix");
+            check_bits(context, pq, rp * rq, "quaternion product");
+            check_bits(context, uDotV, Sm::dot(ru, rv), "dot");
+            check_bits(context, determinant, ra.determinant(), "determinant");
+        }
+    }
+
+    void run_constexpr_tests(Context &context) {
+        run_time(context);
+    }
+}
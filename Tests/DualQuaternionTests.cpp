@@ -0,0 +1,143 @@
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "Test.h"
+#include "DualQuaternion.h"
+#include "Skinning.h"
+
+// DualQuaternion against the quaternion and matrix forms of the same rigid transform, and Sm::skin against a scalar
+// dual quaternion blend of every vertex.
+namespace Test {
+    namespace {
+        template<typename T>
+        DualQuaternion<T> random_rigid() {
+            return DualQuaternion<T>{random_rotation<T>(), random_vector<T, 3>()};
+        }
+
+        template<typename T>
+        void transforms(Context &context) {
+            context.section(std::string("DualQuaternion<") + type_name<T>() + ">");
+            const double eps = tolerance<T>() * 10.0;
+
+            for (std::size_t round = 0; round < 100; ++round) {
+                const Quaternion<T> rotation = random_rotation<T>();
+                const Vector<T, 3> translation = random_vector<T, 3>();
+                const DualQuaternion<T> dq{rotation, translation};
+                const Vector<T, 3> point = random_vector<T, 3>();
+
+                const Vector<T, 3> expected = rotation * point + translation;
+                check_near(context, dq.transform_point(point), expected, eps, "transform_point is q * p + t");
+                check_near(context, dq * point, expected, eps, "operator*(Vector) is transform_point");
+                check_near(context, dq.get_translation(), translation, eps, "get_translation gives t back");
+
+                const Vector<T, 4> homogeneous = Sm::operator*(dq.to_matrix(), Vector<T, 4>{point, T(1)});
+                check_near(context, Vector<T, 3>{homogeneous}, expected, eps, "to_matrix() * p is transform_point");
+
+                const DualQuaternion<T> next = random_rigid<T>();
+                check_near(context, (dq * next).transform_point(point),
+                           next.transform_point(dq.transform_point(point)), eps, "lhs * rhs applies lhs first");
+
+                const DualQuaternion<T> identity = dq * dq.Inverse();
+                check_near(context, identity.real, Quaternion<T>{}, eps, "dq * dq.Inverse() has no rotation");
+                check_near(context, identity.get_translation(), Vector<T, 3>{}, eps,
+                           "dq * dq.Inverse() has no translation");
+                check_near(context, dq.Inverse().transform_point(expected), point, eps, "Inverse undoes the transform");
+            }
+        }
+
+        // The matrix constructor near 180 degrees, where the trace of the rotation is close to -1
+        template<typename T>
+        void from_matrix(Context &context) {
+            context.section(std::string("DualQuaternion<") + type_name<T>() + ">(Matrix)");
+            const T pi = T(3.14159265358979323846);
+
+            for (std::size_t round = 0; round < 200; ++round) {
+                const Vector<T, 3> axis = random_vector<T, 3>().normalized();
+                const T angle = round < 100 ? pi - T(round) * T(1e-4) : random_value<T>(-pi, pi);
+                const T s = std::sin(angle / T(2));
+                const Quaternion<T> rotation{axis.x * s, axis.y * s, axis.z * s, std::cos(angle / T(2))};
+                const DualQuaternion<T> expected{rotation, random_vector<T, 3>()};
+
+                DualQuaternion<T> converted{expected.to_matrix()};
+                /* q and -q are the same rotation */
+                if (Sm::dot(converted.real, expected.real) < T(0))
+                    converted *= T(-1);
+
+                check_near(context, converted.real, expected.real, tolerance<T>(), "rotation");
+                check_near(context, converted.get_translation(), expected.get_translation(), tolerance<T>() * 4.0,
+                           "translation");
+                const Vector<T, 3> point = random_vector<T, 3>();
+                check_near(context, converted.transform_point(point), expected.transform_point(point),
+                           tolerance<T>() * 10.0, "transformed point");
+            }
+        }
+
+        // Blend with signs aligned to the first influence, normalize, apply
+        template<typename T>
+        DualQuaternion<T> blend(const DualQuaternion<T> *bones, const std::uint32_t *indices, const T *weights) {
+            DualQuaternion<T> sum{Quaternion<T>{T(0), T(0), T(0), T(0)}, Quaternion<T>{T(0), T(0), T(0), T(0)}};
+            const Quaternion<T> &pivot = bones[indices[0]].real;
+            for (std::size_t k = 0; k < Sm::skinInfluences; ++k) {
+                const DualQuaternion<T> &bone = bones[indices[k]];
+                const T sign = Sm::dot(bone.real, pivot) < T(0) ? T(-1) : T(1);
+                sum += bone * (weights[k] * sign);
+            }
+            return sum.Normalized();
+        }
+
+        template<typename T>
+        void skinning(Context &context) {
+            context.section(std::string("Sm::skin(DualQuaternion<") + type_name<T>() + ">)");
+            const std::size_t boneCount = 12, vertexCount = 101;
+
+            std::vector<DualQuaternion<T>> bones(boneCount);
+            for (auto &bone: bones)
+                bone = random_rigid<T>();
+
+            std::vector<std::uint32_t> indices(vertexCount * Sm::skinInfluences);
+            std::vector<T> weights(vertexCount * Sm::skinInfluences);
+            std::vector<Vector<T, 3>> positions(vertexCount), normals(vertexCount);
+            for (std::size_t i = 0; i < vertexCount; ++i) {
+                T total = T(0);
+                for (std::size_t k = 0; k < Sm::skinInfluences; ++k) {
+                    indices[i * 4 + k] = std::uint32_t(rng()() % boneCount);
+                    /* Some vertices use fewer than four bones */
+                    weights[i * 4 + k] = k > 0 && i % 3 == 0 ? T(0) : random_value<T>(T(0.1), T(1));
+                    total += weights[i * 4 + k];
+                }
+                for (std::size_t k = 0; k < Sm::skinInfluences; ++k)
+                    weights[i * 4 + k] /= total;
+                positions[i] = random_vector<T, 3>();
+                normals[i] = random_vector<T, 3>().normalized();
+            }
+
+            std::vector<Vector<T, 3>> outPositions(vertexCount), outNormals(vertexCount);
+            Sm::skin(bones.data(), indices.data(), weights.data(), positions.data(), normals.data(),
+                     outPositions.data(), outNormals.data(), vertexCount);
+
+            Executor executor{3};
+            std::vector<Vector<T, 3>> parallelPositions(vertexCount);
+            Sm::skin(executor, bones.data(), indices.data(), weights.data(), positions.data(),
+                     parallelPositions.data(), vertexCount);
+
+            for (std::size_t i = 0; i < vertexCount; ++i) {
+                const DualQuaternion<T> dq = blend(bones.data(), indices.data() + i * 4, weights.data() + i * 4);
+                const std::string vertex = "vertex " + std::to_string(i);
+                check_near(context, outPositions[i], dq.transform_point(positions[i]), tolerance<T>() * 10.0,
+                           vertex + " position");
+                check_near(context, outNormals[i], dq.transform_direction(normals[i]), tolerance<T>() * 10.0,
+                           vertex + " normal");
+                check_near(context, parallelPositions[i], outPositions[i], 0.0, vertex + " with an executor");
+            }
+        }
+    }
+
+    void run_dual_quaternion_tests(Context &context) {
+        transforms<float>(context);
+        transforms<double>(context);
+        from_matrix<float>(context);
+        from_matrix<double>(context);
+        skinning<float>(context);
+        skinning<double>(context);
+    }
+}
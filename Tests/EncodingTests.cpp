@@ -0,0 +1,248 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+#include "Test.h"
+#include "Half.h"
+#include "Encoding.h"
+
+// Half floats over every one of the 65536 bit patterns, the array encoders bitwise against the single value ones
+// (packs and scalar tails, NaN and out of range inputs included) and the worst angular error of the octahedral and
+// smallest three encodings against the bounds Encoding.h documents.
+namespace Test {
+    namespace {
+        const double degrees = 180.0 / 3.14159265358979323846;
+
+        bool is_nan_bits(std::uint16_t bits) {
+            return (bits & 0x7c00u) == 0x7c00u && (bits & 0x03ffu) != 0;
+        }
+
+        void halves(Context &context) {
+            context.section("half");
+            std::vector<half> all(65536);
+            for (std::size_t b = 0; b < all.size(); ++b)
+                all[b] = half::from_bits(static_cast<std::uint16_t>(b));
+
+            /* half -> float -> half gives every pattern back, NaNs stay NaNs of the same sign */
+            std::size_t mismatches = 0;
+            for (std::size_t b = 0; b < all.size(); ++b) {
+                const std::uint16_t back = half{float(all[b])}.bits;
+                const bool same = is_nan_bits(all[b].bits) ?
+                                  is_nan_bits(back) && (back & 0x8000u) == (all[b].bits & 0x8000u) :
+                                  back == all[b].bits;
+                mismatches += same ? 0 : 1;
+            }
+            context.check(mismatches == 0, "every bit pattern round trips, " + std::to_string(mismatches) + " do not");
+
+            /* The array conversions agree with the single ones on every pattern */
+            std::vector<float> floats(all.size());
+            std::vector<half> back(all.size());
+            Sm::to_float(all.data(), floats.data(), all.size());
+            Sm::to_half(floats.data(), back.data(), floats.size());
+            std::size_t floatMismatches = 0, halfMismatches = 0;
+            for (std::size_t b = 0; b < all.size(); ++b) {
+                const float single = float(all[b]);
+                floatMismatches += std::memcmp(&single, &floats[b], sizeof(single)) == 0 ||
+                                   (single != single && floats[b] != floats[b]) ? 0 : 1;
+                const std::uint16_t singleBack = half{floats[b]}.bits;
+                halfMismatches += singleBack == back[b].bits || (is_nan_bits(singleBack) && is_nan_bits(back[b].bits))
+                                  ? 0 : 1;
+            }
+            context.check(floatMismatches == 0, "Sm::to_float(array) matches float(half) on every pattern");
+            context.check(halfMismatches == 0, "Sm::to_half(array) matches half(float) on every pattern");
+
+            /* Halfway between two neighbouring halves rounds to the even one, the largest finite half plus half a
+             * step overflows */
+            std::size_t ties = 0;
+            for (std::uint32_t b = 0; b < 0x7bffu; ++b) {
+                const float low = float(half::from_bits(static_cast<std::uint16_t>(b)));
+                const float high = float(half::from_bits(static_cast<std::uint16_t>(b + 1)));
+                const std::uint16_t even = static_cast<std::uint16_t>(b % 2 == 0 ? b : b + 1);
+                ties += half{(low + high) * 0.5f}.bits == even && half{-(low + high) * 0.5f}.bits == (even | 0x8000u)
+                        ? 0 : 1;
+            }
+            context.check(ties == 0, "ties round to even, " + std::to_string(ties) + " do not");
+            context.check(half{65520.0f}.bits == 0x7c00u && half{65519.0f}.bits == 0x7bffu,
+                          "65520 overflows to infinity, 65519 does not");
+        }
+
+        // Random values in [low, high] plus the edge cases every encoder has to treat the same in both paths
+        template<typename T>
+        std::vector<T> scalar_inputs(T low, T high) {
+            std::vector<T> values = {T(0), -T(0), T(1), T(-1), T(0.5), T(-0.5), T(2), T(-2),
+                                     std::numeric_limits<T>::infinity(), -std::numeric_limits<T>::infinity(),
+                                     std::numeric_limits<T>::quiet_NaN(), std::numeric_limits<T>::denorm_min()};
+            while (values.size() < 1003)
+                values.push_back(random_value<T>(low, high));
+            return values;
+        }
+
+        template<typename Q, typename T>
+        void unorm(Context &context) {
+            const std::vector<T> values = scalar_inputs<T>(T(-0.25), T(1.25));
+            std::vector<Q> encoded(values.size());
+            Sm::encode_unorm(values.data(), encoded.data(), values.size());
+            bool same = true;
+            for (std::size_t i = 0; i < values.size(); ++i)
+                same = same && encoded[i] == Sm::encode_unorm<Q>(values[i]);
+            context.check(same, std::string("encode_unorm<") + std::to_string(8 * sizeof(Q)) + " bit>(" +
+                                type_name<T>() + " array) matches the single value encoder");
+
+            /* Every integer decodes to the same bits */
+            std::vector<Q> all;
+            for (std::uint32_t q = 0; q <= std::numeric_limits<Q>::max(); ++q)
+                all.push_back(static_cast<Q>(q));
+            std::vector<T> decoded(all.size());
+            Sm::decode_unorm(all.data(), decoded.data(), all.size());
+            same = true;
+            for (std::size_t i = 0; i < all.size(); ++i) {
+                const T single = Sm::decode_unorm<T>(all[i]);
+                same = same && std::memcmp(&single, &decoded[i], sizeof(single)) == 0 &&
+                       Sm::encode_unorm<Q>(single) == all[i];
+            }
+            context.check(same, std::string("decode_unorm<") + std::to_string(8 * sizeof(Q)) + " bit>(" +
+                                type_name<T>() + " array) matches the single value decoder and round trips");
+        }
+
+        template<typename Q, typename T>
+        void snorm(Context &context) {
+            const std::vector<T> values = scalar_inputs<T>(T(-1.25), T(1.25));
+            std::vector<Q> encoded(values.size());
+            Sm::encode_snorm(values.data(), encoded.data(), values.size());
+            bool same = true;
+            for (std::size_t i = 0; i < values.size(); ++i)
+                same = same && encoded[i] == Sm::encode_snorm<Q>(values[i]);
+            context.check(same, std::string("encode_snorm<") + std::to_string(8 * sizeof(Q)) + " bit>(" +
+                                type_name<T>() + " array) matches the single value encoder");
+
+            std::vector<Q> all;
+            for (std::int32_t q = std::numeric_limits<Q>::min(); q <= std::numeric_limits<Q>::max(); ++q)
+                all.push_back(static_cast<Q>(q));
+            std::vector<T> decoded(all.size());
+            Sm::decode_snorm(all.data(), decoded.data(), all.size());
+            same = true;
+            for (std::size_t i = 0; i < all.size(); ++i) {
+                const T single = Sm::decode_snorm<T>(all[i]);
+                /* The most negative integer decodes to -1 like its neighbour, which it re-encodes to */
+                const Q expected = all[i] == std::numeric_limits<Q>::min() ? Q(-std::numeric_limits<Q>::max())
+                                                                           : all[i];
+                same = same && std::memcmp(&single, &decoded[i], sizeof(single)) == 0 &&
+                       Sm::encode_snorm<Q>(single) == expected;
+            }
+            context.check(same, std::string("decode_snorm<") + std::to_string(8 * sizeof(Q)) + " bit>(" +
+                                type_name<T>() + " array) matches the single value decoder and round trips");
+        }
+
+        template<typename T>
+        std::vector<Vector<T, 3>> random_normals(std::size_t count) {
+            /* The axes and the octahedron's edges and corners, where the folds meet, then random directions */
+            std::vector<Vector<T, 3>> normals = {
+                    Vector<T, 3>{T(1), T(0), T(0)}, Vector<T, 3>{T(-1), T(0), T(0)}, Vector<T, 3>{T(0), T(1), T(0)},
+                    Vector<T, 3>{T(0), T(-1), T(0)}, Vector<T, 3>{T(0), T(0), T(1)}, Vector<T, 3>{T(0), T(0), T(-1)},
+                    Vector<T, 3>{T(1), T(1), T(0)}.normalized(), Vector<T, 3>{T(1), T(-1), T(0)}.normalized(),
+                    Vector<T, 3>{T(1), T(1), T(1)}.normalized(), Vector<T, 3>{T(-1), T(-1), T(-1)}.normalized(),
+                    Vector<T, 3>{T(0), T(-1), T(-1)}.normalized(), Vector<T, 3>{T(-1), T(0), T(-1)}.normalized()};
+            while (normals.size() < count) {
+                const Vector<T, 3> v = random_vector<T, 3>(T(-1), T(1));
+                if (Sm::dot(v, v) > T(0.01) && Sm::dot(v, v) <= T(1))
+                    normals.push_back(v.normalized());
+            }
+            return normals;
+        }
+
+        template<typename Q, typename T>
+        void octahedral(Context &context, double maxDegrees) {
+            const std::string name = std::string("octahedral<") + std::to_string(16 * sizeof(Q)) + " bit, " +
+                                     type_name<T>() + ">";
+            const std::vector<Vector<T, 3>> normals = random_normals<T>(100003);
+            std::vector<Vector<Q, 2>> encoded(normals.size());
+            std::vector<Vector<T, 3>> decoded(normals.size());
+            Sm::encode_octahedral(normals.data(), encoded.data(), normals.size());
+            Sm::decode_octahedral(encoded.data(), decoded.data(), encoded.size());
+
+            std::size_t encodeMismatches = 0, decodeMismatches = 0;
+            for (std::size_t i = 0; i < normals.size(); ++i) {
+                const Vector<Q, 2> single = Sm::encode_octahedral<Q>(normals[i]);
+                encodeMismatches += single.x == encoded[i].x && single.y == encoded[i].y ? 0 : 1;
+                const Vector<T, 3> singleDecoded = Sm::decode_octahedral<T>(encoded[i]);
+                decodeMismatches += std::memcmp(&singleDecoded, &decoded[i], sizeof(singleDecoded)) == 0 ? 0 : 1;
+            }
+            context.check(encodeMismatches == 0, name + ": array encoder matches the single one, " +
+                                                 std::to_string(encodeMismatches) + " differ");
+            context.check(decodeMismatches == 0, name + ": array decoder matches the single one, " +
+                                                 std::to_string(decodeMismatches) + " differ");
+
+            const Sm::EncodingError error = Sm::angular_error(normals.data(), decoded.data(), normals.size());
+            context.check(error.max * degrees <= maxDegrees,
+                          name + ": worst error " + std::to_string(error.max * degrees) + " degrees, allowed " +
+                          std::to_string(maxDegrees));
+
+            /* Decoding is exact for the six axes */
+            bool axes = true;
+            for (std::size_t i = 0; i < 6; ++i)
+                axes = axes && max_difference(decoded[i], normals[i]) == 0.0;
+            context.check(axes, name + ": the axes decode exactly");
+        }
+
+        template<std::size_t Bits, typename T>
+        void smallest_three(Context &context, double maxDegrees) {
+            const std::string name = std::string("smallest three<") + std::to_string(Bits) + " bit, " +
+                                     type_name<T>() + ">";
+            std::vector<Quaternion<T>> rotations = {Quaternion<T>{}, Quaternion<T>{T(0), T(0), T(0), T(-1)},
+                                                    Quaternion<T>{T(1), T(0), T(0), T(0)},
+                                                    Quaternion<T>{T(0.5), T(-0.5), T(0.5), T(-0.5)}};
+            while (rotations.size() < 100003)
+                rotations.push_back(random_rotation<T>());
+
+            std::vector<Sm::SmallestThree<Bits>> encoded(rotations.size());
+            std::vector<Quaternion<T>> decoded(rotations.size());
+            Sm::encode_smallest_three<Bits>(rotations.data(), encoded.data(), rotations.size());
+            Sm::decode_smallest_three<Bits>(encoded.data(), decoded.data(), encoded.size());
+
+            std::size_t encodeMismatches = 0, decodeMismatches = 0;
+            for (std::size_t i = 0; i < rotations.size(); ++i) {
+                encodeMismatches += Sm::encode_smallest_three<Bits>(rotations[i]) == encoded[i] ? 0 : 1;
+                const Quaternion<T> single = Sm::decode_smallest_three<Bits, T>(encoded[i]);
+                decodeMismatches += std::memcmp(&single, &decoded[i], sizeof(single)) == 0 ? 0 : 1;
+            }
+            context.check(encodeMismatches == 0, name + ": array encoder matches the single one, " +
+                                                 std::to_string(encodeMismatches) + " differ");
+            context.check(decodeMismatches == 0, name + ": array decoder matches the single one, " +
+                                                 std::to_string(decodeMismatches) + " differ");
+
+            const Sm::EncodingError error = Sm::angular_error(rotations.data(), decoded.data(), rotations.size());
+            context.check(error.max * degrees <= maxDegrees,
+                          name + ": worst error " + std::to_string(error.max * degrees) + " degrees, allowed " +
+                          std::to_string(maxDegrees));
+
+            bool unit = true;
+            for (const auto &q: decoded)
+                unit = unit && std::abs(double(Sm::dot(q, q)) - 1.0) <= tolerance<T>();
+            context.check(unit, name + ": decoded rotations are unit quaternions");
+        }
+
+        template<typename T>
+        void encodings(Context &context) {
+            context.section(std::string("Encoding<") + type_name<T>() + ">");
+            unorm<std::uint8_t, T>(context);
+            unorm<std::uint16_t, T>(context);
+            snorm<std::int8_t, T>(context);
+            snorm<std::int16_t, T>(context);
+
+            /* The worst cases Encoding.h documents, found over far more samples than these */
+            octahedral<std::int8_t, T>(context, 0.64);
+            octahedral<std::int16_t, T>(context, 0.0025);
+            smallest_three<10, T>(context, 0.16);
+            smallest_three<16, T>(context, 0.0025);
+        }
+    }
+
+    void run_encoding_tests(Context &context) {
+        halves(context);
+        encodings<float>(context);
+        encodings<double>(context);
+    }
+}
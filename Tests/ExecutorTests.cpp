@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Test.h"
+#include "Executor.h"
+
+// Sm::parallel_for covers every index exactly once, cuts only where its Partition allows and keeps pieces of at least
+// the grain, for several thread counts, nested calls and exceptions. Sm::parallel_reduce has to give bitwise the same
+// float sum for every thread count, and Sm::cache_partition has to cut on cache lines of the output.
+namespace Test {
+    namespace {
+        const std::size_t threadCounts[] = {1, 2, 3, 4, 8};
+
+        // Every piece parallel_for handed out, and how often each index was visited
+        struct Coverage {
+            explicit Coverage(std::size_t count) : visits(count) {
+                for (auto &visit: visits)
+                    visit.store(0);
+            }
+
+            void add(std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i)
+                    visits[i].fetch_add(1);
+                std::lock_guard<std::mutex> lock{mutex};
+                pieces.emplace_back(begin, end);
+            }
+
+            bool once() const {
+                for (const auto &visit: visits)
+                    if (visit.load() != 1)
+                        return false;
+                return true;
+            }
+
+            std::vector<std::atomic<int>> visits;
+            std::vector<std::pair<std::size_t, std::size_t>> pieces;
+            std::mutex mutex;
+        };
+
+        void coverage(Context &context) {
+            context.section("Sm::parallel_for");
+            const std::size_t counts[] = {0, 1, 2, 7, 64, 1000, 100003};
+            Sm::Partition partitions[3];
+            partitions[1].grain = 64;
+            partitions[2].grain = 48;
+            partitions[2].step = 16;
+            partitions[2].phase = 5;
+
+            for (std::size_t threads: threadCounts) {
+                Executor executor{threads};
+                context.check(executor.threads() == threads, "threads() counts the caller");
+
+                for (std::size_t count: counts)
+                    for (std::size_t p = 0; p < 3; ++p) {
+                        const Sm::Partition &partition = partitions[p];
+                        Coverage seen{count};
+                        Sm::parallel_for(executor, count, [&](std::size_t begin, std::size_t end) {
+                            seen.add(begin, end);
+                        }, partition);
+
+                        /* Cuts at phase + k * step, pieces of at least the grain unless the whole range is shorter */
+                        bool cuts = true, grains = true;
+                        for (const auto &piece: seen.pieces) {
+                            cuts = cuts && (piece.first == 0 || (piece.first >= partition.phase &&
+                                                                 (piece.first - partition.phase) % partition.step == 0));
+                            grains = grains && (piece.second - piece.first >= partition.grain || count < 2 * partition.grain);
+                        }
+
+                        const std::string what = std::to_string(threads) + " threads, " + std::to_string(count) +
+                                                 " indices, grain " + std::to_string(partition.grain) + " step " +
+                                                 std::to_string(partition.step);
+                        context.check(seen.once(), what + ": every index exactly once");
+                        context.check(cuts, what + ": cuts only at phase + k * step");
+                        context.check(grains, what + ": pieces of at least the grain");
+                    }
+
+                /* A parallel_for inside every piece of another one, on the same pool */
+                Coverage nested{64 * 500};
+                Sm::parallel_for(executor, 64, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t outer = begin; outer < end; ++outer)
+                        Sm::parallel_for(executor, 500, [&](std::size_t innerBegin, std::size_t innerEnd) {
+                            nested.add(outer * 500 + innerBegin, outer * 500 + innerEnd);
+                        }, Sm::Partition{50});
+                });
+                context.check(nested.once(), std::to_string(threads) + " threads: nested calls cover every index");
+
+                std::atomic<int> invoked{0};
+                Sm::parallel_invoke(executor, [&] { invoked.fetch_add(1); }, [&] { invoked.fetch_add(10); });
+                context.check(invoked.load() == 11, std::to_string(threads) + " threads: parallel_invoke runs both");
+            }
+        }
+
+        void exceptions(Context &context) {
+            context.section("Sm::parallel_for exceptions");
+            for (std::size_t threads: threadCounts) {
+                Executor executor{threads};
+                const std::string what = std::to_string(threads) + " threads";
+
+                bool caught = false;
+                try {
+                    Sm::parallel_for(executor, 10000, [&](std::size_t begin, std::size_t end) {
+                        if (begin <= 6000 && 6000 < end)
+                            throw std::runtime_error("index 6000");
+                    }, Sm::Partition{100});
+                } catch (const std::runtime_error &error) {
+                    caught = std::string(error.what()) == "index 6000";
+                }
+                context.check(caught, what + ": the body's exception reaches the caller");
+
+                caught = false;
+                try {
+                    Sm::parallel_reduce(executor, 10000, 100, 0, [&](std::size_t begin, std::size_t) -> int {
+                        if (begin == 4200)
+                            throw std::runtime_error("chunk 42");
+                        return 1;
+                    }, [](int lhs, int rhs) { return lhs + rhs; });
+                } catch (const std::runtime_error &error) {
+                    caught = std::string(error.what()) == "chunk 42";
+                }
+                context.check(caught, what + ": the map's exception reaches the caller of parallel_reduce");
+
+                /* The pool is still usable afterwards */
+                Coverage seen{10000};
+                Sm::parallel_for(executor, 10000, [&](std::size_t begin, std::size_t end) { seen.add(begin, end); },
+                                 Sm::Partition{100});
+                context.check(seen.once(), what + ": the pool keeps working after an exception");
+            }
+        }
+
+        void reduction(Context &context) {
+            context.section("Sm::parallel_reduce");
+
+            /* Float sums of values of very different sizes round differently in every order */
+            const std::size_t count = 100003, grain = 1000;
+            std::vector<float> values(count);
+            for (std::size_t i = 0; i < count; ++i)
+                values[i] = random_value<float>(-1, 1) * (i % 17 == 0 ? 1e6f : 1.0f);
+            const auto sum = [&](std::size_t begin, std::size_t end) {
+                float partial = 0;
+                for (std::size_t i = begin; i < end; ++i)
+                    partial += values[i];
+                return partial;
+            };
+            const auto add = [](float lhs, float rhs) { return lhs + rhs; };
+
+            float expected = 0;
+            for (std::size_t begin = 0; begin < count; begin += grain)
+                expected = add(expected, sum(begin, std::min(count, begin + grain)));
+
+            for (std::size_t threads: threadCounts) {
+                Executor executor{threads};
+                bool same = true;
+                for (std::size_t run = 0; run < 5; ++run) {
+                    const float result = Sm::parallel_reduce(executor, count, grain, 0.0f, sum, add);
+                    same = same && std::memcmp(&result, &expected, sizeof(result)) == 0;
+                }
+                context.check(same, std::to_string(threads) + " threads: bitwise the in order chunk sums");
+            }
+
+            Executor executor{4};
+            context.check(Sm::parallel_reduce(executor, 0, grain, 7.0f, sum, add) == 7.0f,
+                          "no indices give the identity");
+            context.check(Sm::parallel_reduce(executor, 5, 0, 0.0f, sum, add) == sum(0, 5),
+                          "grain 0 is treated as 1");
+        }
+
+        void partitions(Context &context) {
+            context.section("Sm::cache_partition");
+            alignas(64) static float floats[256];
+            alignas(64) static double doubles[256];
+
+            /* Lines and simd widths both fit when the offset is a multiple of the width, else only the width */
+            bool lines = true, widths = true;
+            for (std::size_t offset = 0; offset < 16; ++offset)
+                for (std::size_t multiple: {1, 4, 8}) {
+                    const Sm::Partition partition = Sm::cache_partition(floats + offset, 1024, multiple);
+                    const std::uintptr_t cut = reinterpret_cast<std::uintptr_t>(floats + offset + partition.phase);
+                    widths = widths && partition.step % multiple == 0 && partition.phase % multiple == 0 &&
+                             partition.grain % partition.step == 0 && partition.grain * sizeof(float) >= 1024;
+                    if (offset % multiple == 0)
+                        lines = lines && cut % 64 == 0 && partition.step % 16 == 0;
+                    else
+                        lines = lines && partition.step == multiple && partition.phase == 0;
+                }
+            context.check(widths, "float cuts on simd widths with pieces of at least minBytes");
+            context.check(lines, "float cuts on 64 byte lines whenever the simd width allows it");
+
+            const Sm::Partition odd = Sm::cache_partition(doubles + 1, 1024, 2);
+            context.check(odd.phase % 2 == 0 && odd.step % 2 == 0,
+                          "a misaligned double array keeps the simd width and drops the line alignment");
+
+            struct Vec3 {
+                float x, y, z;
+            };
+            alignas(64) static Vec3 vectors[64];
+            const Sm::Partition vec3 = Sm::cache_partition(vectors, 1024);
+            context.check(vec3.step == 16 && vec3.phase == 0, "12 byte elements meet a line every 16 elements");
+        }
+    }
+
+    void run_executor_tests(Context &context) {
+        coverage(context);
+        exceptions(context);
+        reduction(context);
+        partitions(context);
+    }
+}
@@ -0,0 +1,53 @@
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include "Test.h"
+#include "Vector3.h"
+#include "FastMath.h"
+
+// Sm::fast::angle away from unit length, where the squared lengths of both vectors no longer multiply in range, and
+// Sm::fast::sqrt at the ends of its domain.
+namespace Test {
+    namespace {
+        template<typename T>
+        void angle(Context &context) {
+            context.section(std::string("Sm::fast::angle<") + type_name<T>() + ">");
+            const T quarterPi = T(0.785398163397448309616);
+            const T tolerance = T(1e-3);
+
+            for (const T scale: {T(1), T(1e-15), T(1e-12), T(1e12), T(1e15)}) {
+                const Vector<T, 3> lhs{scale, T(0), T(0)};
+                const Vector<T, 3> rhs{scale * T(3), scale * T(3), T(0)};
+                const T angle = Sm::fast::angle(lhs, rhs);
+
+                std::ostringstream what;
+                what << "lengths around " << scale << " give " << angle << ", not pi / 4";
+                context.check(std::abs(angle - quarterPi) <= tolerance, what.str());
+            }
+        }
+
+        // The ends of the domain, where x * rsqrt(x) would be NaN
+        template<typename T>
+        void sqrt(Context &context) {
+            context.section(std::string("Sm::fast::sqrt<") + type_name<T>() + ">");
+            const T inf = std::numeric_limits<T>::infinity();
+            context.check(Sm::fast::sqrt(inf) == inf, "sqrt(+inf) is +inf");
+            context.check(Sm::fast::sqrt(T(0)) == T(0), "sqrt(0) is 0");
+            context.check(Sm::fast::sqrt(T(-1)) == T(0), "sqrt of a negative value is 0");
+            context.check(std::isnan(Sm::fast::sqrt(std::numeric_limits<T>::quiet_NaN())), "sqrt(NaN) is NaN");
+            context.check(std::abs(Sm::fast::sqrt(T(16)) - T(4)) <= T(4) * Sm::fast::rsqrt_max_error<T>(),
+                          "sqrt(16) is 4");
+
+            const T huge = std::numeric_limits<T>::max() / T(2);
+            const Vector<T, 3> overflowing{huge, huge, huge};
+            context.check(Sm::fast::length(overflowing) == inf, "the length of an overflowing vector is +inf");
+        }
+    }
+
+    void run_fast_math_tests(Context &context) {
+        angle<float>(context);
+        angle<double>(context);
+        sqrt<float>(context);
+        sqrt<double>(context);
+    }
+}
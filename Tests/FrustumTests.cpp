@@ -0,0 +1,150 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Test.h"
+#include "Frustum.h"
+
+// The cull_spheres and cull_aabbs batches, AoS and VectorArray, against the Frustum member functions they have to
+// match exactly. The scenes mix objects inside, outside, straddling a plane and touching one, and the frustums come
+// from perspective view projections in both clip depth conventions.
+namespace Test {
+    namespace {
+        // Perspective looking down -z of the camera, which sits at eye rotated by view
+        template<typename T>
+        Matrix<T, 4, 4> view_projection(Sm::ClipDepth depth, const Vector<T, 3> &eye, const Quaternion<T> &view) {
+            const T nearPlane = T(0.5), farPlane = T(40), focal = T(1) / std::tan(T(0.6));
+            Matrix<T, 4, 4> projection;
+            projection(0, 0) = focal / T(16.0 / 9.0);
+            projection(1, 1) = focal;
+            if (depth == Sm::ClipDepth::ZeroToOne) {
+                projection(2, 2) = farPlane / (nearPlane - farPlane);
+                projection(2, 3) = farPlane * nearPlane / (nearPlane - farPlane);
+            } else {
+                projection(2, 2) = (farPlane + nearPlane) / (nearPlane - farPlane);
+                projection(2, 3) = T(2) * farPlane * nearPlane / (nearPlane - farPlane);
+            }
+            projection(3, 2) = T(-1);
+            projection(3, 3) = T(0);
+
+            /* The inverse of the camera transform, transposed rotation and rotated negative eye */
+            const Matrix<T, 3, 3> rotation = view.ToMatrix3().transposed();
+            Matrix<T, 4, 4> world;
+            for (std::size_t r = 0; r < 3; ++r) {
+                world(r, 3) = -(rotation(r, 0) * eye.x + rotation(r, 1) * eye.y + rotation(r, 2) * eye.z);
+                for (std::size_t c = 0; c < 3; ++c)
+                    world(r, c) = rotation(r, c);
+            }
+            return projection * world;
+        }
+
+        template<typename T>
+        struct Scene {
+            std::vector<Vector<T, 3>> centers, mins, maxs;
+            std::vector<T> radii;
+        };
+
+        // Random objects around the camera, every fourth sphere moved just outside a plane so it touches it exactly
+        template<typename T>
+        Scene<T> random_scene(const Frustum<T> &frustum, const Vector<T, 3> &ahead, std::size_t count) {
+            Scene<T> scene;
+            for (std::size_t i = 0; i < count; ++i) {
+                Vector<T, 3> center = random_vector<T, 3>(T(-30), T(30));
+                const Vector<T, 3> extent = random_vector<T, 3>(T(0), T(4));
+                T radius = std::sqrt(extent.x * extent.x + extent.y * extent.y + extent.z * extent.z);
+                if (i % 4 == 3) {
+                    const Plane<T> &plane = frustum.planes[(i / 4) % Frustum<T>::planeCount];
+                    center = ahead + random_vector<T, 3>(T(-1), T(1));
+                    center = center - plane.normal() * (plane.distance(center) + radius);
+                    radius = -plane.distance(center);
+                }
+
+                scene.centers.push_back(center);
+                scene.radii.push_back(radius);
+                scene.mins.push_back(center - extent);
+                scene.maxs.push_back(center + extent);
+            }
+            return scene;
+        }
+
+        template<typename T, typename Visible>
+        bool same_indices(std::size_t count, std::size_t written, const std::vector<std::uint32_t> &indices,
+                          Visible &&visible) {
+            std::size_t expected = 0;
+            for (std::size_t i = 0; i < count; ++i) {
+                if (!visible(i))
+                    continue;
+                if (expected >= written || indices[expected] != i)
+                    return false;
+                ++expected;
+            }
+            return expected == written;
+        }
+
+        template<typename T>
+        void culling(Context &context, Sm::ClipDepth depth) {
+            const std::string clip = depth == Sm::ClipDepth::ZeroToOne ? "ZeroToOne" : "NegativeOneToOne";
+            context.section(std::string("Sm::cull_*<") + type_name<T>() + "> " + clip);
+
+            for (std::size_t round = 0; round < 8; ++round) {
+                const Vector<T, 3> eye = round == 0 ? Vector<T, 3>{} : random_vector<T, 3>();
+                const Quaternion<T> view = round == 0 ? Quaternion<T>{} : random_rotation<T>();
+                const Frustum<T> frustum{view_projection(depth, eye, view), depth};
+                const Vector<T, 3> ahead = eye + Sm::operator*(view.ToMatrix3(), Vector<T, 3>{T(0), T(0), T(-10)});
+
+                /* Every count up to a few packs covers the packs and the scalar tail, the last scene is large */
+                for (std::size_t count = 0; count <= 20; ++count) {
+                    const std::size_t objects = count == 20 ? 1000 : count;
+                    const Scene<T> scene = random_scene(frustum, ahead, objects);
+                    const VectorArray<T, 3> centers{scene.centers.data(), objects};
+                    const VectorArray<T, 3> mins{scene.mins.data(), objects}, maxs{scene.maxs.data(), objects};
+                    const std::string what = "round " + std::to_string(round) + ", " + std::to_string(objects) +
+                                             " objects";
+
+                    const auto sphere = [&](std::size_t i) {
+                        return frustum.intersects_sphere(scene.centers[i], scene.radii[i]);
+                    };
+                    const auto box = [&](std::size_t i) {
+                        return frustum.intersects_aabb(scene.mins[i], scene.maxs[i]);
+                    };
+
+                    std::vector<std::uint32_t> visible(objects);
+                    std::size_t written = Sm::cull_spheres(frustum, scene.centers.data(), scene.radii.data(),
+                                                           objects, visible.data());
+                    context.check(same_indices<T>(objects, written, visible, sphere),
+                                  what + ": cull_spheres matches intersects_sphere");
+                    written = Sm::cull_spheres(frustum, centers, scene.radii.data(), visible.data());
+                    context.check(same_indices<T>(objects, written, visible, sphere),
+                                  what + ": cull_spheres(VectorArray) matches intersects_sphere");
+
+                    written = Sm::cull_aabbs(frustum, scene.mins.data(), scene.maxs.data(), objects, visible.data());
+                    context.check(same_indices<T>(objects, written, visible, box),
+                                  what + ": cull_aabbs matches intersects_aabb");
+                    written = Sm::cull_aabbs(frustum, mins, maxs, visible.data());
+                    context.check(same_indices<T>(objects, written, visible, box),
+                                  what + ": cull_aabbs(VectorArray) matches intersects_aabb");
+                }
+            }
+
+            /* Looking down -z from the origin: in front is visible, behind and past the far plane is not */
+            const Frustum<T> frustum{view_projection(depth, Vector<T, 3>{}, Quaternion<T>{}), depth};
+            const Vector<T, 3> centers[4] = {Vector<T, 3>{T(0), T(0), T(-5)}, Vector<T, 3>{T(0), T(0), T(5)},
+                                             Vector<T, 3>{T(0), T(0), T(-50)}, Vector<T, 3>{T(0), T(0), T(-0.5)}};
+            const T radii[4] = {T(1), T(1), T(1), T(0)};
+            std::uint32_t visible[4];
+            const std::size_t written = Sm::cull_spheres(frustum, centers, radii, 4, visible);
+            context.check(written == 2 && visible[0] == 0 && visible[1] == 3,
+                          "in front, on the near plane and not behind or past the far plane");
+            context.check(frustum.contains(centers[0]) && !frustum.contains(centers[1]) &&
+                          !frustum.contains(centers[2]), "Frustum::contains agrees");
+        }
+    }
+
+    void run_frustum_tests(Context &context) {
+        culling<float>(context, Sm::ClipDepth::NegativeOneToOne);
+        culling<float>(context, Sm::ClipDepth::ZeroToOne);
+        culling<double>(context, Sm::ClipDepth::NegativeOneToOne);
+        culling<double>(context, Sm::ClipDepth::ZeroToOne);
+    }
+}
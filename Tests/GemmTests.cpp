@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "Test.h"
+#include "DynamicMatrix.h"
+
+// The blocked product behind DynamicMatrix against a plain triple loop, for shapes that leave ragged micro tiles and
+// cross the KC, MC and NC block sizes. Serial and threaded runs, and runs after larger or smaller products have used
+// the per thread packing buffers, have to give bitwise the same result.
+namespace Test {
+    namespace {
+        template<typename T>
+        DynamicMatrix<T> random_dynamic(std::size_t rows, std::size_t columns) {
+            DynamicMatrix<T> m{rows, columns};
+            for (std::size_t i = 0; i < m.elements(); ++i)
+                m[i] = random_value<T>(T(-1), T(1));
+            return m;
+        }
+
+        template<typename T>
+        double naive_error(const DynamicMatrix<T> &a, const DynamicMatrix<T> &b, const DynamicMatrix<T> &c) {
+            double worst = 0;
+            for (std::size_t r = 0; r < a.rows(); ++r)
+                for (std::size_t col = 0; col < b.columns(); ++col) {
+                    double sum = 0;
+                    for (std::size_t p = 0; p < a.columns(); ++p)
+                        sum += double(a(r, p)) * double(b(p, col));
+                    worst = std::max(worst, std::abs(sum - double(c(r, col))));
+                }
+            return worst;
+        }
+
+        template<typename T>
+        bool same_bits(const DynamicMatrix<T> &lhs, const DynamicMatrix<T> &rhs) {
+            return lhs.rows() == rhs.rows() && lhs.columns() == rhs.columns() &&
+                   (lhs.elements() == 0 || std::memcmp(lhs.ptr(), rhs.ptr(), lhs.elements() * sizeof(T)) == 0);
+        }
+
+        template<typename T>
+        void products(Context &context) {
+            context.section(std::string("Sm::multiply(DynamicMatrix)<") + type_name<T>() + ">");
+            struct Shape {
+                std::size_t m, n, k;
+            };
+            const Shape shapes[] = {{1, 1, 1}, {7, 5, 3}, {6, 16, 256}, {97, 131, 300}, {200, 40, 9},
+                                    {13, 2100, 20}, {0, 4, 4}, {4, 4, 0}};
+
+            Executor executor{4};
+            for (const Shape &shape: shapes) {
+                const DynamicMatrix<T> a = random_dynamic<T>(shape.m, shape.k), b = random_dynamic<T>(shape.k, shape.n);
+                const std::string what = std::to_string(shape.m) + " x " + std::to_string(shape.k) + " times " +
+                                         std::to_string(shape.k) + " x " + std::to_string(shape.n);
+
+                Sm::GemmOptions serialOptions;
+                serialOptions.parallelThreshold = static_cast<std::size_t>(-1);
+                DynamicMatrix<T> serial;
+                Sm::multiply(a, b, serial, serialOptions);
+                check_near(context, naive_error(a, b, serial), 0.0, tolerance<T>() * double(shape.k + 1),
+                           what + ": the plain triple loop");
+
+                Sm::GemmOptions threadedOptions;
+                threadedOptions.parallelThreshold = 0;
+                threadedOptions.executor = &executor;
+                DynamicMatrix<T> threaded;
+                Sm::multiply(a, b, threaded, threadedOptions);
+                context.check(same_bits(threaded, serial), what + ": threaded slabs match the serial product");
+
+                /* The buffers now hold the packed blocks of other products */
+                const DynamicMatrix<T> other = random_dynamic<T>(300, 300);
+                DynamicMatrix<T> discard, again;
+                Sm::multiply(other, other, discard, serialOptions);
+                Sm::multiply(a, b, again, serialOptions);
+                context.check(same_bits(again, serial), what + ": the same after a larger product");
+            }
+        }
+    }
+
+    void run_gemm_tests(Context &context) {
+        products<float>(context);
+        products<double>(context);
+    }
+}
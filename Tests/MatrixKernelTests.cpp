@@ -0,0 +1,119 @@
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include "Test.h"
+#include "MatrixKernels.h"
+
+// The SIMD multiply kernels against the scalar templates on random inputs.
+// MatrixKernels.h accumulates in the scalar order, so every element has to match within maxUlps, which is 0: the
+// results are bitwise equal. The reference loops are the generic templates written out, the specializations hide
+// them for these sizes. Which kernels run depends on the target: SSE2 in SlimeMathsTests, the AVX versions in
+// SlimeMathsTestsAvx.
+namespace Test {
+    namespace {
+        const std::uint64_t maxUlps = 0;
+        const std::size_t rounds = 1000;
+
+        template<typename T, std::size_t Rows, std::size_t Cols>
+        void matrix_vector_reference(T *out, const T *mat, const T *vec) {
+            for (std::size_t r = 0; r < Rows; ++r) {
+                T sum = T(0);
+                for (std::size_t c = 0; c < Cols; ++c)
+                    sum += mat[r * Cols + c] * vec[c];
+                out[r] = sum;
+            }
+        }
+
+        template<typename T, std::size_t Rows, std::size_t Cols>
+        void vector_matrix_reference(T *out, const T *vec, const T *mat) {
+            for (std::size_t c = 0; c < Cols; ++c) {
+                T sum = T(0);
+                for (std::size_t r = 0; r < Rows; ++r)
+                    sum += mat[r * Cols + c] * vec[r];
+                out[c] = sum;
+            }
+        }
+
+        template<typename T, std::size_t Count>
+        void randomize(T (&values)[Count]) {
+            for (T &value: values)
+                value = random_value<T>();
+        }
+
+        // One check per round, failing on the first element further than maxUlps from the reference
+        template<typename T, std::size_t Count>
+        void compare(Context &context, const T (&kernel)[Count], const T (&reference)[Count], std::size_t round) {
+            for (std::size_t e = 0; e < Count; ++e) {
+                const std::uint64_t ulps = ulp_distance(kernel[e], reference[e]);
+                if (ulps > maxUlps) {
+                    std::ostringstream what;
+                    what.precision(17);
+                    what << "round " << round << " element " << e << ": kernel " << kernel[e] << ", scalar "
+                         << reference[e] << " (" << ulps << " ulps)";
+                    context.check(false, what.str());
+                    return;
+                }
+            }
+            context.check(true, "");
+        }
+
+        template<typename T, std::size_t Rows, std::size_t ColsRows, std::size_t Cols>
+        void matrix_multiply(Context &context) {
+            context.section(std::string("MatrixMultiplyKernel<") + type_name<T>() + ", " + std::to_string(Rows) +
+                            ", " + std::to_string(ColsRows) + ", " + std::to_string(Cols) + ">");
+            for (std::size_t round = 0; round < rounds; ++round) {
+                T lhs[Rows * ColsRows], rhs[ColsRows * Cols], kernel[Rows * Cols], reference[Rows * Cols];
+                randomize(lhs);
+                randomize(rhs);
+                Sm::detail::MatrixMultiplyKernel<T, Rows, ColsRows, Cols>::apply(kernel, lhs, rhs);
+                Sm::detail::MatrixMultiplyScalar<T, Rows, ColsRows, Cols>::apply(reference, lhs, rhs);
+                compare(context, kernel, reference, round);
+            }
+        }
+
+        template<typename T, std::size_t Rows, std::size_t Cols>
+        void matrix_vector(Context &context) {
+            context.section(std::string("MatrixVectorKernel<") + type_name<T>() + ", " + std::to_string(Rows) + ", " +
+                            std::to_string(Cols) + ">");
+            for (std::size_t round = 0; round < rounds; ++round) {
+                T mat[Rows * Cols], vec[Cols], kernel[Rows], reference[Rows];
+                randomize(mat);
+                randomize(vec);
+                Sm::detail::MatrixVectorKernel<T, Rows, Cols>::apply(kernel, mat, vec);
+                matrix_vector_reference<T, Rows, Cols>(reference, mat, vec);
+                compare(context, kernel, reference, round);
+            }
+        }
+
+        template<typename T, std::size_t Rows, std::size_t Cols>
+        void vector_matrix(Context &context) {
+            context.section(std::string("VectorMatrixKernel<") + type_name<T>() + ", " + std::to_string(Rows) + ", " +
+                            std::to_string(Cols) + ">");
+            for (std::size_t round = 0; round < rounds; ++round) {
+                T vec[Rows], mat[Rows * Cols], kernel[Cols], reference[Cols];
+                randomize(vec);
+                randomize(mat);
+                Sm::detail::VectorMatrixKernel<T, Rows, Cols>::apply(kernel, vec, mat);
+                vector_matrix_reference<T, Rows, Cols>(reference, vec, mat);
+                compare(context, kernel, reference, round);
+            }
+        }
+    }
+
+    void run_matrix_kernel_tests(Context &context) {
+        /* Every specialization in MatrixKernels.h, plus a generic size as a sanity check of the references */
+        matrix_multiply<float, 4, 4, 4>(context);
+        matrix_multiply<float, 3, 3, 3>(context);
+        matrix_multiply<double, 4, 4, 4>(context);
+        matrix_multiply<float, 2, 3, 4>(context);
+
+        matrix_vector<float, 4, 4>(context);
+        matrix_vector<float, 3, 3>(context);
+        matrix_vector<double, 4, 4>(context);
+        matrix_vector<double, 3, 3>(context);
+
+        vector_matrix<float, 4, 4>(context);
+        vector_matrix<float, 3, 3>(context);
+        vector_matrix<double, 4, 4>(context);
+    }
+}
@@ -0,0 +1,38 @@
+#include <limits>
+#include "Test.h"
+#include "Matrix.h"
+
+// Matrix::try_inverse on the determinants it has to refuse: zero, within epsilon and NaN.
+namespace Test {
+    namespace {
+        template<typename T>
+        void try_inverse(Context &context) {
+            using M4 = Matrix<T, 4, 4>;
+            context.section(std::string("Matrix::try_inverse<") + type_name<T>() + ">");
+
+            M4 scaled;
+            scaled(0, 0) = T(-2);
+            M4 inverse;
+            context.check(scaled.try_inverse(inverse) && inverse(0, 0) == T(-0.5),
+                          "a negative determinant inverts");
+
+            M4 singular;
+            singular(1, 1) = T(0);
+            context.check(!singular.try_inverse(inverse), "a zero determinant is refused");
+
+            M4 small;
+            small(2, 2) = T(1e-3);
+            context.check(!small.try_inverse(inverse, T(1e-2)), "a determinant within epsilon is refused");
+
+            M4 invalid;
+            invalid(3, 3) = std::numeric_limits<T>::quiet_NaN();
+            context.check(!invalid.try_inverse(inverse), "a NaN determinant is refused");
+            context.check(!invalid.try_inverse(inverse, T(1)), "a NaN determinant is refused with an epsilon");
+        }
+    }
+
+    void run_matrix_tests(Context &context) {
+        try_inverse<float>(context);
+        try_inverse<double>(context);
+    }
+}
@@ -0,0 +1,228 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "Test.h"
+#include "Dispatch.h"
+#include "Encoding.h"
+#include "Frustum.h"
+#include "QuaternionBlend.h"
+#include "QuaternionConversion.h"
+#include "Ray.h"
+#include "Skinning.h"
+#include "Svd.h"
+#include "SymmetricEigen.h"
+#include "Trs.h"
+
+// The batches written with the simd packs run under every instruction set Sm::force_isa can select, and each has to
+// give the bits of the scalar run: VectorArray, slerp, palettes, skinning, culling, encodings, rays, eigen, SVD and TRS.
+namespace Test {
+    namespace {
+        template<typename T>
+        struct Inputs {
+            std::vector<Vector<T, 3>> points, mins, maxs;
+            std::vector<Quaternion<T>> from, to;
+            std::vector<T> radii, t, weights;
+            std::vector<std::uint16_t> indices;
+            std::vector<Matrix<T, 3, 3>> matrices, symmetric;
+            std::vector<DualQuaternion<T>> bones;
+            std::vector<Ray<T>> rays;
+        };
+
+        template<typename T>
+        Inputs<T> random_inputs(std::size_t count) {
+            Inputs<T> in;
+            for (std::size_t i = 0; i < count; ++i) {
+                const Vector<T, 3> corner = random_vector<T, 3>(T(-2), T(2)), extent = random_vector<T, 3>(T(0), T(1));
+                in.points.push_back(random_vector<T, 3>(T(-2), T(2)));
+                in.mins.push_back(corner);
+                in.maxs.push_back(corner + extent);
+                in.from.push_back(random_rotation<T>());
+                in.to.push_back(random_rotation<T>());
+                in.radii.push_back(random_value<T>(T(0), T(1)));
+                in.t.push_back(random_value<T>(T(0), T(1)));
+
+                const Matrix<T, 3, 3> m = random_matrix<T, 3, 3>();
+                in.matrices.push_back(m);
+                in.symmetric.push_back(m + m.transposed());
+
+                T total = T(0);
+                for (std::size_t k = 0; k < Sm::skinInfluences; ++k) {
+                    in.weights.push_back(random_value<T>(T(0.1), T(1)));
+                    in.indices.push_back(static_cast<std::uint16_t>((i + k) % count));
+                    total += in.weights.back();
+                }
+                for (std::size_t k = 0; k < Sm::skinInfluences; ++k)
+                    in.weights[in.weights.size() - 1 - k] /= total;
+                in.bones.push_back(DualQuaternion<T>{random_rotation<T>(), random_vector<T, 3>()});
+            }
+            for (std::size_t lane = 0; lane < 8; ++lane)
+                in.rays.push_back(Ray<T>{random_vector<T, 3>(T(-1), T(1)) - Vector<T, 3>{T(0), T(0), T(4)},
+                                         Vector<T, 3>{T(0), T(0), T(1)}});
+            return in;
+        }
+
+        template<typename T>
+        struct Outputs {
+            std::vector<T> lengths;
+            std::vector<Quaternion<T>> slerped, polar, smallestThree;
+            std::vector<Matrix<T, 3, 4>> palette;
+            std::vector<Vector<T, 3>> skinned, octahedral;
+            std::vector<std::uint32_t> visible;
+            std::vector<Matrix<T, 4, 4>> composed;
+            std::vector<Svd<T>> svds;
+            std::vector<SymmetricEigen<T>> eigen;
+            std::vector<int> packetHits;
+            std::vector<T> rayDistances;
+            VectorArray<T, 3> normalized, translations, scales;
+            VectorArray<T, 4> rotations;
+        };
+
+        template<typename T>
+        Outputs<T> run_batches(const Inputs<T> &in) {
+            const std::size_t count = in.points.size();
+            Outputs<T> out;
+
+            out.normalized = VectorArray<T, 3>(count);
+            for (std::size_t i = 0; i < count; ++i)
+                out.normalized.set(i, in.points[i]);
+            out.lengths.resize(count);
+            Sm::length(out.normalized, out.lengths.data());
+            Sm::normalize(out.normalized);
+
+            out.slerped.resize(count);
+            Sm::slerp(in.from.data(), in.to.data(), in.t.data(), out.slerped.data(), count);
+            out.palette.resize(count);
+            Sm::compose_palette(in.from.data(), in.points.data(), out.palette.data(), count);
+            out.skinned.resize(count);
+            Sm::skin(in.bones.data(), in.indices.data(), in.weights.data(), in.points.data(), out.skinned.data(),
+                     count);
+
+            const Frustum<T> frustum{Matrix<T, 4, 4>{}};
+            out.visible.resize(2 * count);
+            const std::size_t spheres = Sm::cull_spheres(frustum, in.points.data(), in.radii.data(), count,
+                                                         out.visible.data());
+            const std::size_t boxes = Sm::cull_aabbs(frustum, in.mins.data(), in.maxs.data(), count,
+                                                     out.visible.data() + spheres);
+            out.visible.resize(spheres + boxes);
+
+            std::vector<Vector<T, 3>> normals(count);
+            for (std::size_t i = 0; i < count; ++i)
+                normals[i] = out.normalized.get(i);
+            std::vector<Vector<std::int16_t, 2>> octahedral(count);
+            Sm::encode_octahedral(normals.data(), octahedral.data(), count);
+            out.octahedral.resize(count);
+            Sm::decode_octahedral(octahedral.data(), out.octahedral.data(), count);
+            std::vector<Sm::SmallestThree<10>> smallestThree(count);
+            Sm::encode_smallest_three(in.from.data(), smallestThree.data(), count);
+            out.smallestThree.resize(count);
+            Sm::decode_smallest_three(smallestThree.data(), out.smallestThree.data(), count);
+
+            /* Rays against the boxes as triangles, a packet of 8 and one of 4 against each of the first triangles */
+            Ray<T> ray = in.rays[0];
+            RayHit<T> hit;
+            Sm::intersect_triangles(ray, in.mins.data(), in.maxs.data(), in.points.data(), count, hit);
+            out.rayDistances.push_back(ray.tMax);
+            out.rayDistances.push_back(T(Sm::occluded_triangles(in.rays[1], in.mins.data(), in.maxs.data(),
+                                                                in.points.data(), count)));
+            std::vector<std::uint32_t> boxHits(count);
+            std::vector<T> distances(count);
+            const std::size_t hits = Sm::intersect_aabbs(in.rays[2], in.mins.data(), in.maxs.data(), count,
+                                                         boxHits.data(), distances.data());
+            out.rayDistances.insert(out.rayDistances.end(), distances.begin(), distances.begin() + hits);
+            const RayPacket<T, 8> wide{in.rays.data()};
+            const RayPacket<T, 4> narrow{in.rays.data()};
+            for (std::size_t i = 0; i < count && i < 8; ++i) {
+                out.packetHits.push_back(Sm::intersect_triangle(wide, in.mins[i], in.maxs[i], in.points[i]));
+                out.packetHits.push_back(Sm::intersect_triangle(narrow, in.mins[i], in.maxs[i], in.points[i]));
+            }
+
+            out.eigen.resize(count);
+            Sm::eigen_symmetric(in.symmetric.data(), out.eigen.data(), count);
+            out.svds.resize(count);
+            Sm::svd(in.matrices.data(), out.svds.data(), count);
+            out.polar.resize(count);
+            Sm::polar_rotation(in.matrices.data(), out.polar.data(), count);
+
+            out.composed.resize(count);
+            VectorArray<T, 3> translations(count), scales(count);
+            VectorArray<T, 4> rotations(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                translations.set(i, in.points[i]);
+                scales.set(i, in.mins[i]);
+                rotations.set(i, Vector<T, 4>{in.from[i].x, in.from[i].y, in.from[i].z, in.from[i].w});
+            }
+            Sm::compose_trs(translations, rotations, scales, out.composed.data());
+            Sm::decompose_trs(out.composed.data(), count, out.translations, out.rotations, out.scales);
+            return out;
+        }
+
+        template<typename V>
+        bool same_bits(const std::vector<V> &lhs, const std::vector<V> &rhs) {
+            return lhs.size() == rhs.size() && (lhs.empty() || std::memcmp(lhs.data(), rhs.data(),
+                                                                           lhs.size() * sizeof(V)) == 0);
+        }
+
+        template<typename T, std::size_t N>
+        bool same_bits(const VectorArray<T, N> &lhs, const VectorArray<T, N> &rhs) {
+            if (lhs.size() != rhs.size())
+                return false;
+            for (std::size_t k = 0; k < N; ++k)
+                if (lhs.size() && std::memcmp(lhs.component(k), rhs.component(k), lhs.size() * sizeof(T)) != 0)
+                    return false;
+            return true;
+        }
+
+        template<typename T>
+        void compare(Context &context, const Outputs<T> &out, const Outputs<T> &scalar, const std::string &what) {
+            context.check(same_bits(out.lengths, scalar.lengths) && same_bits(out.normalized, scalar.normalized),
+                          what + ": VectorArray length and normalize");
+            context.check(same_bits(out.slerped, scalar.slerped), what + ": slerp");
+            context.check(same_bits(out.palette, scalar.palette), what + ": compose_palette");
+            context.check(same_bits(out.skinned, scalar.skinned), what + ": skin");
+            context.check(same_bits(out.visible, scalar.visible), what + ": cull_spheres and cull_aabbs");
+            context.check(same_bits(out.octahedral, scalar.octahedral) &&
+                          same_bits(out.smallestThree, scalar.smallestThree), what + ": encodings");
+            context.check(same_bits(out.rayDistances, scalar.rayDistances) &&
+                          same_bits(out.packetHits, scalar.packetHits), what + ": rays and ray packets");
+            context.check(same_bits(out.eigen, scalar.eigen), what + ": eigen_symmetric");
+            context.check(same_bits(out.svds, scalar.svds) && same_bits(out.polar, scalar.polar),
+                          what + ": svd and polar_rotation");
+            context.check(same_bits(out.composed, scalar.composed) &&
+                          same_bits(out.translations, scalar.translations) &&
+                          same_bits(out.rotations, scalar.rotations) && same_bits(out.scales, scalar.scales),
+                          what + ": compose_trs and decompose_trs");
+        }
+
+        template<typename T>
+        void dispatched(Context &context) {
+            context.section(std::string("simd pack dispatch<") + type_name<T>() + ">");
+
+            /* Counts around the pack widths cover the packs and the scalar tails */
+            const std::size_t counts[] = {1, 3, 4, 7, 8, 9, 17, 100};
+            const Sm::Isa isas[] = {Sm::Isa::Scalar, Sm::Isa::Sse2, Sm::Isa::Avx2, Sm::Isa::Avx512};
+            for (std::size_t count: counts) {
+                const Inputs<T> in = random_inputs<T>(count);
+                Sm::force_isa(Sm::Isa::Scalar);
+                const Outputs<T> scalar = run_batches(in);
+
+                Sm::Isa previous = Sm::Isa::Scalar;
+                for (Sm::Isa isa: isas) {
+                    const Sm::Isa active = Sm::force_isa(isa);
+                    if (active == previous)
+                        continue;
+                    previous = active;
+                    compare(context, run_batches(in), scalar,
+                            std::string(Sm::isa_name(active)) + ", " + std::to_string(count) + " items");
+                }
+            }
+            Sm::reset_isa();
+        }
+    }
+
+    void run_pack_dispatch_tests(Context &context) {
+        dispatched<float>(context);
+        dispatched<double>(context);
+    }
+}
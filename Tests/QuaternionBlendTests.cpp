@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "Test.h"
+#include "QuaternionBlend.h"
+
+// The batch slerp in both modes against the single quaternion Sm::slerp, within the documented error bounds, and
+// SlerpMode::Accurate bitwise against Sm::fast::slerp, which runs the same trig kernels one quaternion at a time.
+namespace Test {
+    namespace {
+        template<typename T>
+        double length(const Quaternion<T> &q) {
+            return std::sqrt(double(q.x) * q.x + double(q.y) * q.y + double(q.z) * q.z + double(q.w) * q.w);
+        }
+
+        // Rotation angle between two quaternions, whatever their lengths, q and -q are the same rotation.
+        // atan2 of the chord lengths stays accurate for tiny angles where acos of the dot product does not
+        template<typename T>
+        double rotation_angle(const Quaternion<T> &lhs, const Quaternion<T> &rhs) {
+            const double sign = Sm::dot(lhs, rhs) < T(0) ? -1.0 : 1.0;
+            const double lhsLength = length(lhs), rhsLength = length(rhs);
+            double minus = 0, plus = 0;
+            for (std::size_t i = 0; i < 4; ++i) {
+                const double a = lhs[i] / lhsLength, b = sign * double(rhs[i]) / rhsLength;
+                minus += (a - b) * (a - b);
+                plus += (a + b) * (a + b);
+            }
+            return 4.0 * std::atan2(std::sqrt(minus), std::sqrt(plus));
+        }
+
+        // Random pairs, every third one less than 0.02 apart and every fifth one in opposite hemispheres
+        template<typename T>
+        void random_pairs(std::size_t count, std::vector<Quaternion<T>> &from, std::vector<Quaternion<T>> &to,
+                          std::vector<T> &t) {
+            from.resize(count);
+            to.resize(count);
+            t.resize(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                from[i] = random_rotation<T>();
+                to[i] = random_rotation<T>();
+                if (i % 3 == 1) {
+                    const T nudge = std::pow(T(10), random_value<T>(T(-6), T(-2)));
+                    const Quaternion<T> &q = from[i], &r = to[i];
+                    to[i] = Quaternion<T>{q.x + nudge * r.x, q.y + nudge * r.y, q.z + nudge * r.z,
+                                          q.w + nudge * r.w}.Normalized();
+                }
+                if (i % 5 == 2)
+                    to[i] = Quaternion<T>{-to[i].x, -to[i].y, -to[i].z, -to[i].w};
+                t[i] = random_value<T>(T(0), T(1));
+            }
+            if (count > 0)
+                t[0] = T(0);
+            if (count > 1)
+                t[count - 1] = T(1);
+        }
+
+        template<typename T>
+        bool same_bits(const std::vector<Quaternion<T>> &lhs, const std::vector<Quaternion<T>> &rhs) {
+            return lhs.size() == rhs.size() &&
+                   (lhs.empty() || std::memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(lhs[0])) == 0);
+        }
+
+        template<typename T>
+        void accurate(Context &context) {
+            context.section(std::string("Sm::slerp(batch, Accurate)<") + type_name<T>() + ">");
+
+            /* Every count up to a few packs covers the packs and the scalar tail, the last batch is large */
+            for (std::size_t count = 0; count <= 20; ++count) {
+                const std::size_t size = count == 20 ? 2000 : count;
+                std::vector<Quaternion<T>> from, to, perElement(size), broadcast(size), single(size);
+                std::vector<T> t;
+                random_pairs(size, from, to, t);
+                const T shared = random_value<T>(T(0), T(1));
+
+                Sm::slerp(from.data(), to.data(), t.data(), perElement.data(), size);
+                Sm::slerp(from.data(), to.data(), shared, broadcast.data(), size, Sm::SlerpMode::Accurate);
+
+                bool sameFast = true;
+                double error = 0, unit = 0;
+                for (std::size_t i = 0; i < size; ++i) {
+                    single[i] = Sm::fast::slerp(from[i], to[i], shared);
+                    const Quaternion<T> fast = Sm::fast::slerp(from[i], to[i], t[i]);
+                    sameFast = sameFast && std::memcmp(&fast, &perElement[i], sizeof(fast)) == 0;
+                    error = std::max(error, rotation_angle(perElement[i], Sm::slerp(from[i], to[i], t[i])));
+                    error = std::max(error, rotation_angle(broadcast[i], Sm::slerp(from[i], to[i], shared)));
+                    unit = std::max(unit, std::max(std::abs(length(perElement[i]) - 1.0),
+                                                   std::abs(length(broadcast[i]) - 1.0)));
+                }
+                const std::string what = std::to_string(size) + " pairs";
+                context.check(sameFast && same_bits(broadcast, single), what + ": bitwise Sm::fast::slerp");
+                check_near(context, error, 0.0, double(Sm::slerp_accurate_max_error<T>()),
+                           what + ": within slerp_accurate_max_error of Sm::slerp");
+                check_near(context, unit, 0.0, double(Sm::slerp_accurate_max_error<T>()),
+                           what + ": within slerp_accurate_max_error of unit length");
+            }
+
+            /* The ends of the blend and the hemisphere flip */
+            const Quaternion<T> from = random_rotation<T>(), to = random_rotation<T>();
+            const Quaternion<T> flipped{-to.x, -to.y, -to.z, -to.w};
+            const Quaternion<T> ends[2] = {from, from};
+            const Quaternion<T> targets[2] = {to, flipped};
+            const T ts[2] = {T(0), T(1)};
+            Quaternion<T> out[2];
+            Sm::slerp(ends, targets, ts, out, 2);
+            check_near(context, out[0], from, tolerance<T>(), "t = 0 gives from");
+            context.check(rotation_angle(out[1], to) <= Sm::slerp_accurate_max_error<T>(),
+                          "t = 1 gives the rotation of to, whatever its hemisphere");
+            context.check(Sm::dot(out[1], from) >= T(0), "the result stays in the hemisphere of from");
+        }
+
+        template<typename T>
+        void fast(Context &context) {
+            context.section(std::string("Sm::slerp(batch, Fast)<") + type_name<T>() + ">");
+            std::vector<Quaternion<T>> from, to;
+            std::vector<T> t;
+            random_pairs(5000, from, to, t);
+
+            std::vector<Quaternion<T>> all(from.size());
+            Sm::slerp(from.data(), to.data(), t.data(), all.data(), from.size(), Sm::SlerpMode::Fast);
+            double error = 0, unit = 0;
+            for (std::size_t i = 0; i < from.size(); ++i) {
+                error = std::max(error, rotation_angle(all[i], Sm::slerp(from[i], to[i], t[i])));
+                unit = std::max(unit, std::abs(length(all[i]) - 1.0));
+            }
+            check_near(context, error, 0.0, double(Sm::slerp_fast_max_error<T>()),
+                       "within slerp_fast_max_error of Sm::slerp");
+            check_near(context, unit, 0.0, tolerance<T>(), "unit quaternions");
+
+            /* A quaternion's result does not depend on whether it lands in a pack or in the tail */
+            bool same = true;
+            for (std::size_t count = 0; count <= 19; ++count) {
+                std::vector<Quaternion<T>> out(count);
+                Sm::slerp(from.data() + count, to.data() + count, t.data() + count, out.data(), count,
+                          Sm::SlerpMode::Fast);
+                same = same && (count == 0 || std::memcmp(out.data(), all.data() + count, count * sizeof(out[0])) == 0);
+            }
+            context.check(same, "short batches match the same quaternions in a long one");
+        }
+
+        template<typename T>
+        void parallel(Context &context) {
+            context.section(std::string("Sm::slerp(Executor)<") + type_name<T>() + ">");
+            std::vector<Quaternion<T>> from, to;
+            std::vector<T> t;
+            random_pairs(20011, from, to, t);
+            Executor executor{4};
+
+            for (Sm::SlerpMode mode: {Sm::SlerpMode::Accurate, Sm::SlerpMode::Fast}) {
+                const std::string name = mode == Sm::SlerpMode::Fast ? "Fast" : "Accurate";
+                std::vector<Quaternion<T>> serial(from.size()), threaded(from.size());
+                Sm::slerp(from.data(), to.data(), t.data(), serial.data(), from.size(), mode);
+                Sm::slerp(executor, from.data(), to.data(), t.data(), threaded.data(), from.size(), mode);
+                context.check(same_bits(serial, threaded), name + ": per element t matches the serial batch");
+
+                Sm::slerp(from.data(), to.data(), T(0.3), serial.data(), from.size(), mode);
+                Sm::slerp(executor, from.data(), to.data(), T(0.3), threaded.data(), from.size(), mode);
+                context.check(same_bits(serial, threaded), name + ": shared t matches the serial batch");
+            }
+        }
+    }
+
+    void run_quaternion_blend_tests(Context &context) {
+        accurate<float>(context);
+        accurate<double>(context);
+        fast<float>(context);
+        fast<double>(context);
+        parallel<float>(context);
+        parallel<double>(context);
+    }
+}
@@ -0,0 +1,34 @@
+#include <sstream>
+#include "Test.h"
+#include "Quaternion.h"
+
+// Quaternion::ToMatrix3Transposed has to be exactly ToMatrix3().transposed(), both evaluate the same products.
+namespace Test {
+    namespace {
+        template<typename T>
+        void to_matrix_transposed(Context &context) {
+            context.section(std::string("Quaternion::ToMatrix3Transposed<") + type_name<T>() + ">");
+            for (std::size_t round = 0; round < 100; ++round) {
+                const Quaternion<T> q = Quaternion<T>{random_value<T>(), random_value<T>(), random_value<T>(),
+                                                      random_value<T>()}.Normalized();
+                const Matrix<T, 3, 3> expected = q.ToMatrix3().transposed();
+                const Matrix<T, 3, 3> transposed = q.ToMatrix3Transposed();
+
+                std::size_t e = 0;
+                while (e < expected.elements && transposed[e] == expected[e])
+                    ++e;
+
+                std::ostringstream what;
+                if (e < expected.elements)
+                    what << "round " << round << " element " << e << ": " << transposed[e] << ", expected "
+                         << expected[e];
+                context.check(e == expected.elements, what.str());
+            }
+        }
+    }
+
+    void run_quaternion_tests(Context &context) {
+        to_matrix_transposed<float>(context);
+        to_matrix_transposed<double>(context);
+    }
+}
@@ -0,0 +1,236 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+#include "Test.h"
+#include "Ray.h"
+
+// Moller-Trumbore and slab tests on known configurations, then every packet and pack-of-primitives entry point
+// against the one ray, one primitive calls: the same lanes hit with bitwise the same distances and barycentrics.
+namespace Test {
+    namespace {
+        template<typename T>
+        bool same_bits(const T &lhs, const T &rhs) {
+            return std::memcmp(&lhs, &rhs, sizeof(T)) == 0;
+        }
+
+        template<typename T>
+        struct Triangle {
+            Vector<T, 3> a, b, c;
+        };
+
+        template<typename T>
+        Triangle<T> random_triangle() {
+            const Vector<T, 3> center = random_vector<T, 3>(T(-2), T(2));
+            return Triangle<T>{center + random_vector<T, 3>(T(-1), T(1)), center + random_vector<T, 3>(T(-1), T(1)),
+                               center + random_vector<T, 3>(T(-1), T(1))};
+        }
+
+        // Rays from around the scene towards target, some with a tMax short of the scene
+        template<typename T>
+        Ray<T> random_ray(const Vector<T, 3> &target) {
+            const Vector<T, 3> origin = random_vector<T, 3>(T(-6), T(6));
+            const T tMax = random_value<T>(T(0), T(1)) < T(0.2) ? random_value<T>(T(0.5), T(2))
+                                                                 : std::numeric_limits<T>::infinity();
+            return Ray<T>{origin, target - origin, T(0), tMax};
+        }
+
+        // Around triangle abc, a bit more than half of the points are inside it
+        template<typename T>
+        Vector<T, 3> near_triangle(const Triangle<T> &triangle) {
+            const T u = random_value<T>(T(-0.25), T(1)), v = random_value<T>(T(-0.25), T(1) - u);
+            return triangle.a + (triangle.b - triangle.a) * u + (triangle.c - triangle.a) * v;
+        }
+
+        template<typename T>
+        void single(Context &context) {
+            context.section(std::string("Sm::intersect_triangle / intersect_aabb<") + type_name<T>() + ">");
+            const T inf = std::numeric_limits<T>::infinity();
+            const Vector<T, 3> a{T(0), T(0), T(0)}, b{T(1), T(0), T(0)}, c{T(0), T(1), T(0)};
+            T t, u, v;
+
+            /* Straight down onto (0.25, 0.5), from the front and from the back */
+            context.check(Sm::intersect_triangle(Ray<T>{Vector<T, 3>{T(0.25), T(0.5), T(2)},
+                                                        Vector<T, 3>{T(0), T(0), T(-1)}}, a, b, c, t, u, v) &&
+                          t == T(2) && u == T(0.25) && v == T(0.5), "front face hit with t, u and v");
+            context.check(Sm::intersect_triangle(Ray<T>{Vector<T, 3>{T(0.25), T(0.5), T(-3)},
+                                                        Vector<T, 3>{T(0), T(0), T(2)}}, a, b, c, t, u, v) &&
+                          t == T(1.5), "back face hit, t in multiples of the direction");
+            context.check(!Sm::intersect_triangle(Ray<T>{Vector<T, 3>{T(0.75), T(0.75), T(2)},
+                                                         Vector<T, 3>{T(0), T(0), T(-1)}}, a, b, c, t, u, v),
+                          "outside the hypotenuse misses");
+            context.check(!Sm::intersect_triangle(Ray<T>{Vector<T, 3>{T(-1), T(0.25), T(0)},
+                                                         Vector<T, 3>{T(1), T(0), T(0)}}, a, b, c, t, u, v),
+                          "a ray in the triangle plane misses");
+            const Ray<T> down{Vector<T, 3>{T(0.25), T(0.25), T(2)}, Vector<T, 3>{T(0), T(0), T(-1)}};
+            context.check(!Sm::intersect_triangle(Ray<T>{down.origin, down.direction, T(0), T(2)}, a, b, c, t, u, v),
+                          "t == tMax misses");
+            context.check(Sm::intersect_triangle(Ray<T>{down.origin, down.direction, T(2), inf}, a, b, c, t, u, v),
+                          "t == tMin hits");
+            context.check(Sm::intersect_triangle(Ray<T>{Vector<T, 3>{T(0), T(0), T(1)}, down.direction},
+                                                 a, b, c, t, u, v) && u == T(0) && v == T(0),
+                          "a corner is hit");
+
+            const AABB<T> box{Vector<T, 3>{T(-1), T(-1), T(-1)}, Vector<T, 3>{T(1), T(1), T(1)}};
+            T near;
+            context.check(Sm::intersect_aabb(Ray<T>{Vector<T, 3>{T(-5), T(0), T(0)}, Vector<T, 3>{T(2), T(0), T(0)}},
+                                             box, near) && near == T(2), "box entry distance");
+            context.check(Sm::intersect_aabb(Ray<T>{Vector<T, 3>{}, Vector<T, 3>{T(0), T(1), T(0)}, T(0.5), inf},
+                                             box, near) && near == T(0.5), "starting inside enters at tMin");
+            context.check(!Sm::intersect_aabb(Ray<T>{Vector<T, 3>{T(-5), T(2), T(0)}, Vector<T, 3>{T(1), T(0), T(0)}},
+                                              box, near), "a parallel ray beside the box misses");
+            context.check(Sm::intersect_aabb(Ray<T>{Vector<T, 3>{T(-5), T(1), T(0)}, Vector<T, 3>{T(1), T(0), T(0)}},
+                                             box, near) && near == T(4), "a parallel ray along a face hits");
+            context.check(!Sm::intersect_aabb(Ray<T>{Vector<T, 3>{T(-5), T(0), T(0)}, Vector<T, 3>{T(1), T(0), T(0)},
+                                                     T(0), T(3)}, box, near), "a box past tMax misses");
+            context.check(!Sm::intersect_aabb(Ray<T>{Vector<T, 3>{T(-5), T(0), T(0)}, Vector<T, 3>{T(-1), T(0), T(0)}},
+                                              box, near), "a box behind the ray misses");
+        }
+
+        template<typename T, std::size_t N>
+        void packets(Context &context) {
+            context.section(std::string("RayPacket<") + type_name<T>() + ", " + std::to_string(N) + ">");
+            std::size_t triangleHits = 0, boxHits = 0;
+
+            for (std::size_t round = 0; round < 300; ++round) {
+                const Triangle<T> triangle = random_triangle<T>();
+                const Vector<T, 3> corner = random_vector<T, 3>(T(-2), T(2));
+                const AABB<T> box{corner, corner + random_vector<T, 3>(T(0), T(2))};
+                const int active = round % 5 == 4 ? static_cast<int>(random_value<T>(T(0), T(1 << N))) :
+                                   RayPacket<T, N>::allLanes;
+
+                /* Even lanes aim at the triangle, odd lanes at the box */
+                Ray<T> rays[N];
+                for (std::size_t lane = 0; lane < N; ++lane)
+                    rays[lane] = random_ray(lane % 2 == 0 ? near_triangle(triangle)
+                                                          : box.min + (box.max - box.min) * random_value<T>(T(-0.2),
+                                                                                                            T(1.2)));
+                const std::string what = "round " + std::to_string(round);
+
+                RayPacket<T, N> packet{rays};
+                const int triangleMask = Sm::intersect_triangle(packet, triangle.a, triangle.b, triangle.c, active);
+                T near[N];
+                const int boxMask = Sm::intersect_aabb(packet, box, active, near);
+
+                RayPacketHit<T, N> hits;
+                const int closestMask = Sm::intersect_triangle(packet, triangle.a, triangle.b, triangle.c,
+                                                               std::uint32_t(round), hits, active);
+
+                bool sameTriangles = closestMask == triangleMask, sameClosest = true, sameBoxes = true;
+                for (std::size_t lane = 0; lane < N; ++lane) {
+                    const bool on = (active >> lane) & 1;
+                    T t, u, v, entry;
+                    const bool triangleHit = on && Sm::intersect_triangle(rays[lane], triangle.a, triangle.b,
+                                                                          triangle.c, t, u, v);
+                    const bool boxHit = on && Sm::intersect_aabb(rays[lane], box, entry);
+                    triangleHits += triangleHit ? 1 : 0;
+                    boxHits += boxHit ? 1 : 0;
+
+                    sameTriangles = sameTriangles && (((triangleMask >> lane) & 1) != 0) == triangleHit;
+                    sameBoxes = sameBoxes && (((boxMask >> lane) & 1) != 0) == boxHit &&
+                                (!boxHit || same_bits(near[lane], entry));
+                    /* Hit lanes take the hit, every other lane keeps its ray and an empty hit record */
+                    const Ray<T> after = packet.get(lane);
+                    if (triangleHit)
+                        sameClosest = sameClosest && same_bits(after.tMax, t) && same_bits(hits.u[lane], u) &&
+                                      same_bits(hits.v[lane], v) && hits.primitive[lane] == std::uint32_t(round);
+                    else
+                        sameClosest = sameClosest && same_bits(after.tMax, rays[lane].tMax) &&
+                                      hits.primitive[lane] == RayHit<T>::none;
+                }
+                context.check(sameTriangles, what + ": packet triangle lanes match the single ray");
+                context.check(sameClosest, what + ": closest hit update matches the single ray");
+                context.check(sameBoxes, what + ": packet box lanes and entries match the single ray");
+            }
+            context.check(triangleHits > 200 && boxHits > 200, "the random rays hit often enough to mean something");
+        }
+
+        template<typename T>
+        void primitive_packs(Context &context) {
+            context.section(std::string("Sm::intersect_triangles / intersect_aabbs<") + type_name<T>() + ">");
+
+            /* Every count up to a few packs, so both the packs and the scalar tail are covered */
+            for (std::size_t count = 0; count <= 19; ++count) {
+                std::vector<Vector<T, 3>> a(count), b(count), c(count), mins(count), maxs(count);
+                for (std::size_t i = 0; i < count; ++i) {
+                    const Triangle<T> triangle = random_triangle<T>();
+                    a[i] = triangle.a;
+                    b[i] = triangle.b;
+                    c[i] = triangle.c;
+                    mins[i] = random_vector<T, 3>(T(-2), T(2));
+                    maxs[i] = mins[i] + random_vector<T, 3>(T(0), T(2));
+                }
+                /* A duplicate in the same pack, so two triangles are hit at exactly the same distance */
+                if (count > 3) {
+                    a[3] = a[2];
+                    b[3] = b[2];
+                    c[3] = c[2];
+                }
+
+                bool sameClosest = true, sameOccluded = true, sameBoxes = true;
+                for (std::size_t round = 0; round < 20; ++round) {
+                    const std::size_t aim = count > 3 && round % 2 == 0 ? 2 : round % (count + 1);
+                    const Ray<T> ray = random_ray(aim == count ? Vector<T, 3>{} :
+                                                  near_triangle(Triangle<T>{a[aim], b[aim], c[aim]}));
+
+                    /* One triangle after the other, ties keep the lower index */
+                    Ray<T> expected = ray;
+                    RayHit<T> expectedHit;
+                    bool any = false;
+                    for (std::size_t i = 0; i < count; ++i) {
+                        T t, u, v;
+                        if (Sm::intersect_triangle(ray, a[i], b[i], c[i], t, u, v))
+                            any = true;
+                        if (Sm::intersect_triangle(expected, a[i], b[i], c[i], t, u, v)) {
+                            expected.tMax = t;
+                            expectedHit.u = u;
+                            expectedHit.v = v;
+                            expectedHit.primitive = std::uint32_t(i);
+                        }
+                    }
+                    Ray<T> closest = ray;
+                    RayHit<T> hit;
+                    const bool found = Sm::intersect_triangles(closest, a.data(), b.data(), c.data(), count, hit);
+                    sameClosest = sameClosest && found == (expectedHit.primitive != RayHit<T>::none) &&
+                                  same_bits(closest.tMax, expected.tMax) && same_bits(hit.u, expectedHit.u) &&
+                                  same_bits(hit.v, expectedHit.v) && hit.primitive == expectedHit.primitive;
+                    sameOccluded = sameOccluded &&
+                                   Sm::occluded_triangles(ray, a.data(), b.data(), c.data(), count) == any;
+
+                    std::vector<std::uint32_t> indices(count);
+                    std::vector<T> distances(count);
+                    const std::size_t written = Sm::intersect_aabbs(ray, mins.data(), maxs.data(), count,
+                                                                    indices.data(), distances.data());
+                    std::size_t next = 0;
+                    for (std::size_t i = 0; i < count; ++i) {
+                        T near;
+                        if (!Sm::intersect_aabb(ray, AABB<T>{mins[i], maxs[i]}, near))
+                            continue;
+                        sameBoxes = sameBoxes && next < written && indices[next] == i &&
+                                    same_bits(distances[next], near);
+                        ++next;
+                    }
+                    sameBoxes = sameBoxes && next == written;
+                }
+
+                const std::string what = std::to_string(count) + " primitives";
+                context.check(sameClosest, what + ": intersect_triangles matches the single triangle calls");
+                context.check(sameOccluded, what + ": occluded_triangles matches the single triangle calls");
+                context.check(sameBoxes, what + ": intersect_aabbs matches the single box calls");
+            }
+        }
+    }
+
+    void run_ray_tests(Context &context) {
+        single<float>(context);
+        single<double>(context);
+        packets<float, 4>(context);
+        packets<float, 8>(context);
+        packets<double, 4>(context);
+        packets<double, 8>(context);
+        primitive_packs<float>(context);
+        primitive_packs<double>(context);
+    }
+}
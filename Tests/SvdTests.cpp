@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Test.h"
+#include "Svd.h"
+
+// Sm::svd and Sm::polar_rotation on random matrices, reflections and the degenerate cases the branch free kernel has
+// to survive: rank two, rank one, zero and repeated singular values. The batch entry points run the same kernel on
+// simd packs and have to match the single matrix calls bitwise.
+namespace Test {
+    namespace {
+        template<typename T>
+        Matrix<T, 3, 3> diagonal(T x, T y, T z) {
+            return Matrix<T, 3, 3>{x, T(0), T(0), T(0), y, T(0), T(0), T(0), z};
+        }
+
+        // rotation * diag(x, y, z) * another rotation, singular values |x|, |y|, |z| and determinant sign of x y z
+        template<typename T>
+        Matrix<T, 3, 3> with_singular_values(T x, T y, T z) {
+            return random_rotation<T>().ToMatrix3() * diagonal(x, y, z) * random_rotation<T>().ToMatrix3();
+        }
+
+        struct Case {
+            std::string name;
+            std::size_t rank;
+        };
+
+        template<typename T>
+        std::vector<Matrix<T, 3, 3>> test_matrices(std::vector<Case> &cases) {
+            std::vector<Matrix<T, 3, 3>> matrices;
+            const auto add = [&](const Matrix<T, 3, 3> &m, const std::string &name, std::size_t rank) {
+                matrices.push_back(m);
+                cases.push_back(Case{name, rank});
+            };
+
+            for (std::size_t i = 0; i < 200; ++i)
+                add(random_matrix<T, 3, 3>(), "random", 3);
+            for (std::size_t i = 0; i < 50; ++i) {
+                const T x = random_value<T>(T(0.5), T(4)), y = random_value<T>(T(0.5), T(4));
+                const T z = random_value<T>(T(0.5), T(4));
+                add(with_singular_values(x, y, -z), "reflection", 3);
+                add(with_singular_values(x, y, T(0)), "rank two", 2);
+                add(with_singular_values(x, T(0), T(0)), "rank one", 1);
+                add(with_singular_values(x, x, z), "two repeated", 3);
+                add(with_singular_values(x, x, -x), "three repeated reflection", 3);
+                add(random_rotation<T>().ToMatrix3() * x, "scaled rotation", 3);
+            }
+            add(Matrix<T, 3, 3>{}, "identity", 3);
+            add(diagonal(T(0), T(0), T(0)), "zero", 0);
+            add(diagonal(T(1), T(-1), T(1)), "diagonal reflection", 3);
+            add(diagonal(T(1), T(3), T(2)), "unsorted diagonal", 3);
+            return matrices;
+        }
+
+        template<typename T>
+        double orthonormal_error(const Matrix<T, 3, 3> &m) {
+            return max_difference(m * m.transposed(), Matrix<T, 3, 3>{});
+        }
+
+        template<typename T>
+        bool same_bits(const Svd<T> &lhs, const Svd<T> &rhs) {
+            return std::memcmp(&lhs.u, &rhs.u, sizeof(lhs.u)) == 0 &&
+                   std::memcmp(&lhs.sigma, &rhs.sigma, sizeof(lhs.sigma)) == 0 &&
+                   std::memcmp(&lhs.v, &rhs.v, sizeof(lhs.v)) == 0;
+        }
+
+        template<typename T>
+        void decompositions(Context &context) {
+            context.section(std::string("Sm::svd<") + type_name<T>() + ">");
+            std::vector<Case> cases;
+            const std::vector<Matrix<T, 3, 3>> matrices = test_matrices<T>(cases);
+            const double tolerance = Test::tolerance<T>();
+
+            for (std::size_t i = 0; i < matrices.size(); ++i) {
+                const Matrix<T, 3, 3> &m = matrices[i];
+                const Svd<T> svd = Sm::svd(m);
+                const std::string what = cases[i].name + " " + std::to_string(i);
+                const double scale = std::max(1.0, double(std::abs(svd.sigma.x)));
+
+                check_near(context, svd.matrix(), m, tolerance * scale, what + ": u * diag(sigma) * transposed(v)");
+                check_near(context, orthonormal_error(svd.u), 0.0, tolerance, what + ": u orthonormal");
+                check_near(context, orthonormal_error(svd.v), 0.0, tolerance, what + ": v orthonormal");
+                check_near(context, double(svd.u.determinant()), 1.0, tolerance, what + ": det(u) = 1");
+                check_near(context, double(svd.v.determinant()), 1.0, tolerance, what + ": det(v) = 1");
+
+                const double x = svd.sigma.x, y = svd.sigma.y, z = svd.sigma.z;
+                context.check(x >= 0 && y >= 0, what + ": sigma.x and sigma.y are not negative");
+                context.check(x >= y - tolerance * scale && y >= std::abs(z) - tolerance * scale,
+                              what + ": singular values in descending order of magnitude");
+
+                /* The sign of sigma.z carries the reflection, unless the matrix is singular and it is zero anyway */
+                const double determinant = m.determinant();
+                if (std::abs(determinant) > tolerance * scale * scale * scale)
+                    context.check((z < 0) == (determinant < 0), what + ": sigma.z negative exactly for reflections");
+                if (cases[i].rank < 3)
+                    check_near(context, z, 0.0, tolerance * scale, what + ": sigma.z zero below full rank");
+                if (cases[i].rank < 2)
+                    check_near(context, y, 0.0, tolerance * scale, what + ": sigma.y zero below rank two");
+            }
+
+            /* Exact values where they are known */
+            const Svd<T> repeated = Sm::svd(with_singular_values(T(2), T(2), T(-2)));
+            check_near(context, repeated.sigma, Vector<T, 3>{T(2), T(2), T(-2)}, tolerance * 2,
+                       "three repeated singular values of a reflection");
+            const Svd<T> sorted = Sm::svd(diagonal(T(1), T(3), T(2)));
+            check_near(context, sorted.sigma, Vector<T, 3>{T(3), T(2), T(1)}, tolerance * 3,
+                       "singular values of an unsorted diagonal");
+            const Svd<T> zero = Sm::svd(diagonal(T(0), T(0), T(0)));
+            context.check(zero.sigma.x == T(0) && zero.sigma.y == T(0) && zero.sigma.z == T(0),
+                          "the zero matrix has zero singular values");
+        }
+
+        template<typename T>
+        void polar(Context &context) {
+            context.section(std::string("Sm::polar_rotation<") + type_name<T>() + ">");
+            std::vector<Case> cases;
+            const std::vector<Matrix<T, 3, 3>> matrices = test_matrices<T>(cases);
+            const double tolerance = Test::tolerance<T>();
+
+            for (std::size_t i = 0; i < matrices.size(); ++i) {
+                const Svd<T> svd = Sm::svd(matrices[i]);
+                const Quaternion<T> rotation = Sm::polar_rotation(matrices[i]);
+                const std::string what = cases[i].name + " " + std::to_string(i);
+
+                check_near(context, double(Sm::dot(rotation, rotation)), 1.0, tolerance, what + ": unit quaternion");
+                context.check(rotation.w >= 0, what + ": w not negative");
+                check_near(context, rotation.ToMatrix3(), svd.u * svd.v.transposed(), tolerance,
+                           what + ": u * transposed(v)");
+            }
+
+            /* A scaled rotation is its own polar rotation, up to the sign of the quaternion */
+            for (std::size_t i = 0; i < 50; ++i) {
+                Quaternion<T> q = random_rotation<T>();
+                if (q.w < 0)
+                    q = Quaternion<T>{-q.x, -q.y, -q.z, -q.w};
+                const Quaternion<T> rotation = Sm::polar_rotation(q.ToMatrix3() * random_value<T>(T(0.5), T(4)));
+                check_near(context, rotation, q, tolerance, "rotation of a scaled rotation " + std::to_string(i));
+            }
+        }
+
+        template<typename T>
+        void batches(Context &context) {
+            context.section(std::string("Sm::svd(batch)<") + type_name<T>() + ">");
+            std::vector<Case> cases;
+            const std::vector<Matrix<T, 3, 3>> matrices = test_matrices<T>(cases);
+
+            /* Every count up to a few packs, so both the packs and the scalar tail are covered */
+            for (std::size_t count = 0; count <= 19; ++count) {
+                std::vector<Svd<T>> batch(count);
+                std::vector<Quaternion<T>> rotations(count);
+                Sm::svd(matrices.data(), batch.data(), count);
+                Sm::polar_rotation(matrices.data(), rotations.data(), count);
+
+                bool same = true;
+                for (std::size_t i = 0; i < count; ++i) {
+                    const Quaternion<T> rotation = Sm::polar_rotation(matrices[i]);
+                    same = same && same_bits(batch[i], Sm::svd(matrices[i])) &&
+                           std::memcmp(&rotations[i], &rotation, sizeof(rotation)) == 0;
+                }
+                context.check(same, "batch of " + std::to_string(count) + " matches the single matrix calls");
+            }
+
+            std::vector<Svd<T>> batch(matrices.size());
+            Sm::svd(matrices.data(), batch.data(), matrices.size());
+            std::size_t mismatches = 0;
+            for (std::size_t i = 0; i < matrices.size(); ++i)
+                mismatches += same_bits(batch[i], Sm::svd(matrices[i])) ? 0 : 1;
+            context.check(mismatches == 0, "every test matrix in one batch, " + std::to_string(mismatches) +
+                                           " differ from the single matrix call");
+
+            Executor executor{4};
+            std::vector<Quaternion<T>> parallel(matrices.size()), serial(matrices.size());
+            Sm::polar_rotation(executor, matrices.data(), parallel.data(), matrices.size());
+            Sm::polar_rotation(matrices.data(), serial.data(), matrices.size());
+            context.check(std::memcmp(parallel.data(), serial.data(), serial.size() * sizeof(serial[0])) == 0,
+                          "Sm::polar_rotation(Executor) matches the serial batch");
+        }
+    }
+
+    void run_svd_tests(Context &context) {
+        decompositions<float>(context);
+        decompositions<double>(context);
+        polar<float>(context);
+        polar<double>(context);
+        batches<float>(context);
+        batches<double>(context);
+    }
+}
@@ -0,0 +1,254 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "Test.h"
+#include "SymmetricEigen.h"
+
+// Sm::eigen_symmetric against the decomposition it promises (reconstruction, a right handed orthonormal basis,
+// descending eigenvalues) on random, repeated and diagonal matrices, the batch and SoA entry points bitwise against the
+// single matrix call, and Covariance against a direct two pass computation, with the parallel version bitwise equal
+// to a serial add.
+namespace Test {
+    namespace {
+        template<typename T>
+        Matrix<T, 3, 3> diagonal(T x, T y, T z) {
+            return Matrix<T, 3, 3>{x, T(0), T(0), T(0), y, T(0), T(0), T(0), z};
+        }
+
+        // rotation * diag(x, y, z) * transposed(rotation), eigenvalues x, y and z
+        template<typename T>
+        Matrix<T, 3, 3> with_eigenvalues(T x, T y, T z) {
+            const Matrix<T, 3, 3> rotation = random_rotation<T>().ToMatrix3();
+            return rotation * diagonal(x, y, z) * rotation.transposed();
+        }
+
+        template<typename T>
+        Matrix<T, 3, 3> random_symmetric() {
+            Matrix<T, 3, 3> m = random_matrix<T, 3, 3>();
+            for (std::size_t r = 0; r < 3; ++r)
+                for (std::size_t c = 0; c < r; ++c)
+                    m(r, c) = m(c, r);
+            return m;
+        }
+
+        template<typename T>
+        std::vector<Matrix<T, 3, 3>> test_matrices() {
+            std::vector<Matrix<T, 3, 3>> matrices;
+            for (std::size_t i = 0; i < 200; ++i)
+                matrices.push_back(random_symmetric<T>());
+            for (std::size_t i = 0; i < 50; ++i) {
+                const T x = random_value<T>(), y = random_value<T>();
+                matrices.push_back(with_eigenvalues(x, x, y));
+                matrices.push_back(with_eigenvalues(y, x, x));
+                matrices.push_back(with_eigenvalues(x, x, x));
+                matrices.push_back(with_eigenvalues(x, y, T(0)));
+            }
+            matrices.push_back(Matrix<T, 3, 3>{});
+            matrices.push_back(diagonal(T(0), T(0), T(0)));
+            matrices.push_back(diagonal(T(1), T(3), T(2)));
+            matrices.push_back(diagonal(T(-1), T(-3), T(-2)));
+            return matrices;
+        }
+
+        template<typename T>
+        bool same_bits(const SymmetricEigen<T> &lhs, const SymmetricEigen<T> &rhs) {
+            return std::memcmp(&lhs.values, &rhs.values, sizeof(lhs.values)) == 0 &&
+                   std::memcmp(&lhs.vectors, &rhs.vectors, sizeof(lhs.vectors)) == 0;
+        }
+
+        template<typename T>
+        void decompositions(Context &context) {
+            context.section(std::string("Sm::eigen_symmetric<") + type_name<T>() + ">");
+            const std::vector<Matrix<T, 3, 3>> matrices = test_matrices<T>();
+            const double tolerance = Test::tolerance<T>();
+
+            for (std::size_t i = 0; i < matrices.size(); ++i) {
+                const Matrix<T, 3, 3> &m = matrices[i];
+                const SymmetricEigen<T> eigen = Sm::eigen_symmetric(m);
+                const std::string what = "matrix " + std::to_string(i);
+                const double scale = std::max({1.0, double(std::abs(eigen.values.x)), double(std::abs(eigen.values.z))});
+
+                const Matrix<T, 3, 3> &v = eigen.vectors;
+                check_near(context, v * diagonal(eigen.values.x, eigen.values.y, eigen.values.z) * v.transposed(), m,
+                           tolerance * scale, what + ": vectors * diag(values) * transposed(vectors)");
+                check_near(context, v * v.transposed(), Matrix<T, 3, 3>{}, tolerance, what + ": orthonormal vectors");
+                check_near(context, double(v.determinant()), 1.0, tolerance, what + ": det(vectors) = 1");
+                check_near(context, Sm::cross(eigen.axis(0), eigen.axis(1)), eigen.axis(2), tolerance,
+                           what + ": axis(0) x axis(1) = axis(2)");
+                context.check(eigen.values.x >= eigen.values.y && eigen.values.y >= eigen.values.z,
+                              what + ": eigenvalues in descending order");
+            }
+
+            /* Exact values where they are known, repeated ones included */
+            check_near(context, Sm::eigen_symmetric(diagonal(T(1), T(3), T(2))).values, Vector<T, 3>{T(3), T(2), T(1)},
+                       0.0, "eigenvalues of an unsorted diagonal");
+            check_near(context, Sm::eigen_symmetric(with_eigenvalues(T(2), T(-1), T(2))).values,
+                       Vector<T, 3>{T(2), T(2), T(-1)}, tolerance * 2, "a repeated eigenvalue");
+            check_near(context, Sm::eigen_symmetric(with_eigenvalues(T(3), T(3), T(3))).values,
+                       Vector<T, 3>{T(3), T(3), T(3)}, tolerance * 3, "a triple eigenvalue");
+            const SymmetricEigen<T> zero = Sm::eigen_symmetric(diagonal(T(0), T(0), T(0)));
+            context.check(zero.values.x == T(0) && zero.values.y == T(0) && zero.values.z == T(0),
+                          "the zero matrix has zero eigenvalues");
+            check_near(context, zero.vectors, Matrix<T, 3, 3>{}, tolerance, "the zero matrix keeps the identity basis");
+        }
+
+        template<typename T>
+        void batches(Context &context) {
+            context.section(std::string("Sm::eigen_symmetric(batch)<") + type_name<T>() + ">");
+            const std::vector<Matrix<T, 3, 3>> matrices = test_matrices<T>();
+
+            /* Every count up to a few packs, so both the packs and the scalar tail are covered */
+            for (std::size_t count = 0; count <= 19; ++count) {
+                std::vector<SymmetricEigen<T>> batch(count);
+                Sm::eigen_symmetric(matrices.data(), batch.data(), count);
+
+                VectorArray<T, 3> diagonals(count), offDiagonals(count), values, axes[3];
+                for (std::size_t i = 0; i < count; ++i) {
+                    const Matrix<T, 3, 3> &m = matrices[i];
+                    diagonals.set(i, Vector<T, 3>{m(0, 0), m(1, 1), m(2, 2)});
+                    offDiagonals.set(i, Vector<T, 3>{m(0, 1), m(0, 2), m(1, 2)});
+                }
+                Sm::eigen_symmetric(diagonals, offDiagonals, values, axes);
+
+                bool same = values.size() == count;
+                bool sameSoA = same;
+                for (std::size_t i = 0; i < count; ++i) {
+                    const SymmetricEigen<T> single = Sm::eigen_symmetric(matrices[i]);
+                    same = same && same_bits(batch[i], single);
+
+                    const Vector<T, 3> value = values.get(i);
+                    sameSoA = sameSoA && std::memcmp(&value, &single.values, sizeof(value)) == 0;
+                    for (std::size_t k = 0; k < 3; ++k) {
+                        const Vector<T, 3> axis = axes[k].get(i), expected = single.axis(k);
+                        sameSoA = sameSoA && std::memcmp(&axis, &expected, sizeof(axis)) == 0;
+                    }
+                }
+                context.check(same, "batch of " + std::to_string(count) + " matches the single matrix calls");
+                context.check(sameSoA, "SoA batch of " + std::to_string(count) + " matches the single matrix calls");
+            }
+        }
+
+        // Mean and population covariance in two plain passes, in double
+        template<typename T>
+        void reference_covariance(const std::vector<Vector<T, 3>> &points, Vector<double, 3> &mean,
+                                  Matrix<double, 3, 3> &covariance) {
+            double sums[3] = {};
+            for (const auto &point: points)
+                for (std::size_t k = 0; k < 3; ++k)
+                    sums[k] += double(point[k]);
+            for (std::size_t k = 0; k < 3; ++k)
+                mean[k] = sums[k] / double(points.size());
+
+            double moments[9] = {};
+            for (const auto &point: points)
+                for (std::size_t r = 0; r < 3; ++r)
+                    for (std::size_t c = 0; c < 3; ++c)
+                        moments[r * 3 + c] += (double(point[r]) - mean[r]) * (double(point[c]) - mean[c]);
+            for (std::size_t k = 0; k < 9; ++k)
+                covariance[k] = moments[k] / double(points.size());
+        }
+
+        template<typename T>
+        Vector<double, 3> to_double(const Vector<T, 3> &vec) {
+            return Vector<double, 3>{double(vec.x), double(vec.y), double(vec.z)};
+        }
+
+        template<typename T>
+        Matrix<double, 3, 3> to_double(const Matrix<T, 3, 3> &m) {
+            Matrix<double, 3, 3> result;
+            for (std::size_t k = 0; k < m.elements; ++k)
+                result[k] = double(m[k]);
+            return result;
+        }
+
+        template<typename T>
+        bool same_bits(const Covariance<T> &lhs, const Covariance<T> &rhs) {
+            const Vector<T, 3> lhsMean = lhs.mean(), rhsMean = rhs.mean();
+            const Matrix<T, 3, 3> lhsCovariance = lhs.covariance(), rhsCovariance = rhs.covariance();
+            return lhs.count() == rhs.count() && std::memcmp(&lhsMean, &rhsMean, sizeof(lhsMean)) == 0 &&
+                   std::memcmp(&lhsCovariance, &rhsCovariance, sizeof(lhsCovariance)) == 0;
+        }
+
+        template<typename T>
+        void covariances(Context &context) {
+            context.section(std::string("Covariance<") + type_name<T>() + ">");
+            const double tolerance = Test::tolerance<T>();
+
+            /* An offset far from the spread, which a one pass sum of squares would lose */
+            const Vector<T, 3> offset{T(100), T(-50), T(25)};
+            const Matrix<T, 3, 3> shape = random_matrix<T, 3, 3>(T(-1), T(1));
+
+            /* Counts around the block and chunk sizes, with pack tails */
+            for (std::size_t count: {std::size_t(1), std::size_t(7), std::size_t(1023), std::size_t(1025),
+                                     std::size_t(16 * 1024 + 3), std::size_t(70001)}) {
+                std::vector<Vector<T, 3>> points(count);
+                for (auto &point: points)
+                    point = Sm::operator*(shape, random_vector<T, 3>(T(-1), T(1))) + offset;
+                const VectorArray<T, 3> soa(points.data(), points.size());
+                const std::string what = std::to_string(count) + " points";
+
+                Vector<double, 3> mean;
+                Matrix<double, 3, 3> expected;
+                reference_covariance(points, mean, expected);
+
+                Covariance<T> batch;
+                batch.add(points.data(), points.size());
+                context.check(batch.count() == count, what + ": count");
+                check_near(context, to_double(batch.mean()), mean, tolerance * 100, what + ": mean");
+                check_near(context, to_double(batch.covariance()), expected, tolerance, what + ": covariance");
+
+                Covariance<T> single;
+                for (const auto &point: points)
+                    single.add(point);
+                check_near(context, to_double(single.mean()), mean, tolerance * 100, what + ": Welford mean");
+                check_near(context, to_double(single.covariance()), expected, tolerance, what + ": Welford covariance");
+
+                Covariance<T> fromSoA;
+                fromSoA.add(soa);
+                context.check(same_bits(fromSoA, batch), what + ": VectorArray add matches the AoS add bitwise");
+
+                /* Two halves merged, as threads would */
+                Covariance<T> first, second;
+                first.add(points.data(), count / 2);
+                second.add(points.data() + count / 2, count - count / 2);
+                first.merge(second);
+                check_near(context, to_double(first.covariance()), expected, tolerance, what + ": merged halves");
+
+                for (std::size_t threads: {std::size_t(1), std::size_t(3), std::size_t(4)}) {
+                    Executor executor{threads};
+                    context.check(same_bits(Sm::covariance(executor, points.data(), count), batch),
+                                  what + ", " + std::to_string(threads) + " threads: matches a serial add bitwise");
+                    context.check(same_bits(Sm::covariance(executor, soa), batch),
+                                  what + ", " + std::to_string(threads) +
+                                  " threads: VectorArray matches a serial add bitwise");
+                }
+            }
+
+            context.check(Covariance<T>{}.empty(), "a new accumulator is empty");
+            check_near(context, Covariance<T>{}.covariance(), diagonal(T(0), T(0), T(0)), 0.0,
+                       "an empty accumulator has zero covariance");
+
+            /* Points along one line spread along it only */
+            const Vector<T, 3> direction = Vector<T, 3>{T(1), T(2), T(-2)} * (T(1) / T(3));
+            Covariance<T> line;
+            for (std::size_t i = 0; i < 101; ++i)
+                line.add(direction * (T(i) - T(50)) + offset);
+            const SymmetricEigen<T> axes = Sm::principal_axes(line);
+            check_near(context, double(std::abs(Sm::dot(axes.axis(0), direction))), 1.0, tolerance,
+                       "principal axis of points on a line");
+            check_near(context, double(axes.values.y), 0.0, tolerance * 100, "no spread across the line");
+        }
+    }
+
+    void run_symmetric_eigen_tests(Context &context) {
+        decompositions<float>(context);
+        decompositions<double>(context);
+        batches<float>(context);
+        batches<double>(context);
+        covariances<float>(context);
+        covariances<double>(context);
+    }
+}
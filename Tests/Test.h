@@ -0,0 +1,191 @@
+#ifndef SLIMEMATHS_TEST_H
+#define SLIMEMATHS_TEST_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include "Vector2.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix.h"
+#include "Quaternion.h"
+
+// Minimal self contained test harness.
+// Every check that fails prints where and why, the suite keeps going and the executable returns non zero at the end
+// so ctest reports every failure of a run, not only the first one.
+
+namespace Test {
+
+    class Context {
+    public:
+        // Starts a named group of checks, failures are reported under it
+        void section(std::string name) {
+            _section = std::move(name);
+        }
+
+        bool check(bool condition, const std::string &what) {
+            ++_checks;
+            if (!condition) {
+                ++_failures;
+                std::cerr << "FAIL [" << _section << "] " << what << '\n';
+            }
+            return condition;
+        }
+
+        std::size_t checks() const {
+            return _checks;
+        }
+
+        std::size_t failures() const {
+            return _failures;
+        }
+
+    private:
+        std::string _section;
+        std::size_t _checks = 0;
+        std::size_t _failures = 0;
+    };
+
+    // Distance in units in the last place between two finite values, 0 when they are bitwise equal.
+    // The bit patterns are mapped to unsigned integers that are ordered like the values, so it also works across zero.
+    template<typename Bits, typename T>
+    std::uint64_t ulp_distance_bits(T lhs, T rhs) {
+        static_assert(sizeof(Bits) == sizeof(T), "one integer per value");
+        const Bits sign = Bits(1) << (sizeof(Bits) * 8 - 1);
+        Bits a, b;
+        std::memcpy(&a, &lhs, sizeof(a));
+        std::memcpy(&b, &rhs, sizeof(b));
+        a = (a & sign) ? Bits(~a) : Bits(a | sign);
+        b = (b & sign) ? Bits(~b) : Bits(b | sign);
+        return std::uint64_t(a > b ? a - b : b - a);
+    }
+
+    inline std::uint64_t ulp_distance(float lhs, float rhs) {
+        return ulp_distance_bits<std::uint32_t>(lhs, rhs);
+    }
+
+    inline std::uint64_t ulp_distance(double lhs, double rhs) {
+        return ulp_distance_bits<std::uint64_t>(lhs, rhs);
+    }
+
+    // Same inputs on every run, so a failure reproduces
+    inline std::mt19937 &rng() {
+        static std::mt19937 generator{1234};
+        return generator;
+    }
+
+    template<typename T>
+    T random_value(T low = T(-4), T high = T(4)) {
+        std::uniform_real_distribution<double> dist{double(low), double(high)};
+        return T(dist(rng()));
+    }
+
+    template<typename T, std::size_t N>
+    Vector<T, N> random_vector(T low = T(-4), T high = T(4)) {
+        Vector<T, N> result;
+        for (std::size_t i = 0; i < N; ++i)
+            result[i] = random_value<T>(low, high);
+        return result;
+    }
+
+    // Unit quaternion of a random rotation
+    template<typename T>
+    Quaternion<T> random_rotation() {
+        Quaternion<T> q;
+        do {
+            q = Quaternion<T>{random_value<T>(T(-1), T(1)), random_value<T>(T(-1), T(1)),
+                              random_value<T>(T(-1), T(1)), random_value<T>(T(-1), T(1))};
+        } while (Sm::dot(q, q) < T(0.01));
+        return q.Normalized();
+    }
+
+    template<typename T, std::size_t Rows, std::size_t Cols>
+    Matrix<T, Rows, Cols> random_matrix(T low = T(-4), T high = T(4)) {
+        Matrix<T, Rows, Cols> result;
+        for (std::size_t i = 0; i < result.elements; ++i)
+            result[i] = random_value<T>(low, high);
+        return result;
+    }
+
+    inline double max_difference(float lhs, float rhs) {
+        return std::abs(double(lhs) - double(rhs));
+    }
+
+    inline double max_difference(double lhs, double rhs) {
+        return std::abs(lhs - rhs);
+    }
+
+    // Largest absolute component difference of two vectors or quaternions
+    template<typename V>
+    double max_difference(const V &lhs, const V &rhs) {
+        double worst = 0.0;
+        for (std::size_t i = 0; i < V::components; ++i)
+            worst = std::max(worst, std::abs(double(lhs[i]) - double(rhs[i])));
+        return worst;
+    }
+
+    template<typename T, std::size_t Rows, std::size_t Cols>
+    double max_difference(const Matrix<T, Rows, Cols> &lhs, const Matrix<T, Rows, Cols> &rhs) {
+        double worst = 0.0;
+        for (std::size_t i = 0; i < lhs.elements; ++i)
+            worst = std::max(worst, std::abs(double(lhs[i]) - double(rhs[i])));
+        return worst;
+    }
+
+    // Checks that two scalars, vectors, quaternions or matrices differ by at most tolerance in every component
+    template<typename V>
+    bool check_near(Context &context, const V &actual, const V &expected, double tolerance, const std::string &what) {
+        const double difference = max_difference(actual, expected);
+        if (difference <= tolerance)
+            return context.check(true, what);
+        std::ostringstream message;
+        message << what << ": off by " << difference << ", allowed " << tolerance;
+        return context.check(false, message.str());
+    }
+
+    // Tolerance for results of a few dozen roundings of values around 1, loose for float and tight for double
+    template<typename T>
+    double tolerance() {
+        return sizeof(T) == sizeof(float) ? 1e-4 : 1e-11;
+    }
+
+    template<typename T>
+    const char *type_name();
+
+    template<>
+    inline const char *type_name<float>() { return "float"; }
+
+    template<>
+    inline const char *type_name<double>() { return "double"; }
+
+    // One per test file, run in order by TestMain.cpp
+    void run_matrix_kernel_tests(Context &context);
+    void run_matrix_tests(Context &context);
+    void run_fast_math_tests(Context &context);
+    void run_quaternion_tests(Context &context);
+    void run_dual_quaternion_tests(Context &context);
+    void run_bvh_tests(Context &context);
+    void run_array_file_tests(Context &context);
+    void run_svd_tests(Context &context);
+    void run_symmetric_eigen_tests(Context &context);
+    void run_transform_hierarchy_tests(Context &context);
+    void run_encoding_tests(Context &context);
+    void run_trs_tests(Context &context);
+    void run_frustum_tests(Context &context);
+    void run_ray_tests(Context &context);
+    void run_vector_array_tests(Context &context);
+    void run_batch_transform_tests(Context &context);
+    void run_quaternion_blend_tests(Context &context);
+    void run_executor_tests(Context &context);
+    void run_gemm_tests(Context &context);
+    void run_constexpr_tests(Context &context);
+    void run_pack_dispatch_tests(Context &context);
+}
+
+#endif //SLIMEMATHS_TEST_H
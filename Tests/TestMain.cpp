@@ -0,0 +1,39 @@
+#include <iostream>
+#include "Test.h"
+
+int main() {
+#if defined(__AVX__) && (defined(__GNUC__) || defined(__clang__))
+    /* The AVX build of the suite, ctest counts this return code as skipped */
+    if (!__builtin_cpu_supports("avx")) {
+        std::cout << "This CPU has no AVX, skipped\n";
+        return 77;
+    }
+#endif
+
+    Test::Context context;
+
+    Test::run_matrix_kernel_tests(context);
+    Test::run_matrix_tests(context);
+    Test::run_fast_math_tests(context);
+    Test::run_quaternion_tests(context);
+    Test::run_dual_quaternion_tests(context);
+    Test::run_bvh_tests(context);
+    Test::run_array_file_tests(context);
+    Test::run_svd_tests(context);
+    Test::run_symmetric_eigen_tests(context);
+    Test::run_transform_hierarchy_tests(context);
+    Test::run_encoding_tests(context);
+    Test::run_trs_tests(context);
+    Test::run_frustum_tests(context);
+    Test::run_ray_tests(context);
+    Test::run_vector_array_tests(context);
+    Test::run_batch_transform_tests(context);
+    Test::run_quaternion_blend_tests(context);
+    Test::run_executor_tests(context);
+    Test::run_gemm_tests(context);
+    Test::run_constexpr_tests(context);
+    Test::run_pack_dispatch_tests(context);
+
+    std::cout << context.checks() - context.failures() << " of " << context.checks() << " checks passed\n";
+    return context.failures() ? 1 : 0;
+}
@@ -0,0 +1,306 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <set>
+#include <string>
+#include <vector>
+#include "Test.h"
+#include "TransformHierarchy.h"
+
+// TransformHierarchy against a naive recursive parent world * T * R * S, after a full, a sparse and a dense update,
+// after nodes were added to an updated hierarchy, and split over threads. TransformHierarchyStats has to count exactly
+// the dirty nodes, their descendants and the levels those span.
+namespace Test {
+    namespace {
+        template<typename T>
+        struct Local {
+            Vector<T, 3> translation;
+            Quaternion<T> rotation;
+            Vector<T, 3> scale;
+        };
+
+        // Naive mirror of a hierarchy: parents and local transforms by node handle
+        template<typename T>
+        struct Reference {
+            std::vector<std::size_t> parent;
+            std::vector<Local<T>> local;
+
+            Matrix<T, 4, 4> local_matrix(std::size_t node) const {
+                const Local<T> &l = local[node];
+                Matrix<T, 4, 4> translate, rotate, scale;
+                const Matrix<T, 3, 3> rotation = l.rotation.ToMatrix3();
+                for (std::size_t r = 0; r < 3; ++r) {
+                    translate(r, 3) = l.translation[r];
+                    scale(r, r) = l.scale[r];
+                    for (std::size_t c = 0; c < 3; ++c)
+                        rotate(r, c) = rotation(r, c);
+                }
+                return translate * rotate * scale;
+            }
+
+            Matrix<T, 4, 4> world(std::size_t node) const {
+                if (parent[node] == TransformHierarchy<T>::none)
+                    return local_matrix(node);
+                return world(parent[node]) * local_matrix(node);
+            }
+
+            std::size_t depth(std::size_t node) const {
+                return parent[node] == TransformHierarchy<T>::none ? 0 : depth(parent[node]) + 1;
+            }
+
+            // The dirty nodes and everything below them
+            std::vector<bool> affected(const std::set<std::size_t> &dirty) const {
+                std::vector<bool> result(parent.size(), false);
+                for (std::size_t node = 0; node < parent.size(); ++node)
+                    result[node] = dirty.count(node) != 0 ||
+                                   (parent[node] != TransformHierarchy<T>::none && result[parent[node]]);
+                return result;
+            }
+        };
+
+        template<typename T>
+        Local<T> random_local() {
+            return Local<T>{random_vector<T, 3>(T(-2), T(2)), random_rotation<T>(),
+                            random_vector<T, 3>(T(0.5), T(1.5))};
+        }
+
+        template<typename T>
+        std::size_t add_node(TransformHierarchy<T> &hierarchy, Reference<T> &reference, std::size_t parent) {
+            const Local<T> local = random_local<T>();
+            reference.parent.push_back(parent);
+            reference.local.push_back(local);
+            return hierarchy.add(parent, local.translation, local.rotation, local.scale);
+        }
+
+        // A random forest of count nodes: a few roots, every other node below a random earlier one
+        template<typename T>
+        void add_random_nodes(TransformHierarchy<T> &hierarchy, Reference<T> &reference, std::size_t count) {
+            for (std::size_t i = 0; i < count; ++i) {
+                const std::size_t size = reference.parent.size();
+                const bool root = size == 0 || random_value<double>(0.0, 1.0) < 0.02;
+                const std::size_t parent = root ? TransformHierarchy<T>::none :
+                                           std::min(size - 1, std::size_t(random_value<double>(0.0, double(size))));
+                add_node(hierarchy, reference, parent);
+            }
+        }
+
+        template<typename T>
+        void set_random_local(TransformHierarchy<T> &hierarchy, Reference<T> &reference, std::size_t node,
+                              std::set<std::size_t> &dirty) {
+            const Local<T> local = random_local<T>();
+            reference.local[node] = local;
+            switch (dirty.size() % 3) {
+                case 0:
+                    hierarchy.set_local(node, local.translation, local.rotation, local.scale);
+                    break;
+                case 1:
+                    hierarchy.set_translation(node, local.translation);
+                    hierarchy.set_rotation(node, local.rotation);
+                    hierarchy.set_scale(node, local.scale);
+                    break;
+                default:
+                    /* The same node twice is still one dirty node */
+                    hierarchy.set_translation(node, local.translation);
+                    hierarchy.set_local(node, local.translation, local.rotation, local.scale);
+                    break;
+            }
+            dirty.insert(node);
+        }
+
+        // Every world matrix against the reference, one check
+        template<typename T>
+        void check_worlds(Context &context, const TransformHierarchy<T> &hierarchy, const Reference<T> &reference,
+                          const std::string &what) {
+            std::size_t node = 0;
+            double worst = 0.0;
+            for (; node < hierarchy.size(); ++node) {
+                const Matrix<T, 4, 4> expected = reference.world(node);
+                double magnitude = 1.0;
+                for (std::size_t e = 0; e < expected.elements; ++e)
+                    magnitude = std::max(magnitude, double(std::abs(expected[e])));
+                worst = max_difference(hierarchy.world(node), expected) / magnitude;
+                if (worst > tolerance<T>())
+                    break;
+            }
+            context.check(node == hierarchy.size(), what + ": world matrices match the recursive T * R * S" +
+                                                    (node == hierarchy.size() ? std::string() :
+                                                     ", node " + std::to_string(node) + " off by " +
+                                                     std::to_string(worst)));
+
+            bool order = true;
+            for (std::size_t i = 0; i < hierarchy.size(); ++i)
+                order = order && std::memcmp(&hierarchy.world_matrices()[i], &hierarchy.world(hierarchy.node_at(i)),
+                                             sizeof(Matrix<T, 4, 4>)) == 0;
+            context.check(order, what + ": node_at(i) is the node of world_matrices()[i]");
+        }
+
+        // Updates after the nodes in dirty changed and checks the stats and that nothing else was recomputed
+        template<typename T>
+        void check_update(Context &context, TransformHierarchy<T> &hierarchy, const Reference<T> &reference,
+                          const std::set<std::size_t> &dirty, const Sm::TransformHierarchyOptions &options,
+                          bool reordered, const std::string &what) {
+            std::vector<Matrix<T, 4, 4>> before(hierarchy.size());
+            for (std::size_t node = 0; node < hierarchy.size(); ++node)
+                before[node] = hierarchy.world(node);
+
+            const Sm::TransformHierarchyStats stats = hierarchy.update(options);
+
+            const std::vector<bool> affected = reference.affected(dirty);
+            std::set<std::size_t> depths;
+            std::size_t expectedUpdated = 0;
+            bool untouched = true;
+            for (std::size_t node = 0; node < hierarchy.size(); ++node) {
+                if (affected[node]) {
+                    ++expectedUpdated;
+                    depths.insert(reference.depth(node));
+                } else {
+                    untouched = untouched && std::memcmp(&before[node], &hierarchy.world(node),
+                                                         sizeof(Matrix<T, 4, 4>)) == 0;
+                }
+            }
+
+            context.check(stats.nodes == hierarchy.size(), what + ": stats.nodes");
+            context.check(stats.dirty == dirty.size(), what + ": stats.dirty is " + std::to_string(stats.dirty) +
+                                                       ", expected " + std::to_string(dirty.size()));
+            context.check(stats.worldUpdated == expectedUpdated,
+                          what + ": stats.worldUpdated is " + std::to_string(stats.worldUpdated) + ", expected " +
+                          std::to_string(expectedUpdated));
+            context.check(stats.levels == depths.size(), what + ": stats.levels is " + std::to_string(stats.levels) +
+                                                         ", expected " + std::to_string(depths.size()));
+            context.check(stats.reordered == reordered, what + ": stats.reordered");
+            context.check(untouched, what + ": world matrices outside the dirty subtrees are untouched");
+            context.check(hierarchy.stats().worldUpdated == stats.worldUpdated &&
+                          hierarchy.stats().levels == stats.levels, what + ": stats() returns the last update");
+            check_worlds(context, hierarchy, reference, what);
+        }
+
+        template<typename T>
+        void updates(Context &context) {
+            context.section(std::string("TransformHierarchy<") + type_name<T>() + ">");
+            TransformHierarchy<T> hierarchy;
+            Reference<T> reference;
+            const Sm::TransformHierarchyOptions options;
+
+            add_random_nodes(hierarchy, reference, 400);
+            std::set<std::size_t> dirty;
+            for (std::size_t node = 0; node < hierarchy.size(); ++node)
+                dirty.insert(node);
+            check_update(context, hierarchy, reference, dirty, options, true, "first update");
+
+            dirty.clear();
+            check_update(context, hierarchy, reference, dirty, options, false, "update with nothing dirty");
+
+            /* Fewer than one in eight nodes dirty takes the sparse walk, a parent and its child among them */
+            for (std::size_t round = 0; round < 5; ++round) {
+                dirty.clear();
+                for (std::size_t i = 0; i < 10; ++i)
+                    set_random_local(hierarchy, reference,
+                                     std::size_t(random_value<double>(0.0, double(hierarchy.size() - 1))), dirty);
+                const std::size_t child = std::size_t(random_value<double>(1.0, double(hierarchy.size() - 1)));
+                set_random_local(hierarchy, reference, child, dirty);
+                if (reference.parent[child] != TransformHierarchy<T>::none)
+                    set_random_local(hierarchy, reference, reference.parent[child], dirty);
+                check_update(context, hierarchy, reference, dirty, options, false,
+                             "sparse update " + std::to_string(round));
+            }
+
+            /* More than one in eight takes the dense pass */
+            for (std::size_t round = 0; round < 3; ++round) {
+                dirty.clear();
+                for (std::size_t i = 0; i < hierarchy.size() / 4; ++i)
+                    set_random_local(hierarchy, reference,
+                                     std::size_t(random_value<double>(0.0, double(hierarchy.size() - 1))), dirty);
+                check_update(context, hierarchy, reference, dirty, options, false,
+                             "dense update " + std::to_string(round));
+            }
+
+            /* Nodes added below existing ones, and a new root, move slots around */
+            for (std::size_t round = 0; round < 3; ++round) {
+                dirty.clear();
+                const std::size_t first = hierarchy.size();
+                add_random_nodes(hierarchy, reference, 30);
+                add_node(hierarchy, reference, TransformHierarchy<T>::none);
+                add_node(hierarchy, reference, hierarchy.size() - 1);
+                for (std::size_t node = first; node < hierarchy.size(); ++node)
+                    dirty.insert(node);
+                set_random_local(hierarchy, reference, 0, dirty);
+                check_update(context, hierarchy, reference, dirty, options, true,
+                             "reorder after add " + std::to_string(round));
+
+                bool parents = true;
+                for (std::size_t node = 0; node < hierarchy.size(); ++node)
+                    parents = parents && hierarchy.parent(node) == reference.parent[node];
+                context.check(parents, "parent() keeps the handles after reorder " + std::to_string(round));
+            }
+        }
+
+        // Fills two hierarchies with the same wide tree: a few roots with thousands of children and grandchildren
+        template<typename T>
+        void wide_tree(TransformHierarchy<T> &hierarchy, TransformHierarchy<T> &copy, Reference<T> &reference) {
+            for (std::size_t root = 0; root < 3; ++root)
+                add_node(hierarchy, reference, TransformHierarchy<T>::none);
+            for (std::size_t i = 0; i < 3000; ++i)
+                add_node(hierarchy, reference, i % 3);
+            for (std::size_t i = 0; i < 6000; ++i)
+                add_node(hierarchy, reference, 3 + i % 3000);
+
+            for (std::size_t node = 0; node < reference.parent.size(); ++node)
+                copy.add(reference.parent[node], reference.local[node].translation, reference.local[node].rotation,
+                         reference.local[node].scale);
+        }
+
+        template<typename T>
+        void threads(Context &context) {
+            context.section(std::string("TransformHierarchy<") + type_name<T>() + "> threads");
+            TransformHierarchy<T> hierarchy, serial;
+            Reference<T> reference;
+            wide_tree(hierarchy, serial, reference);
+
+            Executor executor{4};
+            Sm::TransformHierarchyOptions options;
+            options.threads = 4;
+            options.executor = &executor;
+            options.parallelThreshold = 256;
+
+            std::set<std::size_t> dirty;
+            for (std::size_t node = 0; node < hierarchy.size(); ++node)
+                dirty.insert(node);
+            check_update(context, hierarchy, reference, dirty, options, true, "parallel first update");
+            context.check(hierarchy.stats().threads == 4, "levels above the threshold use every thread");
+            serial.update();
+            context.check(serial.stats().threads == 1, "the default options stay on the calling thread");
+
+            /* A dirty root drags its whole subtree into the update, sparse on the dirty list, wide in its levels */
+            for (std::size_t round = 0; round < 3; ++round) {
+                dirty.clear();
+                set_random_local(hierarchy, reference, round, dirty);
+                const Local<T> &local = reference.local[round];
+                serial.set_local(round, local.translation, local.rotation, local.scale);
+                check_update(context, hierarchy, reference, dirty, options, false,
+                             "parallel sparse update " + std::to_string(round));
+                context.check(hierarchy.stats().threads > 1, "a dirty root splits its levels");
+                serial.update();
+            }
+
+            bool same = true;
+            for (std::size_t node = 0; node < hierarchy.size(); ++node)
+                same = same && std::memcmp(&hierarchy.world(node), &serial.world(node), sizeof(Matrix<T, 4, 4>)) == 0;
+            context.check(same, "threads give bitwise the world matrices of the calling thread alone");
+
+            /* Below the threshold a level stays on the calling thread */
+            options.parallelThreshold = 1 << 20;
+            dirty.clear();
+            set_random_local(hierarchy, reference, 0, dirty);
+            check_update(context, hierarchy, reference, dirty, options, false, "update below the threshold");
+            context.check(hierarchy.stats().threads == 1, "levels below the threshold stay on one thread");
+        }
+    }
+
+    void run_transform_hierarchy_tests(Context &context) {
+        updates<float>(context);
+        updates<double>(context);
+        threads<float>(context);
+        threads<double>(context);
+    }
+}
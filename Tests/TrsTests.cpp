@@ -0,0 +1,169 @@
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "Test.h"
+#include "Trs.h"
+
+// Sm::compose_trs against the product of the three 4x4 factors, Sm::decompose_trs round trips with positive,
+// negative and mixed scales, and the VectorArray batches bitwise against the single transform calls.
+namespace Test {
+    namespace {
+        template<typename T>
+        Matrix<T, 4, 4> translate_rotate_scale(const Vector<T, 3> &t, const Quaternion<T> &q, const Vector<T, 3> &s) {
+            Matrix<T, 4, 4> translate, rotate, scale;
+            const Matrix<T, 3, 3> rotation = q.ToMatrix3();
+            for (std::size_t r = 0; r < 3; ++r) {
+                translate(r, 3) = t[r];
+                scale(r, r) = s[r];
+                for (std::size_t c = 0; c < 3; ++c)
+                    rotate(r, c) = rotation(r, c);
+            }
+            return translate * rotate * scale;
+        }
+
+        // q and -q are the same rotation
+        template<typename T>
+        Quaternion<T> same_hemisphere(const Quaternion<T> &q, const Quaternion<T> &reference) {
+            return Sm::dot(q, reference) < T(0) ? Quaternion<T>{-q.x, -q.y, -q.z, -q.w} : q;
+        }
+
+        template<typename T>
+        Vector<T, 3> random_scale() {
+            return random_vector<T, 3>(T(0.25), T(4));
+        }
+
+        template<typename T>
+        void compose(Context &context) {
+            context.section(std::string("Sm::compose_trs<") + type_name<T>() + ">");
+            const double tolerance = Test::tolerance<T>() * 10;
+
+            for (std::size_t round = 0; round < 200; ++round) {
+                const Vector<T, 3> t = random_vector<T, 3>(), s = random_scale<T>();
+                const Quaternion<T> q = random_rotation<T>();
+                const std::string what = "round " + std::to_string(round);
+
+                const Matrix<T, 4, 4> composed = Sm::compose_trs(t, q, s);
+                check_near(context, composed, translate_rotate_scale(t, q, s), tolerance, what + ": T * R * S");
+                check_near(context, Sm::compose_trs(Trs<T>{t, q, s}), composed, 0.0, what + ": Trs overload");
+
+                /* The bottom row is exactly (0, 0, 0, 1) */
+                context.check(composed(3, 0) == T(0) && composed(3, 1) == T(0) && composed(3, 2) == T(0) &&
+                              composed(3, 3) == T(1), what + ": affine bottom row");
+            }
+        }
+
+        template<typename T>
+        void decompose(Context &context) {
+            context.section(std::string("Sm::decompose_trs<") + type_name<T>() + ">");
+            const double tolerance = Test::tolerance<T>() * 10;
+
+            for (std::size_t round = 0; round < 200; ++round) {
+                const Vector<T, 3> t = random_vector<T, 3>(), s = random_scale<T>();
+                const Quaternion<T> q = random_rotation<T>();
+                const std::string what = "round " + std::to_string(round);
+
+                const Trs<T> parts = Sm::decompose_trs(Sm::compose_trs(t, q, s));
+                check_near(context, parts.translation, t, 0.0, what + ": translation is the last column");
+                check_near(context, parts.scale, s, tolerance * 4, what + ": scale");
+                check_near(context, same_hemisphere(parts.rotation, q), q, tolerance, what + ": rotation");
+                check_near(context, double(Sm::dot(parts.rotation, parts.rotation)), 1.0, tolerance,
+                           what + ": unit rotation");
+
+                /* A negative scale.x is kept as it is */
+                const Vector<T, 3> flippedX{-s.x, s.y, s.z};
+                const Trs<T> reflected = Sm::decompose_trs(Sm::compose_trs(t, q, flippedX));
+                check_near(context, reflected.scale, flippedX, tolerance * 4, what + ": negative scale.x");
+                check_near(context, same_hemisphere(reflected.rotation, q), q, tolerance,
+                           what + ": rotation of a negative scale.x");
+
+                /* Other reflections come back as another rotation with a negative scale.x, which composes to the
+                 * same matrix */
+                const Vector<T, 3> flips[3] = {Vector<T, 3>{s.x, -s.y, s.z}, Vector<T, 3>{s.x, s.y, -s.z},
+                                               Vector<T, 3>{-s.x, -s.y, -s.z}};
+                for (const auto &flipped: flips) {
+                    const Matrix<T, 4, 4> m = Sm::compose_trs(t, q, flipped);
+                    const Trs<T> trs = Sm::decompose_trs(m);
+                    context.check(trs.scale.x < T(0) && trs.scale.y > T(0) && trs.scale.z > T(0),
+                                  what + ": a reflection puts the sign on scale.x");
+                    check_near(context, Sm::compose_trs(trs), m, tolerance * 4, what + ": reflection round trip");
+                }
+
+                /* A rotation with a uniform scale and no translation */
+                const T uniform = random_value<T>(T(0.25), T(4));
+                const Trs<T> scaled = Sm::decompose_trs(Sm::compose_trs(Vector<T, 3>{}, q,
+                                                                        Vector<T, 3>{uniform, uniform, uniform}));
+                check_near(context, scaled.scale, Vector<T, 3>{uniform, uniform, uniform}, tolerance * 4,
+                           what + ": uniform scale");
+            }
+
+            /* Rotations where each of w, x, y and z is the largest, so every branch of Shepperd's method runs */
+            const T h = T(0.5);
+            const Quaternion<T> pivots[8] = {
+                    Quaternion<T>{T(0), T(0), T(0), T(1)}, Quaternion<T>{T(1), T(0), T(0), T(0)},
+                    Quaternion<T>{T(0), T(1), T(0), T(0)}, Quaternion<T>{T(0), T(0), T(1), T(0)},
+                    Quaternion<T>{h, -h, h, h}, Quaternion<T>{T(0.8), T(0.36), T(0.48), T(0)},
+                    Quaternion<T>{T(0.36), T(0.8), T(0), T(0.48)}, Quaternion<T>{T(0), T(0.48), T(0.8), T(0.36)}};
+            for (std::size_t i = 0; i < 8; ++i) {
+                const Quaternion<T> q = pivots[i];
+                const Trs<T> parts = Sm::decompose_trs(Sm::compose_trs(Vector<T, 3>{}, q, Vector<T, 3>{T(1)}));
+                check_near(context, same_hemisphere(parts.rotation, q), q, tolerance,
+                           "pivot rotation " + std::to_string(i));
+            }
+        }
+
+        template<typename T>
+        void batches(Context &context) {
+            context.section(std::string("Sm::compose_trs(VectorArray)<") + type_name<T>() + ">");
+
+            /* Every count up to a few packs, so both the packs and the scalar tail are covered */
+            for (std::size_t count = 0; count <= 19; ++count) {
+                VectorArray<T, 3> translations(count), scales(count);
+                VectorArray<T, 4> rotations(count);
+                for (std::size_t i = 0; i < count; ++i) {
+                    const Quaternion<T> q = random_rotation<T>();
+                    translations.set(i, random_vector<T, 3>());
+                    scales.set(i, i % 3 == 0 ? Vector<T, 3>{-random_value<T>(T(0.25), T(4)), T(1), T(2)}
+                                             : random_scale<T>());
+                    rotations.set(i, Vector<T, 4>{q.x, q.y, q.z, q.w});
+                }
+
+                std::vector<Matrix<T, 4, 4>> composed(count);
+                Sm::compose_trs(translations, rotations, scales, composed.data());
+                bool same = true;
+                for (std::size_t i = 0; i < count; ++i) {
+                    const Vector<T, 4> r = rotations.get(i);
+                    const Matrix<T, 4, 4> single = Sm::compose_trs(translations.get(i),
+                                                                   Quaternion<T>{r.x, r.y, r.z, r.w}, scales.get(i));
+                    same = same && std::memcmp(&single, &composed[i], sizeof(single)) == 0;
+                }
+                context.check(same, "compose batch of " + std::to_string(count) + " matches the single calls");
+
+                VectorArray<T, 3> outTranslations, outScales;
+                VectorArray<T, 4> outRotations;
+                Sm::decompose_trs(composed.data(), count, outTranslations, outRotations, outScales);
+                same = outTranslations.size() == count && outRotations.size() == count && outScales.size() == count;
+                for (std::size_t i = 0; same && i < count; ++i) {
+                    const Trs<T> single = Sm::decompose_trs(composed[i]);
+                    const Vector<T, 3> t = outTranslations.get(i), s = outScales.get(i);
+                    const Vector<T, 4> r = outRotations.get(i);
+                    const Quaternion<T> q{r.x, r.y, r.z, r.w};
+                    same = std::memcmp(&t, &single.translation, sizeof(t)) == 0 &&
+                           std::memcmp(&s, &single.scale, sizeof(s)) == 0 &&
+                           std::memcmp(&q, &single.rotation, sizeof(q)) == 0;
+                }
+                context.check(same, "decompose batch of " + std::to_string(count) + " matches the single calls");
+            }
+        }
+    }
+
+    void run_trs_tests(Context &context) {
+        compose<float>(context);
+        compose<double>(context);
+        decompose<float>(context);
+        decompose<double>(context);
+        batches<float>(context);
+        batches<double>(context);
+    }
+}
@@ -0,0 +1,156 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Test.h"
+#include "VectorArray.h"
+
+// VectorArray storage, and the Sm:: batch overloads against the single vector functions they stand in for.
+// Batches run the same operations in the same order, so every result has to be the same value, zero and unit
+// vectors included.
+namespace Test {
+    namespace {
+        // The same value, NaN equal to NaN
+        template<typename T>
+        bool same_value(T lhs, T rhs) {
+            return lhs == rhs || (lhs != lhs && rhs != rhs);
+        }
+
+        template<typename T, std::size_t N>
+        bool same_vector(const Vector<T, N> &lhs, const Vector<T, N> &rhs) {
+            for (std::size_t c = 0; c < N; ++c)
+                if (!same_value(lhs[c], rhs[c]))
+                    return false;
+            return true;
+        }
+
+        // Random vectors with a zero vector, a unit axis and a tiny one mixed in
+        template<typename T, std::size_t N>
+        std::vector<Vector<T, N>> test_vectors(std::size_t count) {
+            std::vector<Vector<T, N>> vectors(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                vectors[i] = random_vector<T, N>();
+                if (i % 7 == 3)
+                    vectors[i] = Vector<T, N>{};
+                if (i % 7 == 5) {
+                    vectors[i] = Vector<T, N>{};
+                    vectors[i][i % N] = T(i % 2 == 0 ? 1 : -1);
+                }
+                if (i % 7 == 6)
+                    vectors[i] = random_vector<T, N>(T(-1e-3), T(1e-3));
+            }
+            return vectors;
+        }
+
+        template<typename T, std::size_t N>
+        void storage(Context &context) {
+            context.section(std::string("VectorArray<") + type_name<T>() + ", " + std::to_string(N) + ">");
+            const std::vector<Vector<T, N>> vectors = test_vectors<T, N>(100);
+
+            VectorArray<T, N> pushed;
+            for (const auto &vec: vectors)
+                pushed.push_back(vec);
+            const VectorArray<T, N> assigned{vectors.data(), vectors.size()};
+            bool same = pushed.size() == vectors.size() && assigned.size() == vectors.size();
+            for (std::size_t i = 0; same && i < vectors.size(); ++i)
+                same = same_vector(pushed.get(i), vectors[i]) && same_vector(assigned.get(i), vectors[i]);
+            context.check(same, "push_back and assign keep every vector");
+
+            bool aligned = true;
+            for (std::size_t c = 0; c < N; ++c)
+                aligned = aligned && reinterpret_cast<std::uintptr_t>(pushed.component(c)) %
+                                     VectorArray<T, N>::alignment == 0;
+            context.check(aligned, "every component stream is aligned");
+
+            std::vector<Vector<T, N>> stored(vectors.size());
+            assigned.store(stored.data());
+            same = true;
+            for (std::size_t i = 0; i < vectors.size(); ++i)
+                same = same && same_vector(stored[i], vectors[i]);
+            context.check(same, "store gives the vectors back");
+
+            VectorArray<T, N> copied{assigned};
+            VectorArray<T, N> moved{std::move(pushed)};
+            copied.set(0, Vector<T, N>{T(7)});
+            context.check(pushed.empty() && moved.size() == vectors.size() && same_vector(moved.get(1), vectors[1]),
+                          "moving takes the storage");
+            context.check(same_vector(copied.get(0), Vector<T, N>{T(7)}) && same_vector(assigned.get(0), vectors[0]),
+                          "copies are independent");
+
+            copied.reserve(1000);
+            same = copied.capacity() >= 1000 && copied.size() == vectors.size();
+            for (std::size_t i = 1; same && i < vectors.size(); ++i)
+                same = same_vector(copied.get(i), vectors[i]);
+            context.check(same, "reserve keeps the vectors");
+
+            copied.resize(vectors.size() + 3);
+            context.check(same_vector(copied.get(vectors.size() + 2), Vector<T, N>{}),
+                          "resize fills with default vectors");
+            copied.clear();
+            context.check(copied.empty() && copied.capacity() >= 1000, "clear keeps the capacity");
+        }
+
+        template<typename T, std::size_t N>
+        void batches(Context &context) {
+            context.section(std::string("Sm::*(VectorArray<") + type_name<T>() + ", " + std::to_string(N) + ">)");
+
+            /* Every count up to a few packs covers the packs and the scalar tail, the last batch is large */
+            for (std::size_t count = 0; count <= 20; ++count) {
+                const std::size_t size = count == 20 ? 1000 : count;
+                const std::vector<Vector<T, N>> lhs = test_vectors<T, N>(size), rhs = test_vectors<T, N>(size);
+                const VectorArray<T, N> lhsArray{lhs.data(), size}, rhsArray{rhs.data(), size};
+                const T length = random_value<T>(T(0.5), T(3));
+
+                std::vector<T> dots(size), lengthsSq(size), lengths(size);
+                Sm::dot(lhsArray, rhsArray, dots.data());
+                Sm::length_sq(lhsArray, lengthsSq.data());
+                Sm::length(lhsArray, lengths.data());
+                VectorArray<T, N> normalized{lhsArray}, resized{lhsArray};
+                Sm::normalize(normalized);
+                Sm::resize(resized, length);
+
+                bool sameDot = true, sameLength = true, sameNormalize = true, sameResize = true;
+                for (std::size_t i = 0; i < size; ++i) {
+                    sameDot = sameDot && same_value(dots[i], Sm::dot(lhs[i], rhs[i]));
+                    sameLength = sameLength && same_value(lengthsSq[i], Sm::length_sq(lhs[i])) &&
+                                 same_value(lengths[i], Sm::length(lhs[i]));
+                    Vector<T, N> unit = lhs[i], scaled = lhs[i];
+                    Sm::normalize(unit);
+                    Sm::resize(scaled, length);
+                    sameNormalize = sameNormalize && same_vector(normalized.get(i), unit);
+                    sameResize = sameResize && same_vector(resized.get(i), scaled);
+                }
+                const std::string what = std::to_string(size) + " vectors";
+                context.check(sameDot, what + ": dot matches the single vector call");
+                context.check(sameLength, what + ": length_sq and length match the single vector calls");
+                context.check(sameNormalize, what + ": normalize matches the single vector call");
+                context.check(sameResize, what + ": resize matches the single vector call");
+            }
+
+            /* Enough vectors for several cache line aligned chunks per thread */
+            const std::vector<Vector<T, N>> vectors = test_vectors<T, N>(20011);
+            VectorArray<T, N> serial{vectors.data(), vectors.size()}, parallel{serial};
+            Executor executor{4};
+            Sm::normalize(serial);
+            Sm::normalize(executor, parallel);
+            bool same = true;
+            for (std::size_t c = 0; c < N; ++c)
+                for (std::size_t i = 0; i < vectors.size(); ++i)
+                    same = same && same_value(serial.component(c)[i], parallel.component(c)[i]);
+            context.check(same, "Sm::normalize(Executor) matches the serial batch");
+        }
+    }
+
+    void run_vector_array_tests(Context &context) {
+        storage<float, 2>(context);
+        storage<float, 3>(context);
+        storage<double, 4>(context);
+        batches<float, 2>(context);
+        batches<float, 3>(context);
+        batches<float, 4>(context);
+        batches<double, 2>(context);
+        batches<double, 3>(context);
+        batches<double, 4>(context);
+    }
+}